@@ -10,12 +10,16 @@
 //
 //-----------------------------------------------------------------------------
 
+#include "IlmThreadPool.h"
 #include "ImfAcesFile.h"
 #include "ImfArray.h"
+#include "ImfCompression.h"
 #include "ImfRgbaFile.h"
 #include "ImfMisc.h"
+#include "ImfScanLineBands.h"
+#include "ImfThreading.h"
 #include "OpenEXRConfig.h"
-#include <exception>
+#include <algorithm>
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
@@ -65,16 +69,6 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
                "";
 }
 
-void
-exr2aces (const char inFileName[], const char outFileName[], bool verbose)
-{
-    Array2D<Rgba> p;
-    Header        h;
-    RgbaChannels  ch;
-    Box2i         dw;
-    int           width;
-    int           height;
-
 #ifdef _MSC_VER
 #    pragma warning(push)
 #    pragma warning(disable : 4996)
@@ -83,22 +77,18 @@ exr2aces (const char inFileName[], const char outFileName[], bool verbose)
 #    pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 #endif
 
-    {
-        if (verbose) cout << "Reading file " << inFileName << endl;
-
-        AcesInputFile in (inFileName);
-
-        h  = in.header ();
-        ch = in.channels ();
-        dw = h.dataWindow ();
+void
+exr2aces (const char inFileName[], const char outFileName[], bool verbose)
+{
+    if (verbose) cout << "Reading file " << inFileName << endl;
 
-        width  = dw.max.x - dw.min.x + 1;
-        height = dw.max.y - dw.min.y + 1;
-        p.resizeErase (height, width);
+    AcesInputFile in (inFileName);
 
-        in.setFrameBuffer (ComputeBasePointer (&p[0][0], dw), 1, width);
-        in.readPixels (dw.min.y, dw.max.y);
-    }
+    Header       h      = in.header ();
+    RgbaChannels ch     = in.channels ();
+    Box2i        dw     = h.dataWindow ();
+    int          width  = dw.max.x - dw.min.x + 1;
+    int          height = dw.max.y - dw.min.y + 1;
 
     switch (h.compression ())
     {
@@ -110,21 +100,47 @@ exr2aces (const char inFileName[], const char outFileName[], bool verbose)
         default: h.compression () = PIZ_COMPRESSION;
     }
 
-    {
-        if (verbose) cout << "Writing file " << outFileName << endl;
+    if (verbose) cout << "Writing file " << outFileName << endl;
 
-        AcesOutputFile out (outFileName, h, ch);
+    AcesOutputFile out (outFileName, h, ch);
 
-        out.setFrameBuffer (ComputeBasePointer (&p[0][0], dw), 1, width);
-        out.writePixels (height);
-    }
+    Array2D<Rgba> pixels[2];
+    int           bandLines =
+        scanLineBandHeight (getCompressionNumScanlines (h.compression ()));
+
+    for (Array2D<Rgba>& band: pixels)
+        band.resizeErase (min (bandLines, height), width);
+
+    //
+    // The base pointer of a band buffer holding scan lines y1 to y2.
+    //
+
+    auto base = [&] (int buffer, int y1, int y2) {
+        return ComputeBasePointer (
+            &pixels[buffer][0][0],
+            Box2i (V2i (dw.min.x, y1), V2i (dw.max.x, y2)));
+    };
+
+    convertScanLineBands (
+        dw.min.y,
+        dw.max.y,
+        bandLines,
+        out.lineOrder (),
+        [&] (int buffer, int y1, int y2) {
+            in.setFrameBuffer (base (buffer, y1, y2), 1, width);
+            in.readPixels (y1, y2);
+        },
+        [&] (int buffer, int y1, int y2) {
+            out.setFrameBuffer (base (buffer, y1, y2), 1, width);
+            out.writePixels (y2 - y1 + 1);
+        });
+}
 
 #ifdef _MSC_VER
 #    pragma warning(pop)
 #elif defined(__clang__) || defined(__GNUC__)
 #    pragma GCC diagnostic pop
 #endif
-}
 
 } // namespace
 
@@ -211,6 +227,9 @@ main (int argc, char** argv)
 
     try
     {
+        setGlobalThreadCount (
+            ILMTHREAD_NAMESPACE::ThreadPool::estimateThreadCountForFileIO ());
+
         exr2aces (inFile, outFile, verbose);
     }
     catch (const exception& e)
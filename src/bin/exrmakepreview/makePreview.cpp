@@ -12,6 +12,9 @@
 #include "makePreview.h"
 
 #include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfFrameBuffer.h"
+#include "ImfPartType.h"
 #include "ImfInputFile.h"
 #include "ImfOutputFile.h"
 #include "ImfPreviewImage.h"
@@ -58,6 +61,30 @@ gamma (half h, float m)
         std::pow (x, 0.4545f) * 84.66f, 0.f, 255.f));
 }
 
+//
+// Whether the preview can be read with a decimated read of the file's
+// R, G, B and A channels, rather than reading the whole image through
+// the RGBA interface, which also handles luminance / chroma images.
+//
+
+bool
+canDecimate (const Header& header)
+{
+    if (header.hasTileDescription () ||
+        (header.hasType () && isDeepData (header.type ())) ||
+        header.channels ().findChannel ("Y"))
+        return false;
+
+    for (ChannelList::ConstIterator i = header.channels ().begin ();
+         i != header.channels ().end ();
+         ++i)
+    {
+        if (i.channel ().xSampling != 1 || i.channel ().ySampling != 1)
+            return false;
+    }
+    return true;
+}
+
 void
 generatePreview (
     const char            inFileName[],
@@ -67,25 +94,62 @@ generatePreview (
     Array2D<PreviewRgba>& previewPixels)
 {
     //
-    // Read the input file
+    // Read the input file. When possible, only every n-th pixel (or
+    // rather, the average of each n by n block) is read, where n is
+    // the largest factor which still leaves at least as many pixels
+    // as there are in the preview, so the whole image never has to
+    // be held in memory.
     //
 
-    RgbaInputFile in (inFileName);
+    InputFile inFile (inFileName);
 
-    Box2i dw = in.dataWindow ();
-    float a  = in.pixelAspectRatio ();
+    Box2i dw = inFile.header ().dataWindow ();
+    float a  = inFile.header ().pixelAspectRatio ();
     int   w  = dw.max.x - dw.min.x + 1;
     int   h  = dw.max.y - dw.min.y + 1;
 
-    Array2D<Rgba> pixels (h, w);
-    in.setFrameBuffer (ComputeBasePointer (&pixels[0][0], dw), 1, w);
-    in.readPixels (dw.min.y, dw.max.y);
+    previewHeight = max (int (h / (w * a) * previewWidth + .5f), 1);
+
+    Array2D<Rgba> pixels;
+    Box2i         pdw = dw;
+    int           n   = 1;
+
+    if (canDecimate (inFile.header ()))
+    {
+        n = max (1, min (w / previewWidth, h / previewHeight));
+        inFile.setDecimation (n, true);
+
+        pdw    = inFile.decimatedDataWindow ();
+        int pw = pdw.max.x - pdw.min.x + 1;
+        int ph = pdw.max.y - pdw.min.y + 1;
+
+        pixels.resizeErase (ph, pw);
+
+        Rgba*       base = ComputeBasePointer (&pixels[0][0], pdw);
+        size_t      xs   = sizeof (Rgba);
+        size_t      ys   = xs * pw;
+        FrameBuffer fb;
+        fb.insert ("R", Slice (HALF, (char*) &base->r, xs, ys, 1, 1, 0.0));
+        fb.insert ("G", Slice (HALF, (char*) &base->g, xs, ys, 1, 1, 0.0));
+        fb.insert ("B", Slice (HALF, (char*) &base->b, xs, ys, 1, 1, 0.0));
+        fb.insert ("A", Slice (HALF, (char*) &base->a, xs, ys, 1, 1, 1.0));
+
+        inFile.setFrameBuffer (fb);
+        inFile.readPixels (pdw.min.y, pdw.max.y);
+    }
+    else
+    {
+        RgbaInputFile in (inFileName);
+
+        pixels.resizeErase (h, w);
+        in.setFrameBuffer (ComputeBasePointer (&pixels[0][0], dw), 1, w);
+        in.readPixels (dw.min.y, dw.max.y);
+    }
 
     //
     // Make a preview image
     //
 
-    previewHeight = max (int (h / (w * a) * previewWidth + .5f), 1);
     previewPixels.resizeErase (previewHeight, previewWidth);
 
     double fx = (previewWidth > 1) ? (double (w - 1) / (previewWidth - 1)) : 1;
@@ -96,10 +160,17 @@ generatePreview (
 
     for (int y = 0; y < previewHeight; ++y)
     {
+        // the (decimated) pixel covering the sampled pixel of the image
+        int py = divp (dw.min.y + int (y * fy + .5f), n);
+        py     = IMATH_NAMESPACE::clamp (py, pdw.min.y, pdw.max.y) - pdw.min.y;
+
         for (int x = 0; x < previewWidth; ++x)
         {
+            int px = divp (dw.min.x + int (x * fx + .5f), n);
+            px = IMATH_NAMESPACE::clamp (px, pdw.min.x, pdw.max.x) - pdw.min.x;
+
             PreviewRgba& preview = previewPixels[y][x];
-            const Rgba&  pixel = pixels[int (y * fy + .5f)][int (x * fx + .5f)];
+            const Rgba&  pixel   = pixels[py][px];
 
             preview.r = gamma (pixel.r, m);
             preview.g = gamma (pixel.g, m);
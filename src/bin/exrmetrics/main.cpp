@@ -11,6 +11,7 @@
 #include "ImfThreading.h"
 #include "IlmThreadPool.h"
 #include "ImfMultiPartInputFile.h"
+#include "ImfTranscode.h"
 #include "ImfVersion.h"
 
 #include <algorithm>
@@ -77,6 +78,8 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
                "  --convert                   shorthand options for writing a new file with no metrics:\n"
                "                              -p all --time none --pixelmode orig --no-size --passes 1\n"
                "                              change pixel data type/compression by specifying --pixelmode/-z after --convert\n"
+               "                              changing only the compression of one file copies the compressed\n"
+               "                              chunks without unpacking the pixels, which is much faster\n"
                "\n"
                "  --bench                     shorthand options for robust performance benchmarking:\n"
                "                              -p all --compression all --time write,reread --passes 10 --type half,float --no-size --csv\n"
@@ -131,6 +134,7 @@ struct options
     bool                     outputPartSizeOnDisk = false;
     bool                     verbose        = false;
     bool                     csv            = false;
+    bool                     convert        = false;
     std::vector<PixelMode>   pixelModes;
     std::vector<OPENEXR_IMF_NAMESPACE::Compression> compressions;
 
@@ -522,6 +526,25 @@ main (int argc, char** argv)
         else
             setGlobalThreadCount (opts.threads);
 
+        //
+        // converting a file to a new compression method, with no metrics,
+        // doesn't need to unpack the pixels
+        //
+        if (opts.convert && opts.outFile && opts.inFiles.size () == 1 &&
+            opts.part == -1 && !opts.timing && !opts.outputSizeData &&
+            opts.pixelModes.size () == 1 &&
+            opts.pixelModes[0] == PIXELMODE_ORIGINAL &&
+            opts.compressions.size () == 1 &&
+            opts.compressions[0] != NUM_COMPRESSION_METHODS)
+        {
+            transcodeOpenEXRFile (
+                opts.inFiles[0],
+                opts.outFile,
+                opts.compressions[0],
+                isinf (opts.level) ? -1.f : opts.level);
+            return 0;
+        }
+
         for (const char* inFile: opts.inFiles)
         {
             bool hasDeep = false;
@@ -688,6 +711,7 @@ options::parse (int argc, char* argv[])
             outputSizeData = false;
             timing         = 0;
             part           = -1;
+            convert        = true;
             i += 1;
         }
         else if (!strcmp (argv[i], "--passes"))
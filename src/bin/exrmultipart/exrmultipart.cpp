@@ -10,6 +10,7 @@
 //-----------------------------------------------------------------------------
 
 #include "ImfChannelList.h"
+#include "ImfCompression.h"
 #include "ImfDeepScanLineInputPart.h"
 #include "ImfDeepScanLineOutputPart.h"
 #include "ImfDeepTiledInputPart.h"
@@ -20,12 +21,15 @@
 #include "ImfOutputPart.h"
 #include "ImfPartHelper.h"
 #include "ImfPartType.h"
+#include "ImfScanLineBands.h"
 #include "ImfStringAttribute.h"
 #include "ImfTiledInputPart.h"
+#include "ImfThreading.h"
 #include "ImfTiledOutputPart.h"
 #include "ImfMisc.h"
 #include "OpenEXRConfig.h"
 
+#include "IlmThreadPool.h"
 #include "Iex.h"
 #include "OpenEXRConfig.h"
 
@@ -33,6 +37,7 @@
 #include <assert.h>
 #include <cctype>
 #include <cstdint>
+#include <exception>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -76,6 +81,18 @@ vectorSize (int64_t count, size_t samplesize)
     return c * samplesize;
 }
 
+//
+// The pixels of a band of scan lines, one buffer per channel, and the
+// frame buffers to read and write them.
+//
+
+struct Band
+{
+    vector<vector<char>> store;
+    FrameBuffer          input;
+    vector<FrameBuffer>  outputs;
+};
+
 } // namespace
 
 void
@@ -280,9 +297,7 @@ convert (
     int parts = SplitChannels (
         output_channels.begin (), output_channels.end (), true, hero);
 
-    vector<Header>      output_headers (parts);
-    vector<FrameBuffer> output_framebuffers (parts);
-    FrameBuffer         input_framebuffer;
+    vector<Header> output_headers (parts);
 
     //
     // make all output headers the same as the input header but
@@ -307,31 +322,31 @@ convert (
 
     const ChannelList& in_chanlist = infile.header (0).channels ();
 
-    int channel_count = 0;
-    for (ChannelList::ConstIterator i = in_chanlist.begin ();
-         i != in_chanlist.end ();
-         ++i)
-    {
-        ++channel_count;
-    }
-
     Box2i dataWindow  = infile.header (0).dataWindow ();
     //
     // use int64_t for dimensions, since possible overflow int storage
     //
-    int64_t pixel_count = (static_cast<int64_t>(dataWindow.size ().y) + 1) * (static_cast<int64_t>(dataWindow.size ().x) + 1);
     int64_t pixel_width = static_cast<int64_t>(dataWindow.size ().x) + 1;
 
     //
-    // offset in pixels between base of array and 0,0
-    // use int64_t for dimensions, since dataWindow.min.y * pixel_width could overflow int storage
+    // copy the pixels a band of scan lines at a time
     //
-    int64_t pixel_base = static_cast<int64_t>(dataWindow.min.y) * pixel_width + static_cast<int64_t>(dataWindow.min.x);
-
-    vector<vector<char>> channelstore (channel_count);
+    const Header& in_header   = infile.header (0);
+    int           chunk_lines = in_header.hasTileDescription ()
+                                    ? in_header.tileDescription ().ySize
+                                    : getCompressionNumScanlines (in_header.compression ());
+    int     band_lines       = scanLineBandHeight (chunk_lines);
+    int64_t band_pixel_count = static_cast<int64_t>(band_lines) * pixel_width;
+
+    Band bands[2];
+    for (Band& band: bands)
+    {
+        band.store.resize (input_channels.size ());
+        band.outputs.resize (parts);
+    }
 
     //
-    // insert channels into correct header and framebuffers
+    // insert channels into correct header and allocate the bands
     //
     for (size_t i = 0; i < input_channels.size (); i++)
     {
@@ -350,49 +365,78 @@ convert (
         // compute size of channel
         size_t samplesize = sizeof (float);
         if (chan.channel ().type == HALF) { samplesize = sizeof (half); }
-        channelstore[i].resize (vectorSize (pixel_count, samplesize));
-
-        output_framebuffers[part].insert (
-            output_channels[i].name,
-            Slice (
-                chan.channel ().type,
-                &channelstore[i][0] - pixel_base * samplesize,
-                samplesize,
-                pixel_width * samplesize));
-
-        input_framebuffer.insert (
-            input_channels[i].internal_name,
-            Slice (
-                chan.channel ().type,
-                &channelstore[i][0] - pixel_base * samplesize,
-                samplesize,
-                pixel_width * samplesize));
-    }
-
-    //
-    // create output file
-    //
-    MultiPartOutputFile outfile (
-        outname, &output_headers[0], output_headers.size ());
 
-    InputPart inpart (infile, 0);
+        for (Band& band: bands)
+            band.store[i].resize (vectorSize (band_pixel_count, samplesize));
+    }
 
     //
-    // read file
+    // point the frame buffers of a band at the scan lines from y1
     //
-    inpart.setFrameBuffer (input_framebuffer);
-    inpart.readPixels (dataWindow.min.y, dataWindow.max.y);
+    auto setBand = [&] (Band& band, int y1) {
+        //
+        // offset in pixels between base of array and y1,0
+        // use int64_t for dimensions, since y1 * pixel_width could overflow int storage
+        //
+        int64_t pixel_base = static_cast<int64_t>(y1) * pixel_width + static_cast<int64_t>(dataWindow.min.x);
+
+        band.input = FrameBuffer ();
+        for (FrameBuffer& fb: band.outputs)
+            fb = FrameBuffer ();
+
+        for (size_t i = 0; i < input_channels.size (); i++)
+        {
+            PixelType type =
+                in_chanlist[input_channels[i].internal_name].type;
+            size_t samplesize = sizeof (float);
+            if (type == HALF) { samplesize = sizeof (half); }
+
+            band.outputs[output_channels[i].part_number].insert (
+                output_channels[i].name,
+                Slice (
+                    type,
+                    &band.store[i][0] - pixel_base * samplesize,
+                    samplesize,
+                    pixel_width * samplesize));
+
+            band.input.insert (
+                input_channels[i].internal_name,
+                Slice (
+                    type,
+                    &band.store[i][0] - pixel_base * samplesize,
+                    samplesize,
+                    pixel_width * samplesize));
+        }
+    };
 
     //
-    // write each part
+    // create output file
     //
+    MultiPartOutputFile outfile (
+        outname, &output_headers[0], output_headers.size ());
 
-    for (size_t i = 0; i < output_framebuffers.size (); i++)
-    {
-        OutputPart outpart (outfile, i);
-        outpart.setFrameBuffer (output_framebuffers[i]);
-        outpart.writePixels (dataWindow.max.y + 1 - dataWindow.min.y);
-    }
+    InputPart          inpart (infile, 0);
+    vector<OutputPart> outparts;
+    for (int i = 0; i < parts; i++)
+        outparts.emplace_back (outfile, i);
+
+    convertScanLineBands (
+        dataWindow.min.y,
+        dataWindow.max.y,
+        band_lines,
+        in_header.lineOrder (),
+        [&] (int buffer, int y1, int y2) {
+            setBand (bands[buffer], y1);
+            inpart.setFrameBuffer (bands[buffer].input);
+            inpart.readPixels (y1, y2);
+        },
+        [&] (int buffer, int y1, int y2) {
+            for (int i = 0; i < parts; i++)
+            {
+                outparts[i].setFrameBuffer (bands[buffer].outputs[i]);
+                outparts[i].writePixels (y2 + 1 - y1);
+            }
+        });
 }
 
 void
@@ -727,6 +771,9 @@ main (int argc, char* argv[])
         cout << "output:\n      " << outFile << endl;
         cout << "override:" << override << "\n" << endl;
 
+        setGlobalThreadCount (
+            ILMTHREAD_NAMESPACE::ThreadPool::estimateThreadCountForFileIO ());
+
         if (!strcmp (argv[1], "-combine"))
         {
             cout << "-combine multipart input " << endl;
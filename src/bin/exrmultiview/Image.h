@@ -87,6 +87,13 @@ public:
     const IMATH_NAMESPACE::Box2i& dataWindow () const;
     void resize (const IMATH_NAMESPACE::Box2i& dataWindow);
 
+    //
+    // Move the data window up or down so that its first scan line
+    // is y, keeping the pixel buffers (and their contents) unchanged.
+    //
+
+    void moveTo (int y);
+
     int width () const;
     int height () const;
 
@@ -195,6 +202,13 @@ Image::dataWindow () const
     return _dataWindow;
 }
 
+inline void
+Image::moveTo (int y)
+{
+    _dataWindow.max.y += y - _dataWindow.min.y;
+    _dataWindow.min.y = y;
+}
+
 inline int
 Image::width () const
 {
@@ -12,7 +12,9 @@
 //-----------------------------------------------------------------------------
 
 #include "makeMultiView.h"
+#include "IlmThreadPool.h"
 #include "ImfMisc.h"
+#include "ImfThreading.h"
 #include "OpenEXRConfig.h"
 
 #include <exception>
@@ -203,6 +205,9 @@ main (int argc, char** argv)
         // Load inFiles, and save a combined multi-view image in outFile.
         //
 
+        setGlobalThreadCount (
+            ILMTHREAD_NAMESPACE::ThreadPool::estimateThreadCountForFileIO ());
+
         makeMultiView (views, inFiles, outFile, compression, verbose);
     }
     catch (const exception& e)
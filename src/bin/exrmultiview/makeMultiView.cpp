@@ -18,16 +18,65 @@
 #include "ImfInputFile.h"
 #include "ImfMultiView.h"
 #include "ImfOutputFile.h"
+#include "ImfScanLineBands.h"
 #include "ImfStandardAttributes.h"
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 
 #include "namespaceAlias.h"
 using namespace IMF;
 using namespace IMATH_NAMESPACE;
 using namespace std;
 
+namespace
+{
+
+//
+// Read the scan lines covered by the data window of band from the input
+// files.  Parts of the band not covered by an input file's data window
+// are black.
+//
+
+void
+readBand (
+    Image&                                band,
+    const vector<unique_ptr<InputFile>>&  inputs,
+    const vector<string>&                 viewNames)
+{
+    const Box2i& bw = band.dataWindow ();
+
+    for (size_t i = 0; i < inputs.size (); ++i)
+    {
+        InputFile&  in = *inputs[i];
+        FrameBuffer inFb;
+
+        for (ChannelList::ConstIterator j = in.header ().channels ().begin ();
+             j != in.header ().channels ().end ();
+             ++j)
+        {
+            string inChanName  = j.name ();
+            string outChanName = insertViewName (inChanName, viewNames, i);
+
+            band.channel (outChanName).black ();
+            inFb.insert (inChanName, band.channel (outChanName).slice ());
+        }
+
+        const Box2i& dw = in.header ().dataWindow ();
+        int          y1 = max (bw.min.y, dw.min.y);
+        int          y2 = min (bw.max.y, dw.max.y);
+
+        if (y1 <= y2)
+        {
+            in.setFrameBuffer (inFb);
+            in.readPixels (y1, y2);
+        }
+    }
+}
+
+} // namespace
+
 void
 makeMultiView (
     const vector<string>&      viewNames,
@@ -36,9 +85,8 @@ makeMultiView (
     Compression                compression,
     bool                       verbose)
 {
-    Header      header;
-    Image       image;
-    FrameBuffer outFb;
+    Header                        header;
+    vector<unique_ptr<InputFile>> inputs;
 
     //
     // Find the size of the dataWindow, check files
@@ -48,7 +96,8 @@ makeMultiView (
 
     for (size_t i = 0; i < viewNames.size (); ++i)
     {
-        InputFile in (inFileNames[i]);
+        inputs.emplace_back (new InputFile (inFileNames[i]));
+        InputFile& in = *inputs.back ();
 
         if (verbose)
         {
@@ -74,30 +123,30 @@ makeMultiView (
         else { d.extendBy (header.dataWindow ()); }
     }
 
-    image.resize (d);
-
     header.dataWindow () = d;
 
     // blow away channels; we'll rebuild them
     header.channels () = ChannelList ();
 
+    header.compression () = compression;
+    addMultiView (header, viewNames);
+
     //
-    // Read the input image files
+    // The image is combined a band of scan lines at a time.
     //
 
-    for (size_t i = 0; i < viewNames.size (); ++i)
-    {
-        InputFile in (inFileNames[i]);
+    int bandLines =
+        scanLineBandHeight (getCompressionNumScanlines (compression));
 
-        if (verbose)
-        {
-            cout << "reading file " << inFileNames[i]
-                 << " "
-                    "for "
-                 << viewNames[i] << " view" << endl;
-        }
+    Image bands[2];
 
-        FrameBuffer inFb;
+    for (Image& band: bands)
+        band.resize (
+            Box2i (d.min, V2i (d.max.x, d.min.y + bandLines - 1)));
+
+    for (size_t i = 0; i < inputs.size (); ++i)
+    {
+        const InputFile& in = *inputs[i];
 
         for (ChannelList::ConstIterator j = in.header ().channels ().begin ();
              j != in.header ().channels ().end ();
@@ -114,19 +163,12 @@ makeMultiView (
                        << " of " << inFileNames[i]
                        << " has subsampling " << inChannel.xSampling
                        << ", " << inChannel.ySampling);
-            
-            image.addChannel (outChanName, inChannel);
-            image.channel (outChanName).black ();
 
-            header.channels ().insert (outChanName, inChannel);
+            for (Image& band: bands)
+                band.addChannel (outChanName, inChannel);
 
-            inFb.insert (inChanName, image.channel (outChanName).slice ());
-            outFb.insert (outChanName, image.channel (outChanName).slice ());
+            header.channels ().insert (outChanName, inChannel);
         }
-
-        in.setFrameBuffer (inFb);
-        in.readPixels (
-            in.header ().dataWindow ().min.y, in.header ().dataWindow ().max.y);
     }
 
     //
@@ -134,16 +176,32 @@ makeMultiView (
     //
 
     {
-        header.compression () = compression;
-        addMultiView (header, viewNames);
-
         OutputFile out (outFileName, header);
 
         if (verbose) cout << "writing file " << outFileName << endl;
 
-        out.setFrameBuffer (outFb);
-
-        out.writePixels (
-            header.dataWindow ().max.y - header.dataWindow ().min.y + 1);
+        convertScanLineBands (
+            d.min.y,
+            d.max.y,
+            bandLines,
+            header.lineOrder (),
+            [&] (int buffer, int y1, int) {
+                bands[buffer].moveTo (y1);
+                readBand (bands[buffer], inputs, viewNames);
+            },
+            [&] (int buffer, int y1, int y2) {
+                FrameBuffer outFb;
+
+                for (ChannelList::ConstIterator j = header.channels ().begin ();
+                     j != header.channels ().end ();
+                     ++j)
+                {
+                    outFb.insert (
+                        j.name (), bands[buffer].channel (j.name ()).slice ());
+                }
+
+                out.setFrameBuffer (outFb);
+                out.writePixels (y2 - y1 + 1);
+            });
     }
 }
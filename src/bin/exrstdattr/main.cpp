@@ -14,6 +14,7 @@
 #include "ImfDeepScanLineOutputPart.h"
 #include "ImfDeepTiledInputPart.h"
 #include "ImfDeepTiledOutputPart.h"
+#include "ImfInPlaceHeaderUpdate.h"
 #include "ImfInputFile.h"
 #include "ImfInputPart.h"
 #include "ImfIntAttribute.h"
@@ -34,12 +35,14 @@
 #include <Imath/ImathNamespace.h>
 
 #include <exception>
+#include <filesystem>
 #include <iostream>
 #include <sstream>
 #include <map>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <system_error>
 
 using namespace std;
 using namespace OPENEXR_IMF_NAMESPACE;
@@ -55,9 +58,10 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
             << "\n"
                "Read OpenEXR image file infile, set the values of one\n"
                "or more attributes in the headers of the file, and save\n"
-               "the result in outfile.  Infile and outfile must not refer\n"
-               "to the same file (the program cannot edit an image file "
-               "\"in place\").\n"
+               "the result in outfile.  If infile and outfile are the\n"
+               "same file, the headers are updated \"in place\" when\n"
+               "they fit in the space taken by the old ones, without\n"
+               "rewriting the pixels; otherwise the file is rewritten.\n"
                "\n"
                "Command for selecting headers:\n"
                "\n"
@@ -207,6 +211,9 @@ usageMessage (ostream& stream, const char* program_name, bool verbose = false)
                "\n"
                "Other options:\n"
                "\n"
+               "  -pad i        when the file is rewritten, reserve i\n"
+               "                bytes of spare space in its header, so\n"
+               "                that later edits can be made in place\n"
 	       "  -erase s      remove attribute with given name\n" 
                "  -h, --help    print this message\n"
                "      --version print version information\n"
@@ -609,6 +616,36 @@ getPart (const char attrName[], int argc, char** argv, int& i, int& part)
     i += 2;
 }
 
+//
+// true if both names refer to the same existing file, however they
+// are spelled
+//
+
+bool
+sameFile (const char fileName1[], const char fileName2[])
+{
+    error_code ec;
+    return filesystem::equivalent (fileName1, fileName2, ec);
+}
+
+//
+// a temporary file that is removed unless it has been kept
+//
+
+struct TempFile
+{
+    string name;
+
+    TempFile (const string& fileName) : name (fileName) {}
+    ~TempFile ()
+    {
+        error_code ec;
+        if (!name.empty ()) filesystem::remove (name, ec);
+    }
+
+    void keep () { name.clear (); }
+};
+
 int
 main (int argc, char** argv)
 {
@@ -629,8 +666,9 @@ main (int argc, char** argv)
 
         SetAttrVector attrs;
         EraseAttrVector eraseattrs;
-        int           part = -1;
-        int           i    = 1;
+        int           part    = -1;
+        int           padding = -1;
+        int           i       = 1;
 
         while (i < argc)
         {
@@ -756,6 +794,17 @@ main (int argc, char** argv)
             {
                 getName ( argc,argv,i,part,eraseattrs);
             }
+            else if (!strcmp (argv[i], "-pad"))
+            {
+                if (i > argc - 2)
+                    throw invalid_argument ("Expected a number of bytes");
+
+                padding = strtol (argv[i + 1], 0, 0);
+                if (padding < 0)
+                    throw invalid_argument (
+                        "The header padding must not be less than zero");
+                i += 2;
+            }
             else if (!strcmp (argv[i], "-h") || !strcmp (argv[i], "--help"))
             {
                 usageMessage (cout, "exrstdattr", true);
@@ -791,128 +840,161 @@ main (int argc, char** argv)
         if (inFileName == 0) throw invalid_argument ("Missing input filename");
         if (outFileName == 0) throw invalid_argument ("Missing input filename");
 
-        if (!strcmp (inFileName, outFileName))
-            throw invalid_argument ("Input and output cannot be the same file");
+        bool inPlace = sameFile (inFileName, outFileName);
 
         //
         // Load the headers from the input file
         // and add attributes to the headers.
         //
 
-        MultiPartInputFile in (inFileName);
-        int                numParts = in.parts ();
-        vector<Header>     headers;
+        int            numParts;
+        vector<Header> headers;
 
-        //
-        // Treat attributes added to a header in its constructor
-        // as critical and don't allow them to be deleted.
-        // 'name' and 'type' are only required in multipart
-        // file and errors will be reported if they
-        // are erased
-        //
-        Header stdHdr;
-
-        for (int part = 0; part < numParts; ++part)
         {
-            Header h = in.header (part);
+            MultiPartInputFile in (inFileName);
+            numParts = in.parts ();
 
             //
-            // process attributes to erase first, so they can be reinserted
-            // with a different type
+            // Treat attributes added to a header in its constructor
+            // as critical and don't allow them to be deleted.
+            // 'name' and 'type' are only required in multipart
+            // file and errors will be reported if they
+            // are erased
             //
-            for (size_t i = 0 ; i < eraseattrs.size() ; ++i)
+            Header stdHdr;
+
+            for (int part = 0; part < numParts; ++part)
             {
-                const EraseAttr& attr = eraseattrs[i];
-                if (attr.part == -1 || attr.part == part)
+                Header h = in.header (part);
+
+                //
+                // process attributes to erase first, so they can be reinserted
+                // with a different type
+                //
+                for (size_t i = 0 ; i < eraseattrs.size() ; ++i)
                 {
-                    if( stdHdr.find(attr.name)!=stdHdr.end() )
+                    const EraseAttr& attr = eraseattrs[i];
+                    if (attr.part == -1 || attr.part == part)
                     {
-                        cerr << "Cannot erase attribute " << attr.name
+                        if( stdHdr.find(attr.name)!=stdHdr.end() )
+                        {
+                            cerr << "Cannot erase attribute " << attr.name
+                                 << ". "
+                                 << "It is an essential attribute" << endl;
+                            return 1;
+                        }
+                        h.erase( attr.name );
+                    }
+                    else if (attr.part < 0 || attr.part >= numParts)
+                    {
+                        cerr << "Invalid part number " << attr.part
                              << ". "
-                             << "It is an essential attribute" << endl;
+                                "Part numbers in file "
+                             << inFileName
+                             << " "
+                                "go from 0 to "
+                             << numParts - 1 << "." << endl;
+
                         return 1;
                     }
-                    h.erase( attr.name );
-                }
-                else if (attr.part < 0 || attr.part >= numParts)
-                {
-                    cerr << "Invalid part number " << attr.part
-                         << ". "
-                            "Part numbers in file "
-                         << inFileName
-                         << " "
-                            "go from 0 to "
-                         << numParts - 1 << "." << endl;
-
-                    return 1;
                 }
-            }
-
 
-            for (size_t i = 0; i < attrs.size (); ++i)
-            {
-                const SetAttr& attr = attrs[i];
 
-                if (attr.part == -1 || attr.part == part)
-                {
-                    h.insert (attr.name, *attr.attr);
-                }
-                else if (attr.part < 0 || attr.part >= numParts)
+                for (size_t i = 0; i < attrs.size (); ++i)
                 {
-                    cerr << "Invalid part number " << attr.part
-                         << ". "
-                            "Part numbers in file "
-                         << inFileName
-                         << " "
-                            "go from 0 to "
-                         << numParts - 1 << "." << endl;
-
-                    return 1;
+                    const SetAttr& attr = attrs[i];
+
+                    if (attr.part == -1 || attr.part == part)
+                    {
+                        h.insert (attr.name, *attr.attr);
+                    }
+                    else if (attr.part < 0 || attr.part >= numParts)
+                    {
+                        cerr << "Invalid part number " << attr.part
+                             << ". "
+                                "Part numbers in file "
+                             << inFileName
+                             << " "
+                                "go from 0 to "
+                             << numParts - 1 << "." << endl;
+
+                        return 1;
+                    }
                 }
+
+                headers.push_back (h);
             }
+        }
+
+        //
+        // Replace the headers of the input file, if it is also
+        // the output file and the modified headers fit.
+        //
 
-            headers.push_back (h);
+        if (inPlace && updateHeadersInPlace (inFileName, &headers[0], numParts))
+        {
+            for (size_t i = 0; i < attrs.size (); i++)
+                delete attrs[i].attr;
+
+            return 0;
         }
 
         //
-        // Create an output file with the modified headers,
-        // and copy the pixels from the input file to the
-        // output file.
+        // Otherwise create an output file with the modified headers,
+        // and copy the pixels from the input file to the output file.
+        // When editing a file, the output goes to a temporary file that
+        // then replaces it.
         //
 
-        MultiPartOutputFile out (outFileName, &headers[0], numParts);
+        if (padding >= 0) addHeaderPadding (headers[0], padding);
+
+        TempFile tmpFile (inPlace ? string (outFileName) + ".tmp" : string ());
 
-        for (int p = 0; p < numParts; ++p)
         {
-            const Header& h    = in.header (p);
-            const string& type = h.type ();
+            MultiPartInputFile  in (inFileName);
+            MultiPartOutputFile out (
+                inPlace ? tmpFile.name.c_str () : outFileName,
+                &headers[0],
+                numParts);
 
-            if (type == SCANLINEIMAGE)
+            for (int p = 0; p < numParts; ++p)
             {
-                InputPart  inPart (in, p);
-                OutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == TILEDIMAGE)
-            {
-                TiledInputPart  inPart (in, p);
-                TiledOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == DEEPSCANLINE)
-            {
-                DeepScanLineInputPart  inPart (in, p);
-                DeepScanLineOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
-            }
-            else if (type == DEEPTILE)
-            {
-                DeepTiledInputPart  inPart (in, p);
-                DeepTiledOutputPart outPart (out, p);
-                outPart.copyPixels (inPart);
+                const Header& h    = in.header (p);
+                const string& type = h.type ();
+
+                if (type == SCANLINEIMAGE)
+                {
+                    InputPart  inPart (in, p);
+                    OutputPart outPart (out, p);
+                    outPart.copyPixels (inPart);
+                }
+                else if (type == TILEDIMAGE)
+                {
+                    TiledInputPart  inPart (in, p);
+                    TiledOutputPart outPart (out, p);
+                    outPart.copyPixels (inPart);
+                }
+                else if (type == DEEPSCANLINE)
+                {
+                    DeepScanLineInputPart  inPart (in, p);
+                    DeepScanLineOutputPart outPart (out, p);
+                    outPart.copyPixels (inPart);
+                }
+                else if (type == DEEPTILE)
+                {
+                    DeepTiledInputPart  inPart (in, p);
+                    DeepTiledOutputPart outPart (out, p);
+                    outPart.copyPixels (inPart);
+                }
             }
         }
 
+        if (inPlace)
+        {
+            filesystem::rename (tmpFile.name, outFileName);
+            tmpFile.keep ();
+        }
+
         for (size_t i = 0; i < attrs.size (); i++)
             delete attrs[i].attr;
     }
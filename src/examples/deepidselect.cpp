@@ -5,6 +5,8 @@
 
 //
 // example of using an IDManifest to locate given objects in a deep image with IDs
+// text searches need the text of every entry, so decode the whole IDManifest,
+// whereas known numeric IDs are looked up through an IDManifestIndex
 // demonstrates how to use multivariate IDs, and 64 bit IDs spread across two channels
 // deepidexample will create images that can be used as input
 // (though this tool is intended to support images from other sources)
@@ -23,6 +25,7 @@
 #include <iomanip>
 #include <list>
 #include <map>
+#include <memory>
 #include <vector>
 
 using namespace OPENEXR_IMF_NAMESPACE;
@@ -51,11 +54,11 @@ struct match
 // ids are entered in a new list
 //
 void setIds (
-    const IDManifest&       mfst,
-    list<list<match>>&      ids,
-    const char*             matches[],
-    int                     numMatches,
-    const map<string, int>& channelToPos);
+    const CompressedIDManifest& manifest,
+    list<list<match>>&          ids,
+    const char*                 matches[],
+    int                         numMatches,
+    const map<string, int>&     channelToPos);
 
 int
 main (int argc, const char* argv[])
@@ -174,9 +177,13 @@ main (int argc, const char* argv[])
         //
         int               manifestPart = hasIDManifest (inputHeader) ? pt : 0;
         list<list<match>> ids;
-        IDManifest        mfst = idManifest (input.header (manifestPart));
 
-        setIds (mfst, ids, matchArguments, numMatchArguments, channelToPos);
+        setIds (
+            idManifest (input.header (manifestPart)),
+            ids,
+            matchArguments,
+            numMatchArguments,
+            channelToPos);
 
         // store for an individual deep scanline. Accessed using scanLine[channelIndex][pixelIndex][sampleIndex]
         // where pixelIndex is 0 for the leftmost pixel (even if the dataWindow doesn't start at 0)
@@ -369,11 +376,11 @@ main (int argc, const char* argv[])
 
 void
 setIds (
-    const IDManifest&       mfst,
-    list<list<match>>&      ids,
-    const char*             matches[],
-    int                     numMatches,
-    const map<string, int>& channelToPos)
+    const CompressedIDManifest& manifest,
+    list<list<match>>&          ids,
+    const char*                 matches[],
+    int                         numMatches,
+    const map<string, int>&     channelToPos)
 {
 
     //
@@ -382,6 +389,12 @@ setIds (
     ids.clear ();
     ids.push_back (list<match> ());
 
+    //
+    // decode the manifest only as far as the matches need it
+    //
+    std::unique_ptr<IDManifestIndex> index;
+    std::unique_ptr<IDManifest>      decoded;
+
     //
     // check each manifest, each entry, against each matching expression
     //
@@ -423,11 +436,32 @@ setIds (
                 m.id1      = stoi (matchString);
                 m.channel2 = -1;
                 ids.back ().push_back (m);
+
+                // the text of a known ID is a single lookup in the index
+                if (!index) index.reset (new IDManifestIndex (manifest));
+
+                size_t         group = index->find (componentName);
+                vector<string> text;
+                if (group < index->size () &&
+                    index->header (group).getEncodingScheme () ==
+                        IDManifest::ID_SCHEME &&
+                    index->lookup (group, m.id1, text))
+                {
+                    cerr << "adding match " << hex << m.id1 << dec
+                         << " for strings";
+                    for (const string& t: text)
+                        cerr << ' ' << t;
+                    cerr << " in channel " << chan->second << '('
+                         << chan->first << ")\n";
+                }
             }
-            continue; // skip parsing the manifests for this string
+            continue; // skip searching the text of the manifests for this string
         }
 
         // check the manifest for each group of channels
+        if (!decoded) decoded.reset (new IDManifest (manifest));
+        const IDManifest& mfst = *decoded;
+
         for (size_t i = 0; i < mfst.size (); ++i)
         {
 
@@ -0,0 +1,464 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Weta Digital, Ltd and Contributors to the OpenEXR Project.
+//
+
+#include "ImfCompositeDeep.h"
+#include "ImfChannelList.h"
+#include "ImfDeepCompositing.h"
+#include "ImfPixelType.h"
+
+#include "Iex.h"
+#include <algorithm>
+#include <limits>
+#include <stddef.h>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using ILMTHREAD_NAMESPACE::Task;
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using ILMTHREAD_NAMESPACE::ThreadPool;
+using IMATH_NAMESPACE::Box2i;
+using std::string;
+using std::vector;
+
+namespace
+{
+
+//
+// samples per band when no maximum sample count is set
+//
+
+const int64_t defaultBandSampleCount = int64_t (1) << 22;
+
+class CompositeTask : public Task
+{
+public:
+    CompositeTask (
+        TaskGroup*                 group,
+        const CompositeDeep*       data,
+        const CompositeDeep::Band* band,
+        const Box2i&               area,
+        bool                       tileCoords,
+        vector<const char*>*       names)
+        : Task (group)
+        , _Data (data)
+        , _band (band)
+        , _area (area)
+        , _tileCoords (tileCoords)
+        , _names (names)
+    {}
+
+    virtual ~CompositeTask () {}
+
+    virtual void execute ()
+    {
+        _Data->composite (*_band, _area, _tileCoords, *_names);
+    }
+
+    const CompositeDeep*       _Data;
+    const CompositeDeep::Band* _band;
+    Box2i                      _area;
+    bool                       _tileCoords;
+    vector<const char*>*       _names;
+};
+
+} // namespace
+
+CompositeDeep::CompositeDeep () : _zback (false), _comp (NULL)
+{}
+
+void
+CompositeDeep::checkChannels (const Header& header, const char* owner)
+{
+    bool has_z     = false;
+    bool has_alpha = false;
+    // check good channel names
+    for (ChannelList::ConstIterator i = header.channels ().begin ();
+         i != header.channels ().end ();
+         ++i)
+    {
+        std::string n (i.name ());
+        if (n == "ZBack") { _zback = true; }
+        else if (n == "Z") { has_z = true; }
+        else if (n == "A") { has_alpha = true; }
+    }
+
+    if (!has_z)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Deep data provided to " << owner << " is missing a Z channel");
+    }
+
+    if (!has_alpha)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Deep data provided to " << owner
+                                     << " is missing an alpha channel");
+    }
+}
+
+void
+CompositeDeep::setFrameBuffer (const FrameBuffer& fr)
+{
+
+    //
+    // count channels; build map between channels in frame buffer
+    // and channels in internal buffers
+    //
+
+    _channels.resize (3);
+    _channels[0] = "Z";
+    _channels[1] = _zback ? "ZBack" : "Z";
+    _channels[2] = "A";
+    _bufferMap.resize (0);
+
+    for (FrameBuffer::ConstIterator q = fr.begin (); q != fr.end (); q++)
+    {
+
+        //
+        // Frame buffer must have xSampling and ySampling set to 1
+        // (Sampling in FrameBuffers must match sampling in file,
+        //  and Header::sanityCheck enforces sampling in deep files is 1)
+        //
+
+        if (q.slice ().xSampling != 1 || q.slice ().ySampling != 1)
+        {
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "X and/or y subsampling factors "
+                "of \""
+                    << q.name ()
+                    << "\" channel in framebuffer "
+                       "are not 1");
+        }
+
+        string name (q.name ());
+        if (name == "ZBack") { _bufferMap.push_back (1); }
+        else if (name == "Z") { _bufferMap.push_back (0); }
+        else if (name == "A") { _bufferMap.push_back (2); }
+        else
+        {
+            _bufferMap.push_back (static_cast<int> (_channels.size ()));
+            _channels.push_back (name);
+        }
+    }
+
+    _outputFrameBuffer = fr;
+}
+
+void
+CompositeDeep::channelNames (vector<const char*>& names) const
+{
+    // turn vector of strings into array of char *
+    // and make sure 'ZBack' channel is correct
+    names.resize (_channels.size ());
+    for (size_t i = 0; i < names.size (); i++)
+    {
+        names[i] = _channels[i].c_str ();
+    }
+
+    if (!_zback)
+        names[1] = names[0]; // no zback channel, so make it point to z
+}
+
+Slice
+CompositeDeep::sampleCountSlice (unsigned int* counts, const Box2i& region)
+{
+    ptrdiff_t width = region.size ().x + 1;
+
+    return Slice (
+        OPENEXR_IMF_INTERNAL_NAMESPACE::UINT,
+        (char*) (counts - region.min.x - region.min.y * width),
+        sizeof (unsigned int),
+        sizeof (unsigned int) * width);
+}
+
+void
+CompositeDeep::handleDeepFrameBuffer (
+    DeepFrameBuffer&             buf,
+    unsigned int*                counts,
+    const Box2i&                 countRegion,
+    vector<std::vector<float*>>& pointers,
+    const Box2i&                 region)
+{
+    ptrdiff_t width      = region.size ().x + 1;
+    size_t    pixelcount = width * (region.size ().y + 1);
+    ptrdiff_t origin     = region.min.x + region.min.y * width;
+
+    pointers.resize (_channels.size ());
+    buf.insertSampleCountSlice (sampleCountSlice (counts, countRegion));
+
+    pointers[0].resize (pixelcount);
+    buf.insert (
+        "Z",
+        DeepSlice (
+            OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT,
+            (char*) (&pointers[0][0] - origin),
+            sizeof (float*),
+            sizeof (float*) * width,
+            sizeof (float)));
+
+    if (_zback)
+    {
+        pointers[1].resize (pixelcount);
+        buf.insert (
+            "ZBack",
+            DeepSlice (
+                OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT,
+                (char*) (&pointers[1][0] - origin),
+                sizeof (float*),
+                sizeof (float*) * width,
+                sizeof (float)));
+    }
+
+    pointers[2].resize (pixelcount);
+    buf.insert (
+        "A",
+        DeepSlice (
+            OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT,
+            (char*) (&pointers[2][0] - origin),
+            sizeof (float*),
+            sizeof (float*) * width,
+            sizeof (float)));
+
+    size_t i = 0;
+    for (FrameBuffer::ConstIterator qt = _outputFrameBuffer.begin ();
+         qt != _outputFrameBuffer.end ();
+         qt++)
+    {
+        int channel_in_source = _bufferMap[i];
+        if (channel_in_source > 2)
+        {
+            // not dealt with yet (0,1,2 previously inserted)
+            pointers[channel_in_source].resize (pixelcount);
+            buf.insert (
+                qt.name (),
+                DeepSlice (
+                    OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT,
+                    (char*) (&pointers[channel_in_source][0] - origin),
+                    sizeof (float*),
+                    sizeof (float*) * width,
+                    sizeof (float)));
+        }
+
+        i++;
+    }
+}
+
+void
+CompositeDeep::setupBand (
+    Band&                         band,
+    vector<vector<unsigned int>>& counts,
+    const Box2i&                  countRegion,
+    const char*                   what)
+{
+    size_t parts      = counts.size ();
+    size_t countWidth = countRegion.size ().x + 1;
+    size_t width      = band.region.size ().x + 1;
+    size_t height     = band.region.size ().y + 1;
+    size_t first      = countWidth * (band.region.min.y - countRegion.min.y) +
+                   (band.region.min.x - countRegion.min.x);
+
+    band.framebuffers.resize (parts);
+    band.pointers.resize (parts);
+
+    for (size_t i = 0; i < parts; i++)
+    {
+        band.framebuffers[i] = DeepFrameBuffer ();
+        handleDeepFrameBuffer (
+            band.framebuffers[i],
+            &counts[i][0],
+            countRegion,
+            band.pointers[i],
+            band.region);
+    }
+
+    //
+    // accumulate pixel counts
+    //
+
+    band.total_sizes.resize (width * height);
+    band.num_sources.resize (width * height); //number of parts with non-zero sample count
+
+    for (size_t y = 0; y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            size_t ptr = y * width + x;
+
+            band.total_sizes[ptr] = 0;
+            band.num_sources[ptr] = 0;
+            for (size_t j = 0; j < parts; j++)
+            {
+                unsigned int count = counts[j][first + y * countWidth + x];
+
+                if (band.total_sizes[ptr] >
+                    std::numeric_limits<unsigned int>::max () - count)
+                    THROW (
+                        IEX_NAMESPACE::ArgExc,
+                        "Cannot composite "
+                            << what
+                            << ": pixel cannot have more than UINT_MAX samples");
+
+                band.total_sizes[ptr] += count;
+                if (count > 0) band.num_sources[ptr]++;
+            }
+        }
+    }
+
+    //
+    // allocate arrays for pixel data
+    // samples array accessed as in samples[channel][sample]
+    //
+
+    band.samples.resize (_channels.size ());
+
+    for (size_t channel = 0; channel < band.samples.size (); channel++)
+    {
+        if (channel != 1 || _zback)
+        {
+            band.samples[channel].resize (band.sampleCount);
+
+            //
+            // allocate pointers for channel data
+            //
+
+            float* samples = band.samples[channel].data ();
+
+            for (size_t y = 0; y < height; y++)
+            {
+                for (size_t x = 0; x < width; x++)
+                {
+                    for (size_t part = 0; part < parts; part++)
+                    {
+                        band.pointers[part][channel][y * width + x] = samples;
+                        samples += counts[part][first + y * countWidth + x];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+CompositeDeep::composite (
+    const Band&                band,
+    const Box2i&               area,
+    bool                       tileCoords,
+    vector<const char*>&       names) const
+{
+    vector<float> output_pixel (names.size ()); //the pixel we'll output to
+    vector<const float*> inputs (names.size ());
+    DeepCompositing      d; // fallback compositing engine
+    DeepCompositing*     comp = _comp ? _comp : &d;
+
+    int width = band.region.max.x + 1 - band.region.min.x;
+
+    //
+    // the sample pointers of all sources point into the same arrays,
+    // with those of the first source first
+    //
+
+    const vector<vector<float*>>& pointers = band.pointers[0];
+
+    for (int y = area.min.y; y <= area.max.y; y++)
+    {
+        int pixel =
+            (y - band.region.min.y) * width + area.min.x - band.region.min.x;
+
+        for (int x = area.min.x; x <= area.max.x; x++)
+        {
+            // set inputs[] to point to the first sample of the first part of each channel
+            // if there's a zback, set all channel independently...
+
+            if (_zback)
+            {
+                for (size_t channel = 0; channel < names.size (); channel++)
+                {
+                    inputs[channel] = pointers[channel][pixel];
+                }
+            }
+            else
+            {
+                // otherwise, set 0 and 1 to point to Z
+
+                inputs[0] = pointers[0][pixel];
+                inputs[1] = pointers[0][pixel];
+                for (size_t channel = 2; channel < names.size (); channel++)
+                {
+                    inputs[channel] = pointers[channel][pixel];
+                }
+            }
+
+            comp->composite_pixel (
+                &output_pixel[0],
+                &inputs[0],
+                &names[0],
+                static_cast<int> (names.size ()),
+                band.total_sizes[pixel],
+                band.num_sources[pixel]);
+
+            size_t channel_number = 0;
+
+            //
+            // write out composited value into internal frame buffer
+            //
+            for (FrameBuffer::ConstIterator it = _outputFrameBuffer.begin ();
+                 it != _outputFrameBuffer.end ();
+                 it++)
+            {
+                const Slice& slice = it.slice ();
+
+                float value =
+                    output_pixel[_bufferMap[channel_number]]; // value to write
+                intptr_t base = reinterpret_cast<intptr_t> (slice.base);
+                int xs = tileCoords && slice.xTileCoords ? x - area.min.x : x;
+                int ys = tileCoords && slice.yTileCoords ? y - area.min.y : y;
+
+                // cast to half float if necessary
+                if (slice.type == OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT)
+                {
+                    float* ptr = reinterpret_cast<float*> (
+                        base + ys * slice.yStride + xs * slice.xStride);
+                    *ptr = value;
+                }
+                else if (slice.type == HALF)
+                {
+                    half* ptr = reinterpret_cast<half*> (
+                        base + ys * slice.yStride + xs * slice.xStride);
+                    *ptr = half (value);
+                }
+
+                channel_number++;
+            }
+
+            pixel++;
+
+        } // next pixel on row
+    }
+}
+
+void
+CompositeDeep::addCompositeTask (
+    TaskGroup*                 group,
+    const Band&                band,
+    const Box2i&               area,
+    bool                       tileCoords,
+    vector<const char*>&       names) const
+{
+    ThreadPool::addGlobalTask (
+        new CompositeTask (group, this, &band, area, tileCoords, &names));
+}
+
+int64_t
+CompositeDeep::bandSampleCount (int64_t maximumSampleCount)
+{
+    return maximumSampleCount > 0
+               ? std::max (maximumSampleCount / 2, int64_t (1))
+               : defaultBandSampleCount;
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
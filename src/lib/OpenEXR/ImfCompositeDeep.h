@@ -0,0 +1,146 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_COMPOSITEDEEP_H
+#define INCLUDED_IMF_COMPOSITEDEEP_H
+
+//-----------------------------------------------------------------------------
+//
+//	Internal state shared by CompositeDeepScanLine and
+//	CompositeDeepTiled: the channels to composite, the buffers
+//	holding the samples of a band of pixels read from all sources,
+//	and the compositing of those pixels into the output frame buffer.
+//
+//	A band is a rectangle of pixels, a run of scanlines or a run of
+//	tiles, whose samples are held at once. The callers read a band
+//	while the previous one is composited, so each keeps two.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfDeepFrameBuffer.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+
+#include "IlmThreadPool.h"
+
+#include <Imath/ImathBox.h>
+
+#include <string>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+struct CompositeDeep
+{
+    FrameBuffer _outputFrameBuffer; // output frame buffer provided
+    bool _zback; // true if we are using zback (otherwise channel 1 = channel 0)
+    DeepCompositing*         _comp;     // user-provided compositor
+    std::vector<std::string> _channels; // names of channels that will be composited
+    std::vector<int>
+        _bufferMap; // entry _outputFrameBuffer[n].name() == _channels[ _bufferMap[n] ].name()
+
+    struct Band
+    {
+        IMATH_NAMESPACE::Box2i       region;       // pixels of the band
+        int64_t                      sampleCount;  // total samples in band
+        std::vector<DeepFrameBuffer> framebuffers; // one per source
+        std::vector<std::vector<std::vector<float*>>>
+            pointers; // per source/channel/pixel
+        std::vector<std::vector<float>> samples; // sample values per channel
+        std::vector<unsigned int> total_sizes;   // per-pixel sample counts
+        std::vector<unsigned int> num_sources;   // sources with samples
+    };
+
+    CompositeDeep ();
+
+    //
+    // check the header of a newly added source has Z and alpha
+    // channels, and note whether it has a ZBack channel; owner is
+    // the name of the class, for error messages
+    //
+
+    void checkChannels (const Header& header, const char* owner);
+
+    //
+    // build the map between the channels of the frame buffer and
+    // the composited channels
+    //
+
+    void setFrameBuffer (const FrameBuffer& fr);
+
+    //
+    // names of the composited channels, as passed to DeepCompositing,
+    // with 'ZBack' pointing to 'Z' if there is no ZBack channel
+    //
+
+    void channelNames (std::vector<const char*>& names) const;
+
+    //
+    // a sample count slice for counts, which hold the counts of
+    // the pixels of region
+    //
+
+    static Slice
+    sampleCountSlice (unsigned int* counts, const IMATH_NAMESPACE::Box2i& region);
+
+    //
+    // set up the frame buffers of band to read the samples of the
+    // pixels of band.region from each source, and allocate the
+    // sample buffers; counts hold the per-source sample counts of
+    // the pixels of countRegion, and what names the unit that is
+    // read, for error messages
+    //
+
+    void setupBand (
+        Band&                                   band,
+        std::vector<std::vector<unsigned int>>& counts,
+        const IMATH_NAMESPACE::Box2i&           countRegion,
+        const char*                             what);
+
+    //
+    // composite the pixels of area, which must lie in band.region,
+    // into the output frame buffer; with tileCoords, slices with x
+    // or y tile coordinates are relative to area.min
+    //
+
+    void composite (
+        const Band&                     band,
+        const IMATH_NAMESPACE::Box2i&   area,
+        bool                            tileCoords,
+        std::vector<const char*>&       names) const;
+
+    //
+    // composite the pixels of area as above, on the global thread
+    // pool; the band and names must remain valid until the group
+    // is done
+    //
+
+    void addCompositeTask (
+        ILMTHREAD_NAMESPACE::TaskGroup* group,
+        const Band&                     band,
+        const IMATH_NAMESPACE::Box2i&   area,
+        bool                            tileCoords,
+        std::vector<const char*>&       names) const;
+
+    //
+    // the most samples a band may hold, given the maximum number
+    // of samples that may be composited at once: half of them, so
+    // that the next band can be read while one is composited
+    //
+
+    static int64_t bandSampleCount (int64_t maximumSampleCount);
+
+private:
+    void handleDeepFrameBuffer (
+        DeepFrameBuffer&                  buf,
+        unsigned int*                     counts,
+        const IMATH_NAMESPACE::Box2i&     countRegion,
+        std::vector<std::vector<float*>>& pointers,
+        const IMATH_NAMESPACE::Box2i&     region);
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
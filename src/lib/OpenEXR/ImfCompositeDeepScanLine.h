@@ -77,6 +77,11 @@ public:
     // read scanlines start to end from the source(s)
     // storing the result in the frame buffer provided
     //
+    // Large requests are split into bands of scanlines by
+    // their sample counts, and each band is composited while
+    // the next one is read, so the whole image may be read
+    // in one call without holding all of its samples at once
+    //
     //////////////////////////////////////////////////
 
     IMF_EXPORT
@@ -110,7 +115,9 @@ public:
     // set the maximum number of samples that will be composited.
     // If a single scanline has more samples, readPixels will throw
     // an exception. This mechanism prevents the library allocating
-    // excessive memory to composite deep scanline images.
+    // excessive memory to composite deep scanline images: readPixels
+    // holds no more than this many samples at once, splitting
+    // larger requests into bands of scanlines.
     // A value of 0 will cause deep compositing to be disabled entirely
     // A negative value disables the limit, allowing images with
     // arbitrarily large sample counts to be composited
@@ -0,0 +1,560 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#include "ImfCompositeDeepTiled.h"
+#include "IlmThreadPool.h"
+#include "ImfChannelList.h"
+#include "ImfCompositeDeep.h"
+#include "ImfDeepFrameBuffer.h"
+#include "ImfDeepTiledInputFile.h"
+#include "ImfDeepTiledInputPart.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfMisc.h"
+#include "ImfPixelType.h"
+#include "ImfTileDescription.h"
+#include "ImfTiledOutputFile.h"
+#include "ImfTiledOutputPart.h"
+
+#include "Iex.h"
+#include <algorithm>
+#include <memory>
+#include <stddef.h>
+#include <vector>
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using ILMTHREAD_NAMESPACE::TaskGroup;
+using IMATH_NAMESPACE::Box2i;
+using std::vector;
+
+struct CompositeDeepTiled::Data : public CompositeDeep
+{
+public:
+    vector<DeepTiledInputFile*> _file; // array of files
+    vector<DeepTiledInputPart*> _part; // array of parts
+    Box2i           _dataWindow; // data window shared by all inputs
+    TileDescription _tileDesc;   // tile description shared by all inputs
+
+    //
+    // the tiles of a readTiles() call are read and composited in
+    // bands, runs of tiles dx1 to dx2 on tile row dy, so that only a
+    // limited number of samples is held at once
+    //
+
+    struct TileBand : public Band
+    {
+        int dx1;
+        int dx2;
+        int dy;
+    };
+
+    TileBand _bands[2];
+    vector<vector<unsigned int>>
+        _counts; // per-source sample counts of all requested tiles
+
+    void check_valid (
+        const Header&
+            header); // check newly added part/file is OK; on first good call, set _zback/_dataWindow/_tileDesc
+
+    //
+    // tile geometry, which all sources share
+    //
+
+    bool  isValidLevel (int lx, int ly) const;
+    Box2i dataWindowForTile (int dx, int dy, int lx, int ly) const;
+
+    //
+    // read sample counts or samples from the given file or part
+    //
+
+    void readSource (
+        size_t                 source,
+        const DeepFrameBuffer& buf,
+        int                    dx1,
+        int                    dx2,
+        int                    dy1,
+        int                    dy2,
+        int                    lx,
+        int                    ly,
+        bool                   counts);
+};
+
+CompositeDeepTiled::CompositeDeepTiled () : _Data (new Data)
+{}
+
+CompositeDeepTiled::~CompositeDeepTiled ()
+{
+    delete _Data;
+}
+
+void
+CompositeDeepTiled::addSource (DeepTiledInputPart* part)
+{
+    _Data->check_valid (part->header ());
+    _Data->_part.push_back (part);
+}
+
+void
+CompositeDeepTiled::addSource (DeepTiledInputFile* file)
+{
+    _Data->check_valid (file->header ());
+    _Data->_file.push_back (file);
+}
+
+int
+CompositeDeepTiled::sources () const
+{
+    return int (_Data->_part.size ()) + int (_Data->_file.size ());
+}
+
+void
+CompositeDeepTiled::Data::check_valid (const Header& header)
+{
+    checkChannels (header, "CompositeDeepTiled");
+
+    if (!header.hasTileDescription ())
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Deep data provided to CompositeDeepTiled is not tiled");
+    }
+
+    if (_part.size () == 0 && _file.size () == 0)
+    {
+        // first in - update and return
+
+        _dataWindow = header.dataWindow ();
+        _tileDesc   = header.tileDescription ();
+
+        return;
+    }
+
+    const Header* const match_header = _part.size () > 0 ? &_part[0]->header ()
+                                                         : &_file[0]->header ();
+
+    // check the sizes match
+    if (match_header->displayWindow () != header.displayWindow ())
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Deep data provided to CompositeDeepTiled has a different displayWindow to previously provided data");
+    }
+
+    //
+    // tiles cover different pixels in parts with different data
+    // windows or tile sizes, so these must match too
+    //
+
+    if (_dataWindow != header.dataWindow ())
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Deep data provided to CompositeDeepTiled has a different dataWindow to previously provided data");
+    }
+
+    if (!(_tileDesc == header.tileDescription ()))
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "Deep data provided to CompositeDeepTiled has a different tile description to previously provided data");
+    }
+}
+
+bool
+CompositeDeepTiled::Data::isValidLevel (int lx, int ly) const
+{
+    if (_file.size () > 0) return _file[0]->isValidLevel (lx, ly);
+    return _part[0]->isValidLevel (lx, ly);
+}
+
+Box2i
+CompositeDeepTiled::Data::dataWindowForTile (
+    int dx, int dy, int lx, int ly) const
+{
+    if (_file.size () > 0)
+        return _file[0]->dataWindowForTile (dx, dy, lx, ly);
+    return _part[0]->dataWindowForTile (dx, dy, lx, ly);
+}
+
+void
+CompositeDeepTiled::setCompositing (DeepCompositing* c)
+{
+    _Data->_comp = c;
+}
+
+const IMATH_NAMESPACE::Box2i&
+CompositeDeepTiled::dataWindow () const
+{
+    return _Data->_dataWindow;
+}
+
+const TileDescription&
+CompositeDeepTiled::tileDescription () const
+{
+    return _Data->_tileDesc;
+}
+
+void
+CompositeDeepTiled::setFrameBuffer (const FrameBuffer& fr)
+{
+    _Data->setFrameBuffer (fr);
+}
+
+const FrameBuffer&
+CompositeDeepTiled::frameBuffer () const
+{
+    return _Data->_outputFrameBuffer;
+}
+
+namespace
+{
+int64_t maximumSampleCount = 0;
+}
+
+void
+CompositeDeepTiled::setMaximumSampleCount (int64_t c)
+{
+    maximumSampleCount = c;
+}
+
+int64_t
+CompositeDeepTiled::getMaximumSampleCount ()
+{
+    return maximumSampleCount;
+}
+
+void
+CompositeDeepTiled::Data::readSource (
+    size_t                 source,
+    const DeepFrameBuffer& buf,
+    int                    dx1,
+    int                    dx2,
+    int                    dy1,
+    int                    dy2,
+    int                    lx,
+    int                    ly,
+    bool                   counts)
+{
+    if (source < _file.size ())
+    {
+        DeepTiledInputFile* file = _file[source];
+        file->setFrameBuffer (buf);
+        if (counts)
+            file->readPixelSampleCounts (dx1, dx2, dy1, dy2, lx, ly);
+        else
+            file->readTiles (dx1, dx2, dy1, dy2, lx, ly);
+    }
+    else
+    {
+        DeepTiledInputPart* part = _part[source - _file.size ()];
+        part->setFrameBuffer (buf);
+        if (counts)
+            part->readPixelSampleCounts (dx1, dx2, dy1, dy2, lx, ly);
+        else
+            part->readTiles (dx1, dx2, dy1, dy2, lx, ly);
+    }
+}
+
+void
+CompositeDeepTiled::readTile (int dx, int dy, int l)
+{
+    readTiles (dx, dx, dy, dy, l, l);
+}
+
+void
+CompositeDeepTiled::readTile (int dx, int dy, int lx, int ly)
+{
+    readTiles (dx, dx, dy, dy, lx, ly);
+}
+
+void
+CompositeDeepTiled::readTiles (int dx1, int dx2, int dy1, int dy2, int l)
+{
+    readTiles (dx1, dx2, dy1, dy2, l, l);
+}
+
+void
+CompositeDeepTiled::readTiles (
+    int dx1, int dx2, int dy1, int dy2, int lx, int ly)
+{
+    size_t parts =
+        _Data->_file.size () + _Data->_part.size (); // total of files+parts
+
+    if (parts == 0)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "No deep data provided to CompositeDeepTiled");
+    }
+
+    if (!_Data->isValidLevel (lx, ly))
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Level coordinate "
+            "(" << lx
+                << ", " << ly
+                << ") "
+                   "is invalid.");
+
+    if (dx1 > dx2) std::swap (dx1, dx2);
+    if (dy1 > dy2) std::swap (dy1, dy2);
+
+    //
+    // read the sample counts of all the tiles first, so that the
+    // request can be split into bands by their actual sample counts
+    //
+
+    Box2i countRegion (
+        _Data->dataWindowForTile (dx1, dy1, lx, ly).min,
+        _Data->dataWindowForTile (dx2, dy2, lx, ly).max);
+
+    size_t total_width  = countRegion.size ().x + 1;
+    size_t total_pixels = total_width * (countRegion.size ().y + 1);
+
+    _Data->_counts.resize (parts);
+
+    for (size_t i = 0; i < parts; i++)
+    {
+        vector<unsigned int>& counts = _Data->_counts[i];
+        counts.assign (total_pixels, 0);
+
+        DeepFrameBuffer buf;
+        buf.insertSampleCountSlice (
+            CompositeDeep::sampleCountSlice (&counts[0], countRegion));
+
+        _Data->readSource (i, buf, dx1, dx2, dy1, dy2, lx, ly, true);
+    }
+
+    //
+    // sum of all samples in all images in each tile
+    //
+
+    int             tiles_x = dx2 - dx1 + 1;
+    vector<int64_t> tile_samples (size_t (tiles_x) * (dy2 - dy1 + 1), 0);
+
+    for (int dy = dy1; dy <= dy2; dy++)
+    {
+        for (int dx = dx1; dx <= dx2; dx++)
+        {
+            Box2i    tile  = _Data->dataWindowForTile (dx, dy, lx, ly);
+            int64_t& total = tile_samples[(dy - dy1) * tiles_x + dx - dx1];
+
+            for (int y = tile.min.y; y <= tile.max.y; y++)
+            {
+                size_t first = (y - countRegion.min.y) * total_width +
+                               (tile.min.x - countRegion.min.x);
+                for (size_t j = 0; j < parts; j++)
+                {
+                    for (int x = 0; x <= tile.max.x - tile.min.x; x++)
+                        total += _Data->_counts[j][first + x];
+                }
+            }
+
+            if (maximumSampleCount > 0 && total > maximumSampleCount)
+            {
+                throw IEX_NAMESPACE::ArgExc (
+                    "Cannot composite tile: total sample count in tile exceeds "
+                    "limit set by CompositeDeepTiled::setMaximumSampleCount()");
+            }
+        }
+    }
+
+    int64_t bandSampleCount =
+        CompositeDeep::bandSampleCount (maximumSampleCount);
+
+    vector<const char*> names;
+    _Data->channelNames (names);
+
+    //
+    // the tasks compositing a band finish when the group is destroyed,
+    // before the bands or the names above go away
+    //
+
+    std::unique_ptr<TaskGroup> compositing;
+    int64_t                    compositingSamples = 0;
+    int                        current            = 0;
+
+    for (int dy = dy1; dy <= dy2; dy++)
+    {
+        const int64_t* row = &tile_samples[(dy - dy1) * tiles_x];
+
+        for (int dx = dx1; dx <= dx2;)
+        {
+            Data::TileBand& band = _Data->_bands[current];
+
+            band.dx1         = dx;
+            band.dy          = dy;
+            band.sampleCount = 0;
+
+            do
+            {
+                band.sampleCount += row[dx - dx1];
+                dx++;
+            } while (dx <= dx2 &&
+                     band.sampleCount + row[dx - dx1] <= bandSampleCount);
+
+            band.dx2    = dx - 1;
+            band.region = Box2i (
+                _Data->dataWindowForTile (band.dx1, dy, lx, ly).min,
+                _Data->dataWindowForTile (band.dx2, dy, lx, ly).max);
+
+            if (maximumSampleCount > 0 &&
+                compositingSamples + band.sampleCount > maximumSampleCount)
+            {
+                compositing.reset ();
+            }
+
+            _Data->setupBand (band, _Data->_counts, countRegion, "tile");
+
+            for (size_t i = 0; i < parts; i++)
+            {
+                _Data->readSource (
+                    i,
+                    band.framebuffers[i],
+                    band.dx1,
+                    band.dx2,
+                    dy,
+                    dy,
+                    lx,
+                    ly,
+                    false);
+            }
+
+            //
+            // composite tiles and write back to framebuffer, once the
+            // previous band is done
+            //
+
+            compositing.reset ();
+            compositing.reset (new TaskGroup);
+
+            for (int tx = band.dx1; tx <= band.dx2; tx++)
+            {
+                _Data->addCompositeTask (
+                    compositing.get (),
+                    band,
+                    _Data->dataWindowForTile (tx, dy, lx, ly),
+                    true,
+                    names);
+            } //next tile
+
+            compositingSamples = band.sampleCount;
+            current            = 1 - current;
+        }
+    }
+}
+
+namespace
+{
+
+template <class TiledOutput>
+void
+writeCompositedTiles (CompositeDeepTiled& comp, TiledOutput& out)
+{
+    const Header& header = out.header ();
+
+    if (header.dataWindow () != comp.dataWindow () ||
+        !(header.tileDescription () == comp.tileDescription ()))
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Cannot write composited tiles to image file \""
+                << out.fileName ()
+                << "\": its data window or tile description differs "
+                   "from that of the deep data.");
+    }
+
+    size_t numChannels = 0;
+    for (ChannelList::ConstIterator i = header.channels ().begin ();
+         i != header.channels ().end ();
+         ++i, ++numChannels)
+    {
+        if (i.channel ().type != HALF && i.channel ().type != FLOAT)
+        {
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Cannot write composited tiles to image file \""
+                    << out.fileName () << "\": channel \"" << i.name ()
+                    << "\" is neither half nor float.");
+        }
+    }
+
+    FrameBuffer          saved = comp.frameBuffer ();
+    vector<vector<char>> buffers;
+
+    try
+    {
+        for (int ly = 0; ly < out.numYLevels (); ly++)
+        {
+            for (int lx = 0; lx < out.numXLevels (); lx++)
+            {
+                if (!out.isValidLevel (lx, ly)) continue;
+
+                int numXTiles = out.numXTiles (lx);
+
+                for (int dy = 0; dy < out.numYTiles (ly); dy++)
+                {
+                    //
+                    // composite a row of tiles into a flat buffer,
+                    // and write it out
+                    //
+
+                    Box2i row (
+                        out.dataWindowForTile (0, dy, lx, ly).min,
+                        out.dataWindowForTile (numXTiles - 1, dy, lx, ly).max);
+
+                    size_t pixels = size_t (row.size ().x + 1) *
+                                    size_t (row.size ().y + 1);
+
+                    FrameBuffer fb;
+                    buffers.resize (numChannels);
+
+                    size_t c = 0;
+                    for (ChannelList::ConstIterator i =
+                             header.channels ().begin ();
+                         i != header.channels ().end ();
+                         ++i, ++c)
+                    {
+                        size_t size = pixelTypeSize (i.channel ().type);
+
+                        buffers[c].resize (size * pixels);
+                        fb.insert (
+                            i.name (),
+                            Slice::Make (
+                                i.channel ().type,
+                                buffers[c].data (),
+                                row,
+                                size,
+                                size * (row.size ().x + 1)));
+                    }
+
+                    comp.setFrameBuffer (fb);
+                    comp.readTiles (0, numXTiles - 1, dy, dy, lx, ly);
+
+                    out.setFrameBuffer (fb);
+                    out.writeTiles (0, numXTiles - 1, dy, dy, lx, ly);
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        comp.setFrameBuffer (saved);
+        throw;
+    }
+
+    comp.setFrameBuffer (saved);
+}
+
+} // namespace
+
+void
+CompositeDeepTiled::writeTiles (TiledOutputFile& out)
+{
+    writeCompositedTiles (*this, out);
+}
+
+void
+CompositeDeepTiled::writeTiles (TiledOutputPart& out)
+{
+    writeCompositedTiles (*this, out);
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
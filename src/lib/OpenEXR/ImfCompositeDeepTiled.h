@@ -0,0 +1,174 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_COMPOSITEDEEPTILED_H
+#define INCLUDED_IMF_COMPOSITEDEEPTILED_H
+
+//-----------------------------------------------------------------------------
+//
+//	Class to composite deep tiles into a frame buffer
+//      Initialise with a deep tiled input part or deep tiled input file
+//      (also supports multiple files and parts, and will
+//       composite them together, as long as their data windows and
+//       tile descriptions agree)
+//
+//      Then call setFrameBuffer, and readTile or readTiles, exactly as
+//      for reading regular tiled images; or call writeTiles to
+//      composite every tile of every level into a flat tiled file.
+//
+//      Tiles are composited in parallel, on the global thread pool.
+//
+//      Restrictions - source file(s) must contain at least Z and alpha channels
+//                   - if multiple files/parts are provided, data windows
+//                     and tile descriptions must match
+//                   - all requested channels will be composited as premultiplied
+//                   - only half and float channels can be requested
+//
+//      This object should not be considered threadsafe
+//
+//      As for CompositeDeepScanLine, you may derive from the DeepCompositing
+//      class, override the sort() and composite_pixel() functions, and pass
+//      an instance to setCompositing().
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfForward.h"
+#include "ImfTileDescription.h"
+
+#include <Imath/ImathBox.h>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class IMF_EXPORT_TYPE CompositeDeepTiled
+{
+public:
+    IMF_EXPORT
+    CompositeDeepTiled ();
+    IMF_EXPORT
+    virtual ~CompositeDeepTiled ();
+
+    /// set the source data as a part
+    ///@note all parts must remain valid until after last interaction with DeepComp
+    IMF_EXPORT
+    void addSource (DeepTiledInputPart* part);
+
+    /// set the source data as a file
+    ///@note all file must remain valid until after last interaction with DeepComp
+    IMF_EXPORT
+    void addSource (DeepTiledInputFile* file);
+
+    IMF_EXPORT
+    int sources () const; // return number of sources
+
+    /////////////////////////////////////////
+    //
+    // set the frame buffer for output values
+    // the buffers specified must be large enough
+    // to hold the tiles that are read, as for
+    // TiledInputFile::setFrameBuffer (slices may
+    // use tile coordinates)
+    //
+    /////////////////////////////////////////
+    IMF_EXPORT
+    void setFrameBuffer (const FrameBuffer& fr);
+
+    /////////////////////////////////////////
+    //
+    // retrieve frameBuffer
+    //
+    ////////////////////////////////////////
+    IMF_EXPORT
+    const FrameBuffer& frameBuffer () const;
+
+    //////////////////////////////////////////////////
+    //
+    // read the given tiles from the source(s), composite
+    // them, and store the result in the frame buffer
+    // provided
+    //
+    // Large requests are split into runs of tiles by
+    // their sample counts, as in CompositeDeepScanLine,
+    // using the limit set with setMaximumSampleCount()
+    //
+    //////////////////////////////////////////////////
+
+    IMF_EXPORT
+    void readTile (int dx, int dy, int l = 0);
+    IMF_EXPORT
+    void readTile (int dx, int dy, int lx, int ly);
+
+    IMF_EXPORT
+    void readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly);
+    IMF_EXPORT
+    void readTiles (int dx1, int dx2, int dy1, int dy2, int l = 0);
+
+    //////////////////////////////////////////////////
+    //
+    // composite all tiles of all levels of the source(s)
+    // and write them to the given file or part, one row
+    // of tiles at a time
+    //
+    // The output must have the same data window and tile
+    // description as the sources, and only half and float
+    // channels; it must contain Z and A channels only if
+    // they should be written. The frame buffer set with
+    // setFrameBuffer() is left unchanged.
+    //
+    //////////////////////////////////////////////////
+
+    IMF_EXPORT
+    void writeTiles (TiledOutputFile& out);
+    IMF_EXPORT
+    void writeTiles (TiledOutputPart& out);
+
+    /////////////////////////////////////////////////
+    //
+    // retrieve the data window and tile description
+    // shared by all sources
+    //
+    ////////////////////////////////////////////////
+
+    IMF_EXPORT
+    const IMATH_NAMESPACE::Box2i& dataWindow () const;
+
+    IMF_EXPORT
+    const TileDescription& tileDescription () const;
+
+    //
+    // override default sorting/compositing operation
+    // (otherwise an instance of the base class will be used)
+    //
+
+    IMF_EXPORT
+    void setCompositing (DeepCompositing*);
+
+    struct IMF_HIDDEN Data;
+
+    //
+    // set the maximum number of samples that will be composited.
+    // If a single tile has more samples, readTiles will throw
+    // an exception. readTiles holds no more than this many samples
+    // at once, splitting larger requests into runs of tiles.
+    // A value of 0 or less disables the limit. The limit is
+    // separate from the one of CompositeDeepScanLine
+    //
+    IMF_EXPORT
+    static void setMaximumSampleCount (int64_t sampleCount);
+
+    IMF_EXPORT
+    static int64_t getMaximumSampleCount ();
+
+private:
+    struct Data* _Data;
+
+    CompositeDeepTiled (const CompositeDeepTiled&)            = delete;
+    CompositeDeepTiled& operator= (const CompositeDeepTiled&) = delete;
+    CompositeDeepTiled (CompositeDeepTiled&&)                 = delete;
+    CompositeDeepTiled& operator= (CompositeDeepTiled&&)      = delete;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
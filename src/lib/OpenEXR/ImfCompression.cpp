@@ -188,6 +188,13 @@ static const CompressionDesc IdToDesc[] = {
         32,
         false,
         false),
+    CompressionDesc (
+        "zipd",
+        "zlib compression of predicted samples, one scan line at a time. "
+        "Suited to deep data sorted by depth.",
+        1,
+        false,
+        true),
 };
 // clang-format on
 
@@ -206,6 +213,7 @@ static const std::map<std::string, Compression> CompressionNameToId = {
     {"dwab", Compression::DWAB_COMPRESSION},
     {"htj2k256", Compression::HTJ2K256_COMPRESSION},
     {"htj2k32", Compression::HTJ2K32_COMPRESSION},
+    {"zipd", Compression::ZIPD_COMPRESSION},
 };
 
 #define UNKNOWN_COMPRESSION_ID_MSG "INVALID COMPRESSION ID"
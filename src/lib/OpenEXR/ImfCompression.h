@@ -55,6 +55,10 @@ enum IMF_EXPORT_ENUM Compression
 
     HTJ2K32_COMPRESSION = 11,    // High-Throughput JPEG2000 (HTJ2K), 32 scanlines
 
+    ZIPD_COMPRESSION = 12, // zlib compression of predicted samples, one
+                           // scan line at a time, suited to deep data
+                           // sorted by depth.
+
     NUM_COMPRESSION_METHODS // number of different compression methods
 };
 
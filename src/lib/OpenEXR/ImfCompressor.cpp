@@ -18,16 +18,85 @@
 #include "ImfPxr24Compressor.h"
 #include "ImfRleCompressor.h"
 #include "ImfZipCompressor.h"
+#include "ImfZipDCompressor.h"
 #include "ImfZip.h"
 
+#include "IlmThreadConfig.h"
+
 #include <algorithm>
+#include <map>
 #include <stdexcept>
+#if ILMTHREAD_THREADING_ENABLED
+#    include <mutex>
+#endif
 #include "ImfHTCompressor.h"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 using IMATH_NAMESPACE::Box2i;
 
+namespace
+{
+
+//
+// The sample count tables of deep compressors are kept in a map keyed
+// by the compressor, rather than in the class, to leave the layout of
+// Compressor unchanged. Compressors never given a table have no entry.
+//
+
+struct SampleCountTables
+{
+    const char* table      = nullptr;
+    const char* packed     = nullptr;
+    uint64_t    packedSize = 0;
+};
+
+struct SampleCountStash
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex _mutex;
+#endif
+    std::map<const Compressor*, SampleCountTables> _store;
+};
+
+SampleCountStash&
+getStash ()
+{
+    static SampleCountStash stash;
+    return stash;
+}
+
+//
+// Entries are only added, changed and removed by the thread using
+// their compressor, so the returned pointer stays valid without the
+// lock.
+//
+
+SampleCountTables*
+findSampleCountTables (const Compressor* c, bool create)
+{
+    SampleCountStash& s = getStash ();
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lk (s._mutex);
+#endif
+    if (create) return &s._store[c];
+
+    auto i = s._store.find (c);
+    return i != s._store.end () ? &i->second : nullptr;
+}
+
+void
+clearSampleCountTables (const Compressor* c)
+{
+    SampleCountStash& s = getStash ();
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lk (s._mutex);
+#endif
+    s._store.erase (c);
+}
+
+} // namespace
+
 Compressor::Compressor (
     const Header& hdr,
     exr_compression_t compression_type,
@@ -72,6 +141,7 @@ Compressor::Compressor (
 
 Compressor::~Compressor ()
 {
+    clearSampleCountTables (this);
     if (_decoder_init)
         exr_decoding_destroy(_ctxt, &_decoder);
     if (_encoder_init)
@@ -132,6 +202,25 @@ Compressor::uncompressTile (
         runDecodeStep (inPtr, inSize, range, outPtr));
 }
 
+void
+Compressor::setSampleCountTable (const char* inPtr, int inSize)
+{
+    SampleCountTables* t = findSampleCountTables (this, true);
+
+    t->table      = inPtr;
+    t->packed     = inPtr;
+    t->packedSize = inSize;
+}
+
+int
+Compressor::sampleCountTable (const char*& outPtr) const
+{
+    const SampleCountTables* t = findSampleCountTables (this, false);
+
+    outPtr = t ? t->packed : nullptr;
+    return t ? static_cast<int> (t->packedSize) : 0;
+}
+
 uint64_t
 Compressor::runEncodeStep (
     const char* inPtr,
@@ -139,8 +228,23 @@ Compressor::runEncodeStep (
     IMATH_NAMESPACE::Box2i range,
     const char*& outPtr)
 {
+    SampleCountTables* tables = findSampleCountTables (this, false);
+    const char*        table  = nullptr;
+
+    if (tables)
+    {
+        table         = tables->table;
+        tables->table = nullptr;
+
+        if (!table)
+        {
+            tables->packed     = nullptr;
+            tables->packedSize = 0;
+        }
+    }
+
     // special case
-    if (inSize == 0)
+    if (inSize == 0 && !table)
     {
         outPtr = inPtr;
         return 0;
@@ -168,12 +272,24 @@ Compressor::runEncodeStep (
 
     _encoder.packed_buffer = const_cast<char*> (inPtr);
     _encoder.packed_bytes = inSize;
+    _encoder.sample_count_table =
+        reinterpret_cast<int32_t*> (const_cast<char*> (table));
 
-    if (EXR_ERR_SUCCESS != exr_compress_chunk(&_encoder))
+    exr_result_t rv = exr_compress_chunk (&_encoder);
+
+    _encoder.sample_count_table = nullptr;
+
+    if (EXR_ERR_SUCCESS != rv)
         throw IEX_NAMESPACE::ArgExc ("Unable to run compression routine");
 
     outPtr = (const char*) _encoder.compressed_buffer;
 
+    if (table)
+    {
+        tables->packed = (const char*) _encoder.packed_sample_count_table;
+        tables->packedSize = _encoder.packed_sample_count_bytes;
+    }
+
     _encoder.packed_buffer = nullptr;
     _encoder.packed_bytes = 0;
 
@@ -298,6 +414,11 @@ newCompressor (Compression c, size_t maxScanLineSize, const Header& hdr)
             ret = new ZipCompressor (hdr, maxScanLineSize, 16);
             break;
 
+        case ZIPD_COMPRESSION:
+
+            ret = new ZipDCompressor (hdr, maxScanLineSize, 1);
+            break;
+
         case PIZ_COMPRESSION:
 
             ret = new PizCompressor (hdr, maxScanLineSize, 32);
@@ -387,6 +508,11 @@ newTileCompressor (
             ret = new ZipCompressor (hdr, tileLineSize, numTileLines);
             break;
 
+        case ZIPD_COMPRESSION:
+
+            ret = new ZipDCompressor (hdr, tileLineSize, numTileLines);
+            break;
+
         case PIZ_COMPRESSION:
 
             ret = new PizCompressor (hdr, tileLineSize, numTileLines);
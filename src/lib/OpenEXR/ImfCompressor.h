@@ -178,6 +178,25 @@ public:
         IMATH_NAMESPACE::Box2i range,
         const char*&           outPtr);
 
+    //-------------------------------------------------------------------------
+    // Deep data: set the sample count table of the chunk passed to the
+    // next call of compress() or compressTile(), as it is stored in the
+    // file (cumulative sample counts per line, in Xdr format). The table
+    // is compressed along with the samples, some compression methods
+    // predict the samples from the sample counts.
+    //
+    // sampleCountTable() sets outPtr to the compressed table of the last
+    // chunk and returns its size, which is inSize if it did not shrink;
+    // if no table was set for the last chunk, it sets outPtr to null and
+    // returns 0.
+    //-------------------------------------------------------------------------
+
+    IMF_EXPORT
+    void setSampleCountTable (const char* inPtr, int inSize);
+
+    IMF_EXPORT
+    int sampleCountTable (const char*& outPtr) const;
+
     void setExpectedSize (size_t sz) { _expectedSize = sz; }
     void setTileLevel (int lx, int ly) { _levelX = lx; _levelY = ly; }
 
@@ -121,7 +121,19 @@ Context::Context (const char* filename, const ContextInitializer& ctxtinit, read
 {
     exr_result_t rv;
 
-    rv = exr_start_read (_ctxt.get (), filename, &(ctxtinit._initializer));
+    // a stream over memory can be read in place by the core
+    const MemoryIStream* memstr =
+        dynamic_cast<const MemoryIStream*> (ctxtinit._prov_stream);
+
+    if (memstr)
+        rv = exr_start_read_from_memory (
+            _ctxt.get (),
+            filename,
+            memstr->data (),
+            memstr->dataSize (),
+            &(ctxtinit._initializer));
+    else
+        rv = exr_start_read (_ctxt.get (), filename, &(ctxtinit._initializer));
     if (EXR_ERR_SUCCESS != rv)
     {
         if (rv == EXR_ERR_MISSING_REQ_ATTR)
@@ -270,6 +282,30 @@ Context::dataWindow (int partidx) const
 
 ////////////////////////////////////////
 
+exr_attr_box2i_t
+Context::reducedDataWindow (int partidx, int levels) const
+{
+    exr_attr_box2i_t dw;
+
+    if (EXR_ERR_SUCCESS !=
+        exr_get_reduced_data_window (*_ctxt, partidx, levels, &dw))
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Unable to read part "
+                << partidx << " in file '" << fileName ()
+                << "' at reduced resolution level " << levels
+                << ": this requires HTJ2K compression (or DWA compression at"
+                   " level 3), no sub-sampled channels, and chunk sizes"
+                   " which are multiples of 2^"
+                << levels);
+    }
+
+    return dw;
+}
+
+////////////////////////////////////////
+
 const exr_attr_chlist_t*
 Context::channels (int partidx) const
 {
@@ -296,18 +332,20 @@ Context::hasChannel (int partidx, const char* name) const
 
 const exr_attr_chlist_entry_t* Context::findChannel (int partidx, const char* name) const
 {
-    const exr_attr_chlist_t* cl  = channels (partidx);
-    int32_t                  len = strlen (name);
+    int idx = findChannelIndex (partidx, name);
+    if (idx < 0) return nullptr;
+    return channels (partidx)->entries + idx;
+}
 
-    for (int i = 0; i < cl->num_channels; ++i)
-    {
-        const exr_attr_chlist_entry_t* curc = cl->entries + i;
-        if (curc->name.length == len && 0 == memcmp (name, curc->name.str, len))
-        {
-            return curc;
-        }
-    }
-    return nullptr;
+////////////////////////////////////////
+
+int
+Context::findChannelIndex (int partidx, const char* name) const
+{
+    int32_t idx = -1;
+    if (EXR_ERR_SUCCESS != exr_find_channel (*_ctxt, partidx, name, &idx))
+        return -1;
+    return idx;
 }
 
 ////////////////////////////////////////
@@ -67,10 +67,18 @@ public:
     // access to commonly used attributes
 
     IMF_EXPORT exr_attr_box2i_t dataWindow (int partidx) const;
+    /// data window when decoding at 1/2^levels resolution, throws
+    /// if the part can not be decoded at reduced resolution
+    IMF_EXPORT exr_attr_box2i_t
+    reducedDataWindow (int partidx, int levels) const;
 
     IMF_EXPORT const exr_attr_chlist_t* channels (int partidx) const;
     IMF_EXPORT bool hasChannel (int partidx, const char* name) const;
     IMF_EXPORT const exr_attr_chlist_entry_t* findChannel (int partidx, const char* name) const;
+    /// returns the index of the channel in the (sorted) channel list,
+    /// which is also the index in the channels of a decode pipeline,
+    /// or -1 if the part has no such channel
+    IMF_EXPORT int findChannelIndex (int partidx, const char* name) const;
 
     IMF_EXPORT exr_lineorder_t lineOrder (int partidx) const;
 
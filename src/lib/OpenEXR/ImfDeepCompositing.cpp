@@ -7,12 +7,154 @@
 
 #include "ImfNamespace.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 using std::sort;
 using std::vector;
+
+namespace
+{
+
+//
+// Compare two depths; a NaN depth is equal to another NaN, and
+// farther than any number.
+//
+
+inline int
+compareDepth (float a, float b)
+{
+    if (a < b) return -1;
+    if (a > b) return 1;
+    return int (a != a) - int (b != b);
+}
+
+//
+// Samples are ordered by Z, then by ZBack, then by sample index, which
+// is a strict total order, also with NaN depths: every sorting method
+// below produces exactly the order std::sort() gives with sort_helper,
+// from any permutation of the samples.
+//
+
+struct sort_helper
+{
+    const float** inputs;
+    bool          operator() (int a, int b) const
+    {
+        int c = compareDepth (inputs[0][a], inputs[0][b]);
+        if (c == 0) c = compareDepth (inputs[1][a], inputs[1][b]);
+        if (c != 0) return c < 0;
+        return a < b;
+    }
+    sort_helper (const float** i) : inputs (i) {}
+};
+
+//
+// Up to this many samples, insertion sort beats std::sort();
+// from radixSortMin samples on, a radix sort does.
+//
+
+const int insertionSortMax = 16;
+const int radixSortMin     = 2048;
+
+bool
+isSorted (const int order[], int num_samples, const sort_helper& less)
+{
+    for (int i = 1; i < num_samples; i++)
+        if (less (order[i], order[i - 1])) return false;
+    return true;
+}
+
+void
+insertionSort (int order[], int num_samples, const sort_helper& less)
+{
+    for (int i = 1; i < num_samples; i++)
+    {
+        int s = order[i];
+        int j = i;
+        for (; j > 0 && less (s, order[j - 1]); j--)
+            order[j] = order[j - 1];
+        order[j] = s;
+    }
+}
+
+//
+// Map a float to an unsigned integer with the same ordering,
+// treating -0 and +0 as equal, and all NaNs as equal and last,
+// as compareDepth() does.
+//
+
+inline uint32_t
+sortableBits (float f)
+{
+    if (f != f) return 0xffffffffu;
+    f += 0.0f;
+
+    uint32_t u;
+    memcpy (&u, &f, sizeof (u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+
+//
+// Stable LSD radix sort of the samples on (Z, ZBack), one byte at a
+// time; being stable, it keeps equal samples in index order. As the
+// order is total, the result does not depend on the permutation order
+// holds on input, so the samples are taken in index order. The counts
+// for all eight digits are gathered in a single pass, and digits that
+// are the same for all samples are skipped.
+//
+
+struct KeyIndex
+{
+    uint64_t key;
+    int      index;
+};
+
+void
+radixSort (int order[], const float* z, const float* zback, int num_samples)
+{
+    vector<KeyIndex> keys (2 * size_t (num_samples));
+    KeyIndex*        src = keys.data ();
+    KeyIndex*        dst = src + num_samples;
+
+    int count[8][256] = {{0}};
+    for (int i = 0; i < num_samples; i++)
+    {
+        uint64_t key =
+            (uint64_t (sortableBits (z[i])) << 32) | sortableBits (zback[i]);
+        src[i] = {key, i};
+        for (int d = 0; d < 8; d++)
+            count[d][(key >> (8 * d)) & 0xff]++;
+    }
+
+    for (int d = 0; d < 8; d++)
+    {
+        int shift = 8 * d;
+        if (count[d][(src[0].key >> shift) & 0xff] == num_samples) continue;
+
+        int offset = 0;
+        for (int v = 0; v < 256; v++)
+        {
+            int c       = count[d][v];
+            count[d][v] = offset;
+            offset += c;
+        }
+
+        for (int i = 0; i < num_samples; i++)
+            dst[count[d][(src[i].key >> shift) & 0xff]++] = src[i];
+
+        std::swap (src, dst);
+    }
+
+    for (int i = 0; i < num_samples; i++)
+        order[i] = src[i].index;
+}
+
+} // namespace
+
 DeepCompositing::DeepCompositing ()
 {}
 
@@ -33,14 +175,29 @@ DeepCompositing::composite_pixel (
     // no samples? do nothing
     if (num_samples == 0) { return; }
 
+    //
+    // Most pixels have few samples: avoid allocating the sort
+    // order for them.
+    //
+
+    int         local_order[64];
     vector<int> sort_order;
+    int*        order = nullptr;
+
     if (sources > 1)
     {
-        sort_order.resize (num_samples);
+        if (num_samples <= int (sizeof (local_order) / sizeof (int)))
+            order = local_order;
+        else
+        {
+            sort_order.resize (num_samples);
+            order = sort_order.data ();
+        }
+
         for (int i = 0; i < num_samples; i++)
-            sort_order[i] = i;
+            order[i] = i;
         sort (
-            &sort_order[0],
+            order,
             inputs,
             channel_names,
             num_channels,
@@ -50,31 +207,18 @@ DeepCompositing::composite_pixel (
 
     for (int i = 0; i < num_samples; i++)
     {
-        int   s     = (sources > 1) ? sort_order[i] : i;
+        int   s     = order ? order[i] : i;
         float alpha = outputs[2];
         if (alpha >= 1.0f) return;
 
+        float weight = 1.0f - alpha;
         for (int c = 0; c < num_channels; c++)
         {
-            outputs[c] += (1.0f - alpha) * inputs[c][s];
+            outputs[c] += weight * inputs[c][s];
         }
     }
 }
 
-struct sort_helper
-{
-    const float** inputs;
-    bool          operator() (int a, int b)
-    {
-        if (inputs[0][a] < inputs[0][b]) return true;
-        if (inputs[0][a] > inputs[0][b]) return false;
-        if (inputs[1][a] < inputs[1][b]) return true;
-        if (inputs[1][a] > inputs[1][b]) return false;
-        return a < b;
-    }
-    sort_helper (const float** i) : inputs (i) {}
-};
-
 void
 DeepCompositing::sort (
     int          order[],
@@ -84,7 +228,21 @@ DeepCompositing::sort (
     int          num_samples,
     int          sources)
 {
-    std::sort (order + 0, order + num_samples, sort_helper (inputs));
+    sort_helper less (inputs);
+
+    //
+    // Samples from a single tidy image, or from sources that do not
+    // overlap in depth, often arrive in order already.
+    //
+
+    if (isSorted (order, num_samples, less)) return;
+
+    if (num_samples <= insertionSortMax)
+        insertionSort (order, num_samples, less);
+    else if (num_samples >= radixSortMin)
+        radixSort (order, inputs[0], inputs[1], num_samples);
+    else
+        std::sort (order + 0, order + num_samples, less);
 }
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
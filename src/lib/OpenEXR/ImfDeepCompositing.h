@@ -10,7 +10,7 @@
 //
 //	Class to sort and composite deep samples into a frame buffer
 //      You may derive from this class to change the way that CompositeDeepScanLine
-//      and CompositeDeepTile combine samples together - pass an instance of your derived
+//      and CompositeDeepTiled combine samples together - pass an instance of your derived
 //      class to the compositing engine
 //
 //-----------------------------------------------------------------------------
@@ -75,9 +75,14 @@ public:
     /// does not sort the values in-place. Instead it populates
     /// array 'order' with the desired sorting order
     ///
-    /// the default operation sorts samples from front to back according to their Z channel
+    /// the default operation sorts samples from front to back according to their Z channel,
+    /// then their ZBack channel, keeping samples with equal depths in their original order.
+    /// Samples with a NaN depth are sorted after all others.
+    /// Samples that are already in that order are detected and not sorted again.
     ///
-    /// @param order         - required output order. order[n] shall be the nth closest sample
+    /// @param order         - on input, a permutation of the sample indices, as set up by
+    ///                        composite_pixel(); required output order. order[n] shall be
+    ///                        the nth closest sample
     /// @param inputs        - arrays of input samples, one array per channel_name
     /// @param channel_names - array of channel names for corresponding channels
     /// @param num_channels  - number of channels (3 or greater)
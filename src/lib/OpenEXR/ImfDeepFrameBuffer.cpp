@@ -5,12 +5,69 @@
 
 #include "ImfDeepFrameBuffer.h"
 #include "Iex.h"
+#include "IlmThreadConfig.h"
+
+#if ILMTHREAD_THREADING_ENABLED
+#    include <mutex>
+#endif
 
 using namespace std;
 #include "ImfNamespace.h"
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+namespace
+{
+
+//
+// The sample offset slices are kept in a map keyed by the frame buffer,
+// rather than in the class, to leave the layout of DeepFrameBuffer
+// unchanged. Frame buffers without offsets have no entry.
+//
+
+struct SampleOffsetStash
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex _mutex;
+#endif
+    std::map<const DeepFrameBuffer*, Slice> _store;
+};
+
+SampleOffsetStash&
+getStash ()
+{
+    static SampleOffsetStash stash;
+    return stash;
+}
+
+const Slice&
+retrieveSampleOffsets (const DeepFrameBuffer* fb)
+{
+    static const Slice noOffsets;
+
+    SampleOffsetStash& s = getStash ();
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lk (s._mutex);
+#endif
+    auto i = s._store.find (fb);
+    return i != s._store.end () ? i->second : noOffsets;
+}
+
+void
+storeSampleOffsets (const DeepFrameBuffer* fb, const Slice& slice)
+{
+    SampleOffsetStash& s = getStash ();
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lk (s._mutex);
+#endif
+    if (slice.base)
+        s._store[fb] = slice;
+    else
+        s._store.erase (fb);
+}
+
+} // namespace
+
 DeepSlice::DeepSlice (
     PixelType t,
     char*     b,
@@ -28,6 +85,34 @@ DeepSlice::DeepSlice (
     // empty
 }
 
+DeepFrameBuffer::DeepFrameBuffer ()
+{
+    // empty
+}
+
+DeepFrameBuffer::DeepFrameBuffer (const DeepFrameBuffer& other)
+    : _map (other._map), _sampleCounts (other._sampleCounts)
+{
+    storeSampleOffsets (this, retrieveSampleOffsets (&other));
+}
+
+DeepFrameBuffer&
+DeepFrameBuffer::operator= (const DeepFrameBuffer& other)
+{
+    if (this != &other)
+    {
+        _map          = other._map;
+        _sampleCounts = other._sampleCounts;
+        storeSampleOffsets (this, retrieveSampleOffsets (&other));
+    }
+    return *this;
+}
+
+DeepFrameBuffer::~DeepFrameBuffer ()
+{
+    storeSampleOffsets (this, Slice ());
+}
+
 void
 DeepFrameBuffer::insert (const char name[], const DeepSlice& slice)
 {
@@ -181,4 +266,22 @@ DeepFrameBuffer::getSampleCountSlice () const
     return _sampleCounts;
 }
 
+void
+DeepFrameBuffer::insertSampleOffsetSlice (const Slice& slice)
+{
+    if (slice.base && slice.type != UINT)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "The type of sample offset slice should be UINT.");
+    }
+
+    storeSampleOffsets (this, slice);
+}
+
+const Slice&
+DeepFrameBuffer::getSampleOffsetSlice () const
+{
+    return retrieveSampleOffsets (this);
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
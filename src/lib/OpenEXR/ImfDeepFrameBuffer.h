@@ -38,6 +38,13 @@ struct IMF_EXPORT_TYPE DeepSlice : public Slice
     //      if xTileCoords is true then xp = x - xt, else xp = x
     //      if yTileCoords is true then yp = y - yt, else yp = y
     //
+    // If the frame buffer has a sample offset slice (see
+    // DeepFrameBuffer::insertSampleOffsetSlice()), base points to one
+    // contiguous block of samples instead, xStride and yStride are
+    // ignored, and the address of sample i in pixel (x, y) is
+    //
+    //  base + (offset (x, y) + i) * sampleStride
+    //
     //---------------------------------------------------------------------
 
     int sampleStride;
@@ -66,6 +73,15 @@ struct IMF_EXPORT_TYPE DeepSlice : public Slice
 class IMF_EXPORT_TYPE DeepFrameBuffer
 {
 public:
+    IMF_EXPORT
+    DeepFrameBuffer ();
+    IMF_EXPORT
+    DeepFrameBuffer (const DeepFrameBuffer& other);
+    IMF_EXPORT
+    DeepFrameBuffer& operator= (const DeepFrameBuffer& other);
+    IMF_EXPORT
+    ~DeepFrameBuffer ();
+
     //------------
     // Add a slice
     //------------
@@ -146,6 +162,30 @@ public:
     IMF_EXPORT
     const Slice& getSampleCountSlice () const;
 
+    //------------------------------------------------------------------
+    // Sample offset slice.
+    //
+    // Instead of a table of per-pixel pointers, the deep slices can
+    // each point to a single contiguous block of samples, with the
+    // position of the first sample of every pixel given by an offset
+    // slice: offset (x, y) is the number of samples in the block
+    // before those of pixel (x, y), counted in units of each deep
+    // slice's sampleStride.  The offset slice must be of type UINT and
+    // is addressed like the sample count slice.
+    //
+    // When the offsets are the running sum of the sample counts, as
+    // in the file itself, samples are read and written one chunk at a
+    // time rather than one pixel at a time.
+    //
+    // A slice with a null base pointer (the default) removes the
+    // offsets; the deep slices then hold per-pixel pointers again.
+    //------------------------------------------------------------------
+
+    IMF_EXPORT
+    void insertSampleOffsetSlice (const Slice& slice);
+    IMF_EXPORT
+    const Slice& getSampleOffsetSlice () const;
+
 private:
     SliceMap _map;
     Slice    _sampleCounts;
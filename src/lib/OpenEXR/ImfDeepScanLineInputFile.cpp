@@ -13,6 +13,7 @@
 
 #include "ImfDeepFrameBuffer.h"
 #include "ImfInputPartData.h"
+#include "ImfMisc.h"
 
 #include "IlmThreadPool.h"
 #if ILMTHREAD_THREADING_ENABLED
@@ -23,6 +24,7 @@
 #include "Iex.h"
 
 #include <algorithm>
+#include <exception>
 #include <limits>
 #include <string>
 #include <vector>
@@ -80,12 +82,33 @@ struct ScanLineProcess
         const DeepFrameBuffer *outfb,
         int fbY);
 
+    void run_allocate (int fbY);
+
+    void place_samples (const DeepFrameBuffer *outfb);
+
     exr_result_t          last_decode_err = EXR_ERR_UNKNOWN;
     bool                  first = true;
     bool                  counts_only = false;
     exr_chunk_info_t      cinfo;
     exr_decode_pipeline_t decoder;
 
+    // the frame buffer has a sample offset slice: the samples are
+    // placed once the sample counts of the chunk are known
+    bool                  use_offsets = false;
+    // per-pixel sample pointers, built from the sample offsets when
+    // the samples of a chunk are not contiguous in the frame buffer
+    std::vector<void*>    sample_pointers;
+
+    // set by readSampleCountsAndPixels: called once the sample counts
+    // of the chunk are known, before the samples are unpacked
+    const DeepScanLineInputFile::SampleAllocator* allocate = nullptr;
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex*           allocate_mutex = nullptr;
+#endif
+    const DeepFrameBuffer* allocate_fb = nullptr;
+    int                   allocate_y = 0;
+    std::exception_ptr    allocate_error;
+
     ScanLineProcess*      next;
 };
 
@@ -113,7 +136,12 @@ struct DeepScanLineInputFile::Data
 
     std::pair<int, int> getChunkRange (int y) const;
 
-    void readData (const DeepFrameBuffer &fb, int scanLine1, int scanLine2, bool countsOnly);
+    void readData (
+        const DeepFrameBuffer &fb,
+        int scanLine1,
+        int scanLine2,
+        bool countsOnly,
+        const SampleAllocator* allocate = nullptr);
     void readMemData (
         const DeepFrameBuffer &fb,
         const char *rawPixelData,
@@ -136,6 +164,7 @@ struct DeepScanLineInputFile::Data
 
 #if ILMTHREAD_THREADING_ENABLED
     std::mutex _mx;
+    std::mutex _allocateMx;
 
     class LineBufferTask final : public ILMTHREAD_NAMESPACE::Task
     {
@@ -148,7 +177,8 @@ struct DeepScanLineInputFile::Data
             const exr_chunk_info_t& cinfo,
             int                     fby,
             int                     endScan,
-            bool                    countsOnly)
+            bool                    countsOnly,
+            const SampleAllocator*  allocate)
             : Task (group)
             , _outfb (outfb)
             , _ifd (ifd)
@@ -159,6 +189,8 @@ struct DeepScanLineInputFile::Data
         {
             _line->cinfo = cinfo;
             _line->counts_only = countsOnly;
+            _line->allocate = allocate;
+            _line->allocate_mutex = &ifd->_allocateMx;
         }
 
         ~LineBufferTask () override
@@ -419,6 +451,26 @@ DeepScanLineInputFile::readPixelSampleCounts (int scanline)
     readPixelSampleCounts (scanline, scanline);
 }
 
+void
+DeepScanLineInputFile::readSampleCountsAndPixels (
+    int scanLine1, int scanLine2, const SampleAllocator& allocateSamples)
+{
+    if (!_data->frameBufferValid)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "readSampleCountsAndPixels called with no valid frame buffer");
+    }
+
+    if (!allocateSamples)
+    {
+        throw IEX_NAMESPACE::ArgExc (
+            "readSampleCountsAndPixels called with no sample allocator");
+    }
+
+    _data->readData (
+        _data->frameBuffer, scanLine1, scanLine2, false, &allocateSamples);
+}
+
 int
 DeepScanLineInputFile::firstScanLineInChunk (int y) const
 {
@@ -476,7 +528,11 @@ std::pair<int, int> DeepScanLineInputFile::Data::getChunkRange (int y) const
 
 void
 DeepScanLineInputFile::Data::readData (
-    const DeepFrameBuffer &fb, int scanLine1, int scanLine2, bool countsOnly)
+    const DeepFrameBuffer &fb,
+    int scanLine1,
+    int scanLine2,
+    bool countsOnly,
+    const SampleAllocator* allocate)
 {
     exr_attr_box2i_t dw = _ctxt->dataWindow (partNumber);
     exr_chunk_info_t cinfo;
@@ -527,7 +583,8 @@ DeepScanLineInputFile::Data::readData (
                     throw IEX_NAMESPACE::InputExc ("Unable to query scanline information");
 
                 ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
-                    new LineBufferTask (&tg, this, &sg, &fb, cinfo, y, scanLine2, countsOnly) );
+                    new LineBufferTask (
+                        &tg, this, &sg, &fb, cinfo, y, scanLine2, countsOnly, allocate) );
 
                 y += scansperchunk - (y - cinfo.start_y);
             }
@@ -542,6 +599,7 @@ DeepScanLineInputFile::Data::readData (
         bool redo = true;
 
         sp.counts_only = countsOnly;
+        sp.allocate = allocate;
         for (int y = scanLine1; y <= scanLine2; )
         {
             if (EXR_ERR_SUCCESS != exr_read_scanline_chunk_info (*_ctxt, partNumber, y, &cinfo))
@@ -727,6 +785,31 @@ mem_skip_read_chunk (exr_decode_pipeline_t* decode)
     return EXR_ERR_SUCCESS;
 }
 
+static exr_result_t
+prepare_deep_samples (exr_decode_pipeline_t* decode)
+{
+    ScanLineProcess* sp =
+        static_cast<ScanLineProcess*> (decode->decoding_user_data);
+
+    try
+    {
+        if (sp->allocate)
+        {
+            sp->copy_sample_count (sp->allocate_fb, sp->allocate_y);
+            sp->run_allocate (sp->allocate_y);
+        }
+
+        if (sp->use_offsets)
+            sp->place_samples (sp->allocate_fb);
+    }
+    catch (...)
+    {
+        sp->allocate_error = std::current_exception ();
+        return EXR_ERR_OUT_OF_MEMORY;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
 void ScanLineProcess::run_mem_decode (
         exr_const_context_t ctxt,
         int pn,
@@ -765,7 +848,19 @@ void ScanLineProcess::run_mem_decode (
     rawdata += cinfo.sample_count_table_size;
     decoder.packed_buffer = const_cast<char*> (rawdata);
 
+    if (use_offsets)
+    {
+        allocate_fb    = outfb;
+        allocate_y     = fbY;
+        allocate_error = nullptr;
+
+        decoder.decoding_user_data       = this;
+        decoder.realloc_nonimage_data_fn = &prepare_deep_samples;
+    }
+
     last_decode_err = exr_decoding_run (ctxt, pn, &decoder);
+    if (allocate_error)
+        std::rethrow_exception (allocate_error);
     if (EXR_ERR_SUCCESS != last_decode_err)
         throw IEX_NAMESPACE::IoExc ("Unable to run decoder");
 
@@ -828,11 +923,31 @@ void ScanLineProcess::run_decode (
         }
     }
 
+    bool allocating = allocate && !counts_only;
+
+    if (allocating || use_offsets)
+    {
+        // the sample counts are stored and the samples allocated
+        // and placed between unpacking the sample count table and
+        // the samples, so the chunk is only read and decompressed once
+        allocate_fb    = outfb;
+        allocate_y     = fbY;
+        allocate_error = nullptr;
+
+        decoder.decoding_user_data       = this;
+        decoder.realloc_nonimage_data_fn = &prepare_deep_samples;
+    }
+    else
+        decoder.realloc_nonimage_data_fn = nullptr;
+
     last_decode_err = exr_decoding_run (ctxt, pn, &decoder);
+    if (allocate_error)
+        std::rethrow_exception (allocate_error);
     if (EXR_ERR_SUCCESS != last_decode_err)
         throw IEX_NAMESPACE::IoExc ("Unable to run decoder");
 
-    copy_sample_count (outfb, fbY);
+    if (!allocating)
+        copy_sample_count (outfb, fbY);
 
     if (counts_only)
         return;
@@ -857,6 +972,12 @@ void ScanLineProcess::run_unpack (
     if (counts_only)
         return;
 
+    if (allocate)
+        run_allocate (fbY);
+
+    if (use_offsets)
+        place_samples (outfb);
+
     /* won't work for deep where we need to re-allocate the number of
      * samples but for scenario where we have separated sample count read
      * and deep sample alloc, should be fine to bypass pipe
@@ -882,9 +1003,14 @@ void ScanLineProcess::update_pointers (
     if ((int64_t)fbLastY < endY)
         decoder.user_line_end_ignore = (int32_t)(endY - fbLastY);
 
+    use_offsets = false;
     if (counts_only)
         return;
 
+    use_offsets = outfb->getSampleOffsetSlice ().base != nullptr;
+    if (!use_offsets)
+        decoder.decode_flags |= EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+
     for (int c = 0; c < decoder.channel_count; ++c)
     {
         exr_coding_channel_info_t& curchan = decoder.channels[c];
@@ -903,6 +1029,16 @@ void ScanLineProcess::update_pointers (
 
         curchan.user_bytes_per_element = fbslice->sampleStride;
         curchan.user_data_type         = (exr_pixel_type_t)fbslice->type;
+
+        if (use_offsets)
+        {
+            // placed by place_samples once the counts are known
+            curchan.user_pixel_stride = 0;
+            curchan.user_line_stride  = 0;
+            curchan.decode_to_ptr = reinterpret_cast<uint8_t*> (fbslice->base);
+            continue;
+        }
+
         curchan.user_pixel_stride      = fbslice->xStride;
         curchan.user_line_stride       = fbslice->yStride;
 
@@ -921,6 +1057,8 @@ void ScanLineProcess::run_fill (
     int fbY,
     const std::vector<DeepSlice> &filllist)
 {
+    const Slice& offsets = outfb->getSampleOffsetSlice ();
+
     for (auto& fills: filllist)
     {
         uint8_t*       ptr;
@@ -943,7 +1081,21 @@ void ScanLineProcess::run_fill (
             for ( int sx = 0, ex = cinfo.width; sx < ex; ++sx )
             {
                 int32_t samps = counts[sx];
-                void *dest = *((void **)outptr);
+                void *dest;
+
+                if (offsets.base)
+                {
+                    dest = fills.base +
+                           int64_t (sampleCount (
+                               offsets.base,
+                               offsets.xStride,
+                               offsets.yStride,
+                               cinfo.start_x + sx,
+                               y)) *
+                               int64_t (fills.sampleStride);
+                }
+                else
+                    dest = *((void **)outptr);
 
                 if (samps == 0 || dest == nullptr)
                 {
@@ -1040,4 +1192,139 @@ void ScanLineProcess::copy_sample_count (
     }
 }
 
+////////////////////////////////////////
+
+void ScanLineProcess::run_allocate (int fbY)
+{
+    int lastY = cinfo.start_y + cinfo.height - 1 - decoder.user_line_end_ignore;
+
+#if ILMTHREAD_THREADING_ENABLED
+    std::unique_lock<std::mutex> lock;
+    if (allocate_mutex)
+        lock = std::unique_lock<std::mutex> (*allocate_mutex);
+#endif
+
+    (*allocate) (fbY, lastY);
+}
+
+////////////////////////////////////////
+
+void ScanLineProcess::place_samples (const DeepFrameBuffer *outfb)
+{
+    const Slice&   offsets = outfb->getSampleOffsetSlice ();
+    int            begin   = decoder.user_line_begin_skip;
+    int            end     = cinfo.height - decoder.user_line_end_ignore;
+    int            w       = cinfo.width;
+    const int32_t* counts  = decoder.sample_count_table;
+
+    //
+    // If the offsets of the chunk follow its sample counts, the
+    // samples of each channel are unpacked as one run; otherwise
+    // through a table of per-pixel pointers.
+    //
+
+    int64_t first = -1;
+    int64_t next  = 0;
+    bool    contiguous = true;
+
+    for (int y = begin; y < end && contiguous; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int64_t off = (unsigned int) sampleCount (
+                offsets.base,
+                offsets.xStride,
+                offsets.yStride,
+                cinfo.start_x + x,
+                cinfo.start_y + y);
+
+            if (first < 0)
+                first = next = off;
+
+            if (off != next)
+            {
+                contiguous = false;
+                break;
+            }
+
+            next += counts[int64_t (y) * w + x];
+        }
+    }
+
+    uint16_t flags = decoder.decode_flags;
+    size_t   npix  = size_t (w) * size_t (std::max (end - begin, 0));
+    int      nused = 0;
+
+    if (contiguous)
+        flags &= ~EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+    else
+    {
+        flags |= EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+        sample_pointers.resize (npix * size_t (decoder.channel_count));
+    }
+
+    for (int c = 0; c < decoder.channel_count; ++c)
+    {
+        exr_coding_channel_info_t& curchan = decoder.channels[c];
+
+        if (!curchan.decode_to_ptr)
+            continue;
+
+        const DeepSlice& fbslice = (*outfb)[curchan.channel_name];
+        int64_t          ss      = fbslice.sampleStride;
+
+        if (contiguous)
+        {
+            curchan.decode_to_ptr =
+                reinterpret_cast<uint8_t*> (fbslice.base) +
+                std::max (first, int64_t (0)) * ss;
+            continue;
+        }
+
+        void** table = &sample_pointers[npix * size_t (nused++)];
+
+        for (int y = begin; y < end; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                void*& p = table[size_t (y - begin) * w + x];
+
+                if (counts[int64_t (y) * w + x] == 0)
+                {
+                    p = nullptr;
+                    continue;
+                }
+
+                int64_t off = (unsigned int) sampleCount (
+                    offsets.base,
+                    offsets.xStride,
+                    offsets.yStride,
+                    cinfo.start_x + x,
+                    cinfo.start_y + y);
+
+                p = fbslice.base + off * ss;
+            }
+        }
+
+        curchan.decode_to_ptr     = reinterpret_cast<uint8_t*> (table);
+        curchan.user_pixel_stride = sizeof (void*);
+        curchan.user_line_stride  = int32_t (w * sizeof (void*));
+    }
+
+    if (flags != decoder.decode_flags)
+    {
+        // the chunk has already been read, keep the reader in place
+        // for the in-memory decode
+        auto read_fn = decoder.read_fn;
+
+        decoder.decode_flags = flags;
+        if (EXR_ERR_SUCCESS != exr_decoding_choose_default_routines (
+                decoder.context, decoder.part_index, &decoder))
+        {
+            throw IEX_NAMESPACE::IoExc ("Unable to choose decoder routines");
+        }
+        decoder.read_fn = read_fn;
+    }
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
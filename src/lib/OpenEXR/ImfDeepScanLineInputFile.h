@@ -22,6 +22,8 @@
 
 #include "ImfThreading.h"
 
+#include <functional>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class IMF_EXPORT_TYPE DeepScanLineInputFile
@@ -235,6 +237,35 @@ public:
         int                    scanLine1,
         int                    scanLine2) const;
 
+    //-----------------------------------------------------------
+    // Read pixel sample counts and pixel data in a single pass.
+    //
+    // readSampleCountsAndPixels(s1, s2, allocateSamples) reads the
+    // same scan lines as readPixels(s1, s2), but reads and
+    // uncompresses each chunk of the file only once, instead of once
+    // for readPixelSampleCounts() and again for readPixels().
+    //
+    // As each chunk is read, its sample counts are stored in the
+    // "sample count" slice of the current frame buffer, and then
+    // allocateSamples(y1, y2) is called for the scan lines y1 to y2
+    // of the chunk: it must store, in the pointer slices of the frame
+    // buffer, the addresses of enough memory for the samples of those
+    // scan lines, before the samples are unpacked there. If the frame
+    // buffer has a sample offset slice, allocateSamples(y1, y2) stores
+    // the sample offsets of those scan lines instead.
+    //
+    // If threading is enabled, chunks are read in parallel, so the
+    // calls to allocateSamples() may come from different threads and
+    // in any order, but never at the same time. allocateSamples()
+    // must not change the frame buffer itself.
+    //-----------------------------------------------------------
+
+    using SampleAllocator = std::function<void (int y1, int y2)>;
+
+    IMF_EXPORT
+    void readSampleCountsAndPixels (
+        int scanLine1, int scanLine2, const SampleAllocator& allocateSamples);
+
 private:
     Context _ctxt;
     struct IMF_HIDDEN Data;
@@ -84,6 +84,15 @@ DeepScanLineInputPart::readPixelSampleCounts (int scanline)
     file->readPixelSampleCounts (scanline);
 }
 
+void
+DeepScanLineInputPart::readSampleCountsAndPixels (
+    int                                           scanLine1,
+    int                                           scanLine2,
+    const DeepScanLineInputFile::SampleAllocator& allocateSamples)
+{
+    file->readSampleCountsAndPixels (scanLine1, scanLine2, allocateSamples);
+}
+
 int
 DeepScanLineInputPart::firstScanLineInChunk (int y) const
 {
@@ -9,6 +9,7 @@
 #include "ImfForward.h"
 
 #include <cstdint>
+#include <functional>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
@@ -141,6 +142,17 @@ public:
         int                    scanLine1,
         int                    scanLine2) const;
 
+    //-----------------------------------------------------------
+    // Read pixel sample counts and pixel data in a single pass;
+    // see DeepScanLineInputFile::readSampleCountsAndPixels().
+    //-----------------------------------------------------------
+
+    IMF_EXPORT
+    void readSampleCountsAndPixels (
+        int                                        scanLine1,
+        int                                        scanLine2,
+        const std::function<void (int y1, int y2)>& allocateSamples);
+
     IMF_EXPORT
     int firstScanLineInChunk (int y) const;
     IMF_EXPORT
@@ -21,6 +21,7 @@
 #include "ImfMisc.h"
 #include "ImfPartType.h"
 #include "ImfPreviewImageAttribute.h"
+#include "ImfRawChunkCopy.h"
 #include "ImfStdIO.h"
 #include "ImfXdr.h"
 
@@ -109,7 +110,6 @@ struct LineBuffer
     Array<char>        sampleCountTableBuffer;
     const char*        sampleCountTablePtr;
     uint64_t           sampleCountTableSize;
-    Compressor*        sampleCountTableCompressor;
     int                minY;        // the min y scanline stored
     int                maxY;        // the max y scanline stored
     int                scanLineMin; // the min y scanline writing out
@@ -133,7 +133,6 @@ LineBuffer::LineBuffer (int linesInBuffer)
     : dataPtr (0)
     , dataSize (0)
     , sampleCountTablePtr (0)
-    , sampleCountTableCompressor (0)
     , compressor (0)
     , partiallyFull (false)
     , hasException (false)
@@ -146,8 +145,6 @@ LineBuffer::LineBuffer (int linesInBuffer)
 LineBuffer::~LineBuffer ()
 {
     if (compressor != 0) delete compressor;
-
-    if (sampleCountTableCompressor != 0) delete sampleCountTableCompressor;
 }
 
 } // namespace
@@ -185,6 +182,11 @@ struct DeepScanLineOutputFile::Data
     int sampleCountXStride;     // the x stride for sampleCountSliceBase
     int sampleCountYStride;     // the y stride for sampleCountSliceBase
 
+    char* sampleOffsetSliceBase; // the offset of the first sample of each
+                                 // pixel, or null for per-pixel pointers
+    int sampleOffsetXStride;     // the x stride for sampleOffsetSliceBase
+    int sampleOffsetYStride;     // the y stride for sampleOffsetSliceBase
+
     Array<unsigned int> lineSampleCount; // the number of samples
                                          // in each line
 
@@ -213,6 +215,7 @@ struct DeepScanLineOutputFile::Data
 DeepScanLineOutputFile::Data::Data (int numThreads)
     : lineOffsetsPosition (0)
     , partNumber (-1)
+    , sampleOffsetSliceBase (0)
     , _streamData (NULL)
     , _deleteStream (false)
 {
@@ -624,6 +627,28 @@ LineBufferTask::execute ()
                         slice.type,
                         _ofd->lineSampleCount[y - _ofd->minY]);
                 }
+                else if (_ofd->sampleOffsetSliceBase)
+                {
+                    copyFromDeepFrameBuffer (
+                        writePtr,
+                        slice.base,
+                        _ofd->sampleCountSliceBase,
+                        _ofd->sampleCountXStride,
+                        _ofd->sampleCountYStride,
+                        _ofd->sampleOffsetSliceBase,
+                        _ofd->sampleOffsetXStride,
+                        _ofd->sampleOffsetYStride,
+                        y,
+                        _ofd->minX,
+                        _ofd->maxX,
+                        0,
+                        0, //offsets for samplecount
+                        0,
+                        0, //offsets for sampleoffset
+                        slice.sampleStride,
+                        _ofd->format,
+                        slice.type);
+                }
                 else
                 {
 
@@ -689,7 +714,7 @@ LineBufferTask::execute ()
         _lineBuffer->uncompressedDataSize = _lineBuffer->dataSize;
 
         //
-        // Compress the pixel sample count table.
+        // Build the pixel sample count table.
         //
 
         char*    ptr           = _lineBuffer->sampleCountTableBuffer;
@@ -705,30 +730,8 @@ LineBufferTask::execute ()
             }
         }
 
-        if (_lineBuffer->sampleCountTableCompressor)
-        {
-            _lineBuffer->sampleCountTableSize =
-                _lineBuffer->sampleCountTableCompressor->compress (
-                    _lineBuffer->sampleCountTableBuffer,
-                    static_cast<int> (tableDataSize),
-                    _lineBuffer->minY,
-                    _lineBuffer->sampleCountTablePtr);
-        }
-
-        //
-        // If we can't make data shrink (or we weren't compressing), then just use the raw data.
-        //
-
-        if (!_lineBuffer->sampleCountTableCompressor ||
-            _lineBuffer->sampleCountTableSize >= tableDataSize)
-        {
-            _lineBuffer->sampleCountTableSize = tableDataSize;
-            _lineBuffer->sampleCountTablePtr =
-                _lineBuffer->sampleCountTableBuffer;
-        }
-
         //
-        // Compress the sample data
+        // Compress the sample data, along with the sample count table
         //
 
         // (TODO) don't do this all the time.
@@ -738,16 +741,36 @@ LineBufferTask::execute ()
 
         Compressor* compressor = _lineBuffer->compressor;
 
+        _lineBuffer->sampleCountTableSize = tableDataSize;
+        _lineBuffer->sampleCountTablePtr  = _lineBuffer->sampleCountTableBuffer;
+
         if (compressor)
         {
             const char* compPtr;
 
+            compressor->setSampleCountTable (
+                _lineBuffer->sampleCountTableBuffer,
+                static_cast<int> (tableDataSize));
+
             uint64_t compSize = compressor->compress (
                 _lineBuffer->dataPtr,
                 static_cast<int> (_lineBuffer->dataSize),
                 _lineBuffer->minY,
                 compPtr);
 
+            //
+            // If we can't make the table shrink, then just use the raw data.
+            //
+
+            const char* tablePtr;
+            uint64_t    tableSize = compressor->sampleCountTable (tablePtr);
+
+            if (tableSize < tableDataSize)
+            {
+                _lineBuffer->sampleCountTableSize = tableSize;
+                _lineBuffer->sampleCountTablePtr  = tablePtr;
+            }
+
             if (compSize < _lineBuffer->dataSize)
             {
                 _lineBuffer->dataSize = compSize;
@@ -963,11 +986,6 @@ DeepScanLineOutputFile::initialize (const Header& header)
         _data->lineBuffers[i] = new LineBuffer (_data->linesInBuffer);
         _data->lineBuffers[i]->sampleCountTableBuffer.resizeErase (
             static_cast<long> (_data->maxSampleCountTableSize));
-
-        _data->lineBuffers[i]->sampleCountTableCompressor = newCompressor (
-            _data->header.compression (),
-            _data->maxSampleCountTableSize,
-            _data->header);
     }
 }
 
@@ -1096,6 +1114,11 @@ DeepScanLineOutputFile::setFrameBuffer (const DeepFrameBuffer& frameBuffer)
         _data->sampleCountYStride = static_cast<int> (sampleCountSlice.yStride);
     }
 
+    const Slice& sampleOffsetSlice = frameBuffer.getSampleOffsetSlice ();
+    _data->sampleOffsetSliceBase   = sampleOffsetSlice.base;
+    _data->sampleOffsetXStride = static_cast<int> (sampleOffsetSlice.xStride);
+    _data->sampleOffsetYStride = static_cast<int> (sampleOffsetSlice.yStride);
+
     //
     // Initialize slice table for writePixels().
     // Pixel sample count slice is not presented in the header,
@@ -1533,51 +1556,57 @@ DeepScanLineOutputFile::copyPixels (DeepScanLineInputFile& in)
     // Copy the pixel data.
     //
 
-    vector<char> data (4096);
+    //
+    // The chunks are read in parallel, with up to as many chunks in
+    // memory as there are line buffers.
+    //
 
-    while (_data->missingScanLines > 0)
-    {
-        uint64_t dataSize = (uint64_t) data.size ();
-        in.rawPixelData (_data->currentScanLine, &data[0], dataSize);
-        if (dataSize > data.size ())
-        {
-            // block wasn't big enough - go again with enough memory this time
+    int numChunks = (_data->missingScanLines + _data->linesInBuffer - 1) /
+                    _data->linesInBuffer;
+    int step      = (_data->lineOrder == INCREASING_Y)
+                        ? _data->linesInBuffer
+                        : -_data->linesInBuffer;
+    int firstLine = _data->currentScanLine;
+
+    copyRawChunks (
+        numChunks,
+        static_cast<int> (_data->lineBuffers.size ()),
+        [&] (int i, vector<char>& data) {
+            uint64_t dataSize = 0;
+            in.rawPixelData (firstLine + i * step, nullptr, dataSize);
             data.resize (dataSize);
-            in.rawPixelData (_data->currentScanLine, &data[0], dataSize);
-        }
-
-        // extract header from block to pass to writePixelData
-
-        bytesOruint64_t tmp;
-        memcpy (&tmp.b, &data[4], 8);
-        uint64_t packedSampleCountSize = tmp.i;
-
-        memcpy (&tmp.b, &data[12], 8);
-        uint64_t packedDataSize = tmp.i;
-
-        memcpy (&tmp.b, &data[20], 8);
-        uint64_t unpackedDataSize = tmp.i;
-
-        const char* sampleCountTable = &data[0] + 28;
-        const char* pixelData        = sampleCountTable + packedSampleCountSize;
-
-        writePixelData (
-            _data->_streamData,
-            _data,
-            lineBufferMinY (
-                _data->currentScanLine, _data->minY, _data->linesInBuffer),
-            pixelData,
-            packedDataSize,
-            unpackedDataSize,
-            sampleCountTable,
-            packedSampleCountSize);
-
-        _data->currentScanLine += (_data->lineOrder == INCREASING_Y)
-                                      ? _data->linesInBuffer
-                                      : -_data->linesInBuffer;
-
-        _data->missingScanLines -= _data->linesInBuffer;
-    }
+            in.rawPixelData (firstLine + i * step, data.data (), dataSize);
+        },
+        [&] (int, const vector<char>& data) {
+            // extract header from block to pass to writePixelData
+
+            bytesOruint64_t tmp;
+            memcpy (&tmp.b, &data[4], 8);
+            uint64_t packedSampleCountSize = tmp.i;
+
+            memcpy (&tmp.b, &data[12], 8);
+            uint64_t packedDataSize = tmp.i;
+
+            memcpy (&tmp.b, &data[20], 8);
+            uint64_t unpackedDataSize = tmp.i;
+
+            const char* sampleCountTable = &data[0] + 28;
+            const char* pixelData = sampleCountTable + packedSampleCountSize;
+
+            writePixelData (
+                _data->_streamData,
+                _data,
+                lineBufferMinY (
+                    _data->currentScanLine, _data->minY, _data->linesInBuffer),
+                pixelData,
+                packedDataSize,
+                unpackedDataSize,
+                sampleCountTable,
+                packedSampleCountSize);
+
+            _data->currentScanLine += step;
+            _data->missingScanLines -= _data->linesInBuffer;
+        });
 }
 
 void
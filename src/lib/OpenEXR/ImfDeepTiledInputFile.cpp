@@ -21,12 +21,14 @@
 
 #include "ImfDeepFrameBuffer.h"
 #include "ImfInputPartData.h"
+#include "ImfMisc.h"
 
 // TODO: remove once TiledOutput is converted
 #include "ImfTileOffsets.h"
 #include "ImfTiledMisc.h"
 
 #include <algorithm>
+#include <exception>
 #include <string>
 #include <vector>
 
@@ -65,12 +67,38 @@ struct TileProcess
         int fb_absX, int fb_absY,
         int t_absX, int t_absY);
 
+    void place_samples (
+        const DeepFrameBuffer *outfb,
+        int t_absX, int t_absY);
+
+    void run_allocate ();
+
     exr_result_t          last_decode_err = EXR_ERR_UNKNOWN;
     bool                  first = true;
     bool                  counts_only = false;
     exr_chunk_info_t      cinfo;
     exr_decode_pipeline_t decoder;
 
+    // set by readSampleCountsAndTiles: called once the sample counts
+    // of the tile are known, before the samples are unpacked
+    const DeepTiledInputFile::SampleAllocator* allocate = nullptr;
+#if ILMTHREAD_THREADING_ENABLED
+    std::mutex*           allocate_mutex = nullptr;
+#endif
+
+    // the frame buffer has a sample offset slice: the samples are
+    // placed once the sample counts of the tile are known
+    bool                  use_offsets = false;
+    const DeepFrameBuffer* place_fb = nullptr;
+    int                   place_fb_x = 0;
+    int                   place_fb_y = 0;
+    int                   place_x = 0;
+    int                   place_y = 0;
+    std::exception_ptr    place_error;
+    // per-pixel sample pointers, built from the sample offsets when
+    // the samples of a tile are not contiguous in the frame buffer
+    std::vector<void*>    sample_pointers;
+
     TileProcess*          next;
 };
 
@@ -116,7 +144,15 @@ struct DeepTiledInputFile::Data
     }
 
     // TODO: generalize to have async framebuffer path
-    void readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly, bool countsOnly);
+    void readTiles (
+        int dx1,
+        int dx2,
+        int dy1,
+        int dy2,
+        int lx,
+        int ly,
+        bool countsOnly,
+        const SampleAllocator* allocate = nullptr);
 
     Context* _ctxt;
     int partNumber;
@@ -138,6 +174,7 @@ struct DeepTiledInputFile::Data
 
 #if ILMTHREAD_THREADING_ENABLED
     std::mutex _mx;
+    std::mutex _allocateMx;
 
     class TileBufferTask final : public ILMTHREAD_NAMESPACE::Task
     {
@@ -148,7 +185,8 @@ struct DeepTiledInputFile::Data
             TileProcessGroup*       tileg,
             const DeepFrameBuffer*  outfb,
             const exr_chunk_info_t& cinfo,
-            bool                    countsOnly)
+            bool                    countsOnly,
+            const SampleAllocator*  allocate)
             : Task (group)
             , _outfb (outfb)
             , _ifd (ifd)
@@ -157,6 +195,8 @@ struct DeepTiledInputFile::Data
         {
             _tile->cinfo = cinfo;
             _tile->counts_only = countsOnly;
+            _tile->allocate = allocate;
+            _tile->allocate_mutex = &ifd->_allocateMx;
         }
 
         ~TileBufferTask () override
@@ -719,6 +759,67 @@ DeepTiledInputFile::readPixelSampleCounts (
     readPixelSampleCounts (dx1, dx2, dy1, dy2, l, l);
 }
 
+void
+DeepTiledInputFile::readSampleCountsAndTiles (
+    int                    dx1,
+    int                    dx2,
+    int                    dy1,
+    int                    dy2,
+    int                    lx,
+    int                    ly,
+    const SampleAllocator& allocateSamples)
+{
+    try
+    {
+        if (!_data->frameBufferValid)
+        {
+            throw IEX_NAMESPACE::ArgExc (
+                "readSampleCountsAndTiles called with no valid frame buffer");
+        }
+
+        if (!allocateSamples)
+        {
+            throw IEX_NAMESPACE::ArgExc (
+                "readSampleCountsAndTiles called with no sample allocator");
+        }
+
+        if (!isValidLevel (lx, ly))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Level coordinate "
+                "(" << lx
+                    << ", " << ly
+                    << ") "
+                       "is invalid.");
+
+        if (dx1 > dx2) std::swap (dx1, dx2);
+        if (dy1 > dy2) std::swap (dy1, dy2);
+
+        _data->readTiles (dx1, dx2, dy1, dy2, lx, ly, false, &allocateSamples);
+    }
+    catch (IEX_NAMESPACE::BaseExc& e)
+    {
+        REPLACE_EXC (
+            e,
+            "Error reading deep tiled data from image "
+            "file \""
+                << fileName () << "\". " << e.what ());
+        throw;
+    }
+}
+
+void
+DeepTiledInputFile::readSampleCountsAndTiles (
+    int                    dx1,
+    int                    dx2,
+    int                    dy1,
+    int                    dy2,
+    int                    l,
+    const SampleAllocator& allocateSamples)
+{
+    readSampleCountsAndTiles (dx1, dx2, dy1, dy2, l, l, allocateSamples);
+}
+
 size_t
 DeepTiledInputFile::totalTiles () const
 {
@@ -900,7 +1001,14 @@ DeepTiledInputFile::getTileOrder (int dx[], int dy[], int lx[], int ly[]) const
 }
 
 void DeepTiledInputFile::Data::readTiles (
-    int dx1, int dx2, int dy1, int dy2, int lx, int ly, bool countsOnly)
+    int dx1,
+    int dx2,
+    int dy1,
+    int dy2,
+    int lx,
+    int ly,
+    bool countsOnly,
+    const SampleAllocator* allocate)
 {
     int nTiles = dx2 - dx1 + 1;
     nTiles *= dy2 - dy1 + 1;
@@ -935,7 +1043,8 @@ void DeepTiledInputFile::Data::readTiles (
                         throw IEX_NAMESPACE::InputExc ("Unable to query tile information");
 
                     ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
-                        new TileBufferTask (&tg, this, &tpg, &frameBuffer, cinfo, countsOnly) );
+                        new TileBufferTask (
+                            &tg, this, &tpg, &frameBuffer, cinfo, countsOnly, allocate) );
                 }
             }
         }
@@ -948,6 +1057,7 @@ void DeepTiledInputFile::Data::readTiles (
         TileProcess tp;
 
         tp.counts_only = countsOnly;
+        tp.allocate = allocate;
         for (int ty = dy1; ty <= dy2; ++ty)
         {
             for (int tx = dx1; tx <= dx2; ++tx)
@@ -1001,6 +1111,35 @@ void DeepTiledInputFile::Data::TileBufferTask::execute ()
 
 ////////////////////////////////////////
 
+static exr_result_t
+prepare_deep_samples (exr_decode_pipeline_t* decode)
+{
+    TileProcess* tp = static_cast<TileProcess*> (decode->decoding_user_data);
+
+    try
+    {
+        if (tp->allocate)
+        {
+            tp->copy_sample_count (
+                tp->place_fb,
+                tp->place_fb_x,
+                tp->place_fb_y,
+                tp->place_x,
+                tp->place_y);
+            tp->run_allocate ();
+        }
+
+        if (tp->use_offsets)
+            tp->place_samples (tp->place_fb, tp->place_x, tp->place_y);
+    }
+    catch (...)
+    {
+        tp->place_error = std::current_exception ();
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
 void TileProcess::run_decode (
     exr_const_context_t ctxt,
     int pn,
@@ -1060,7 +1199,29 @@ void TileProcess::run_decode (
         }
     }
 
+    bool allocating = allocate && !counts_only;
+
+    if (allocating || use_offsets)
+    {
+        // the sample counts are stored and the samples allocated
+        // and placed between unpacking the sample count table and
+        // the samples, so the tile is only read and decompressed once
+        place_fb    = outfb;
+        place_fb_x  = dw.min.x;
+        place_fb_y  = dw.min.y;
+        place_x     = absX;
+        place_y     = absY;
+        place_error = nullptr;
+
+        decoder.decoding_user_data       = this;
+        decoder.realloc_nonimage_data_fn = &prepare_deep_samples;
+    }
+    else
+        decoder.realloc_nonimage_data_fn = nullptr;
+
     last_decode_err = exr_decoding_run (ctxt, pn, &decoder);
+    if (place_error)
+        std::rethrow_exception (place_error);
     if (EXR_ERR_SUCCESS != last_decode_err)
     {
         THROW (
@@ -1069,7 +1230,8 @@ void TileProcess::run_decode (
             << exr_get_error_code_as_string (last_decode_err));
     }
 
-    copy_sample_count (outfb, dw.min.x, dw.min.y, absX, absY);
+    if (!allocating)
+        copy_sample_count (outfb, dw.min.x, dw.min.y, absX, absY);
 
     if (counts_only)
         return;
@@ -1084,6 +1246,11 @@ void TileProcess::update_pointers (const DeepFrameBuffer *outfb, int fb_absX, in
     decoder.user_line_begin_skip = 0;
     decoder.user_line_end_ignore = 0;
 
+    use_offsets =
+        !counts_only && outfb->getSampleOffsetSlice ().base != nullptr;
+    if (!use_offsets)
+        decoder.decode_flags |= EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+
     for (int c = 0; c < decoder.channel_count; ++c)
     {
         exr_coding_channel_info_t& curchan = decoder.channels[c];
@@ -1108,6 +1275,16 @@ void TileProcess::update_pointers (const DeepFrameBuffer *outfb, int fb_absX, in
 
         curchan.user_bytes_per_element = fbslice->sampleStride;
         curchan.user_data_type         = (exr_pixel_type_t)fbslice->type;
+
+        if (use_offsets)
+        {
+            // placed by place_samples once the counts are known
+            curchan.user_pixel_stride = 0;
+            curchan.user_line_stride  = 0;
+            curchan.decode_to_ptr = reinterpret_cast<uint8_t*> (fbslice->base);
+            continue;
+        }
+
         curchan.user_pixel_stride      = fbslice->xStride;
         curchan.user_line_stride       = fbslice->yStride;
 
@@ -1125,6 +1302,10 @@ void TileProcess::run_fill (
     const DeepFrameBuffer *outfb, int fb_absX, int fb_absY, int t_absX, int t_absY,
     const std::vector<DeepSlice> &filllist)
 {
+    const Slice& offsets = outfb->getSampleOffsetSlice ();
+    int          offX    = offsets.xTileCoords ? 0 : t_absX;
+    int          offY    = offsets.yTileCoords ? 0 : t_absY;
+
     for (auto& fills: filllist)
     {
         uint8_t* ptr;
@@ -1149,7 +1330,21 @@ void TileProcess::run_fill (
             for ( int sx = 0; sx < cinfo.width; ++sx )
             {
                 int32_t samps = counts[sx];
-                void *dest = *((void **)outptr);
+                void *dest;
+
+                if (offsets.base)
+                {
+                    dest = fills.base +
+                           int64_t (sampleCount (
+                               offsets.base,
+                               offsets.xStride,
+                               offsets.yStride,
+                               offX + sx,
+                               offY + start)) *
+                               int64_t (fills.sampleStride);
+                }
+                else
+                    dest = *((void **)outptr);
 
                 if (samps == 0 || dest == nullptr)
                 {
@@ -1250,4 +1445,135 @@ void TileProcess::copy_sample_count (
     }
 }
 
+////////////////////////////////////////
+
+void TileProcess::place_samples (
+    const DeepFrameBuffer *outfb,
+    int t_absX, int t_absY)
+{
+    const Slice&   offsets = outfb->getSampleOffsetSlice ();
+    int            offX    = offsets.xTileCoords ? 0 : t_absX;
+    int            offY    = offsets.yTileCoords ? 0 : t_absY;
+    int            w       = cinfo.width;
+    int            h       = cinfo.height;
+    const int32_t* counts  = decoder.sample_count_table;
+
+    //
+    // If the offsets of the tile follow its sample counts, the
+    // samples of each channel are unpacked as one run; otherwise
+    // through a table of per-pixel pointers.
+    //
+
+    int64_t first = -1;
+    int64_t next  = 0;
+    bool    contiguous = true;
+
+    for (int y = 0; y < h && contiguous; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int64_t off = (unsigned int) sampleCount (
+                offsets.base,
+                offsets.xStride,
+                offsets.yStride,
+                offX + x,
+                offY + y);
+
+            if (first < 0)
+                first = next = off;
+
+            if (off != next)
+            {
+                contiguous = false;
+                break;
+            }
+
+            next += counts[int64_t (y) * w + x];
+        }
+    }
+
+    uint16_t flags = decoder.decode_flags;
+    size_t   npix  = size_t (w) * size_t (h);
+    int      nused = 0;
+
+    if (contiguous)
+        flags &= ~EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+    else
+    {
+        flags |= EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS;
+        sample_pointers.resize (npix * size_t (decoder.channel_count));
+    }
+
+    for (int c = 0; c < decoder.channel_count; ++c)
+    {
+        exr_coding_channel_info_t& curchan = decoder.channels[c];
+
+        if (!curchan.decode_to_ptr)
+            continue;
+
+        const DeepSlice& fbslice = (*outfb)[curchan.channel_name];
+        int64_t          ss      = fbslice.sampleStride;
+
+        if (contiguous)
+        {
+            curchan.decode_to_ptr =
+                reinterpret_cast<uint8_t*> (fbslice.base) +
+                std::max (first, int64_t (0)) * ss;
+            continue;
+        }
+
+        void** table = &sample_pointers[npix * size_t (nused++)];
+
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                void*& p = table[size_t (y) * w + x];
+
+                if (counts[int64_t (y) * w + x] == 0)
+                {
+                    p = nullptr;
+                    continue;
+                }
+
+                int64_t off = (unsigned int) sampleCount (
+                    offsets.base,
+                    offsets.xStride,
+                    offsets.yStride,
+                    offX + x,
+                    offY + y);
+
+                p = fbslice.base + off * ss;
+            }
+        }
+
+        curchan.decode_to_ptr     = reinterpret_cast<uint8_t*> (table);
+        curchan.user_pixel_stride = sizeof (void*);
+        curchan.user_line_stride  = int32_t (w * sizeof (void*));
+    }
+
+    if (flags != decoder.decode_flags)
+    {
+        decoder.decode_flags = flags;
+        if (EXR_ERR_SUCCESS != exr_decoding_choose_default_routines (
+                decoder.context, decoder.part_index, &decoder))
+        {
+            throw IEX_NAMESPACE::IoExc ("Unable to choose decoder routines");
+        }
+    }
+}
+
+////////////////////////////////////////
+
+void TileProcess::run_allocate ()
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::unique_lock<std::mutex> lock;
+    if (allocate_mutex)
+        lock = std::unique_lock<std::mutex> (*allocate_mutex);
+#endif
+
+    (*allocate) (cinfo.start_x, cinfo.start_y, cinfo.level_x, cinfo.level_y);
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
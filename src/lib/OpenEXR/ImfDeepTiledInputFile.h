@@ -24,6 +24,8 @@
 
 #include <Imath/ImathBox.h>
 
+#include <functional>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
 class IMF_EXPORT_TYPE DeepTiledInputFile
@@ -379,6 +381,58 @@ public:
     IMF_EXPORT
     void readPixelSampleCounts (int dx1, int dx2, int dy1, int dy2, int l = 0);
 
+    //-----------------------------------------------------------
+    // Read pixel sample counts and pixel data in a single pass.
+    //
+    // readSampleCountsAndTiles(dx1, dx2, dy1, dy2, lx, ly,
+    // allocateSamples) reads the same tiles as readTiles(dx1, dx2,
+    // dy1, dy2, lx, ly), but reads and uncompresses each tile of the
+    // file only once, instead of once for readPixelSampleCounts()
+    // and again for readTiles().
+    //
+    // As each tile is read, its sample counts are stored in the
+    // "sample count" slice of the current frame buffer, and then
+    // allocateSamples(dx, dy, lx, ly) is called for the tile: it
+    // must store, in the pointer slices of the frame buffer, the
+    // addresses of enough memory for the samples of the tile, before
+    // the samples are unpacked there. If the frame buffer has a
+    // sample offset slice, allocateSamples(dx, dy, lx, ly) stores
+    // the sample offsets of the tile instead.
+    //
+    // If threading is enabled, tiles are read in parallel, so the
+    // sample counts of later tiles are read and uncompressed while
+    // the samples of earlier tiles are still being uncompressed.
+    // The calls to allocateSamples() may then come from different
+    // threads and in any order, but never at the same time.
+    // allocateSamples() must not change the frame buffer itself.
+    //
+    // readSampleCountsAndTiles(dx1, dx2, dy1, dy2, l,
+    // allocateSamples) calls readSampleCountsAndTiles(dx1, dx2,
+    // dy1, dy2, lx = l, ly = l, allocateSamples).
+    //-----------------------------------------------------------
+
+    using SampleAllocator =
+        std::function<void (int dx, int dy, int lx, int ly)>;
+
+    IMF_EXPORT
+    void readSampleCountsAndTiles (
+        int                    dx1,
+        int                    dx2,
+        int                    dy1,
+        int                    dy2,
+        int                    lx,
+        int                    ly,
+        const SampleAllocator& allocateSamples);
+
+    IMF_EXPORT
+    void readSampleCountsAndTiles (
+        int                    dx1,
+        int                    dx2,
+        int                    dy1,
+        int                    dy2,
+        int                    l,
+        const SampleAllocator& allocateSamples);
+
 private:
     Context _ctxt;
     struct IMF_HIDDEN Data;
@@ -207,4 +207,30 @@ DeepTiledInputPart::readPixelSampleCounts (
     file->readPixelSampleCounts (dx1, dx2, dy1, dy2, l);
 }
 
+void
+DeepTiledInputPart::readSampleCountsAndTiles (
+    int                                        dx1,
+    int                                        dx2,
+    int                                        dy1,
+    int                                        dy2,
+    int                                        lx,
+    int                                        ly,
+    const DeepTiledInputFile::SampleAllocator& allocateSamples)
+{
+    file->readSampleCountsAndTiles (
+        dx1, dx2, dy1, dy2, lx, ly, allocateSamples);
+}
+
+void
+DeepTiledInputPart::readSampleCountsAndTiles (
+    int                                        dx1,
+    int                                        dx2,
+    int                                        dy1,
+    int                                        dy2,
+    int                                        l,
+    const DeepTiledInputFile::SampleAllocator& allocateSamples)
+{
+    file->readSampleCountsAndTiles (dx1, dx2, dy1, dy2, l, allocateSamples);
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -11,6 +11,7 @@
 #include "ImfTileDescription.h"
 
 #include <cstdint>
+#include <functional>
 #include <Imath/ImathBox.h>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
@@ -334,6 +335,32 @@ public:
     IMF_EXPORT
     void readPixelSampleCounts (int dx1, int dx2, int dy1, int dy2, int l = 0);
 
+    //-----------------------------------------------------------
+    // Read pixel sample counts and pixel data in a single pass;
+    // see DeepTiledInputFile::readSampleCountsAndTiles().
+    //-----------------------------------------------------------
+
+    IMF_EXPORT
+    void readSampleCountsAndTiles (
+        int dx1,
+        int dx2,
+        int dy1,
+        int dy2,
+        int lx,
+        int ly,
+        const std::function<void (int dx, int dy, int lx, int ly)>&
+            allocateSamples);
+
+    IMF_EXPORT
+    void readSampleCountsAndTiles (
+        int dx1,
+        int dx2,
+        int dy1,
+        int dy2,
+        int l,
+        const std::function<void (int dx, int dy, int lx, int ly)>&
+            allocateSamples);
+
 private:
     DeepTiledInputFile* file;
 
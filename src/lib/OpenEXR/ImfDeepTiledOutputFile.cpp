@@ -23,6 +23,7 @@
 #include "ImfOutputStreamMutex.h"
 #include "ImfPartType.h"
 #include "ImfPreviewImageAttribute.h"
+#include "ImfRawChunkCopy.h"
 #include "ImfStdIO.h"
 #include "ImfThreading.h"
 #include "ImfTileDescriptionAttribute.h"
@@ -184,7 +185,6 @@ struct TileBuffer
     Array<char> sampleCountTableBuffer;
     const char* sampleCountTablePtr;
     uint64_t    sampleCountTableSize;
-    Compressor* sampleCountTableCompressor;
     TileCoord   tileCoord;
     bool        hasException;
     string      exception;
@@ -204,7 +204,6 @@ TileBuffer::TileBuffer ()
     , dataSize (0)
     , compressor (0)
     , sampleCountTablePtr (0)
-    , sampleCountTableCompressor (0)
     , hasException (false)
     , exception ()
     , _sem (1)
@@ -215,8 +214,6 @@ TileBuffer::TileBuffer ()
 TileBuffer::~TileBuffer ()
 {
     if (compressor != 0) delete compressor;
-
-    if (sampleCountTableCompressor != 0) delete sampleCountTableCompressor;
 }
 
 } // namespace
@@ -262,6 +259,13 @@ struct DeepTiledOutputFile::Data
     int sampleCountXTileCoords; // using x coordinates relative to current tile
     int sampleCountYTileCoords; // using y coordinates relative to current tile
 
+    char* sampleOffsetSliceBase; // the offset of the first sample of each
+                                 // pixel, or null for per-pixel pointers
+    int sampleOffsetXStride;     // the x stride for sampleOffsetSliceBase
+    int sampleOffsetYStride;     // the y stride for sampleOffsetSliceBase
+    int sampleOffsetXTileCoords; // using x coordinates relative to current tile
+    int sampleOffsetYTileCoords; // using y coordinates relative to current tile
+
     uint64_t maxSampleCountTableSize; // the max size in bytes for a pixel
                                       // sample count table
     OutputStreamMutex* _streamData;
@@ -292,6 +296,7 @@ DeepTiledOutputFile::Data::Data (int numThreads)
     , numYTiles (0)
     , tileOffsetsPosition (0)
     , partNumber (-1)
+    , sampleOffsetSliceBase (0)
     , _streamData (NULL)
     , _deleteStream (true)
 {
@@ -911,6 +916,30 @@ TileBufferTask::execute ()
                     int yOffsetForData = slice.yTileCoords ? tileRange.min.y
                                                            : 0;
 
+                    if (_ofd->sampleOffsetSliceBase)
+                    {
+                        copyFromDeepFrameBuffer (
+                            writePtr,
+                            slice.base,
+                            _ofd->sampleCountSliceBase,
+                            _ofd->sampleCountXStride,
+                            _ofd->sampleCountYStride,
+                            _ofd->sampleOffsetSliceBase,
+                            _ofd->sampleOffsetXStride,
+                            _ofd->sampleOffsetYStride,
+                            y,
+                            tileRange.min.x,
+                            tileRange.max.x,
+                            xOffsetForSampleCount,
+                            yOffsetForSampleCount,
+                            _ofd->sampleOffsetXTileCoords ? tileRange.min.x : 0,
+                            _ofd->sampleOffsetYTileCoords ? tileRange.min.y : 0,
+                            slice.sampleStride,
+                            _ofd->format,
+                            slice.type);
+                        continue;
+                    }
+
                     // (TODO) treat sample count offsets differently.
                     copyFromDeepFrameBuffer (
                         writePtr,
@@ -938,7 +967,7 @@ TileBufferTask::execute ()
         }
 
         //
-        // Compress the pixel sample count table.
+        // Build the pixel sample count table.
         //
 
         char*    ptr           = _tileBuffer->sampleCountTableBuffer;
@@ -955,31 +984,10 @@ TileBufferTask::execute ()
             }
         }
 
-        if (_tileBuffer->sampleCountTableCompressor)
-        {
-            _tileBuffer->sampleCountTableSize =
-                _tileBuffer->sampleCountTableCompressor->compress (
-                    _tileBuffer->sampleCountTableBuffer,
-                    static_cast<int> (tableDataSize),
-                    tileRange.min.y,
-                    _tileBuffer->sampleCountTablePtr);
-        }
-
-        //
-        // If we can't make data shrink (or compression was disabled), then just use the raw data.
-        //
-
-        if (!_tileBuffer->sampleCountTableCompressor ||
-            _tileBuffer->sampleCountTableSize >= _ofd->maxSampleCountTableSize)
-        {
-            _tileBuffer->sampleCountTableSize = _ofd->maxSampleCountTableSize;
-            _tileBuffer->sampleCountTablePtr =
-                _tileBuffer->sampleCountTableBuffer;
-        }
-
         //
-        // Compress the contents of the tileBuffer,
-        // and store the compressed data in the output file.
+        // Compress the contents of the tileBuffer, along with the
+        // sample count table, and store the compressed data in the
+        // output file.
         //
 
         _tileBuffer->dataSize         = writePtr - _tileBuffer->buffer;
@@ -994,6 +1002,9 @@ TileBufferTask::execute ()
             _ofd->tileDesc.ySize,
             _ofd->header);
 
+        _tileBuffer->sampleCountTableSize = _ofd->maxSampleCountTableSize;
+        _tileBuffer->sampleCountTablePtr  = _tileBuffer->sampleCountTableBuffer;
+
         if (_tileBuffer->compressor)
         {
             const char* compPtr;
@@ -1001,12 +1012,29 @@ TileBufferTask::execute ()
             _tileBuffer->compressor->setTileLevel (
                 _tileBuffer->tileCoord.lx,
                 _tileBuffer->tileCoord.ly);
+            _tileBuffer->compressor->setSampleCountTable (
+                _tileBuffer->sampleCountTableBuffer,
+                static_cast<int> (tableDataSize));
             uint64_t compSize = _tileBuffer->compressor->compressTile (
                 _tileBuffer->dataPtr,
                 static_cast<int> (_tileBuffer->dataSize),
                 tileRange,
                 compPtr);
 
+            //
+            // If we can't make the table shrink, then just use the raw data.
+            //
+
+            const char* tablePtr;
+            uint64_t    tableSize =
+                _tileBuffer->compressor->sampleCountTable (tablePtr);
+
+            if (tableSize < _ofd->maxSampleCountTableSize)
+            {
+                _tileBuffer->sampleCountTableSize = tableSize;
+                _tileBuffer->sampleCountTablePtr  = tablePtr;
+            }
+
             if (compSize < _tileBuffer->dataSize)
             {
                 _tileBuffer->dataSize = compSize;
@@ -1266,11 +1294,6 @@ DeepTiledOutputFile::initialize (const Header& header)
 
         char* p = &(_data->tileBuffers[i]->sampleCountTableBuffer[0]);
         memset (p, 0, _data->maxSampleCountTableSize);
-
-        _data->tileBuffers[i]->sampleCountTableCompressor = newCompressor (
-            _data->header.compression (),
-            _data->maxSampleCountTableSize,
-            _data->header);
     }
 }
 
@@ -1393,6 +1416,13 @@ DeepTiledOutputFile::setFrameBuffer (const DeepFrameBuffer& frameBuffer)
         _data->sampleCountYTileCoords = sampleCountSlice.yTileCoords;
     }
 
+    const Slice& sampleOffsetSlice = frameBuffer.getSampleOffsetSlice ();
+    _data->sampleOffsetSliceBase   = sampleOffsetSlice.base;
+    _data->sampleOffsetXStride = static_cast<int> (sampleOffsetSlice.xStride);
+    _data->sampleOffsetYStride = static_cast<int> (sampleOffsetSlice.yStride);
+    _data->sampleOffsetXTileCoords = sampleOffsetSlice.xTileCoords;
+    _data->sampleOffsetYTileCoords = sampleOffsetSlice.yTileCoords;
+
     //
     // Initialize slice table for writePixels().
     // Pixel sample count slice is not presented in the header,
@@ -1804,40 +1834,17 @@ DeepTiledOutputFile::copyPixels (DeepTiledInputFile& in)
         _data->nextTileToWrite.ly = ly_list[0];
     }
 
-    vector<char> data (4096);
-    for (size_t i = 0; i < numAllTiles; ++i)
-    {
-
-        int dx = _data->nextTileToWrite.dx;
-        int dy = _data->nextTileToWrite.dy;
-        int lx = _data->nextTileToWrite.lx;
-        int ly = _data->nextTileToWrite.ly;
-
-        uint64_t dataSize = data.size ();
+    //
+    // List the tiles in the order they are written, then copy them,
+    // reading them in parallel, with up to as many tiles in memory as
+    // there are tile buffers.
+    //
 
-        in.rawTileData (dx, dy, lx, ly, &data[0], dataSize);
-        if (dataSize > data.size ())
-        {
-            data.resize (dataSize);
-            in.rawTileData (dx, dy, lx, ly, &data[0], dataSize);
-        }
-        uint64_t sampleCountTableSize  = *(uint64_t*) (&data[0] + 16);
-        uint64_t pixelDataSize         = *(uint64_t*) (&data[0] + 24);
-        uint64_t unpackedPixelDataSize = *(uint64_t*) (&data[0] + 32);
-        char*    sampleCountTable      = &data[0] + 40;
-        char*    pixelData = sampleCountTable + sampleCountTableSize;
+    vector<TileCoord> tiles (numAllTiles);
 
-        writeTileData (
-            _data,
-            dx,
-            dy,
-            lx,
-            ly,
-            pixelData,
-            pixelDataSize,
-            unpackedPixelDataSize,
-            sampleCountTable,
-            sampleCountTableSize);
+    for (size_t i = 0; i < numAllTiles; ++i)
+    {
+        tiles[i] = _data->nextTileToWrite;
 
         if (_data->lineOrder == RANDOM_Y)
         {
@@ -1855,6 +1862,39 @@ DeepTiledOutputFile::copyPixels (DeepTiledInputFile& in)
                 _data->nextTileCoord (_data->nextTileToWrite);
         }
     }
+
+    copyRawChunks (
+        static_cast<int> (numAllTiles),
+        static_cast<int> (_data->tileBuffers.size ()),
+        [&] (int i, vector<char>& data) {
+            TileCoord t        = tiles[i];
+            uint64_t  dataSize = 0;
+
+            in.rawTileData (t.dx, t.dy, t.lx, t.ly, nullptr, dataSize);
+            data.resize (dataSize);
+            in.rawTileData (t.dx, t.dy, t.lx, t.ly, data.data (), dataSize);
+        },
+        [&] (int i, const vector<char>& data) {
+            const TileCoord& t = tiles[i];
+
+            uint64_t sampleCountTableSize  = *(uint64_t*) (&data[0] + 16);
+            uint64_t pixelDataSize         = *(uint64_t*) (&data[0] + 24);
+            uint64_t unpackedPixelDataSize = *(uint64_t*) (&data[0] + 32);
+            const char* sampleCountTable   = &data[0] + 40;
+            const char* pixelData = sampleCountTable + sampleCountTableSize;
+
+            writeTileData (
+                _data,
+                t.dx,
+                t.dy,
+                t.lx,
+                t.ly,
+                pixelData,
+                pixelDataSize,
+                unpackedPixelDataSize,
+                sampleCountTable,
+                sampleCountTableSize);
+        });
 }
 
 void
@@ -79,6 +79,7 @@ struct IMF_EXPORT_TYPE DeepSlice;
 // compositing
 class IMF_EXPORT_TYPE DeepCompositing;
 class IMF_EXPORT_TYPE CompositeDeepScanLine;
+class IMF_EXPORT_TYPE CompositeDeepTiled;
 
 // preview image
 class IMF_EXPORT_TYPE  PreviewImage;
@@ -90,6 +91,7 @@ class IMF_EXPORT_TYPE IStream;
 
 class IMF_EXPORT_TYPE IDManifest;
 class IMF_EXPORT_TYPE CompressedIDManifest;
+class IMF_EXPORT_TYPE IDManifestIndex;
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
 
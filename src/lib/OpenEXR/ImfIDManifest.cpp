@@ -583,7 +583,14 @@ IDManifest::init (const char* data, const char* endOfData)
     }
 }
 
-IDManifest::IDManifest (const CompressedIDManifest& compressed)
+namespace
+{
+
+//
+// decompress the serialized manifest stored in a CompressedIDManifest
+//
+void
+uncompressManifest (const CompressedIDManifest& compressed, vector<char>& uncomp)
 {
     //
     // Reject an implausible declared uncompressed size before allocating
@@ -617,9 +624,9 @@ IDManifest::IDManifest (const CompressedIDManifest& compressed)
     // decompress the compressed manifest
     //
 
-    vector<char> uncomp (compressed._uncompressedDataSize);
-    size_t       outSize;
-    size_t       inSize = static_cast<size_t> (compressed._compressedDataSize);
+    uncomp.resize (compressed._uncompressedDataSize);
+    size_t outSize;
+    size_t inSize = static_cast<size_t> (compressed._compressedDataSize);
     if (EXR_ERR_SUCCESS != exr_uncompress_buffer (
                                nullptr,
                                compressed._data,
@@ -636,8 +643,15 @@ IDManifest::IDManifest (const CompressedIDManifest& compressed)
         throw IEX_NAMESPACE::InputExc (
             "IDManifest decompression (zlib) failed: mismatch in decompressed data size");
     }
+}
+
+} // namespace
 
-    init (uncomp.data (), uncomp.data () + outSize);
+IDManifest::IDManifest (const CompressedIDManifest& compressed)
+{
+    vector<char> uncomp;
+    uncompressManifest (compressed, uncomp);
+    init (uncomp.data (), uncomp.data () + uncomp.size ());
 }
 
 void
@@ -1172,6 +1186,440 @@ CompressedIDManifest::CompressedIDManifest (const IDManifest& manifest)
     _compressedDataSize   = compressedDataSize;
 }
 
+IDManifestIndex::IDManifestIndex (const CompressedIDManifest& compressed)
+    : _data (nullptr), _end (nullptr)
+{
+    uncompressManifest (compressed, _storage);
+    init (_storage.data (), _storage.data () + _storage.size ());
+}
+
+IDManifestIndex::IDManifestIndex (const char* data, const char* end)
+    : _data (nullptr), _end (nullptr)
+{
+    init (data, end);
+}
+
+IDManifestIndex::~IDManifestIndex ()
+{}
+
+void
+IDManifestIndex::init (const char* data, const char* endOfData)
+{
+    //
+    // a single pass over the serialized manifest, in the layout read by
+    // IDManifest::init, which validates it and records where things are
+    // rather than building strings and maps
+    //
+    _data = data;
+    _end  = endOfData;
+
+    if (data + sizeof (unsigned int) > endOfData)
+    {
+        throw IEX_NAMESPACE::InputExc (
+            "IDManifest too small for version field");
+    }
+
+    unsigned int version;
+    Xdr::read<CharPtrIO> (data, version);
+    if (version != 0)
+    {
+        throw IEX_NAMESPACE::InputExc ("Unrecognized IDmanifest version");
+    }
+
+    //
+    // string table: the lengths of all strings, then the strings, each but
+    // the first prefixed with the number of characters in common with the
+    // previous string. Only the position of each string is kept, plus
+    // every 64th string in full so expandString() never has to go back
+    // further than that
+    //
+    if (data + 4 > endOfData)
+    {
+        throw IEX_NAMESPACE::InputExc (
+            "IDManifest too small for string list size");
+    }
+    int numberOfStrings;
+    Xdr::read<CharPtrIO> (data, numberOfStrings);
+
+    if (numberOfStrings < 0)
+    {
+        throw IEX_NAMESPACE::InputExc ("Negative count for number of strings");
+    }
+
+    if (data + numberOfStrings > endOfData)
+    {
+        throw IEX_NAMESPACE::InputExc (
+            "IDManifest too small for string length table");
+    }
+
+    const char* lengthPtr      = data;
+    uint64_t    totalTableSize = 0;
+    for (int i = 0; i < numberOfStrings; ++i)
+    {
+        totalTableSize += readVariableLengthInteger (data, endOfData);
+    }
+
+    if (totalTableSize > uint64_t (endOfData - data))
+    {
+        throw IEX_NAMESPACE::InputExc ("IDManifest too small for string table");
+    }
+
+    _strings.resize (numberOfStrings);
+    _checkpoints.clear ();
+
+    string current;
+    for (int i = 0; i < numberOfStrings; ++i)
+    {
+        uint64_t   length = readVariableLengthInteger (lengthPtr, endOfData);
+        StringRef& ref    = _strings[i];
+
+        if (length > std::numeric_limits<uint32_t>::max ())
+        {
+            throw IEX_NAMESPACE::InputExc ("IDManifest string too long");
+        }
+
+        size_t common      = 0;
+        size_t stringStart = 0;
+        if (i > 0)
+        {
+            stringStart = current.size () > 255 ? 2 : 1;
+            if (length < stringStart)
+            {
+                throw IEX_NAMESPACE::InputExc (
+                    "IDManifest string too small for common prefix length");
+            }
+            if (stringStart == 2)
+            {
+                common = size_t (((unsigned char) (data[0])) << 8) +
+                         size_t ((unsigned char) (data[1]));
+            }
+            else { common = (unsigned char) data[0]; }
+            if (common > current.size ())
+            {
+                throw IEX_NAMESPACE::InputExc (
+                    "Bad common string length in IDmanifest string table");
+            }
+        }
+
+        ref.suffixOffset = uint64_t (data - _data) + stringStart;
+        ref.suffixLength = uint32_t (length - stringStart);
+        ref.common       = uint32_t (common);
+
+        current.resize (common);
+        current.append (data + stringStart, ref.suffixLength);
+        if (i % 64 == 0) { _checkpoints.push_back (current); }
+
+        data += length;
+    }
+
+    //
+    // mapping table from indices in the ID tables to indices in the
+    // string list: see IDManifest::init
+    //
+    _mapping.assign (numberOfStrings, 0);
+    vector<char> seen (numberOfStrings);
+
+    int rleLength;
+    if (endOfData < data + 4)
+    {
+        throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+    }
+
+    Xdr::read<CharPtrIO> (data, rleLength);
+
+    int currentIndex = 0;
+    for (int i = 0; i < rleLength; ++i)
+    {
+        int first;
+        int last;
+        if (endOfData < data + 8)
+        {
+            throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+        }
+        Xdr::read<CharPtrIO> (data, first);
+        Xdr::read<CharPtrIO> (data, last);
+
+        if (first < 0 || last < 0 || first > last ||
+            first >= numberOfStrings || last >= numberOfStrings)
+        {
+            throw IEX_NAMESPACE::InputExc (
+                "Bad mapping table entry in IDManifest");
+        }
+        for (int entry = first; entry <= last; entry++)
+        {
+            if (seen[entry] == 0)
+            {
+                _mapping[currentIndex] = entry;
+                seen[entry]            = 1;
+                currentIndex++;
+            }
+        }
+    }
+
+    //
+    // channel groups: the header of each is decoded, and the IDs of its
+    // table are collected, along with the position of every 16th entry
+    //
+    int manifestEntries;
+
+    if (endOfData < data + 4)
+    {
+        throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+    }
+
+    Xdr::read<CharPtrIO> (data, manifestEntries);
+
+    if (manifestEntries < 0)
+    {
+        throw IEX_NAMESPACE::InputExc (
+            "bad number of ChannelGroupsManifests in IDManifest");
+    }
+
+    _groups.clear ();
+
+    for (int manifestEntry = 0; manifestEntry < manifestEntries;
+         ++manifestEntry)
+    {
+        _groups.push_back (Group ());
+        Group& g = _groups.back ();
+
+        set<string>    channels;
+        vector<string> components;
+        readStringList (data, endOfData, channels);
+        readStringList (data, endOfData, components);
+        g.header.setChannels (channels);
+        g.header.setComponents (components);
+
+        char lifetime;
+        if (endOfData < data + 4)
+        {
+            throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+        }
+        Xdr::read<CharPtrIO> (data, lifetime);
+        g.header.setLifetime (IDManifest::IdLifetime (lifetime));
+
+        string scheme;
+        readPascalString (data, endOfData, scheme);
+        g.header.setHashScheme (scheme);
+        readPascalString (data, endOfData, scheme);
+        g.header.setEncodingScheme (scheme);
+
+        if (endOfData < data + 5)
+        {
+            throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+        }
+        Xdr::read<CharPtrIO> (data, g.storageScheme);
+
+        int tableSize;
+        Xdr::read<CharPtrIO> (data, tableSize);
+
+        // every entry takes at least one byte
+        if (tableSize < 0 || tableSize > endOfData - data)
+        {
+            throw IEX_NAMESPACE::InputExc (
+                "Bad number of entries in IDManifest");
+        }
+
+        g.ids.reserve (tableSize);
+        g.blockOffsets.reserve ((tableSize + 15) / 16);
+
+        uint64_t previousId = 0;
+
+        for (int entry = 0; entry < tableSize; ++entry)
+        {
+            if (entry % 16 == 0)
+            {
+                g.blockOffsets.push_back (uint64_t (data - _data));
+            }
+
+            uint64_t id;
+
+            switch (g.storageScheme)
+            {
+                case 0: {
+                    if (endOfData < data + 8)
+                    {
+                        throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+                    }
+                    Xdr::read<CharPtrIO> (data, id);
+                    break;
+                }
+                case 1: {
+                    if (endOfData < data + 4)
+                    {
+                        throw IEX_NAMESPACE::InputExc ("IDManifest too small");
+                    }
+                    unsigned int id32;
+                    Xdr::read<CharPtrIO> (data, id32);
+                    id = id32;
+                    break;
+                }
+                default: {
+                    id = readVariableLengthInteger (data, endOfData);
+                }
+            }
+
+            id += previousId;
+
+            //
+            // IDs are written in increasing order, which findEntry relies on
+            //
+            if (entry > 0 && id <= previousId)
+            {
+                if (id == previousId)
+                {
+                    throw IEX_NAMESPACE::InputExc (
+                        "ID manifest contains multiple entries for the same ID");
+                }
+                throw IEX_NAMESPACE::InputExc (
+                    "ID manifest entries are not in increasing ID order");
+            }
+            previousId = id;
+            g.ids.push_back (id);
+
+            for (size_t i = 0; i < components.size (); ++i)
+            {
+                uint64_t stringIndex =
+                    readVariableLengthInteger (data, endOfData);
+                if (stringIndex >= uint64_t (numberOfStrings))
+                {
+                    throw IEX_NAMESPACE::InputExc (
+                        "Bad string index in IDManifest");
+                }
+            }
+        }
+    }
+}
+
+string
+IDManifestIndex::expandString (int32_t index) const
+{
+    //
+    // fill in the string from the back: each string supplies the characters
+    // after its common prefix, the previous string the characters before
+    // that, until a fully stored string is reached
+    //
+    const StringRef& ref = _strings[index];
+    string           out (size_t (ref.common) + ref.suffixLength, '\0');
+    size_t           needed = out.size ();
+
+    for (int32_t i = index; needed > 0; --i)
+    {
+        if (i % 64 == 0)
+        {
+            memcpy (&out[0], _checkpoints[i / 64].data (), needed);
+            break;
+        }
+
+        const StringRef& s = _strings[i];
+        if (needed > s.common)
+        {
+            memcpy (
+                &out[s.common], _data + s.suffixOffset, needed - s.common);
+            needed = s.common;
+        }
+    }
+    return out;
+}
+
+const char*
+IDManifestIndex::skipEntries (size_t group, size_t entry) const
+{
+    //
+    // start from the closest recorded entry, and skip the ones before
+    // 'entry'. Returns a pointer to the string indices of 'entry'
+    //
+    const Group& g          = _groups[group];
+    const char*  data       = _data + g.blockOffsets[entry / 16];
+    size_t       components = g.header.getComponents ().size ();
+
+    for (size_t e = entry & ~size_t (15);; ++e)
+    {
+        switch (g.storageScheme)
+        {
+            case 0: data += 8; break;
+            case 1: data += 4; break;
+            default: readVariableLengthInteger (data, _end);
+        }
+
+        if (e == entry) { return data; }
+
+        for (size_t i = 0; i < components; ++i)
+        {
+            readVariableLengthInteger (data, _end);
+        }
+    }
+}
+
+size_t
+IDManifestIndex::size () const
+{
+    return _groups.size ();
+}
+
+size_t
+IDManifestIndex::find (const string& channel) const
+{
+    for (size_t i = 0; i < _groups.size (); ++i)
+    {
+        const set<string>& channels = _groups[i].header.getChannels ();
+        if (channels.find (channel) != channels.end ()) { return i; }
+    }
+    return _groups.size ();
+}
+
+const IDManifest::ChannelGroupManifest&
+IDManifestIndex::header (size_t group) const
+{
+    return _groups[group].header;
+}
+
+size_t
+IDManifestIndex::numIds (size_t group) const
+{
+    return _groups[group].ids.size ();
+}
+
+uint64_t
+IDManifestIndex::id (size_t group, size_t entry) const
+{
+    return _groups[group].ids[entry];
+}
+
+size_t
+IDManifestIndex::findEntry (size_t group, uint64_t idValue) const
+{
+    const vector<uint64_t>&          ids = _groups[group].ids;
+    vector<uint64_t>::const_iterator i =
+        std::lower_bound (ids.begin (), ids.end (), idValue);
+    if (i == ids.end () || *i != idValue) { return ids.size (); }
+    return size_t (i - ids.begin ());
+}
+
+void
+IDManifestIndex::text (
+    size_t group, size_t entry, std::vector<std::string>& text) const
+{
+    const char* data = skipEntries (group, entry);
+
+    text.resize (_groups[group].header.getComponents ().size ());
+    for (size_t i = 0; i < text.size (); ++i)
+    {
+        uint64_t stringIndex = readVariableLengthInteger (data, _end);
+        text[i]              = expandString (_mapping[stringIndex]);
+    }
+}
+
+bool
+IDManifestIndex::lookup (
+    size_t group, uint64_t idValue, std::vector<std::string>& text) const
+{
+    size_t entry = findEntry (group, idValue);
+    if (entry == numIds (group)) { return false; }
+    this->text (group, entry, text);
+    return true;
+}
+
 IDManifest::ChannelGroupManifest::ChannelGroupManifest ()
     : _lifeTime (IDManifest::LIFETIME_STABLE)
     , _hashScheme (IDManifest::UNKNOWN)
@@ -1725,4 +2173,65 @@ IDManifest::MurmurHash64 (const vector<string>& idString)
     return MurmurHash64 (str);
 }
 
+void
+IDManifest::MurmurHash32 (
+    const std::string* idStrings, size_t count, unsigned int* hashes)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        MurmurHash3_x86_32 (
+            idStrings[i].data (), idStrings[i].size (), 0, &hashes[i]);
+    }
+}
+
+void
+IDManifest::MurmurHash32 (
+    const vector<string>* idStrings, size_t count, unsigned int* hashes)
+{
+    // one string is reused to join the components of every ID
+    std::string str;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (idStrings[i].size () == 0)
+        {
+            hashes[i] = 0;
+            continue;
+        }
+        catString (idStrings[i], str);
+        MurmurHash3_x86_32 (str.data (), str.size (), 0, &hashes[i]);
+    }
+}
+
+void
+IDManifest::MurmurHash64 (
+    const std::string* idStrings, size_t count, uint64_t* hashes)
+{
+    uint64_t out[2];
+    for (size_t i = 0; i < count; ++i)
+    {
+        MurmurHash3_x64_128 (
+            idStrings[i].data (), idStrings[i].size (), 0, out);
+        hashes[i] = out[0];
+    }
+}
+
+void
+IDManifest::MurmurHash64 (
+    const vector<string>* idStrings, size_t count, uint64_t* hashes)
+{
+    std::string str;
+    uint64_t    out[2];
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (idStrings[i].size () == 0)
+        {
+            hashes[i] = 0;
+            continue;
+        }
+        catString (idStrings[i], str);
+        MurmurHash3_x64_128 (str.data (), str.size (), 0, out);
+        hashes[i] = out[0];
+    }
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -291,6 +291,29 @@ public:
     static uint64_t MurmurHash64 (const std::string& idString);
     IMF_EXPORT
     static uint64_t MurmurHash64 (const std::vector<std::string>& idString);
+
+    //
+    // batched hash generation: hashes[i] is set to the hash of idStrings[i]
+    // for the first 'count' entries, with the same results as the functions
+    // above, without a call and a temporary string per ID
+    //
+    IMF_EXPORT
+    static void MurmurHash32 (
+        const std::string* idStrings, size_t count, unsigned int* hashes);
+    IMF_EXPORT
+    static void MurmurHash32 (
+        const std::vector<std::string>* idStrings,
+        size_t                          count,
+        unsigned int*                   hashes);
+
+    IMF_EXPORT
+    static void MurmurHash64 (
+        const std::string* idStrings, size_t count, uint64_t* hashes);
+    IMF_EXPORT
+    static void MurmurHash64 (
+        const std::vector<std::string>* idStrings,
+        size_t                          count,
+        uint64_t*                       hashes);
 };
 
 //
@@ -322,6 +345,117 @@ public:
     unsigned char* _data;
 };
 
+//
+// read-only, indexed view of a serialized IDManifest, for looking up a few
+// IDs in a large manifest without building a full IDManifest
+//
+// the index keeps the IDs of each channel group in a sorted array and
+// refers back to the serialized manifest for everything else: the text of
+// an entry is only decoded when it is looked up
+//
+// the index is not stored in the file, so that the manifest attribute is
+// unchanged and readable by any reader: it is built in memory, in a single
+// pass over the serialized manifest, each time an IDManifestIndex is made
+//
+class IMF_EXPORT_TYPE IDManifestIndex
+{
+public:
+    //
+    // decompress a compressed IDManifest and index it
+    //
+    IMF_EXPORT
+    explicit IDManifestIndex (const CompressedIDManifest&);
+
+    //
+    // index the serialized manifest stored at 'data' (as written by
+    // IDManifest::serialize) without copying it - for example a memory
+    // mapped file. 'data' must outlive the index
+    //
+    IMF_EXPORT
+    IDManifestIndex (const char* data, const char* end);
+
+    IMF_EXPORT
+    ~IDManifestIndex ();
+
+    // return number of channel groups in manifest
+    IMF_EXPORT
+    size_t size () const;
+
+    // find the first channel group that defines the given channel
+    // if channel not found, returns a value equal to size()
+    IMF_EXPORT
+    size_t find (const std::string& channel) const;
+
+    //
+    // description of the channel group: channels, components, lifetime,
+    // hash and encoding scheme. The returned manifest has no entries
+    //
+    IMF_EXPORT
+    const IDManifest::ChannelGroupManifest& header (size_t group) const;
+
+    // return number of entries in channel group
+    IMF_EXPORT
+    size_t numIds (size_t group) const;
+
+    // return ID of the given entry: entries are sorted by increasing ID
+    IMF_EXPORT
+    uint64_t id (size_t group, size_t entry) const;
+
+    //
+    // find the entry for idValue in the given channel group.
+    // returns numIds(group) if the ID is not in the manifest
+    //
+    IMF_EXPORT
+    size_t findEntry (size_t group, uint64_t idValue) const;
+
+    // decode the text of the given entry, one string per component
+    IMF_EXPORT
+    void
+    text (size_t group, size_t entry, std::vector<std::string>& text) const;
+
+    //
+    // decode the text for idValue in the given channel group into 'text':
+    // returns false and leaves 'text' unchanged if the ID is not in the manifest
+    //
+    IMF_EXPORT
+    bool lookup (
+        size_t group, uint64_t idValue, std::vector<std::string>& text) const;
+
+private:
+    IDManifestIndex (const IDManifestIndex&)            = delete;
+    IDManifestIndex& operator= (const IDManifestIndex&) = delete;
+
+    IMF_HIDDEN void init (const char* data, const char* end);
+    IMF_HIDDEN std::string expandString (int32_t index) const;
+    IMF_HIDDEN const char*
+    skipEntries (size_t group, size_t entry) const;
+
+    struct Group
+    {
+        IDManifest::ChannelGroupManifest header;
+        char                             storageScheme;
+        std::vector<uint64_t>            ids;
+        // offset in the manifest of every 16th entry of the ID table
+        std::vector<uint64_t>            blockOffsets;
+    };
+
+    // position of a string in the prefix-compressed string table
+    struct StringRef
+    {
+        uint64_t suffixOffset; // characters that follow the common prefix
+        uint32_t suffixLength;
+        uint32_t common; // number of characters shared with previous string
+    };
+
+    std::vector<char>        _storage; // decompressed manifest, when owned
+    const char*              _data;
+    const char*              _end;
+    std::vector<StringRef>   _strings;
+    std::vector<std::string> _checkpoints; // every 64th string, expanded
+    std::vector<int32_t>     _mapping;     // table index to string index
+    std::vector<Group>       _groups;
+};
+
 //
 // Read/Write Iterator object to access individual entries within a manifest
 //
@@ -13,6 +13,8 @@
 #include "ImfNamespace.h"
 #include "ImfIO.h"
 
+#include <string.h>
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 IStream::IStream (const char fileName[]) : _fileName (fileName)
@@ -69,6 +71,80 @@ IStream::read (void *, uint64_t, uint64_t)
                                    "on a stream without support.");
 }
 
+MemoryIStream::MemoryIStream (
+    const char data[/*size*/], uint64_t size, const char fileName[])
+    : IStream (fileName), _data (data), _size (size), _pos (0)
+{
+    // empty
+}
+
+MemoryIStream::~MemoryIStream ()
+{
+    // empty
+}
+
+bool
+MemoryIStream::isMemoryMapped () const
+{
+    return true;
+}
+
+bool
+MemoryIStream::read (char c[/*n*/], int n)
+{
+    if (n < 0 || _pos > _size || static_cast<uint64_t> (n) > _size - _pos)
+        throw IEX_NAMESPACE::InputExc ("Unexpected end of file.");
+
+    memcpy (c, _data + _pos, static_cast<size_t> (n));
+    _pos += static_cast<uint64_t> (n);
+    return _pos < _size;
+}
+
+char*
+MemoryIStream::readMemoryMapped (int n)
+{
+    if (n < 0 || _pos > _size || static_cast<uint64_t> (n) > _size - _pos)
+        throw IEX_NAMESPACE::InputExc ("Reading past end of file.");
+
+    char* retVal = const_cast<char*> (_data + _pos);
+    _pos += static_cast<uint64_t> (n);
+    return retVal;
+}
+
+uint64_t
+MemoryIStream::tellg ()
+{
+    return _pos;
+}
+
+void
+MemoryIStream::seekg (uint64_t pos)
+{
+    _pos = pos;
+}
+
+int64_t
+MemoryIStream::size ()
+{
+    return static_cast<int64_t> (_size);
+}
+
+bool
+MemoryIStream::isStatelessRead () const
+{
+    return true;
+}
+
+int64_t
+MemoryIStream::read (void* buf, uint64_t sz, uint64_t offset)
+{
+    if (offset >= _size) return 0;
+    if (sz > _size - offset) sz = _size - offset;
+
+    memcpy (buf, _data + offset, static_cast<size_t> (sz));
+    return static_cast<int64_t> (sz);
+}
+
 OStream::OStream (const char fileName[]) : _fileName (fileName)
 {
     // empty
@@ -85,4 +161,59 @@ OStream::fileName () const
     return _fileName.c_str ();
 }
 
+MemoryOStream::MemoryOStream (const char fileName[], uint64_t reserve)
+    : OStream (fileName), _buf (&_own), _pos (0)
+{
+    if (reserve > 0) _own.reserve (static_cast<size_t> (reserve));
+}
+
+MemoryOStream::MemoryOStream (std::vector<char>& buffer, const char fileName[])
+    : OStream (fileName), _buf (&buffer), _pos (0)
+{
+    _buf->clear ();
+}
+
+MemoryOStream::~MemoryOStream ()
+{
+    // empty
+}
+
+void
+MemoryOStream::write (const char c[/*n*/], int n)
+{
+    if (n <= 0) return;
+
+    uint64_t end = _pos + static_cast<uint64_t> (n);
+    if (end != static_cast<uint64_t> (static_cast<size_t> (end)))
+        throw IEX_NAMESPACE::ArgExc ("Memory output too large.");
+
+    // positions past the end (a seekp beyond the data written so
+    // far) are zero filled by the resize
+    if (end > _buf->size ()) _buf->resize (static_cast<size_t> (end));
+
+    memcpy (_buf->data () + _pos, c, static_cast<size_t> (n));
+    _pos = end;
+}
+
+uint64_t
+MemoryOStream::tellp ()
+{
+    return _pos;
+}
+
+void
+MemoryOStream::seekp (uint64_t pos)
+{
+    _pos = pos;
+}
+
+std::vector<char>
+MemoryOStream::release ()
+{
+    std::vector<char> ret;
+    ret.swap (*_buf);
+    _pos = 0;
+    return ret;
+}
+
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
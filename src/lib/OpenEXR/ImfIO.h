@@ -26,6 +26,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
@@ -165,6 +166,51 @@ private:
     std::string _fileName;
 };
 
+//-----------------------------------------------------------
+// class MemoryIStream -- an input stream reading a file that
+// is already in memory.
+//
+// The stream references the caller's buffer, which must stay
+// valid and unmodified for the lifetime of the stream and of
+// any file reading from it.  No copy is made: memory-mapped
+// reads return pointers into the buffer, stateless reads need
+// no locking, and the input file classes decode the chunks
+// directly out of the buffer (see exr_start_read_from_memory).
+//-----------------------------------------------------------
+
+class IMF_EXPORT_TYPE MemoryIStream : public IStream
+{
+public:
+    IMF_EXPORT MemoryIStream (
+        const char data[/*size*/],
+        uint64_t   size,
+        const char fileName[] = "<memory>");
+
+    IMF_EXPORT virtual ~MemoryIStream ();
+
+    IMF_EXPORT virtual bool     isMemoryMapped () const;
+    IMF_EXPORT virtual bool     read (char c[/*n*/], int n);
+    IMF_EXPORT virtual char*    readMemoryMapped (int n);
+    IMF_EXPORT virtual uint64_t tellg ();
+    IMF_EXPORT virtual void     seekg (uint64_t pos);
+    IMF_EXPORT virtual int64_t  size ();
+
+    IMF_EXPORT virtual bool    isStatelessRead () const;
+    IMF_EXPORT virtual int64_t read (void* buf, uint64_t sz, uint64_t offset);
+
+    //------------------------------------
+    // The buffer the stream is reading
+    //------------------------------------
+
+    const char* data () const { return _data; }
+    uint64_t    dataSize () const { return _size; }
+
+private:
+    const char* _data;
+    uint64_t    _size;
+    uint64_t    _pos;
+};
+
 //-----------------------------------------------------------
 // class OStream -- an abstract base class for output streams
 //-----------------------------------------------------------
@@ -222,6 +268,59 @@ private:
     std::string _fileName;
 };
 
+//-----------------------------------------------------------
+// class MemoryOStream -- an output stream writing a file into
+// a growable buffer in memory.
+//
+// The stream either owns its buffer, or writes into a vector
+// supplied by the caller (which is cleared first).  Data is
+// written in place, so seeking back to patch the offset tables
+// when a file is closed does not copy the rest of the file, and
+// the result can be accessed through data() or moved out with
+// release() without copying it.
+//-----------------------------------------------------------
+
+class IMF_EXPORT_TYPE MemoryOStream : public OStream
+{
+public:
+    //----------------------------------------------------------
+    // A constructor for a stream owning its buffer, optionally
+    // reserving space up front if the output size is known.
+    //----------------------------------------------------------
+
+    IMF_EXPORT
+    MemoryOStream (const char fileName[] = "<memory>", uint64_t reserve = 0);
+
+    //-------------------------------------------------------
+    // A constructor for a stream writing into buffer, which
+    // must outlive the stream.
+    //-------------------------------------------------------
+
+    IMF_EXPORT MemoryOStream (
+        std::vector<char>& buffer, const char fileName[] = "<memory>");
+
+    IMF_EXPORT virtual ~MemoryOStream ();
+
+    IMF_EXPORT virtual void     write (const char c[/*n*/], int n);
+    IMF_EXPORT virtual uint64_t tellp ();
+    IMF_EXPORT virtual void     seekp (uint64_t pos);
+
+    //----------------------------------------------------------
+    // The data written so far, and moving it out of the stream.
+    // After release() the stream is empty and positioned at 0.
+    //----------------------------------------------------------
+
+    const char* data () const { return _buf->data (); }
+    uint64_t    size () const { return _buf->size (); }
+
+    IMF_EXPORT std::vector<char> release ();
+
+private:
+    std::vector<char>  _own;
+    std::vector<char>* _buf;
+    uint64_t           _pos;
+};
+
 //-----------------------
 // Helper classes for Xdr
 //-----------------------
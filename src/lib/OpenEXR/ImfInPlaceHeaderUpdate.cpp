@@ -0,0 +1,179 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#include "ImfInPlaceHeaderUpdate.h"
+
+#include "ImfBytesAttribute.h"
+#include "ImfChannelList.h"
+#include "ImfContext.h"
+#include "ImfHeader.h"
+#include "ImfMisc.h"
+#include "ImfMultiPartOutputFile.h"
+#include "ImfPartType.h"
+#include "ImfStdIO.h"
+
+#include "Iex.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using namespace std;
+
+namespace
+{
+
+const char PADDING_NAME[] = "headerPadding";
+
+string
+partType (const Header& header)
+{
+    if (header.hasType ()) return header.type ();
+    return header.hasTileDescription () ? TILEDIMAGE : SCANLINEIMAGE;
+}
+
+bool
+sameLayout (const Header& a, const Header& b)
+{
+    if (partType (a) != partType (b) || a.dataWindow () != b.dataWindow () ||
+        !(a.channels () == b.channels ()) ||
+        a.compression () != b.compression () ||
+        a.lineOrder () != b.lineOrder () ||
+        a.hasTileDescription () != b.hasTileDescription ())
+        return false;
+
+    return !a.hasTileDescription () ||
+           a.tileDescription () == b.tileDescription ();
+}
+
+//
+// Serialize the headers as MultiPartOutputFile writes them, up to
+// the chunk offset tables.
+//
+
+string
+writeHeaders (const vector<Header>& headers)
+{
+    StdOSStream os;
+    {
+        MultiPartOutputFile out (os, headers.data (), int (headers.size ()));
+    }
+
+    string   data       = os.str ();
+    uint64_t tableBytes = 0;
+
+    for (const Header& h: headers)
+        tableBytes += uint64_t (getChunkOffsetTableSize (h)) * sizeof (uint64_t);
+
+    data.resize (data.size () - tableBytes);
+    return data;
+}
+
+} // namespace
+
+void
+addHeaderPadding (Header& header, int numBytes)
+{
+    if (numBytes < 0)
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Invalid header padding of " << numBytes << " bytes.");
+
+    vector<unsigned char> zeros (numBytes, 0);
+    header.insert (PADDING_NAME, BytesAttribute (zeros.size (), zeros.data ()));
+}
+
+bool
+updateHeadersInPlace (
+    const char fileName[], const Header headers[], int numParts)
+{
+    uint64_t oldSize = 0;
+
+    {
+        Context ctxt (fileName, ContextInitializer (), Context::read_mode_t{});
+
+        if (numParts != ctxt.partCount ())
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Cannot update the headers of file \""
+                    << fileName << "\" in place: it has " << ctxt.partCount ()
+                    << " parts, not " << numParts << ".");
+
+        for (int p = 0; p < numParts; ++p)
+        {
+            if (!sameLayout (ctxt.header (p), headers[p]))
+                THROW (
+                    IEX_NAMESPACE::ArgExc,
+                    "Cannot update the header of part "
+                        << p << " of file \"" << fileName
+                        << "\" in place: the new header describes "
+                           "different pixels.");
+        }
+
+        if (EXR_ERR_SUCCESS != exr_get_chunk_table_offset (ctxt, 0, &oldSize))
+            THROW (
+                IEX_NAMESPACE::InputExc,
+                "Cannot locate the chunk offset table of file \""
+                    << fileName << "\".");
+    }
+
+    vector<Header> newHeaders (headers, headers + numParts);
+    for (Header& h: newHeaders)
+        h.erase (PADDING_NAME);
+
+    string data = writeHeaders (newHeaders);
+
+    if (data.size () != oldSize)
+    {
+        //
+        // Fill the remaining space with padding, which itself takes
+        // a few bytes for its name, type and size.
+        //
+
+        addHeaderPadding (newHeaders[0], 0);
+        data = writeHeaders (newHeaders);
+        if (data.size () > oldSize) return false;
+
+        addHeaderPadding (newHeaders[0], int (oldSize - data.size ()));
+        data = writeHeaders (newHeaders);
+
+        if (data.size () != oldSize)
+            THROW (
+                IEX_NAMESPACE::LogicExc,
+                "Unexpected size of the padded headers of file \""
+                    << fileName << "\".");
+    }
+
+    fstream file (
+#if __cplusplus >= 202002L
+        filesystem::path (
+            reinterpret_cast<const char8_t*> (fileName),
+            reinterpret_cast<const char8_t*> (fileName) + strlen (fileName)),
+#else
+        filesystem::u8path (fileName),
+#endif
+        ios_base::in | ios_base::out | ios_base::binary);
+
+    if (!file)
+        THROW (
+            IEX_NAMESPACE::ErrnoExc,
+            "Cannot open file \"" << fileName << "\" for update.");
+
+    file.write (data.data (), streamsize (data.size ()));
+    file.flush ();
+
+    if (!file)
+        THROW (
+            IEX_NAMESPACE::ErrnoExc,
+            "Cannot write the headers of file \"" << fileName << "\".");
+
+    return true;
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,62 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_IN_PLACE_HEADER_UPDATE_H
+#define INCLUDED_IMF_IN_PLACE_HEADER_UPDATE_H
+
+//-----------------------------------------------------------------------------
+//
+//	Changing the headers of an existing OpenEXR file without
+//	rewriting its pixels.
+//
+//	The chunk offset tables directly follow the headers in a file,
+//	so a header can only be replaced in place by one that takes
+//	exactly the same space. Spare space is kept in a "headerPadding"
+//	attribute, of type bytes, which is shrunk or grown as needed
+//	when the headers are updated. Readers treat it like any other
+//	attribute.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfExport.h"
+#include "ImfForward.h"
+#include "ImfNamespace.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+//
+// Reserve numBytes bytes of spare space in a header, by setting its
+// "headerPadding" attribute. When a file is written with the header,
+// later calls to updateHeadersInPlace() can add or enlarge attributes
+// by up to that many bytes.
+//
+
+IMF_EXPORT void addHeaderPadding (Header& header, int numBytes);
+
+//
+// Replace the headers of the existing file fileName with headers[0]
+// to headers[numParts-1], without touching the pixels. The
+// "headerPadding" attributes of the headers are ignored: any space
+// left once the new headers are written is kept as padding in the
+// header of the first part.
+//
+// If the new headers do not fit in the space taken by the old ones,
+// the file is not modified, and updateHeadersInPlace() returns false;
+// the file must then be rewritten, for example with copyPixels().
+//
+// The new headers must describe the same pixels as the old ones: the
+// file must have numParts parts, and each header must keep the type,
+// data window, channels, compression, line order and tile description
+// of its part. Otherwise an ArgExc is thrown.
+//
+// fileName is a UTF-8 encoded path; see ImfIO.h.
+//
+
+IMF_EXPORT bool updateHeadersInPlace (
+    const char fileName[], const Header headers[], int numParts);
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -207,6 +207,62 @@ InputFile::isComplete () const
     return _ctxt.chunkTableValid (_data->getPartIdx ());
 }
 
+void
+InputFile::setResolutionReduction (int levels)
+{
+    if (_data->_sFile)
+        _data->_sFile->setResolutionReduction (levels);
+    else if (levels != 0)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Reduced resolution reading is only available for scan line "
+            "files through InputFile, use TiledInputFile to read file '"
+                << fileName () << "'");
+    }
+}
+
+int
+InputFile::resolutionReduction () const
+{
+    return _data->_sFile ? _data->_sFile->resolutionReduction () : 0;
+}
+
+IMATH_NAMESPACE::Box2i
+InputFile::reducedDataWindow () const
+{
+    if (_data->_sFile) return _data->_sFile->reducedDataWindow ();
+    return header ().dataWindow ();
+}
+
+void
+InputFile::setDecimation (int factor, bool average)
+{
+    if (_data->_sFile)
+        _data->_sFile->setDecimation (factor, average);
+    else if (factor != 1)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Decimated reading is only available for flat scan line "
+            "files, unable to decimate file '"
+                << fileName () << "'");
+    }
+}
+
+int
+InputFile::decimation () const
+{
+    return _data->_sFile ? _data->_sFile->decimation () : 1;
+}
+
+IMATH_NAMESPACE::Box2i
+InputFile::decimatedDataWindow () const
+{
+    if (_data->_sFile) return _data->_sFile->decimatedDataWindow ();
+    return header ().dataWindow ();
+}
+
 bool
 InputFile::isOptimizationEnabled () const
 {
@@ -235,6 +291,21 @@ InputFile::readPixels (
     _data->readPixels (frameBuffer, scanLine1, scanLine2);
 }
 
+void
+InputFile::readPixels (
+    const FrameBuffer& frameBuffer, const IMATH_NAMESPACE::Box2i& region)
+{
+    if (!_data->_sFile)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Reading a region of pixels is only available for scan line "
+            "files through InputFile, unable to read file '"
+                << fileName () << "'");
+    }
+    _data->_sFile->readPixels (frameBuffer, region);
+}
+
 void
 InputFile::rawPixelData (
     int firstScanLine, const char*& pixelData, int& pixelDataSize)
@@ -155,6 +155,50 @@ public:
     IMF_EXPORT
     bool isComplete () const;
 
+    //---------------------------------------------------------------
+    // Reduced resolution decoding:
+    //
+    // setResolutionReduction(n) causes subsequent calls to
+    // readPixels() to decode the image at 1/2^n of its resolution in
+    // each direction, for proxies and thumbnails. Scan line numbers
+    // and the frame buffer are then relative to reducedDataWindow()
+    // rather than the data window of the header. This requires a
+    // scan line based, HTJ2K (or, with n = 3, DWA) compressed file
+    // without sub-sampled channels; otherwise an exception is thrown. Tiled files can be
+    // read at reduced resolution with TiledInputFile. See also
+    // ScanLineInputFile::setResolutionReduction().
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void setResolutionReduction (int levels);
+
+    IMF_EXPORT
+    int resolutionReduction () const;
+
+    IMF_EXPORT
+    IMATH_NAMESPACE::Box2i reducedDataWindow () const;
+
+    //---------------------------------------------------------------
+    // Decimated reading:
+    //
+    // setDecimation(n) causes subsequent calls to readPixels() to
+    // store only every n-th pixel of every n-th scan line, or with
+    // average set, the average of each n by n block, into a frame
+    // buffer relative to decimatedDataWindow(). This is intended
+    // for previews of large images, and requires a flat scan line
+    // file without sub-sampled channels. See also
+    // ScanLineInputFile::setDecimation().
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void setDecimation (int factor, bool average = false);
+
+    IMF_EXPORT
+    int decimation () const;
+
+    IMF_EXPORT
+    IMATH_NAMESPACE::Box2i decimatedDataWindow () const;
+
     //---------------------------------------------------------------
     // Check if SSE optimization is enabled
     //
@@ -223,6 +267,20 @@ public:
     void readPixels (
         const FrameBuffer& frameBuffer, int scanLine1, int scanLine2);
 
+    //----------------------------------------------
+    // Reads only the pixels within region, which may be narrower
+    // than the data window, such that the frame buffer need only
+    // cover the region. This requires a scan line based file,
+    // otherwise an exception is thrown; tiled files can be read a
+    // region at a time with TiledInputFile::readTiles(). See
+    // ScanLineInputFile::readPixels(frame, region).
+    //----------------------------------------------
+
+    IMF_EXPORT
+    void readPixels (
+        const FrameBuffer&            frameBuffer,
+        const IMATH_NAMESPACE::Box2i& region);
+
     //----------------------------------------------
     // Read a block of raw pixel data from the file,
     // without uncompressing it (this function is
@@ -19,6 +19,7 @@
 #include "ImfMisc.h"
 #include "ImfPartType.h"
 #include "ImfStdIO.h"
+#include "ImfSystemSpecific.h"
 #include "ImfTileDescription.h"
 #include "ImfXdr.h"
 #include <Imath/ImathFun.h>
@@ -1832,6 +1833,110 @@ copyFromDeepFrameBuffer (
     }
 }
 
+void
+copyFromDeepFrameBuffer (
+    char*&             writePtr,
+    const char*        base,
+    char*              sampleCountBase,
+    ptrdiff_t          sampleCountXStride,
+    ptrdiff_t          sampleCountYStride,
+    char*              sampleOffsetBase,
+    ptrdiff_t          sampleOffsetXStride,
+    ptrdiff_t          sampleOffsetYStride,
+    int                y,
+    int                xMin,
+    int                xMax,
+    int                xOffsetForSampleCount,
+    int                yOffsetForSampleCount,
+    int                xOffsetForSampleOffset,
+    int                yOffsetForSampleOffset,
+    ptrdiff_t          sampleStride,
+    Compressor::Format format,
+    PixelType          type)
+{
+    //
+    // Copy a horizontal row of pixels from a frame buffer with
+    // contiguous samples to an output file's line or tile buffer,
+    // one run of consecutive samples at a time.
+    //
+
+    size_t typeSize = pixelTypeSize (type);
+
+    //
+    // XDR is little-endian, so on little-endian machines runs of
+    // tightly packed samples are already in the right format.
+    //
+
+    bool packed = ptrdiff_t (typeSize) == sampleStride &&
+                  (format == Compressor::NATIVE || GLOBAL_SYSTEM_LITTLE_ENDIAN);
+
+    for (int x = xMin; x <= xMax;)
+    {
+        size_t offset = (unsigned int) sampleCount (
+            sampleOffsetBase,
+            sampleOffsetXStride,
+            sampleOffsetYStride,
+            x - xOffsetForSampleOffset,
+            y - yOffsetForSampleOffset);
+        size_t count = 0;
+
+        do
+        {
+            count += (unsigned int) sampleCount (
+                sampleCountBase,
+                sampleCountXStride,
+                sampleCountYStride,
+                x - xOffsetForSampleCount,
+                y - yOffsetForSampleCount);
+            ++x;
+        } while (x <= xMax && offset + count == (unsigned int) sampleCount (
+                                                     sampleOffsetBase,
+                                                     sampleOffsetXStride,
+                                                     sampleOffsetYStride,
+                                                     x - xOffsetForSampleOffset,
+                                                     y - yOffsetForSampleOffset));
+
+        const char* readPtr = base + offset * sampleStride;
+
+        if (packed)
+        {
+            memcpy (writePtr, readPtr, count * typeSize);
+            writePtr += count * typeSize;
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (format == Compressor::XDR)
+            {
+                switch (type)
+                {
+                    case OPENEXR_IMF_INTERNAL_NAMESPACE::UINT:
+                        Xdr::write<CharPtrIO> (
+                            writePtr, *(const unsigned int*) readPtr);
+                        break;
+                    case OPENEXR_IMF_INTERNAL_NAMESPACE::HALF:
+                        Xdr::write<CharPtrIO> (writePtr, *(const half*) readPtr);
+                        break;
+                    case OPENEXR_IMF_INTERNAL_NAMESPACE::FLOAT:
+                        Xdr::write<CharPtrIO> (
+                            writePtr, *(const float*) readPtr);
+                        break;
+                    default:
+                        throw IEX_NAMESPACE::ArgExc ("Unknown pixel data type.");
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < typeSize; ++j)
+                    *writePtr++ = readPtr[j];
+            }
+
+            readPtr += sampleStride;
+        }
+    }
+}
+
 void
 fillChannelWithZeroes (
     char*& writePtr, Compressor::Format format, PixelType type, size_t xSize)
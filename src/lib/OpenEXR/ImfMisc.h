@@ -396,6 +396,41 @@ void copyFromDeepFrameBuffer (
     Compressor::Format format,
     PixelType          type);
 
+//
+// As above, for a deep frame buffer with a sample offset slice: base
+// points to one contiguous block of samples, and the samples of pixel
+// (x, y) start offset (x, y) samples into it.  Runs of pixels whose
+// offsets follow their sample counts are copied in one go.
+//
+//    sampleOffsetBase,         used to locate the offset of the
+//    sampleOffsetXStride,      first sample of each pixel.
+//    sampleOffsetYStride
+//
+//    xOffsetForSampleOffset,   used to offset the sample offset array.
+//    yOffsetForSampleOffset
+//
+
+IMF_EXPORT
+void copyFromDeepFrameBuffer (
+    char*&             writePtr,
+    const char*        base,
+    char*              sampleCountBase,
+    ptrdiff_t          sampleCountXStride,
+    ptrdiff_t          sampleCountYStride,
+    char*              sampleOffsetBase,
+    ptrdiff_t          sampleOffsetXStride,
+    ptrdiff_t          sampleOffsetYStride,
+    int                y,
+    int                xMin,
+    int                xMax,
+    int                xOffsetForSampleCount,
+    int                yOffsetForSampleCount,
+    int                xOffsetForSampleOffset,
+    int                yOffsetForSampleOffset,
+    ptrdiff_t          sampleStride,
+    Compressor::Format format,
+    PixelType          type);
+
 //
 // Fill part of an output file's line buffer or tile buffer with
 // zeroes.  This routine is called when an output file contains
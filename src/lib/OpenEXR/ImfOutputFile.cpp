@@ -25,6 +25,7 @@
 #include "ImfOutputStreamMutex.h"
 #include "ImfPartType.h"
 #include "ImfPreviewImageAttribute.h"
+#include "ImfRawChunkCopy.h"
 #include "ImfStdIO.h"
 #include "ImfXdr.h"
 #include <Imath/ImathBox.h>
@@ -1328,30 +1329,39 @@ OutputFile::copyPixels (InputFile& in)
                    "pixel data.");
 
     //
-    // Copy the pixel data.
+    // Copy the pixel data. The chunks are read in parallel, using as
+    // many line buffers' worth of memory as writing pixels would.
     //
 
-    while (_data->missingScanLines > 0)
-    {
-        const char* pixelData;
-        int         pixelDataSize;
-
-        in.rawPixelData (_data->currentScanLine, pixelData, pixelDataSize);
-
-        writePixelData (
-            _data->_streamData,
-            _data,
-            lineBufferMinY (
-                _data->currentScanLine, _data->minY, _data->linesInBuffer),
-            pixelData,
-            pixelDataSize);
-
-        _data->currentScanLine += (_data->lineOrder == INCREASING_Y)
-                                      ? _data->linesInBuffer
-                                      : -_data->linesInBuffer;
-
-        _data->missingScanLines -= _data->linesInBuffer;
-    }
+    int numChunks = (_data->missingScanLines + _data->linesInBuffer - 1) /
+                    _data->linesInBuffer;
+    int step      = (_data->lineOrder == INCREASING_Y)
+                        ? _data->linesInBuffer
+                        : -_data->linesInBuffer;
+    int firstLine = _data->currentScanLine;
+
+    copyRawChunks (
+        numChunks,
+        static_cast<int> (_data->lineBuffers.size ()),
+        [&] (int i, std::vector<char>& data) {
+            data.resize (_data->lineBufferSize);
+            int pixelDataSize = static_cast<int> (data.size ());
+            in.rawPixelDataToBuffer (
+                firstLine + i * step, data.data (), pixelDataSize);
+            data.resize (pixelDataSize);
+        },
+        [&] (int, const std::vector<char>& data) {
+            writePixelData (
+                _data->_streamData,
+                _data,
+                lineBufferMinY (
+                    _data->currentScanLine, _data->minY, _data->linesInBuffer),
+                data.data (),
+                static_cast<int> (data.size ()));
+
+            _data->currentScanLine += step;
+            _data->missingScanLines -= _data->linesInBuffer;
+        });
 }
 
 void
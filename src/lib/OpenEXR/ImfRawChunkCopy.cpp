@@ -0,0 +1,142 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#include "ImfRawChunkCopy.h"
+
+#include "IlmThreadPool.h"
+#if ILMTHREAD_THREADING_ENABLED
+#    include <condition_variable>
+#    include <mutex>
+#endif
+
+#include <algorithm>
+#include <exception>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+namespace
+{
+
+struct ChunkSlot
+{
+    std::vector<char>  data;
+    bool               done = false;
+    std::exception_ptr error;
+};
+
+#if ILMTHREAD_THREADING_ENABLED
+
+struct CopyState
+{
+    std::mutex              mx;
+    std::condition_variable cv;
+};
+
+class ReadChunkTask final : public ILMTHREAD_NAMESPACE::Task
+{
+public:
+    ReadChunkTask (
+        ILMTHREAD_NAMESPACE::TaskGroup* group,
+        CopyState*                      state,
+        const RawChunkReader*           readChunk,
+        ChunkSlot*                      slot,
+        int                             chunk)
+        : Task (group)
+        , _state (state)
+        , _readChunk (readChunk)
+        , _slot (slot)
+        , _chunk (chunk)
+    {}
+
+    void execute () override
+    {
+        std::exception_ptr error;
+        try
+        {
+            (*_readChunk) (_chunk, _slot->data);
+        }
+        catch (...)
+        {
+            error = std::current_exception ();
+        }
+
+        std::lock_guard<std::mutex> lock (_state->mx);
+        _slot->error = error;
+        _slot->done  = true;
+        _state->cv.notify_all ();
+    }
+
+private:
+    CopyState*            _state;
+    const RawChunkReader* _readChunk;
+    ChunkSlot*            _slot;
+    int                   _chunk;
+};
+
+#endif
+
+} // namespace
+
+void
+copyRawChunks (
+    int                   numChunks,
+    int                   maxInFlight,
+    const RawChunkReader& readChunk,
+    const RawChunkWriter& writeChunk)
+{
+    if (numChunks <= 0) return;
+
+#if ILMTHREAD_THREADING_ENABLED
+    int window = std::min (std::max (maxInFlight, 1), numChunks);
+    if (window > 1)
+    {
+        std::vector<ChunkSlot> slots (window);
+        CopyState              state;
+
+        //
+        // Declared after the slots, so that, if a chunk fails, the
+        // tasks still reading into them finish first.
+        //
+
+        ILMTHREAD_NAMESPACE::TaskGroup group;
+
+        auto submit = [&] (int chunk) {
+            ChunkSlot& slot = slots[chunk % window];
+            slot.done       = false;
+            slot.error      = nullptr;
+            ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
+                new ReadChunkTask (&group, &state, &readChunk, &slot, chunk));
+        };
+
+        for (int i = 0; i < window; ++i)
+            submit (i);
+
+        for (int i = 0; i < numChunks; ++i)
+        {
+            ChunkSlot& slot = slots[i % window];
+            {
+                std::unique_lock<std::mutex> lock (state.mx);
+                state.cv.wait (lock, [&slot] { return slot.done; });
+            }
+
+            if (slot.error) std::rethrow_exception (slot.error);
+
+            writeChunk (i, slot.data);
+
+            if (i + window < numChunks) submit (i + window);
+        }
+        return;
+    }
+#endif
+
+    std::vector<char> data;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        readChunk (i, data);
+        writeChunk (i, data);
+    }
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,45 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_RAW_CHUNK_COPY_H
+#define INCLUDED_IMF_RAW_CHUNK_COPY_H
+
+//-----------------------------------------------------------------------------
+//
+//	Copying the raw chunks of a part, as done by the copyPixels()
+//	methods of the output files.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfNamespace.h"
+
+#include <functional>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+//
+// Copy numChunks chunks: readChunk (i, data) reads the raw data of
+// chunk i into data, resizing it as needed, and writeChunk (i, data)
+// writes it. Up to maxInFlight chunks are read concurrently using the
+// global thread pool, while the chunks already read are written, in
+// order, by the calling thread, so that reading, which is thread safe
+// for the input files, overlaps writing, with a bounded number of
+// chunks held in memory. If maxInFlight is 1, each chunk is read and
+// written in turn by the calling thread.
+//
+
+using RawChunkReader = std::function<void (int, std::vector<char>&)>;
+using RawChunkWriter = std::function<void (int, const std::vector<char>&)>;
+
+void copyRawChunks (
+    int                   numChunks,
+    int                   maxInFlight,
+    const RawChunkReader& readChunk,
+    const RawChunkWriter& writeChunk);
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
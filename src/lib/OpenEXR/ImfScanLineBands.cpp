@@ -0,0 +1,127 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#include "ImfScanLineBands.h"
+
+#include "ImfThreading.h"
+
+#include "Iex.h"
+#include "IlmThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+using namespace std;
+
+namespace
+{
+
+class ReadBandTask : public ILMTHREAD_NAMESPACE::Task
+{
+public:
+    ReadBandTask (
+        ILMTHREAD_NAMESPACE::TaskGroup*             group,
+        const std::function<void (int, int, int)>& readBand,
+        int                                         buffer,
+        int                                         y1,
+        int                                         y2,
+        exception_ptr&                              error)
+        : Task (group)
+        , _readBand (readBand)
+        , _buffer (buffer)
+        , _y1 (y1)
+        , _y2 (y2)
+        , _error (error)
+    {}
+
+    void execute () override
+    {
+        try
+        {
+            _readBand (_buffer, _y1, _y2);
+        }
+        catch (...)
+        {
+            _error = current_exception ();
+        }
+    }
+
+private:
+    const std::function<void (int, int, int)>& _readBand;
+    int                                         _buffer;
+    int                                         _y1;
+    int                                         _y2;
+    exception_ptr&                              _error;
+};
+
+} // namespace
+
+int
+scanLineBandHeight (int linesPerChunk)
+{
+    return max (64, max (linesPerChunk, 1) * max (globalThreadCount (), 1));
+}
+
+void
+convertScanLineBands (
+    int                                         minY,
+    int                                         maxY,
+    int                                         bandHeight,
+    LineOrder                                   lineOrder,
+    const std::function<void (int, int, int)>& readBand,
+    const std::function<void (int, int, int)>& writeBand)
+{
+    if (bandHeight < 1)
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Invalid scan line band height " << bandHeight << ".");
+
+    if (maxY < minY) return;
+
+    int numBands =
+        int ((int64_t (maxY) - minY + bandHeight) / bandHeight);
+
+    //
+    // The scan lines of the k-th band, counted in line order.
+    //
+
+    auto bandLines = [&] (int k, int& y1, int& y2) {
+        if (lineOrder == DECREASING_Y) k = numBands - 1 - k;
+        y1 = minY + k * bandHeight;
+        y2 = int (min<int64_t> (int64_t (y1) + bandHeight - 1, maxY));
+    };
+
+    ILMTHREAD_NAMESPACE::ThreadPool reader (1);
+    exception_ptr                   error;
+    int                             y1, y2;
+
+    bandLines (0, y1, y2);
+    readBand (0, y1, y2);
+
+    for (int k = 0; k < numBands; ++k)
+    {
+        {
+            ILMTHREAD_NAMESPACE::TaskGroup group;
+
+            if (k + 1 < numBands)
+            {
+                int n1, n2;
+                bandLines (k + 1, n1, n2);
+                reader.addTask (new ReadBandTask (
+                    &group, readBand, (k + 1) % 2, n1, n2, error));
+            }
+
+            bandLines (k, y1, y2);
+            writeBand (k % 2, y1, y2);
+        }
+
+        if (error) rethrow_exception (error);
+    }
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
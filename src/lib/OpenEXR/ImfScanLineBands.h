@@ -0,0 +1,60 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_SCAN_LINE_BANDS_H
+#define INCLUDED_IMF_SCAN_LINE_BANDS_H
+
+//-----------------------------------------------------------------------------
+//
+//	Converting an image a band of scan lines at a time, so that
+//	memory use does not depend on its height.
+//
+//	The caller keeps two band buffers. While the scan lines of one
+//	band are written from one buffer, the next band is read into the
+//	other buffer on a separate thread, rather than on the global
+//	thread pool that the compression of both files keeps busy.
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfExport.h"
+#include "ImfNamespace.h"
+
+#include "ImfLineOrder.h"
+
+#include <functional>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+//
+// The number of scan lines in a band: enough chunks of linesPerChunk
+// scan lines to keep the global thread pool busy, and at least 64.
+//
+
+IMF_EXPORT int scanLineBandHeight (int linesPerChunk);
+
+//
+// Convert scan lines minY to maxY, in bands of bandHeight scan lines.
+// The bands are taken in lineOrder, from the bottom of the image up
+// for DECREASING_Y, and from the top down otherwise.
+//
+// readBand(buffer, y1, y2) must read scan lines y1 to y2 into band
+// buffer 0 or 1, and writeBand(buffer, y1, y2) must write them from
+// that buffer. Only readBand() is called on the reading thread, and it
+// is never called for a buffer that is being written. An exception
+// thrown by readBand() or writeBand() is rethrown once the other
+// buffer is done.
+//
+
+IMF_EXPORT void convertScanLineBands (
+    int                                         minY,
+    int                                         maxY,
+    int                                         bandHeight,
+    LineOrder                                   lineOrder,
+    const std::function<void (int, int, int)>& readBand,
+    const std::function<void (int, int, int)>& writeBand);
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
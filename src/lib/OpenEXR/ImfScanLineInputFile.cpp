@@ -22,12 +22,47 @@
 #include "ImfFrameBuffer.h"
 #include "ImfInputPartData.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 namespace {
 
+// index of the channel in the decode pipeline for each frame buffer
+// slice present in the file. Computed once per read such that the
+// per-chunk setup only visits the requested channels, rather than
+// searching the frame buffer for every channel in the file.
+using ChannelSliceList = std::vector<std::pair<int, const Slice*>>;
+
+// integer division rounding down / up, also for negative coordinates
+inline int
+floorDiv (int v, int n)
+{
+    return (v >= 0) ? (v / n) : -((n - 1 - v) / n);
+}
+
+inline int
+ceilDiv (int v, int n)
+{
+    return -floorDiv (-v, n);
+}
+
+// the pixels of a data window whose coordinates are multiples of n
+exr_attr_box2i_t
+decimateWindow (exr_attr_box2i_t dw, int n)
+{
+    if (n > 1)
+    {
+        dw.min.x = ceilDiv (dw.min.x, n);
+        dw.min.y = ceilDiv (dw.min.y, n);
+        dw.max.x = floorDiv (dw.max.x, n);
+        dw.max.y = floorDiv (dw.max.y, n);
+    }
+    return dw;
+}
+
 struct ScanLineProcess
 {
     ~ScanLineProcess ()
@@ -39,7 +74,7 @@ struct ScanLineProcess
     void run_decode (
         exr_const_context_t ctxt,
         int pn,
-        const FrameBuffer *outfb,
+        const ChannelSliceList &slices,
         int fbY,
         int fbLastY,
         const std::vector<Slice> &filllist);
@@ -47,26 +82,48 @@ struct ScanLineProcess
     void run_unpack (
         exr_const_context_t ctxt,
         int pn,
-        const FrameBuffer *outfb,
+        const ChannelSliceList &slices,
         int fbY,
         int fbLastY,
         const std::vector<Slice> &filllist);
 
     void update_pointers (
-        const FrameBuffer *outfb,
+        const ChannelSliceList &slices,
         int fbY,
         int fbLastY);
 
+    void choose_routines (exr_const_context_t ctxt, int pn);
+
+    bool can_unpack_again (const ChannelSliceList &slices) const;
+
     void run_fill (
-        const FrameBuffer *outfb,
         int fbY,
         const std::vector<Slice> &filllist);
 
     exr_result_t          last_decode_err = EXR_ERR_UNKNOWN;
     bool                  first = true;
+    int                   reduction = 0;
+    int                   decimation = 1;
+    bool                  decimateBox = false;
     exr_chunk_info_t      cinfo;
     exr_decode_pipeline_t decoder;
 
+    // columns of the data window to read
+    int                   xMin = 0;
+    int                   xMax = 0;
+
+    // whether the unpack routines were chosen for a column range
+    bool                  chose_cropped = false;
+
+    // decoder channels which currently have an output pointer set
+    std::vector<int>      active;
+
+    // channels and columns requested when the chunk was decoded, as
+    // the decompressor may skip the others
+    std::vector<int>      decoded;
+    int                   decodedXMin = 0;
+    int                   decodedXMax = 0;
+
     // requirement to use process group
     ScanLineProcess* next;
 };
@@ -97,10 +154,31 @@ struct ScanLineInputFile::Data
     Header header;
     bool header_filled = false;
 
+    // resolution levels discarded when decoding
+    int reduction = 0;
+
+    // only every decimation'th pixel of every decimation'th line is
+    // stored, optionally averaging the block it starts
+    int  decimation  = 1;
+    bool decimateBox = false;
+
+    // the data window of the pixels stored by readPixels, after any
+    // resolution reduction and decimation
+    exr_attr_box2i_t readWindow () const
+    {
+        return decimateWindow (
+            _ctxt->reducedDataWindow (partNumber, reduction), decimation);
+    }
+
     // TODO: remove once we can remove deprecated API
     std::vector<char> _pixel_data_scratch;
 
-    void readPixels (const FrameBuffer &fb, int scanLine1, int scanLine2);
+    void readPixels (
+        const FrameBuffer &fb,
+        int scanLine1,
+        int scanLine2,
+        int xMin,
+        int xMax);
 
     // only keep a single stash of a scanline for things which
     // are reading one-scanline at a time. if we try to keep a
@@ -124,7 +202,6 @@ struct ScanLineInputFile::Data
     }
 
     FrameBuffer frameBuffer;
-    std::vector<Slice> fill_list;
 
 #if ILMTHREAD_THREADING_ENABLED
     std::mutex _mx;
@@ -136,19 +213,28 @@ struct ScanLineInputFile::Data
             ILMTHREAD_NAMESPACE::TaskGroup* group,
             Data*                   ifd,
             ScanLineProcessGroup*   lineg,
-            const FrameBuffer*      outfb,
+            const ChannelSliceList* slices,
+            const std::vector<Slice>* fills,
             const exr_chunk_info_t& cinfo,
             int                     fby,
-            int                     endScan)
+            int                     endScan,
+            int                     xMin,
+            int                     xMax)
             : Task (group)
-            , _outfb (outfb)
+            , _slices (slices)
+            , _fills (fills)
             , _ifd (ifd)
             , _fby (fby)
             , _last_fby (endScan)
             , _line (lineg->pop ())
             , _line_group (lineg)
         {
-            _line->cinfo = cinfo;
+            _line->cinfo     = cinfo;
+            _line->reduction   = ifd->reduction;
+            _line->decimation  = ifd->decimation;
+            _line->decimateBox = ifd->decimateBox;
+            _line->xMin      = xMin;
+            _line->xMax      = xMax;
         }
 
         ~LineBufferTask () override
@@ -161,7 +247,8 @@ struct ScanLineInputFile::Data
     private:
         void run_decode ();
 
-        const FrameBuffer*    _outfb;
+        const ChannelSliceList* _slices;
+        const std::vector<Slice>* _fills;
         Data*                 _ifd;
         int                   _fby;
         int                   _last_fby;
@@ -243,7 +330,6 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
 #if ILMTHREAD_THREADING_ENABLED
     std::lock_guard<std::mutex> lock (_data->_mx);
 #endif
-    _data->fill_list.clear ();
     _data->singleScan.reset();
 
     for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
@@ -253,11 +339,7 @@ ScanLineInputFile::setFrameBuffer (const FrameBuffer& frameBuffer)
         const exr_attr_chlist_entry_t* curc = _ctxt.findChannel (
             _data->partNumber, j.name ());
 
-        if (!curc)
-        {
-            _data->fill_list.push_back (j.slice ());
-            continue;
-        }
+        if (!curc) continue;
 
         if (curc->x_sampling != j.slice ().xSampling ||
             curc->y_sampling != j.slice ().ySampling)
@@ -292,6 +374,99 @@ ScanLineInputFile::isComplete () const
     return _ctxt.chunkTableValid (_data->partNumber);
 }
 
+void
+ScanLineInputFile::setResolutionReduction (int levels)
+{
+    // validates the request
+    _ctxt.reducedDataWindow (_data->partNumber, levels);
+
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (_data->_mx);
+#endif
+    if (_data->reduction != levels)
+    {
+        _data->reduction = levels;
+        _data->singleScan.reset ();
+    }
+}
+
+int
+ScanLineInputFile::resolutionReduction () const
+{
+    return _data->reduction;
+}
+
+IMATH_NAMESPACE::Box2i
+ScanLineInputFile::reducedDataWindow () const
+{
+    exr_attr_box2i_t dw =
+        _ctxt.reducedDataWindow (_data->partNumber, _data->reduction);
+    return IMATH_NAMESPACE::Box2i (
+        IMATH_NAMESPACE::V2i (dw.min.x, dw.min.y),
+        IMATH_NAMESPACE::V2i (dw.max.x, dw.max.y));
+}
+
+void
+ScanLineInputFile::setDecimation (int factor, bool average)
+{
+    if (factor < 1)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Invalid decimation factor " << factor << " for file '"
+                                         << fileName () << "'");
+    }
+
+    const exr_attr_chlist_t* chans = _ctxt.channels (_data->partNumber);
+    for (int c = 0; factor > 1 && c < chans->num_channels; ++c)
+    {
+        if (chans->entries[c].x_sampling != 1 ||
+            chans->entries[c].y_sampling != 1)
+        {
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to decimate file '"
+                    << fileName () << "', channel '"
+                    << chans->entries[c].name.str << "' is sub-sampled");
+        }
+    }
+
+    exr_attr_box2i_t dw = decimateWindow (
+        _ctxt.reducedDataWindow (_data->partNumber, _data->reduction), factor);
+    if (dw.min.x > dw.max.x || dw.min.y > dw.max.y)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Decimating file '" << fileName () << "' by " << factor
+                                << " leaves no pixels");
+    }
+
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (_data->_mx);
+#endif
+    if (_data->decimation != factor || _data->decimateBox != average)
+    {
+        _data->decimation  = factor;
+        _data->decimateBox = average;
+        _data->singleScan.reset ();
+    }
+}
+
+int
+ScanLineInputFile::decimation () const
+{
+    return _data->decimation;
+}
+
+IMATH_NAMESPACE::Box2i
+ScanLineInputFile::decimatedDataWindow () const
+{
+    exr_attr_box2i_t dw = _data->readWindow ();
+    return IMATH_NAMESPACE::Box2i (
+        IMATH_NAMESPACE::V2i (dw.min.x, dw.min.y),
+        IMATH_NAMESPACE::V2i (dw.max.x, dw.max.y));
+}
+
 bool
 ScanLineInputFile::isOptimizationEnabled () const
 {
@@ -304,14 +479,46 @@ ScanLineInputFile::isOptimizationEnabled () const
 void
 ScanLineInputFile::readPixels (int scanLine1, int scanLine2)
 {
-    _data->readPixels (frameBuffer (), scanLine1, scanLine2);
+    _data->readPixels (
+        frameBuffer (),
+        scanLine1,
+        scanLine2,
+        std::numeric_limits<int>::min (),
+        std::numeric_limits<int>::max ());
 }
 
 void
 ScanLineInputFile::readPixels (
     const FrameBuffer& frame, int scanLine1, int scanLine2)
 {
-    _data->readPixels (frame, scanLine1, scanLine2);
+    _data->readPixels (
+        frame,
+        scanLine1,
+        scanLine2,
+        std::numeric_limits<int>::min (),
+        std::numeric_limits<int>::max ());
+}
+
+void
+ScanLineInputFile::readPixels (
+    const FrameBuffer& frame, const IMATH_NAMESPACE::Box2i& region)
+{
+    exr_attr_box2i_t dw = _data->readWindow ();
+
+    if (region.min.x > region.max.x || region.min.x < dw.min.x ||
+        region.max.x > dw.max.x)
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Tried to read columns " << region.min.x << " - "
+                                     << region.max.x
+                                     << " outside the image file's "
+                                        "data window: "
+                                     << dw.min.x << " - " << dw.max.x);
+    }
+
+    _data->readPixels (
+        frame, region.min.y, region.max.y, region.min.x, region.max.x);
 }
 
 ////////////////////////////////////////
@@ -412,12 +619,32 @@ ScanLineInputFile::rawPixelDataToBuffer (
 ////////////////////////////////////////
 
 void ScanLineInputFile::Data::readPixels (
-    const FrameBuffer &fb, int scanLine1, int scanLine2)
+    const FrameBuffer &fb, int scanLine1, int scanLine2, int xMin, int xMax)
 {
-    exr_attr_box2i_t dw = _ctxt->dataWindow (partNumber);
+    int              levels = reduction;
+    int              n      = decimation;
+    exr_attr_box2i_t fulldw = _ctxt->dataWindow (partNumber);
+    exr_attr_box2i_t dw     = fulldw;
+    exr_attr_box2i_t ddw    = readWindow ();
     exr_chunk_info_t cinfo;
     int32_t          scansperchunk = 1;
 
+    // when reducing, scan lines are in the reduced data window, and
+    // map to the scan line (1 << levels) times further into the file
+    if (levels > 0) dw = _ctxt->reducedDataWindow (partNumber, levels);
+
+    // when decimating, scan line y is line y * n of the (reduced)
+    // data window, and the next line to read after a chunk is the
+    // first multiple of n after it
+    auto fileLine = [&] (int y) {
+        return fulldw.min.y + ((y * n - dw.min.y) << levels);
+    };
+    auto nextLine = [&] (const exr_chunk_info_t& ci) {
+        return ceilDiv (
+            dw.min.y + ((ci.start_y - fulldw.min.y + scansperchunk) >> levels),
+            n);
+    };
+
     if (EXR_ERR_SUCCESS != exr_get_scanlines_per_chunk (*_ctxt, partNumber, &scansperchunk))
     {
         THROW (
@@ -429,7 +656,7 @@ void ScanLineInputFile::Data::readPixels (
     if (scanLine2 < scanLine1)
         std::swap (scanLine1, scanLine2);
 
-    if (scanLine1 < dw.min.y || scanLine2 > dw.max.y)
+    if (scanLine1 < ddw.min.y || scanLine2 > ddw.max.y)
     {
         THROW (
             IEX_NAMESPACE::ArgExc,
@@ -437,13 +664,29 @@ void ScanLineInputFile::Data::readPixels (
             "the image file's data window: "
             << scanLine1 << " - " << scanLine2
             << " vs datawindow "
-            << dw.min.y << " - " << dw.max.y);
+            << ddw.min.y << " - " << ddw.max.y);
+    }
+
+    xMin = std::max (xMin, ddw.min.x);
+    xMax = std::min (xMax, ddw.max.x);
+
+    // slices for channels not in the file are filled
+    ChannelSliceList   slices;
+    std::vector<Slice> fills;
+    for (FrameBuffer::ConstIterator j = fb.begin (); j != fb.end (); ++j)
+    {
+        int cidx = _ctxt->findChannelIndex (partNumber, j.name ());
+        if (cidx >= 0)
+            slices.push_back (std::make_pair (cidx, &(j.slice ())));
+        else
+            fills.push_back (j.slice ());
     }
 
 #if ILMTHREAD_THREADING_ENABLED
     int64_t nchunks;
     nchunks = ((int64_t) scanLine2 - (int64_t) scanLine1);
-    nchunks /= (int64_t) scansperchunk;
+    nchunks *= (int64_t) n;
+    nchunks /= (int64_t) std::max (scansperchunk >> levels, 1);
     nchunks += 1;
 
     if (nchunks > 1 && numThreads > 1)
@@ -459,13 +702,24 @@ void ScanLineInputFile::Data::readPixels (
 
             for (int y = scanLine1; y <= scanLine2; )
             {
-                if (EXR_ERR_SUCCESS != exr_read_scanline_chunk_info (*_ctxt, partNumber, y, &cinfo))
+                int fileY = fileLine (y);
+                if (EXR_ERR_SUCCESS != exr_read_scanline_chunk_info (*_ctxt, partNumber, fileY, &cinfo))
                     throw IEX_NAMESPACE::InputExc ("Unable to query scanline information");
 
                 ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
-                    new LineBufferTask (&tg, this, &sg, &fb, cinfo, y, scanLine2) );
-
-                y += scansperchunk - (y - cinfo.start_y);
+                    new LineBufferTask (
+                        &tg,
+                        this,
+                        &sg,
+                        &slices,
+                        &fills,
+                        cinfo,
+                        y,
+                        scanLine2,
+                        xMin,
+                        xMax));
+
+                y = nextLine (cinfo);
             }
         }
 
@@ -475,25 +729,35 @@ void ScanLineInputFile::Data::readPixels (
 #endif
     {
         std::unique_ptr<ScanLineProcess> sp = checkoutScan ();
+        if (sp->first)
+        {
+            sp->reduction   = levels;
+            sp->decimation  = n;
+            sp->decimateBox = decimateBox;
+        }
+        sp->xMin = xMin;
+        sp->xMax = xMax;
 
         for (int y = scanLine1; y <= scanLine2; )
         {
-            if (EXR_ERR_SUCCESS != exr_read_scanline_chunk_info (*_ctxt, partNumber, y, &cinfo))
+            int fileY = fileLine (y);
+            if (EXR_ERR_SUCCESS != exr_read_scanline_chunk_info (*_ctxt, partNumber, fileY, &cinfo))
                 throw IEX_NAMESPACE::InputExc ("Unable to query scanline information");
 
             // check if we have the same chunk where we can just
             // re-run the unpack (i.e. people reading 1 scan at a time
             // in a multi-scanline chunk)
             if (!sp->first && sp->cinfo.idx == cinfo.idx &&
-                sp->last_decode_err == EXR_ERR_SUCCESS)
+                sp->last_decode_err == EXR_ERR_SUCCESS &&
+                sp->can_unpack_again (slices))
             {
                 sp->run_unpack (
                     *_ctxt,
                     partNumber,
-                    &fb,
+                    slices,
                     y,
                     scanLine2,
-                    fill_list);
+                    fills);
             }
             else
             {
@@ -501,13 +765,13 @@ void ScanLineInputFile::Data::readPixels (
                 sp->run_decode (
                     *_ctxt,
                     partNumber,
-                    &fb,
+                    slices,
                     y,
                     scanLine2,
-                    fill_list);
+                    fills);
             }
 
-            y += scansperchunk - (y - cinfo.start_y);
+            y = nextLine (cinfo);
         }
 
         checkinScan (sp);
@@ -524,10 +788,10 @@ void ScanLineInputFile::Data::LineBufferTask::execute ()
         _line->run_decode (
             *(_ifd->_ctxt),
             _ifd->partNumber,
-            _outfb,
+            *_slices,
             _fby,
             _last_fby,
-            _ifd->fill_list);
+            *_fills);
     }
     catch (std::exception &e)
     {
@@ -545,7 +809,7 @@ void ScanLineInputFile::Data::LineBufferTask::execute ()
 void ScanLineProcess::run_decode (
     exr_const_context_t ctxt,
     int pn,
-    const FrameBuffer *outfb,
+    const ChannelSliceList &slices,
     int fbY,
     int fbLastY,
     const std::vector<Slice> &filllist)
@@ -563,6 +827,13 @@ void ScanLineProcess::run_decode (
         }
 
         first = false;
+
+        if (reduction > 0 &&
+            EXR_ERR_SUCCESS != exr_decoding_set_resolution_reduction (
+                                   ctxt, pn, &decoder, reduction))
+        {
+            throw IEX_NAMESPACE::IoExc ("Unable to reduce decode resolution");
+        }
     }
     else
     {
@@ -573,22 +844,22 @@ void ScanLineProcess::run_decode (
         }
     }
 
-    update_pointers (outfb, fbY, fbLastY);
+    update_pointers (slices, fbY, fbLastY);
 
-    if (isfirst)
-    {
-        if (EXR_ERR_SUCCESS !=
-            exr_decoding_choose_default_routines (ctxt, pn, &decoder))
-        {
-            throw IEX_NAMESPACE::IoExc ("Unable to choose decoder routines");
-        }
-    }
+    bool cropped = decoder.user_column_begin_skip > 0 ||
+                   decoder.user_column_end_ignore > 0;
+    if (isfirst || cropped != chose_cropped)
+        choose_routines (ctxt, pn);
 
     last_decode_err = exr_decoding_run (ctxt, pn, &decoder);
     if (EXR_ERR_SUCCESS != last_decode_err)
         throw IEX_NAMESPACE::IoExc ("Unable to run decoder");
 
-    run_fill (outfb, fbY, filllist);
+    decoded     = active;
+    decodedXMin = xMin;
+    decodedXMax = xMax;
+
+    run_fill (fbY, filllist);
 }
 
 ////////////////////////////////////////
@@ -596,12 +867,17 @@ void ScanLineProcess::run_decode (
 void ScanLineProcess::run_unpack (
     exr_const_context_t ctxt,
     int pn,
-    const FrameBuffer *outfb,
+    const ChannelSliceList &slices,
     int fbY,
     int fbLastY,
     const std::vector<Slice> &filllist)
 {
-    update_pointers (outfb, fbY, fbLastY);
+    update_pointers (slices, fbY, fbLastY);
+
+    bool cropped = decoder.user_column_begin_skip > 0 ||
+                   decoder.user_column_end_ignore > 0;
+    if (cropped != chose_cropped)
+        choose_routines (ctxt, pn);
 
     /* won't work for deep where we need to re-allocate the number of
      * samples but for normal scanlines is fine to just bypass pipe
@@ -613,73 +889,160 @@ void ScanLineProcess::run_unpack (
             throw IEX_NAMESPACE::IoExc ("Unable to run decoder");
     }
 
-    run_fill (outfb, fbY, filllist);
+    run_fill (fbY, filllist);
+}
+
+////////////////////////////////////////
+
+void ScanLineProcess::choose_routines (exr_const_context_t ctxt, int pn)
+{
+    if (EXR_ERR_SUCCESS !=
+        exr_decoding_choose_default_routines (ctxt, pn, &decoder))
+    {
+        throw IEX_NAMESPACE::IoExc ("Unable to choose decoder routines");
+    }
+    chose_cropped = decoder.user_column_begin_skip > 0 ||
+                    decoder.user_column_end_ignore > 0;
+}
+
+////////////////////////////////////////
+
+bool ScanLineProcess::can_unpack_again (const ChannelSliceList &slices) const
+{
+    // uncompressed chunks are read straight into the frame buffer
+    if (!decoder.unpack_and_convert_fn)
+        return false;
+
+    if (decoder.decode_flags & EXR_DECODE_REQUESTED_CHANNELS_ONLY)
+    {
+        if (xMin < decodedXMin || xMax > decodedXMax)
+            return false;
+
+        for (auto& sc: slices)
+        {
+            if (decoder.channels[sc.first].height != 0 &&
+                std::find (decoded.begin (), decoded.end (), sc.first) ==
+                    decoded.end ())
+                return false;
+        }
+    }
+    return true;
 }
 
 ////////////////////////////////////////
 
 void ScanLineProcess::update_pointers (
-    const FrameBuffer *outfb, int fbY, int fbLastY)
+    const ChannelSliceList &slices, int fbY, int fbLastY)
 {
-    decoder.user_line_begin_skip = fbY - cinfo.start_y;
-    decoder.user_line_end_ignore = 0;
-    int64_t endY = (int64_t)cinfo.start_y + (int64_t)cinfo.height - 1;
-    if ((int64_t)fbLastY < endY)
-        decoder.user_line_end_ignore = (int32_t)(endY - fbLastY);
+    // the chunk as decoded, which differs from cinfo when reducing
+    const exr_chunk_info_t& chunk = decoder.chunk;
+
+    // when decimating, the frame buffer lines and columns are a
+    // factor n apart in the chunk, and the range read extends to the
+    // end of the block started by the last one
+    const int n    = decimation;
+    const int tail = n - 1;
+
+    decoder.user_decimation = n;
+    if (decimateBox)
+        decoder.decode_flags |= EXR_DECODE_DECIMATE_BOX_FILTER;
+    else
+        decoder.decode_flags &= ~EXR_DECODE_DECIMATE_BOX_FILTER;
 
-    for (int c = 0; c < decoder.channel_count; ++c)
+    decoder.user_line_begin_skip = fbY * n - chunk.start_y;
+    decoder.user_line_end_ignore = 0;
+    int64_t endY = (int64_t)chunk.start_y + (int64_t)chunk.height - 1;
+    int64_t lastY = (int64_t)fbLastY * n + tail;
+    if (lastY < endY)
+        decoder.user_line_end_ignore = (int32_t)(endY - lastY);
+
+    decoder.user_column_begin_skip = std::max (xMin * n - chunk.start_x, 0);
+    decoder.user_column_end_ignore =
+        std::max (chunk.start_x + chunk.width - 1 - (xMax * n + tail), 0);
+
+    // channels not in the frame buffer are left with a NULL output
+    // pointer from initialization, so only the channels touched by
+    // the previous chunk need to be reset
+    for (int c: active)
     {
         exr_coding_channel_info_t& curchan = decoder.channels[c];
-        uint8_t*                   ptr;
-        const Slice*               fbslice;
 
-        fbslice = outfb->findSlice (curchan.channel_name);
+        curchan.decode_to_ptr     = NULL;
+        curchan.user_pixel_stride = 0;
+        curchan.user_line_stride  = 0;
+    }
+    active.clear ();
 
-        if (curchan.height == 0 || !fbslice)
-        {
-            curchan.decode_to_ptr     = NULL;
-            curchan.user_pixel_stride = 0;
-            curchan.user_line_stride  = 0;
+    for (auto& sc: slices)
+    {
+        exr_coding_channel_info_t& curchan = decoder.channels[sc.first];
+        uint8_t*                   ptr;
+        const Slice*               fbslice = sc.second;
+
+        if (curchan.height == 0)
             continue;
-        }
 
         curchan.user_bytes_per_element = (fbslice->type == HALF) ? 2 : 4;
         curchan.user_data_type         = (exr_pixel_type_t)fbslice->type;
         curchan.user_pixel_stride      = fbslice->xStride;
         curchan.user_line_stride       = fbslice->yStride;
 
+        // the first sample of the channel in the column range, there
+        // is no sub-sampling when decimating
+        int firstx = chunk.start_x / fbslice->xSampling +
+                     (decoder.user_column_begin_skip + fbslice->xSampling - 1) /
+                         fbslice->xSampling;
+        if (n > 1) firstx = std::max (xMin, ceilDiv (chunk.start_x, n));
+
         ptr  = reinterpret_cast<uint8_t*> (fbslice->base);
-        ptr += int64_t (cinfo.start_x / fbslice->xSampling) * int64_t (fbslice->xStride);
+        ptr += int64_t (firstx) * int64_t (fbslice->xStride);
         ptr += int64_t (fbY / fbslice->ySampling) * int64_t (fbslice->yStride);
 
         curchan.decode_to_ptr = ptr;
+        active.push_back (sc.first);
     }
 }
 
 ////////////////////////////////////////
 
 void ScanLineProcess::run_fill (
-    const FrameBuffer *outfb,
     int fbY,
     const std::vector<Slice> &filllist)
 {
+    const exr_chunk_info_t& chunk = decoder.chunk;
+
     for (auto& s: filllist)
     {
         uint8_t*       ptr;
 
+        int skip   = decoder.user_column_begin_skip;
+        int firstx = chunk.start_x + skip;
+        int endx   = chunk.start_x + chunk.width - decoder.user_column_end_ignore;
+        int stop   = chunk.start_y + chunk.height - decoder.user_line_end_ignore;
+
         ptr  = reinterpret_cast<uint8_t*> (s.base);
-        ptr += int64_t (cinfo.start_x / s.xSampling) * int64_t (s.xStride);
+        if (decimation > 1)
+        {
+            // columns and lines of the decimated frame buffer
+            firstx = ceilDiv (firstx, decimation);
+            endx   = floorDiv (endx - 1, decimation) + 1;
+            stop   = floorDiv (stop - 1, decimation) + 1;
+            ptr += int64_t (ceilDiv (firstx, s.xSampling)) * int64_t (s.xStride);
+        }
+        else
+        {
+            ptr += int64_t (chunk.start_x / s.xSampling + (skip + s.xSampling - 1) / s.xSampling) *
+                   int64_t (s.xStride);
+        }
         ptr += int64_t (fbY / s.ySampling) * int64_t (s.yStride);
 
         // TODO: update ImfMisc, lift fill type / value
-        int stop = cinfo.start_y + cinfo.height - decoder.user_line_end_ignore;
         for ( int start = fbY; start < stop; ++start )
         {
             if (start % s.ySampling) continue;
 
             uint8_t* outptr = ptr;
-            for ( int sx = cinfo.start_x, ex = cinfo.start_x + cinfo.width;
-                  sx < ex; ++sx )
+            for ( int sx = firstx; sx < endx; ++sx )
             {
                 if (sx % s.xSampling) continue;
 
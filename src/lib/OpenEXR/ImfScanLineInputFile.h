@@ -98,6 +98,57 @@ public:
     IMF_EXPORT
     bool isComplete () const;
 
+    //---------------------------------------------------------------
+    // Reduced resolution decoding:
+    //
+    // setResolutionReduction(n) causes subsequent calls to
+    // readPixels() to decode the image at 1/2^n of its resolution in
+    // each direction, by skipping the finest wavelet levels of the
+    // compressed data, which is much faster than decoding the full
+    // image. Scan line numbers and the frame buffer are then
+    // relative to reducedDataWindow() rather than the data window
+    // of the header. This is intended for proxies and thumbnails,
+    // and requires HTJ2K compression, no sub-sampled channels, and
+    // 2^n to divide the number of scan lines per chunk; otherwise
+    // an exception is thrown. DWAA and DWAB compressed files can be
+    // decoded at 1/8 resolution (n = 3) from the DC coefficients of
+    // the DCT blocks. setResolutionReduction(0) restores decoding at
+    // full resolution.
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void setResolutionReduction (int levels);
+
+    IMF_EXPORT
+    int resolutionReduction () const;
+
+    IMF_EXPORT
+    IMATH_NAMESPACE::Box2i reducedDataWindow () const;
+
+    //---------------------------------------------------------------
+    // Decimated reading:
+    //
+    // setDecimation(n) causes subsequent calls to readPixels() to
+    // store only the pixels whose x and y coordinates are multiples
+    // of n, such that a small thumbnail can be read without a frame
+    // buffer for the whole image. Scan line numbers, regions and the
+    // frame buffer are then relative to decimatedDataWindow(), which
+    // holds the data window (or reducedDataWindow()) divided by n.
+    // If average is true, each pixel stored is the average of the
+    // n by n block of pixels it is the top left corner of, clipped
+    // to the chunk it is in. Files with sub-sampled channels cannot
+    // be decimated. setDecimation(1) restores reading every pixel.
+    //---------------------------------------------------------------
+
+    IMF_EXPORT
+    void setDecimation (int factor, bool average = false);
+
+    IMF_EXPORT
+    int decimation () const;
+
+    IMF_EXPORT
+    IMATH_NAMESPACE::Box2i decimatedDataWindow () const;
+
     //---------------------------------------------------------------
     // Check if SSE optimisation is enabled
     //
@@ -155,6 +206,24 @@ public:
     void readPixels (
         const FrameBuffer& frame, int scanLine1, int scanLine2);
 
+    //----------------------------------------------
+    // Read a region of pixel data:
+    //
+    // readPixels(frame, region) behaves like readPixels(frame,
+    // region.min.y, region.max.y), but only the columns within
+    // [region.min.x, region.max.x] are unpacked and stored in the
+    // frame buffer, such that the frame buffer need only cover the
+    // region, for instance when re-reading crops of full width scan
+    // lines. The slices are still addressed in data window
+    // coordinates, and the region must lie within the data window
+    // (or within reducedDataWindow() when reading at reduced
+    // resolution).
+    //----------------------------------------------
+
+    IMF_EXPORT
+    void readPixels (
+        const FrameBuffer& frame, const IMATH_NAMESPACE::Box2i& region);
+
     //----------------------------------------------
     // Read a block of raw pixel data from the file,
     // without uncompressing it (this function is
@@ -15,6 +15,16 @@
 #include "ImfStdIO.h"
 #include <errno.h>
 #include <filesystem>
+#ifdef _WIN32
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
 #if __cplusplus >= 202002L
 #    include <ranges>
 #    include <span>
@@ -28,32 +38,30 @@ OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 namespace
 {
 
-inline ifstream*
-make_ifstream (const char* filename)
+inline filesystem::path
+make_u8path (const char* filename)
 {
 #if __cplusplus >= 202002L
     auto u8view = ranges::views::transform (span{filename, strlen(filename)},
                                             [](char c) -> char8_t { return c; });
-    return new ifstream (filesystem::path (u8view.begin (), u8view.end ()),
-                         ios_base::in | ios_base::binary);
+    return filesystem::path (u8view.begin (), u8view.end ());
 #else
-    return new ifstream (filesystem::u8path (filename),
-                         ios_base::in | ios_base::binary);
+    return filesystem::u8path (filename);
 #endif
 }
 
+inline ifstream*
+make_ifstream (const char* filename)
+{
+    return new ifstream (make_u8path (filename),
+                         ios_base::in | ios_base::binary);
+}
+
 inline ofstream*
 make_ofstream (const char* filename)
 {
-#if __cplusplus >= 202002L
-    auto u8view = ranges::views::transform (span{filename, strlen(filename)},
-                                            [](char c) -> char8_t { return c; });
-    return new ofstream (filesystem::path (u8view.begin (), u8view.end ()),
-                         ios_base::out | ios_base::binary);
-#else
-    return new ofstream (filesystem::u8path (filename),
+    return new ofstream (make_u8path (filename),
                          ios_base::out | ios_base::binary);
-#endif
 }
 
 void
@@ -149,6 +157,140 @@ StdIFStream::clear ()
     _is->clear ();
 }
 
+StdStatelessIFStream::StdStatelessIFStream (const char fileName[])
+    : OPENEXR_IMF_INTERNAL_NAMESPACE::IStream (fileName), _pos (0), _size (-1)
+{
+    filesystem::path p = make_u8path (fileName);
+
+#ifdef _WIN32
+    HANDLE fh = CreateFileW (
+        p.c_str (),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        NULL,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Unable to open file " << fileName << " (error "
+                                   << GetLastError () << ").");
+
+    LARGE_INTEGER lsz;
+    if (GetFileSizeEx (fh, &lsz)) _size = static_cast<int64_t> (lsz.QuadPart);
+    _handle = fh;
+#else
+    int flags = O_RDONLY;
+#    ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#    endif
+    do
+    {
+        _fd = open (p.c_str (), flags);
+    } while (_fd < 0 && errno == EINTR);
+    if (_fd < 0) IEX_NAMESPACE::throwErrnoExc ();
+
+    struct stat sbuf;
+    if (fstat (_fd, &sbuf) == 0) _size = static_cast<int64_t> (sbuf.st_size);
+#endif
+}
+
+StdStatelessIFStream::~StdStatelessIFStream ()
+{
+#ifdef _WIN32
+    CloseHandle (static_cast<HANDLE> (_handle));
+#else
+    close (_fd);
+#endif
+}
+
+bool
+StdStatelessIFStream::read (char c[/*n*/], int n)
+{
+    int64_t nread = read (c, static_cast<uint64_t> (n), _pos);
+
+    if (nread < n)
+    {
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Early end of file: read " << nread << " out of " << n
+                                       << " requested bytes.");
+    }
+
+    _pos += static_cast<uint64_t> (n);
+    return _size < 0 || _pos < static_cast<uint64_t> (_size);
+}
+
+uint64_t
+StdStatelessIFStream::tellg ()
+{
+    return _pos;
+}
+
+void
+StdStatelessIFStream::seekg (uint64_t pos)
+{
+    _pos = pos;
+}
+
+int64_t
+StdStatelessIFStream::size ()
+{
+    return _size;
+}
+
+bool
+StdStatelessIFStream::isStatelessRead () const
+{
+    return true;
+}
+
+int64_t
+StdStatelessIFStream::read (void* buf, uint64_t sz, uint64_t offset)
+{
+    char*   cur   = static_cast<char*> (buf);
+    int64_t total = 0;
+
+    while (sz > 0)
+    {
+#ifdef _WIN32
+        DWORD      toread  = static_cast<DWORD> (sz > 0x40000000 ? 0x40000000 : sz);
+        DWORD      nread   = 0;
+        OVERLAPPED overlap = {0};
+
+        overlap.Offset     = static_cast<DWORD> (offset & 0xFFFFFFFF);
+        overlap.OffsetHigh = static_cast<DWORD> (offset >> 32);
+        if (!ReadFile (static_cast<HANDLE> (_handle), cur, toread, &nread, &overlap))
+        {
+            DWORD err = GetLastError ();
+            if (err == ERROR_HANDLE_EOF) break;
+            THROW (
+                IEX_NAMESPACE::InputExc,
+                "Unable to read from file " << fileName () << " (error "
+                                            << err << ").");
+        }
+        int64_t rv = static_cast<int64_t> (nread);
+#else
+        size_t  toread = static_cast<size_t> (sz > 0x40000000 ? 0x40000000 : sz);
+        ssize_t rv     = pread (_fd, cur, toread, static_cast<off_t> (offset));
+        if (rv < 0)
+        {
+            if (errno == EINTR) continue;
+            IEX_NAMESPACE::throwErrnoExc ();
+        }
+#endif
+        if (rv == 0) break;
+
+        cur += rv;
+        total += rv;
+        offset += static_cast<uint64_t> (rv);
+        sz -= static_cast<uint64_t> (rv);
+    }
+
+    return total;
+}
+
 StdISStream::StdISStream ()
     : OPENEXR_IMF_INTERNAL_NAMESPACE::IStream ("(string)")
 {
@@ -67,6 +67,50 @@ private:
     bool           _deleteStream;
 };
 
+//-------------------------------------------------------------
+// class StdStatelessIFStream -- an implementation of class
+// OPENEXR_IMF_INTERNAL_NAMESPACE::IStream reading a file through
+// a native file descriptor (pread, or overlapped ReadFile on
+// Windows).  It supports stateless reads, so multiple threads
+// may read from the stream at once without serializing on a
+// shared file position.
+//-------------------------------------------------------------
+
+class IMF_EXPORT_TYPE StdStatelessIFStream
+    : public OPENEXR_IMF_INTERNAL_NAMESPACE::IStream
+{
+public:
+    //-------------------------------------------------------
+    // A constructor that opens the file with the given name.
+    // The destructor will close the file.
+    //-------------------------------------------------------
+
+    IMF_EXPORT StdStatelessIFStream (const char fileName[]);
+
+    IMF_EXPORT virtual ~StdStatelessIFStream ();
+    StdStatelessIFStream (const StdStatelessIFStream&)            = delete;
+    StdStatelessIFStream (StdStatelessIFStream&&)                 = delete;
+    StdStatelessIFStream& operator= (const StdStatelessIFStream&) = delete;
+    StdStatelessIFStream& operator= (StdStatelessIFStream&&)      = delete;
+
+    IMF_EXPORT virtual bool     read (char c[/*n*/], int n);
+    IMF_EXPORT virtual uint64_t tellg ();
+    IMF_EXPORT virtual void     seekg (uint64_t pos);
+    IMF_EXPORT virtual int64_t  size ();
+
+    IMF_EXPORT virtual bool    isStatelessRead () const;
+    IMF_EXPORT virtual int64_t read (void* buf, uint64_t sz, uint64_t offset);
+
+private:
+#ifdef _WIN32
+    void* _handle;
+#else
+    int _fd;
+#endif
+    uint64_t _pos;
+    int64_t  _size;
+};
+
 //------------------------------------------------
 // class StdISStream -- an implementation of class
 // OPENEXR_IMF_INTERNAL_NAMESPACE::IStream, based on class std::istringstream
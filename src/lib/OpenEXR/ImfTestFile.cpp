@@ -24,7 +24,7 @@ isOpenExrFile (const char fileName[], bool& tiled, bool& deep, bool& multiPart)
 {
     try
     {
-        StdIFStream is (fileName);
+        StdStatelessIFStream is (fileName);
 
         int magic, version;
         Xdr::read<StreamIO> (is, magic);
@@ -33,6 +33,12 @@ OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
 namespace {
 
+// index of the channel in the decode pipeline for each frame buffer
+// slice present in the file. Computed once per read such that the
+// per-tile setup only visits the requested channels, rather than
+// searching the frame buffer for every channel in the file.
+using ChannelSliceList = std::vector<std::pair<int, const Slice*>>;
+
 struct TileProcess
 {
     ~TileProcess ()
@@ -44,24 +50,25 @@ struct TileProcess
     void run_decode (
         exr_const_context_t ctxt,
         int pn,
-        const FrameBuffer *outfb,
+        const ChannelSliceList &slices,
         const std::vector<Slice> &filllist);
 
     void update_pointers (
-        const FrameBuffer *outfb,
-        int fb_absX, int fb_absY,
+        const ChannelSliceList &slices,
         int t_absX, int t_absY);
 
     void run_fill (
-        const FrameBuffer *outfb,
-        int fb_absX, int fb_absY,
         int t_absX, int t_absY,
         const std::vector<Slice> &filllist);
 
     bool                  first = true;
+    int                   reduction = 0;
     exr_chunk_info_t      cinfo;
     exr_decode_pipeline_t decoder;
 
+    // decoder channels which currently have an output pointer set
+    std::vector<int>      active;
+
     TileProcess*          next;
 };
 
@@ -122,6 +129,9 @@ struct TiledInputFile::Data
     int32_t num_x_levels = 0;
     int32_t num_y_levels = 0;
 
+    // resolution levels discarded when decoding
+    int reduction = 0;
+
     // TODO: remove once we can remove deprecated API
     std::vector<char> _tile_data_scratch;
 
@@ -140,15 +150,16 @@ struct TiledInputFile::Data
             ILMTHREAD_NAMESPACE::TaskGroup* group,
             Data*                   ifd,
             TileProcessGroup*       tileg,
-            const FrameBuffer*      outfb,
+            const ChannelSliceList* slices,
             const exr_chunk_info_t& cinfo)
             : Task (group)
-            , _outfb (outfb)
+            , _slices (slices)
             , _ifd (ifd)
             , _tile (tileg->pop ())
             , _tile_group (tileg)
         {
-            _tile->cinfo = cinfo;
+            _tile->cinfo     = cinfo;
+            _tile->reduction = ifd->reduction;
         }
 
         ~TileBufferTask () override
@@ -161,7 +172,7 @@ struct TiledInputFile::Data
     private:
         void run_decode ();
 
-        const FrameBuffer* _outfb;
+        const ChannelSliceList* _slices;
         Data*              _ifd;
 
         TileProcess*       _tile;
@@ -289,6 +300,34 @@ TiledInputFile::isComplete () const
     return _ctxt.chunkTableValid (_data->partNumber);
 }
 
+void
+TiledInputFile::setResolutionReduction (int levels)
+{
+    // validates the request
+    _ctxt.reducedDataWindow (_data->partNumber, levels);
+
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (_data->_mx);
+#endif
+    _data->reduction = levels;
+}
+
+int
+TiledInputFile::resolutionReduction () const
+{
+    return _data->reduction;
+}
+
+IMATH_NAMESPACE::Box2i
+TiledInputFile::reducedDataWindow () const
+{
+    exr_attr_box2i_t dw =
+        _ctxt.reducedDataWindow (_data->partNumber, _data->reduction);
+    return IMATH_NAMESPACE::Box2i (
+        IMATH_NAMESPACE::V2i (dw.min.x, dw.min.y),
+        IMATH_NAMESPACE::V2i (dw.max.x, dw.max.y));
+}
+
 void
 TiledInputFile::readTiles (int dx1, int dx2, int dy1, int dy2, int lx, int ly)
 {
@@ -399,6 +438,47 @@ TiledInputFile::rawTileData (
     }
 }
 
+void
+TiledInputFile::rawTileDataToBuffer (
+    int dx, int dy, int lx, int ly, char* pixelData, int& pixelDataSize) const
+{
+    exr_chunk_info_t cinfo;
+    if (EXR_ERR_SUCCESS != exr_read_tile_chunk_info (
+            _ctxt, _data->partNumber, dx, dy, lx, ly, &cinfo))
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Error reading chunk information for tile from image "
+            "file \""
+                << fileName () << "\". Unable to read raw tile offset information.");
+    }
+
+    if (pixelDataSize < 0 ||
+        cinfo.packed_size > static_cast<uint64_t> (pixelDataSize))
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Error reading pixel data from image "
+            "file \""
+                << fileName ()
+                << "\". Provided buffer is too small to read raw tile data:"
+                << pixelDataSize << " bytes.");
+    }
+
+    pixelDataSize = static_cast<int> (cinfo.packed_size);
+
+    if (EXR_ERR_SUCCESS !=
+        exr_read_chunk (_ctxt, _data->partNumber, &cinfo, pixelData))
+    {
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Error reading pixel data from image "
+            "file \""
+                << fileName () << "\". Unable to read raw tile data of "
+                << pixelDataSize << " bytes.");
+    }
+}
+
 unsigned int
 TiledInputFile::tileXSize () const
 {
@@ -764,6 +844,17 @@ void TiledInputFile::Data::readTiles (int dx1, int dx2, int dy1, int dy2, int lx
     nTiles *= dy2 - dy1 + 1;
 
     exr_chunk_info_t      cinfo;
+
+    ChannelSliceList slices;
+    for (FrameBuffer::ConstIterator j = frameBuffer.begin ();
+         j != frameBuffer.end ();
+         ++j)
+    {
+        int cidx = _ctxt->findChannelIndex (partNumber, j.name ());
+        if (cidx >= 0)
+            slices.push_back (std::make_pair (cidx, &(j.slice ())));
+    }
+
 #if ILMTHREAD_THREADING_ENABLED
     if (nTiles > 1 && numThreads > 1)
     {
@@ -793,7 +884,7 @@ void TiledInputFile::Data::readTiles (int dx1, int dx2, int dy1, int dy2, int lx
                         throw IEX_NAMESPACE::InputExc ("Unable to query tile information");
 
                     ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
-                        new TileBufferTask (&tg, this, &tpg, &frameBuffer, cinfo) );
+                        new TileBufferTask (&tg, this, &tpg, &slices, cinfo) );
                 }
             }
         }
@@ -804,6 +895,7 @@ void TiledInputFile::Data::readTiles (int dx1, int dx2, int dy1, int dy2, int lx
 #endif
     {
         TileProcess tp;
+        tp.reduction = reduction;
 
         for (int ty = dy1; ty <= dy2; ++ty)
         {
@@ -825,7 +917,7 @@ void TiledInputFile::Data::readTiles (int dx1, int dx2, int dy1, int dy2, int lx
                 tp.run_decode (
                     *_ctxt,
                     partNumber,
-                    &frameBuffer,
+                    slices,
                     fill_list);
             }
         }
@@ -842,7 +934,7 @@ void TiledInputFile::Data::TileBufferTask::execute ()
         _tile->run_decode (
             *(_ifd->_ctxt),
             _ifd->partNumber,
-            _outfb,
+            *_slices,
             _ifd->fill_list);
     }
     catch (std::exception &e)
@@ -861,7 +953,7 @@ void TiledInputFile::Data::TileBufferTask::execute ()
 void TileProcess::run_decode (
     exr_const_context_t ctxt,
     int pn,
-    const FrameBuffer *outfb,
+    const ChannelSliceList &slices,
     const std::vector<Slice> &filllist)
 {
     int absX, absY, tileX, tileY;
@@ -879,6 +971,13 @@ void TileProcess::run_decode (
         }
 
         first = false;
+
+        if (reduction > 0 &&
+            EXR_ERR_SUCCESS != exr_decoding_set_resolution_reduction (
+                                   ctxt, pn, &decoder, reduction))
+        {
+            throw IEX_NAMESPACE::IoExc ("Unable to reduce decode resolution");
+        }
     }
     else
     {
@@ -889,17 +988,18 @@ void TileProcess::run_decode (
         }
     }
 
-    if (EXR_ERR_SUCCESS != exr_get_data_window (ctxt, pn, &dw))
+    if (EXR_ERR_SUCCESS !=
+        exr_get_reduced_data_window (ctxt, pn, reduction, &dw))
         throw IEX_NAMESPACE::ArgExc ("Unable to query the data window.");
 
     if (EXR_ERR_SUCCESS != exr_get_tile_sizes (
             ctxt, pn, cinfo.level_x, cinfo.level_y, &tileX, &tileY))
         throw IEX_NAMESPACE::ArgExc ("Unable to query the data window.");
 
-    absX = dw.min.x + tileX * cinfo.start_x;
-    absY = dw.min.y + tileY * cinfo.start_y;
+    absX = dw.min.x + (tileX >> reduction) * cinfo.start_x;
+    absY = dw.min.y + (tileY >> reduction) * cinfo.start_y;
 
-    update_pointers (outfb, dw.min.x, dw.min.y, absX, absY);
+    update_pointers (slices, absX, absY);
 
     if (isfirst)
     {
@@ -913,31 +1013,38 @@ void TileProcess::run_decode (
     if (EXR_ERR_SUCCESS != exr_decoding_run (ctxt, pn, &decoder))
         throw IEX_NAMESPACE::IoExc ("Unable to run decoder");
 
-    run_fill (outfb, dw.min.x, dw.min.y, absX, absY, filllist);
+    run_fill (absX, absY, filllist);
 }
 
 ////////////////////////////////////////
 
-void TileProcess::update_pointers (const FrameBuffer *outfb, int fb_absX, int fb_absY, int t_absX, int t_absY)
+void TileProcess::update_pointers (
+    const ChannelSliceList &slices, int t_absX, int t_absY)
 {
     decoder.user_line_begin_skip = 0;
     decoder.user_line_end_ignore = 0;
 
-    for (int c = 0; c < decoder.channel_count; ++c)
+    // channels not in the frame buffer are left with a NULL output
+    // pointer from initialization, so only the channels touched by
+    // the previous tile need to be reset
+    for (int c: active)
     {
         exr_coding_channel_info_t& curchan = decoder.channels[c];
-        uint8_t*                   ptr;
-        const Slice*               fbslice;
 
-        fbslice = outfb->findSlice (curchan.channel_name);
+        curchan.decode_to_ptr     = NULL;
+        curchan.user_pixel_stride = 0;
+        curchan.user_line_stride  = 0;
+    }
+    active.clear ();
 
-        if (curchan.height == 0 || !fbslice)
-        {
-            curchan.decode_to_ptr     = NULL;
-            curchan.user_pixel_stride = 0;
-            curchan.user_line_stride  = 0;
+    for (auto& sc: slices)
+    {
+        exr_coding_channel_info_t& curchan = decoder.channels[sc.first];
+        uint8_t*                   ptr;
+        const Slice*               fbslice = sc.second;
+
+        if (curchan.height == 0)
             continue;
-        }
 
         if (fbslice->xSampling != 1 || fbslice->ySampling != 1)
             throw IEX_NAMESPACE::ArgExc ("Tiled data should not have subsampling.");
@@ -955,14 +1062,14 @@ void TileProcess::update_pointers (const FrameBuffer *outfb, int fb_absX, int fb
         ptr += int64_t (yOffset) * int64_t (fbslice->yStride);
 
         curchan.decode_to_ptr = ptr;
+        active.push_back (sc.first);
     }
 }
 
 ////////////////////////////////////////
 
 void TileProcess::run_fill (
-    const FrameBuffer *outfb, int fb_absX, int fb_absY, int t_absX, int t_absY,
-    const std::vector<Slice> &filllist)
+    int t_absX, int t_absY, const std::vector<Slice> &filllist)
 {
     for (auto& s: filllist)
     {
@@ -979,12 +1086,12 @@ void TileProcess::run_fill (
         ptr += int64_t (yOffset) * int64_t (s.yStride);
 
         // TODO: update ImfMisc, lift fill type / value
-        for ( int start = 0; start < cinfo.height; ++start )
+        for ( int start = 0; start < decoder.chunk.height; ++start )
         {
             if (start % s.ySampling) continue;
 
             uint8_t* outptr = ptr;
-            for ( int sx = 0; sx < cinfo.width; ++sx )
+            for ( int sx = 0; sx < decoder.chunk.width; ++sx )
             {
                 if (sx % s.xSampling) continue;
 
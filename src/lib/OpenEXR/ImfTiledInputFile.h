@@ -116,6 +116,36 @@ public:
     IMF_EXPORT
     bool isComplete () const;
 
+    //------------------------------------------------------------
+    // Reduced resolution decoding:
+    //
+    // setResolutionReduction(n) causes subsequent calls to
+    // readTile() and readTiles() to decode the tiles at 1/2^n of
+    // their resolution in each direction, by skipping the finest
+    // wavelet levels of the compressed data. Tile and level numbers
+    // are unchanged, but the pixels of tile (dx, dy) are stored in
+    // the frame buffer at
+    //
+    //      (reducedDataWindow().min.x + dx * tileXSize() / 2^n,
+    //       reducedDataWindow().min.y + dy * tileYSize() / 2^n)
+    //
+    // This is intended for proxies and thumbnails, and requires
+    // HTJ2K compression (or DWA compression with n = 3) and 2^n to
+    // divide the tile sizes; otherwise an exception is thrown.
+    // setResolutionReduction(0) restores decoding at full
+    // resolution. The other utility functions below always describe
+    // the file at full resolution.
+    //------------------------------------------------------------
+
+    IMF_EXPORT
+    void setResolutionReduction (int levels);
+
+    IMF_EXPORT
+    int resolutionReduction () const;
+
+    IMF_EXPORT
+    IMATH_NAMESPACE::Box2i reducedDataWindow () const;
+
     //--------------------------------------------------
     // Utility functions:
     //--------------------------------------------------
@@ -366,6 +396,17 @@ private:
     IMF_HIDDEN
     void  tileOrder (int dx[], int dy[], int lx[], int ly[]) const;
 
+    //
+    // Like rawTileData(), but reading into a buffer of pixelDataSize
+    // bytes provided by the caller, and safe to call from several
+    // threads at once (for TiledOutputFile::copyPixels()).
+    //
+
+    IMF_HIDDEN
+    void rawTileDataToBuffer (
+        int dx, int dy, int lx, int ly, char* pixelData, int& pixelDataSize)
+        const;
+
     friend class TiledOutputFile;
 };
 
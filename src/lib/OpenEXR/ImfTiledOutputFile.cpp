@@ -24,6 +24,7 @@
 #include "ImfMisc.h"
 #include "ImfPartType.h"
 #include "ImfPreviewImageAttribute.h"
+#include "ImfRawChunkCopy.h"
 #include "ImfStdIO.h"
 #include "ImfThreading.h"
 #include "ImfTileDescriptionAttribute.h"
@@ -1561,19 +1562,17 @@ TiledOutputFile::copyPixels (TiledInputFile& in)
         _data->nextTileToWrite.ly = ly_table[0];
     }
 
-    for (int i = 0; i < numAllTiles; ++i)
-    {
-        const char* pixelData;
-        int         pixelDataSize;
+    //
+    // List the tiles in the order they are written, then copy them,
+    // reading them in parallel, using as many tile buffers' worth of
+    // memory as writing tiles would.
+    //
 
-        int dx = _data->nextTileToWrite.dx;
-        int dy = _data->nextTileToWrite.dy;
-        int lx = _data->nextTileToWrite.lx;
-        int ly = _data->nextTileToWrite.ly;
+    std::vector<TileCoord> tiles (numAllTiles);
 
-        in.rawTileData (dx, dy, lx, ly, pixelData, pixelDataSize);
-        writeTileData (
-            _streamData, _data, dx, dy, lx, ly, pixelData, pixelDataSize);
+    for (int i = 0; i < numAllTiles; ++i)
+    {
+        tiles[i] = _data->nextTileToWrite;
 
         if (random_y)
         {
@@ -1591,6 +1590,30 @@ TiledOutputFile::copyPixels (TiledInputFile& in)
                 _data->nextTileCoord (_data->nextTileToWrite);
         }
     }
+
+    copyRawChunks (
+        numAllTiles,
+        static_cast<int> (_data->tileBuffers.size ()),
+        [&] (int i, std::vector<char>& data) {
+            const TileCoord& t = tiles[i];
+            data.resize (_data->tileBufferSize);
+            int pixelDataSize = static_cast<int> (data.size ());
+            in.rawTileDataToBuffer (
+                t.dx, t.dy, t.lx, t.ly, data.data (), pixelDataSize);
+            data.resize (pixelDataSize);
+        },
+        [&] (int i, const std::vector<char>& data) {
+            const TileCoord& t = tiles[i];
+            writeTileData (
+                _streamData,
+                _data,
+                t.dx,
+                t.dy,
+                t.lx,
+                t.ly,
+                data.data (),
+                static_cast<int> (data.size ()));
+        });
 }
 
 void
@@ -0,0 +1,26 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+//-----------------------------------------------------------------------------
+//
+//	class ZipDCompressor
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfZipDCompressor.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+ZipDCompressor::ZipDCompressor (
+    const Header& hdr, size_t maxScanLineSize, int numScanLines)
+    : Compressor (hdr, EXR_COMPRESSION_ZIPD, maxScanLineSize, numScanLines)
+{
+}
+
+ZipDCompressor::~ZipDCompressor ()
+{
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
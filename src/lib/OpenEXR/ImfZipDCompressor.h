@@ -0,0 +1,35 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef INCLUDED_IMF_ZIPD_COMPRESSOR_H
+#define INCLUDED_IMF_ZIPD_COMPRESSOR_H
+
+//-----------------------------------------------------------------------------
+//
+//	class ZipDCompressor -- performs zlib-style compression of samples
+//	predicted along the depth sorted sample lists of deep pixels
+//
+//-----------------------------------------------------------------------------
+
+#include "ImfCompressor.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+class ZipDCompressor : public Compressor
+{
+public:
+    ZipDCompressor (
+        const Header& hdr, size_t maxScanLineSize, int numScanLines);
+    virtual ~ZipDCompressor ();
+
+    ZipDCompressor (const ZipDCompressor& other)            = delete;
+    ZipDCompressor& operator= (const ZipDCompressor& other) = delete;
+    ZipDCompressor (ZipDCompressor&& other)                 = delete;
+    ZipDCompressor& operator= (ZipDCompressor&& other)      = delete;
+};
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
@@ -139,26 +139,14 @@ exr_attr_chlist_add_with_length (
             ysamp,
             name);
 
-    insertpos = 0;
-    olist     = EXR_CONST_CAST (exr_attr_chlist_entry_t*, clist->entries);
-    for (int32_t c = 0; c < clist->num_channels; ++c)
+    olist = EXR_CONST_CAST (exr_attr_chlist_entry_t*, clist->entries);
+    if (internal_chlist_find (clist, name, &insertpos) >= 0)
     {
-        int ord = strcmp (name, olist[c].name.str);
-        if (ord < 0)
-        {
-            insertpos = c;
-            break;
-        }
-        else if (ord == 0)
-        {
-            return ctxt->print_error (
-                ctxt,
-                EXR_ERR_INVALID_ARGUMENT,
-                "Attempt to add duplicate channel '%s' to channel list",
-                name);
-        }
-        else
-            insertpos = c + 1;
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Attempt to add duplicate channel '%s' to channel list",
+            name);
     }
 
     /* temporarily use newcount as a return value check */
@@ -221,6 +209,33 @@ exr_attr_chlist_add_with_length (
 
 /**************************************/
 
+int
+internal_chlist_find (
+    const exr_attr_chlist_t* clist, const char* name, int* insertpos)
+{
+    int lo = 0, hi;
+
+    hi = (clist && clist->entries) ? clist->num_channels : 0;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        int ord = strcmp (name, clist->entries[mid].name.str);
+        if (ord == 0)
+        {
+            if (insertpos) *insertpos = mid;
+            return mid;
+        }
+        if (ord < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if (insertpos) *insertpos = lo;
+    return -1;
+}
+
+/**************************************/
+
 exr_result_t
 exr_attr_chlist_duplicate (
     exr_context_t ctxt, exr_attr_chlist_t* chl, const exr_attr_chlist_t* srcchl)
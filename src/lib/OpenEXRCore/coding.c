@@ -8,6 +8,11 @@
 
 #include <string.h>
 
+#if defined __SSE2__ || (_MSC_VER >= 1300 && (_M_IX86 || _M_X64) && !defined(_M_ARM64EC))
+#    define IMF_HAVE_SSE2 1
+#    include <emmintrin.h>
+#endif
+
 exr_result_t
 internal_coding_fill_channel_info (
     exr_coding_channel_info_t** channels,
@@ -273,3 +278,87 @@ internal_decode_alloc_buffer (
     }
     return EXR_ERR_SUCCESS;
 }
+
+/**************************************/
+
+exr_result_t
+internal_coding_unpack_sample_line (
+    int32_t* counts, int64_t w, int individual, int32_t* total)
+{
+    int64_t x        = 0;
+    int32_t prevsamp = 0;
+    int     bad      = 0;
+
+    /*
+     * Four counts at a time: compare each count with the one before
+     * it, which also gives the per-pixel counts as a difference. Other
+     * targets, arm64 included, take the scalar loop below.
+     */
+#if defined(IMF_HAVE_SSE2)
+    if (w >= 4)
+    {
+        __m128i vPrev = _mm_setzero_si128 ();
+        __m128i vBad  = _mm_setzero_si128 ();
+
+        for (; x + 4 <= w; x += 4)
+        {
+            __m128i* vLine = (__m128i*) (counts + x);
+            __m128i  cur   = _mm_loadu_si128 (vLine);
+            __m128i  prev  = _mm_or_si128 (
+                _mm_slli_si128 (cur, 4), _mm_srli_si128 (vPrev, 12));
+
+            vBad = _mm_or_si128 (vBad, _mm_cmplt_epi32 (cur, prev));
+            if (individual) _mm_storeu_si128 (vLine, _mm_sub_epi32 (cur, prev));
+            vPrev = cur;
+        }
+
+        bad      = _mm_movemask_epi8 (vBad);
+        prevsamp = _mm_cvtsi128_si32 (_mm_srli_si128 (vPrev, 12));
+    }
+#endif
+
+    for (; x < w; ++x)
+    {
+        int32_t nsamps = counts[x];
+        // not monotonic, violation
+        if (nsamps < prevsamp) bad = 1;
+        if (individual) counts[x] = nsamps - prevsamp;
+        prevsamp = nsamps;
+    }
+
+    *total = prevsamp;
+    return bad ? EXR_ERR_INVALID_SAMPLE_DATA : EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
+uint64_t
+internal_coding_sum_sample_line (const int32_t* counts, int64_t w)
+{
+    int64_t  x   = 0;
+    uint64_t tot = 0;
+
+#if defined(IMF_HAVE_SSE2)
+    if (w >= 4)
+    {
+        const __m128i zero = _mm_setzero_si128 ();
+        __m128i       vTot = _mm_setzero_si128 ();
+        uint64_t      lanes[2];
+
+        for (; x + 4 <= w; x += 4)
+        {
+            __m128i cur = _mm_loadu_si128 ((const __m128i*) (counts + x));
+            vTot = _mm_add_epi64 (vTot, _mm_unpacklo_epi32 (cur, zero));
+            vTot = _mm_add_epi64 (vTot, _mm_unpackhi_epi32 (cur, zero));
+        }
+
+        _mm_storeu_si128 ((__m128i*) lanes, vTot);
+        tot = lanes[0] + lanes[1];
+    }
+#endif
+
+    for (; x < w; ++x)
+        tot += (uint64_t) (uint32_t) counts[x];
+
+    return tot;
+}
@@ -239,7 +239,8 @@ int exr_compression_lines_per_chunk (exr_compression_t comptype)
     {
         case EXR_COMPRESSION_NONE:
         case EXR_COMPRESSION_RLE:
-        case EXR_COMPRESSION_ZIPS: linePerChunk = 1; break;
+        case EXR_COMPRESSION_ZIPS:
+        case EXR_COMPRESSION_ZIPD: linePerChunk = 1; break;
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_PXR24: linePerChunk = 16; break;
         case EXR_COMPRESSION_PIZ:
@@ -321,12 +322,8 @@ exr_compress_chunk (exr_encode_pipeline_t* encode)
         }
         else
         {
-            void *pb;
-            size_t pbb, pas;
-
-            pb = encode->packed_buffer;
-            pbb = encode->packed_bytes;
-            pas = encode->packed_alloc_size;
+            void  *pb, *cb;
+            size_t pbb, pas, cbb, cas;
 
             rv = internal_encode_alloc_buffer (
                 encode,
@@ -337,23 +334,45 @@ exr_compress_chunk (exr_encode_pipeline_t* encode)
             if (rv != EXR_ERR_SUCCESS)
                 return rv;
 
-            encode->packed_buffer = encode->packed_sample_count_table;
-            encode->packed_bytes = sampsize;
-            encode->packed_alloc_size = encode->packed_sample_count_alloc_size;
+            /* the table is compressed on its own, from the sample
+             * count table to the packed sample count table */
+            pb  = encode->packed_buffer;
+            pbb = encode->packed_bytes;
+            pas = encode->packed_alloc_size;
+            cb  = encode->compressed_buffer;
+            cbb = encode->compressed_bytes;
+            cas = encode->compressed_alloc_size;
+
+            encode->packed_buffer         = encode->sample_count_table;
+            encode->packed_bytes          = sampsize;
+            encode->packed_alloc_size     = 0;
+            encode->compressed_buffer     = encode->packed_sample_count_table;
+            encode->compressed_bytes      = 0;
+            encode->compressed_alloc_size =
+                encode->packed_sample_count_alloc_size;
             switch (part->comp_type)
             {
                 case EXR_COMPRESSION_NONE: rv = EXR_ERR_INVALID_ARGUMENT; break;
                 case EXR_COMPRESSION_RLE: rv = internal_exr_apply_rle (encode); break;
                 case EXR_COMPRESSION_ZIP:
                 case EXR_COMPRESSION_ZIPS: rv = internal_exr_apply_zip (encode); break;
+                case EXR_COMPRESSION_ZIPD:
+                    rv = internal_exr_apply_zipd_table (encode);
+                    encode->compressed_bytes = encode->packed_sample_count_bytes;
+                    break;
 
                 default:
                     rv = EXR_ERR_INVALID_ARGUMENT;
                     break;
             }
-            encode->packed_buffer = pb;
-            encode->packed_bytes = pbb;
-            encode->packed_alloc_size = pas;
+            encode->packed_sample_count_bytes = encode->compressed_bytes;
+
+            encode->packed_buffer         = pb;
+            encode->packed_bytes          = pbb;
+            encode->packed_alloc_size     = pas;
+            encode->compressed_buffer     = cb;
+            encode->compressed_bytes      = cbb;
+            encode->compressed_alloc_size = cas;
 
             if (rv != EXR_ERR_SUCCESS)
                 return ctxt->print_error (
@@ -363,6 +382,13 @@ exr_compress_chunk (exr_encode_pipeline_t* encode)
         }
     }
 
+    /* a deep chunk without any samples only has a sample count table */
+    if (encode->packed_bytes == 0)
+    {
+        encode->compressed_bytes = 0;
+        return EXR_ERR_SUCCESS;
+    }
+
     switch (part->comp_type)
     {
         case EXR_COMPRESSION_NONE:
@@ -374,6 +400,7 @@ exr_compress_chunk (exr_encode_pipeline_t* encode)
         case EXR_COMPRESSION_RLE: rv = internal_exr_apply_rle (encode); break;
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS: rv = internal_exr_apply_zip (encode); break;
+        case EXR_COMPRESSION_ZIPD: rv = internal_exr_apply_zipd (encode); break;
         case EXR_COMPRESSION_PIZ: rv = internal_exr_apply_piz (encode); break;
         case EXR_COMPRESSION_PXR24:
             rv = internal_exr_apply_pxr24 (encode);
@@ -437,6 +464,10 @@ decompress_data (
             rv = internal_exr_undo_zip (
                 decode, packbufptr, packsz, unpackbufptr, unpacksz);
             break;
+        case EXR_COMPRESSION_ZIPD:
+            rv = internal_exr_undo_zipd (
+                decode, packbufptr, packsz, unpackbufptr, unpacksz);
+            break;
         case EXR_COMPRESSION_PIZ:
             rv = internal_exr_undo_piz (
                 decode, packbufptr, packsz, unpackbufptr, unpacksz);
@@ -478,6 +509,47 @@ decompress_data (
     return rv;
 }
 
+/* point sample a chunk stored uncompressed down to the reduced
+ * resolution requested, channels are known to be unsampled */
+static exr_result_t
+reduce_uncompressed (exr_decode_pipeline_t* decode)
+{
+    const exr_chunk_info_t* stored  = &(decode->stored_chunk);
+    int                     levels  = decode->resolution_reduction;
+    const uint8_t*          srcbase = decode->packed_buffer;
+    uint8_t*                dst     = decode->unpacked_buffer;
+    size_t                  srcline = 0;
+
+    for (int c = 0; c < decode->channel_count; ++c)
+        srcline += (size_t) stored->width *
+                   (size_t) decode->channels[c].bytes_per_element;
+
+    if (srcline * (size_t) stored->height != stored->unpacked_size)
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    for (int32_t y = 0; y < decode->chunk.height; ++y)
+    {
+        const uint8_t* src = srcbase + ((size_t) y << levels) * srcline;
+
+        for (int c = 0; c < decode->channel_count; ++c)
+        {
+            const exr_coding_channel_info_t* decc = decode->channels + c;
+            size_t bpe  = (size_t) decc->bytes_per_element;
+            size_t step = bpe << levels;
+
+            for (int32_t x = 0; x < decc->width; ++x)
+            {
+                memcpy (dst, src + (size_t) x * step, bpe);
+                dst += bpe;
+            }
+            src += (size_t) stored->width * bpe;
+        }
+    }
+
+    decode->bytes_decompressed = decode->chunk.unpacked_size;
+    return EXR_ERR_SUCCESS;
+}
+
 exr_result_t
 exr_uncompress_chunk (exr_decode_pipeline_t* decode)
 {
@@ -518,14 +590,22 @@ exr_uncompress_chunk (exr_decode_pipeline_t* decode)
 
         sampsize *= sizeof (int32_t);
 
-        rv = decompress_data (
-            ctxt,
-            part->comp_type,
-            decode,
-            decode->packed_sample_count_table,
-            decode->chunk.sample_count_table_size,
-            decode->sample_count_table,
-            sampsize);
+        if (part->comp_type == EXR_COMPRESSION_ZIPD)
+            rv = internal_exr_undo_zipd_table (
+                decode,
+                decode->packed_sample_count_table,
+                decode->chunk.sample_count_table_size,
+                decode->sample_count_table,
+                sampsize);
+        else
+            rv = decompress_data (
+                ctxt,
+                part->comp_type,
+                decode,
+                decode->packed_sample_count_table,
+                decode->chunk.sample_count_table_size,
+                decode->sample_count_table,
+                sampsize);
 
         if (rv != EXR_ERR_SUCCESS)
         {
@@ -540,7 +620,39 @@ exr_uncompress_chunk (exr_decode_pipeline_t* decode)
 
     if ((decode->decode_flags & EXR_DECODE_SAMPLE_DATA_ONLY)) return rv;
 
-    if (rv == EXR_ERR_SUCCESS &&
+    /* when reducing, the packed size has to be compared against the
+     * size of the chunk as stored to know if it is compressed */
+    if (rv == EXR_ERR_SUCCESS && decode->resolution_reduction > 0)
+    {
+        if (decode->chunk.packed_size == 0 ||
+            decode->chunk.unpacked_size == 0)
+            return EXR_ERR_SUCCESS;
+
+        if (decode->chunk.packed_size == decode->stored_chunk.unpacked_size)
+            rv = reduce_uncompressed (decode);
+        else if (part->comp_type == EXR_COMPRESSION_DWAA)
+            rv = internal_exr_undo_dwaa (
+                decode,
+                decode->packed_buffer,
+                decode->chunk.packed_size,
+                decode->unpacked_buffer,
+                decode->chunk.unpacked_size);
+        else if (part->comp_type == EXR_COMPRESSION_DWAB)
+            rv = internal_exr_undo_dwab (
+                decode,
+                decode->packed_buffer,
+                decode->chunk.packed_size,
+                decode->unpacked_buffer,
+                decode->chunk.unpacked_size);
+        else
+            rv = internal_exr_undo_ht (
+                decode,
+                decode->packed_buffer,
+                decode->chunk.packed_size,
+                decode->unpacked_buffer,
+                decode->chunk.unpacked_size);
+    }
+    else if (rv == EXR_ERR_SUCCESS &&
         decode->chunk.packed_size > 0 &&
         decode->chunk.unpacked_size > 0)
         rv = decompress_data (
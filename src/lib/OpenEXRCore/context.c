@@ -66,6 +66,108 @@ dispatch_read (
 
 /**************************************/
 
+static int64_t
+memory_read_func (
+    exr_const_context_t         ctxt,
+    void*                       userdata,
+    void*                       buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t error_cb)
+{
+    uint64_t fsize = (uint64_t) ctxt->file_size;
+
+    (void) userdata;
+    (void) error_cb;
+
+    if (offset >= fsize) return 0;
+    if (sz > fsize - offset) sz = fsize - offset;
+
+    memcpy (buffer, ctxt->memory_data + offset, sz);
+    return (int64_t) sz;
+}
+
+/**************************************/
+
+static int64_t
+memory_write_func (
+    exr_const_context_t         ctxt,
+    void*                       userdata,
+    const void*                 buffer,
+    uint64_t                    sz,
+    uint64_t                    offset,
+    exr_stream_error_func_ptr_t error_cb)
+{
+    exr_memory_output_buffer_t* out = ctxt->memory_output;
+    uint64_t                    end = offset + sz;
+
+    (void) userdata;
+
+    if (end < offset || end > (uint64_t) INT64_MAX)
+    {
+        error_cb (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Write request at offset %" PRIu64 " size %" PRIu64 " too large",
+            offset,
+            sz);
+        return -1;
+    }
+
+    /* writes are serialized by the context lock, so the buffer can be
+     * swapped out without any further locking */
+    if (end > out->capacity)
+    {
+        uint64_t newcap = out->capacity > 4096 ? out->capacity : 4096;
+        void*    newdata;
+
+        while (newcap < end)
+            newcap = (newcap > UINT64_MAX / 2) ? end : newcap * 2;
+
+        if (newcap != (uint64_t) (size_t) newcap) newcap = end;
+        if (newcap != (uint64_t) (size_t) newcap)
+        {
+            error_cb (
+                ctxt,
+                EXR_ERR_OUT_OF_MEMORY,
+                "Memory output of %" PRIu64 " bytes too large for architecture",
+                end);
+            return -1;
+        }
+
+        newdata = ctxt->alloc_fn ((size_t) newcap);
+        if (!newdata)
+        {
+            error_cb (
+                ctxt,
+                EXR_ERR_OUT_OF_MEMORY,
+                "Unable to grow memory output to %" PRIu64 " bytes",
+                newcap);
+            return -1;
+        }
+
+        if (out->data)
+        {
+            if (out->size > 0) memcpy (newdata, out->data, (size_t) out->size);
+            ctxt->free_fn (out->data);
+        }
+        out->data     = newdata;
+        out->capacity = newcap;
+    }
+
+    if (offset > out->size)
+        memset (
+            ((uint8_t*) out->data) + out->size,
+            0,
+            (size_t) (offset - out->size));
+    memcpy (((uint8_t*) out->data) + offset, buffer, (size_t) sz);
+    if (end > out->size) out->size = end;
+
+    return (int64_t) sz;
+}
+
+/**************************************/
+
 static exr_result_t
 dispatch_write (
     exr_context_t ctxt, const void* buf, uint64_t sz, uint64_t* offsetp)
@@ -291,6 +393,70 @@ exr_start_read (
 
 /**************************************/
 
+exr_result_t
+exr_start_read_from_memory (
+    exr_context_t*                   ctxt,
+    const char*                      name,
+    const void*                      data,
+    uint64_t                         size,
+    const exr_context_initializer_t* ctxtdata)
+{
+    exr_result_t              rv    = EXR_ERR_UNKNOWN;
+    exr_context_t             ret   = NULL;
+    exr_context_initializer_t inits = fill_context_data (ctxtdata);
+
+    if (!ctxt)
+    {
+        if (!(inits.flags & EXR_CONTEXT_FLAG_SILENT_HEADER_PARSE))
+            inits.error_handler_fn (
+                NULL,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Invalid context handle passed to start_read function");
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    if (data && size > 0 && size <= (uint64_t) INT64_MAX)
+    {
+        inits.read_fn  = NULL;
+        inits.size_fn  = NULL;
+        inits.write_fn = NULL;
+
+        rv = internal_exr_alloc_context (&ret, &inits, EXR_CONTEXT_READ, 0);
+        if (rv == EXR_ERR_SUCCESS)
+        {
+            ret->do_read     = &dispatch_read;
+            ret->read_fn     = &memory_read_func;
+            ret->user_data   = inits.user_data;
+            ret->memory_data = (const uint8_t*) data;
+            ret->file_size   = (int64_t) size;
+
+            rv = exr_attr_string_create (
+                (exr_context_t) ret,
+                &(ret->filename),
+                name ? name : "<memory>");
+            if (rv == EXR_ERR_SUCCESS) rv = internal_exr_parse_header (ret);
+
+            if (rv != EXR_ERR_SUCCESS) exr_finish ((exr_context_t*) &ret);
+        }
+        else
+            rv = EXR_ERR_OUT_OF_MEMORY;
+    }
+    else
+    {
+        if (!(inits.flags & EXR_CONTEXT_FLAG_SILENT_HEADER_PARSE))
+            inits.error_handler_fn (
+                NULL,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Invalid memory buffer passed to start_read function");
+        rv = EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    *ctxt = (exr_context_t) ret;
+    return rv;
+}
+
+/**************************************/
+
 exr_result_t
 exr_start_write (
     exr_context_t*                   ctxt,
@@ -356,6 +522,67 @@ exr_start_write (
 
 /**************************************/
 
+exr_result_t
+exr_start_write_to_memory (
+    exr_context_t*                   ctxt,
+    const char*                      name,
+    exr_memory_output_buffer_t*      outbuf,
+    const exr_context_initializer_t* ctxtdata)
+{
+    int                       rv    = EXR_ERR_UNKNOWN;
+    exr_context_t             ret   = NULL;
+    exr_context_initializer_t inits = fill_context_data (ctxtdata);
+
+    if (!ctxt)
+    {
+        inits.error_handler_fn (
+            NULL,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid context handle passed to start_write function");
+        return EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    if (outbuf && (outbuf->data != NULL || outbuf->capacity == 0))
+    {
+        inits.read_fn  = NULL;
+        inits.size_fn  = NULL;
+        inits.write_fn = NULL;
+
+        rv = internal_exr_alloc_context (&ret, &inits, EXR_CONTEXT_WRITE, 0);
+        if (rv == EXR_ERR_SUCCESS)
+        {
+            outbuf->size = 0;
+
+            ret->do_write      = &dispatch_write;
+            ret->write_fn      = &memory_write_func;
+            ret->user_data     = inits.user_data;
+            ret->memory_output = outbuf;
+
+            rv = exr_attr_string_create (
+                (exr_context_t) ret,
+                &(ret->filename),
+                name ? name : "<memory>");
+
+            if (rv != EXR_ERR_SUCCESS) exr_finish ((exr_context_t*) &ret);
+        }
+        else
+            rv = EXR_ERR_OUT_OF_MEMORY;
+    }
+    else
+    {
+        inits.error_handler_fn (
+            NULL,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid memory output buffer passed to start_write function");
+        rv = EXR_ERR_INVALID_ARGUMENT;
+    }
+
+    *ctxt = (exr_context_t) ret;
+    return rv;
+}
+
+/**************************************/
+
 exr_result_t
 exr_start_inplace_header_update (
     exr_context_t*                   ctxt,
@@ -10,6 +10,7 @@
 #include "internal_coding.h"
 #include "internal_decompress.h"
 #include "internal_structs.h"
+#include "internal_util.h"
 #include "internal_xdr.h"
 
 #include <stdio.h>
@@ -61,7 +62,10 @@ update_pack_unpack_ptrs (exr_decode_pipeline_t* decode)
             return rv;
     }
 
-    if (decode->chunk.packed_size == decode->chunk.unpacked_size)
+    /* a reduced chunk stored uncompressed is sampled into the
+     * unpacked buffer by the decompress step */
+    if (decode->resolution_reduction == 0 &&
+        decode->chunk.packed_size == decode->chunk.unpacked_size)
     {
         internal_decode_free_buffer (
             decode,
@@ -87,14 +91,100 @@ update_pack_unpack_ptrs (exr_decode_pipeline_t* decode)
     return rv;
 }
 
+/* requested channels separated by at most this many bytes in the
+ * file are fetched with a single read through the scratch buffer
+ * instead of one read each */
+#define EXR_DIRECT_READ_COALESCE_GAP 4096
+
 static exr_result_t
-read_uncompressed_direct (exr_decode_pipeline_t* decode)
+read_direct_span (
+    exr_decode_pipeline_t*           decode,
+    uint64_t                         spanstart,
+    uint64_t                         spanend,
+    int                              spancount,
+    const exr_coding_channel_info_t* firstchan,
+    int                              firstcount,
+    uint8_t*                         firstdata)
 {
     exr_result_t        rv;
-    int                 height, start_y;
-    uint64_t            dataoffset, toread;
-    uint8_t*            cdata;
-    exr_const_context_t ctxt = decode->context;
+    uint64_t            dataoffset = decode->chunk.data_offset + spanstart;
+    exr_const_context_t ctxt       = decode->context;
+
+    if (spancount == 1)
+    {
+        /* actual read into the output pointer */
+        rv = ctxt->do_read (
+            ctxt,
+            firstdata,
+            spanend - spanstart,
+            &dataoffset,
+            NULL,
+            EXR_MUST_READ_ALL);
+        if (rv == EXR_ERR_SUCCESS)
+            priv_to_native (
+                firstdata, firstcount, firstchan->bytes_per_element);
+        return rv;
+    }
+
+    /* the scratch buffer mirrors the layout of the whole chunk, so
+     * spans land at their offset within the chunk */
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        (size_t) decode->chunk.unpacked_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    return ctxt->do_read (
+        ctxt,
+        ((uint8_t*) decode->scratch_buffer_1) + spanstart,
+        spanend - spanstart,
+        &dataoffset,
+        NULL,
+        EXR_MUST_READ_ALL);
+}
+
+static void
+scatter_direct_segment (
+    const exr_decode_pipeline_t*     decode,
+    uint64_t                         segoff,
+    const exr_coding_channel_info_t* decc,
+    int                              count,
+    uint8_t*                         cdata)
+{
+    const uint8_t* src = ((const uint8_t*) decode->scratch_buffer_1) + segoff;
+
+    memcpy (cdata, src, (size_t) count * (size_t) decc->bytes_per_element);
+    priv_to_native (cdata, count, decc->bytes_per_element);
+}
+
+/*
+ * Reads the requested channels of an uncompressed chunk straight
+ * into the output pointers. The channel layout of each line is
+ * fixed, so only the byte ranges of the requested channels are
+ * read, with nearby ranges coalesced into a single read. The first
+ * pass issues the reads, reading a lone range directly into its
+ * output pointer; the second pass copies the ranges which were
+ * read as part of a coalesced span out of the scratch buffer. When
+ * a column range is requested, only those columns of each channel
+ * are read.
+ */
+static exr_result_t
+read_uncompressed_direct (exr_decode_pipeline_t* decode)
+{
+    exr_result_t                     rv;
+    int                              height, start_y, uls, endy;
+    int                              spancount, coalesced = 0;
+    int                              colfirst, colcount;
+    int                              firstcount = 0;
+    uint64_t                         chunkoff, segoff, toread;
+    uint64_t                         spanstart, spanend;
+    uint64_t                         firstoff = 0;
+    const exr_coding_channel_info_t* firstchan = NULL;
+    uint8_t*                         firstdata = NULL;
+    uint8_t*                         cdata;
+    exr_const_context_t              ctxt = decode->context;
 
     if (!ctxt) return EXR_ERR_MISSING_CONTEXT_ARG;
     if (ctxt->mode != EXR_CONTEXT_READ)
@@ -106,41 +196,128 @@ read_uncompressed_direct (exr_decode_pipeline_t* decode)
             "Part index (%d) out of range",
             decode->part_index);
 
-    dataoffset = decode->chunk.data_offset;
-
     height  = decode->chunk.height;
     start_y = decode->chunk.start_y;
-    for (int y = 0; y < height; ++y)
+    uls     = decode->user_line_begin_skip;
+    endy    = height - decode->user_line_end_ignore;
+
+    for (int pass = 0; pass < 2; ++pass)
     {
-        for (int c = 0; c < decode->channel_count; ++c)
+        if (pass == 1 && !coalesced) break;
+
+        chunkoff  = 0;
+        spanstart = 0;
+        spanend   = 0;
+        spancount = 0;
+        for (int y = 0; y < height; ++y)
         {
-            exr_coding_channel_info_t* decc = (decode->channels + c);
+            for (int c = 0; c < decode->channel_count; ++c)
+            {
+                exr_coding_channel_info_t* decc = (decode->channels + c);
+
+                if (decc->height == 0) continue;
+                if (decc->y_samples > 1 &&
+                    ((start_y + y) % decc->y_samples) != 0)
+                    continue;
+
+                colcount = compute_sampled_columns (
+                    decc->width,
+                    decc->x_samples,
+                    decode->chunk.width,
+                    decode->user_column_begin_skip,
+                    decode->user_column_end_ignore,
+                    &colfirst);
+                segoff = chunkoff + (uint64_t) colfirst *
+                                        (uint64_t) decc->bytes_per_element;
+                toread = (uint64_t) colcount *
+                         (uint64_t) decc->bytes_per_element;
+                chunkoff += (uint64_t) decc->width *
+                            (uint64_t) decc->bytes_per_element;
+
+                cdata = decc->decode_to_ptr;
+                if (!cdata || y < uls || y >= endy || toread == 0) continue;
+
+                if (decc->y_samples > 1)
+                {
+                    /* as in the unpackers, the user pointer is at the
+                     * sampled line of the first line not skipped */
+                    const int fb_y = uls + start_y;
+                    cdata +=
+                        ((uint64_t) ((start_y + y) / decc->y_samples -
+                                     fb_y / decc->y_samples) *
+                         (uint64_t) decc->user_line_stride);
+                }
+                else
+                {
+                    cdata += (uint64_t) (y - uls) *
+                             (uint64_t) decc->user_line_stride;
+                }
 
-            cdata = decc->decode_to_ptr;
-            toread =
-                (uint64_t) decc->width * (uint64_t) decc->bytes_per_element;
+                if (chunkoff > decode->chunk.unpacked_size)
+                    return ctxt->print_error (
+                        ctxt,
+                        EXR_ERR_CORRUPT_CHUNK,
+                        "Chunk size %" PRIu64
+                        " too small for channel layout of part %d",
+                        decode->chunk.unpacked_size,
+                        decode->part_index);
+
+                if (spancount > 0 &&
+                    segoff - spanend <= EXR_DIRECT_READ_COALESCE_GAP)
+                {
+                    spanend = segoff + toread;
+                    ++spancount;
+                    if (pass == 1)
+                    {
+                        if (spancount == 2)
+                            scatter_direct_segment (
+                                decode,
+                                firstoff,
+                                firstchan,
+                                firstcount,
+                                firstdata);
+                        scatter_direct_segment (
+                            decode, segoff, decc, colcount, cdata);
+                    }
+                    continue;
+                }
 
-            if (decc->height == 0) continue;
+                if (pass == 0 && spancount > 0)
+                {
+                    rv = read_direct_span (
+                        decode,
+                        spanstart,
+                        spanend,
+                        spancount,
+                        firstchan,
+                        firstcount,
+                        firstdata);
+                    if (rv != EXR_ERR_SUCCESS) return rv;
+                    if (spancount > 1) coalesced = 1;
+                }
 
-            if (decc->y_samples > 1)
-            {
-                if (((start_y + y) % decc->y_samples) != 0) continue;
-                cdata +=
-                    ((uint64_t) (y / decc->y_samples) *
-                     (uint64_t) decc->user_line_stride);
+                spanstart  = segoff;
+                spanend    = segoff + toread;
+                spancount  = 1;
+                firstoff   = segoff;
+                firstchan  = decc;
+                firstcount = colcount;
+                firstdata  = cdata;
             }
-            else { cdata += (uint64_t) y * (uint64_t) decc->user_line_stride; }
+        }
 
-            /* actual read into the output pointer */
-            rv = ctxt->do_read (
-                ctxt, cdata, toread, &dataoffset, NULL, EXR_MUST_READ_ALL);
+        if (pass == 0 && spancount > 0)
+        {
+            rv = read_direct_span (
+                decode,
+                spanstart,
+                spanend,
+                spancount,
+                firstchan,
+                firstcount,
+                firstdata);
             if (rv != EXR_ERR_SUCCESS) return rv;
-
-            // need to swab them to native
-            if (decc->bytes_per_element == 2)
-                priv_to_native16 (cdata, decc->width);
-            else
-                priv_to_native32 (cdata, decc->width);
+            if (spancount > 1) coalesced = 1;
         }
     }
 
@@ -197,6 +374,29 @@ default_read_chunk (exr_decode_pipeline_t* decode)
                 decode->packed_sample_count_table);
         }
     }
+    else if (decode->chunk.packed_size > 0 && ctxt->memory_data)
+    {
+        /* reading from memory, reference the chunk data in place */
+        if (decode->chunk.data_offset > (uint64_t) ctxt->file_size ||
+            decode->chunk.packed_size >
+                (uint64_t) ctxt->file_size - decode->chunk.data_offset)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_READ_IO,
+                "Chunk data at %" PRIu64 " size %" PRIu64
+                " past end of memory buffer",
+                decode->chunk.data_offset,
+                decode->chunk.packed_size);
+
+        internal_decode_free_buffer (
+            decode,
+            EXR_TRANSCODE_BUFFER_PACKED,
+            &(decode->packed_buffer),
+            &(decode->packed_alloc_size));
+        decode->packed_buffer = EXR_CONST_CAST (
+            void*, ctxt->memory_data + decode->chunk.data_offset);
+        rv = EXR_ERR_SUCCESS;
+    }
     else if (decode->chunk.packed_size > 0)
     {
         rv = internal_decode_alloc_buffer (
@@ -224,51 +424,33 @@ unpack_sample_table (exr_const_context_t ctxt, exr_decode_pipeline_t* decode)
     uint64_t     totsamp      = 0;
     int32_t*     samptable    = decode->sample_count_table;
     size_t       combSampSize = 0;
+    int          individual;
 
     for (int c = 0; c < decode->channel_count; ++c)
         combSampSize += ((size_t) decode->channels[c].bytes_per_element);
 
-    if ((decode->decode_flags & EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL))
-    {
-        for (int64_t y = 0; y < h; ++y)
-        {
-            int32_t* cursampline = samptable + y * w;
-            int32_t  prevsamp    = 0;
-            for (int32_t x = 0; x < w; ++x)
-            {
-                int32_t nsamps =
-                    (int32_t) one_to_native32 ((uint32_t) cursampline[x]);
-                // not monotonic, violation
-                if (nsamps < prevsamp) return EXR_ERR_INVALID_SAMPLE_DATA;
-                cursampline[x] = nsamps - prevsamp;
-                prevsamp       = nsamps;
-            }
-            totsamp += (uint64_t) prevsamp;
-        }
-        if (totsamp >= (uint64_t) INT32_MAX) return EXR_ERR_INVALID_SAMPLE_DATA;
-        samptable[w * h] = (int32_t) totsamp;
-    }
-    else
+    individual =
+        (decode->decode_flags & EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL) != 0;
+
+    for (int64_t y = 0; y < h; ++y)
     {
-        for (int64_t y = 0; y < h; ++y)
-        {
-            int32_t* cursampline = samptable + y * w;
-            int32_t  prevsamp    = 0;
-            for (int32_t x = 0; x < w; ++x)
-            {
-                int32_t nsamps =
-                    (int32_t) one_to_native32 ((uint32_t) cursampline[x]);
-                // not monotonic, violation
-                if (nsamps < prevsamp) return EXR_ERR_INVALID_SAMPLE_DATA;
+        int32_t* cursampline = samptable + y * w;
+        int32_t  linesamp;
 
-                cursampline[x] = nsamps;
-                prevsamp       = nsamps;
-            }
+#if EXR_HOST_IS_NOT_LITTLE_ENDIAN
+        for (int64_t x = 0; x < w; ++x)
+            cursampline[x] =
+                (int32_t) one_to_native32 ((uint32_t) cursampline[x]);
+#endif
 
-            totsamp += (uint64_t) prevsamp;
-        }
-        if (totsamp >= (uint64_t) INT32_MAX) return EXR_ERR_INVALID_SAMPLE_DATA;
+        rv = internal_coding_unpack_sample_line (
+            cursampline, w, individual, &linesamp);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+
+        totsamp += (uint64_t) linesamp;
     }
+    if (totsamp >= (uint64_t) INT32_MAX) return EXR_ERR_INVALID_SAMPLE_DATA;
+    if (individual) samptable[w * h] = (int32_t) totsamp;
 
     if ((totsamp * combSampSize) > decode->chunk.unpacked_size)
     {
@@ -364,6 +546,27 @@ exr_decoding_choose_default_routines (
                  ? 1
                  : 0;
 
+    if (decode->user_decimation > 1)
+    {
+        /* the decimating unpacker relies on every line of the chunk
+         * having the same layout */
+        if (isdeep)
+            return ctxt->report_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Decimation is not available for deep data");
+        for (int c = 0; c < decode->channel_count; ++c)
+        {
+            if (decode->channels[c].x_samples != 1 ||
+                decode->channels[c].y_samples != 1)
+                return ctxt->print_error (
+                    ctxt,
+                    EXR_ERR_INVALID_ARGUMENT,
+                    "Decimation is not available for sub-sampled channel '%s'",
+                    decode->channels[c].channel_name);
+        }
+    }
+
     for (int c = 0; c < decode->channel_count; ++c)
     {
         exr_coding_channel_info_t* decc = (decode->channels + c);
@@ -466,10 +669,10 @@ exr_decoding_choose_default_routines (
         simpinterleaverev = -1;
 
     /* special case, uncompressed and reading planar data straight in
-     * to all the channels */
+     * to the requested channels */
     if (!isdeep && part->comp_type == EXR_COMPRESSION_NONE &&
         chanstounpack == 0 && hastypechange == 0 && chanstofill > 0 &&
-        chanstofill == decode->channel_count)
+        decode->user_decimation <= 1)
     {
         decode->read_fn               = &read_uncompressed_direct;
         decode->decompress_fn         = NULL;
@@ -480,6 +683,9 @@ exr_decoding_choose_default_routines (
     if (part->comp_type != EXR_COMPRESSION_NONE)
         decode->decompress_fn = &exr_uncompress_chunk;
 
+    /* the default unpackers only read the channels requested */
+    if (!isdeep) decode->decode_flags |= EXR_DECODE_REQUESTED_CHANNELS_ONLY;
+
     decode->unpack_and_convert_fn = internal_exr_match_decode (
         decode,
         isdeep,
@@ -507,6 +713,208 @@ exr_decoding_choose_default_routines (
 
 /**************************************/
 
+static int32_t
+reduce_coord (int32_t v, int levels)
+{
+    /* divide rounding down, as the shift of a negative value is
+     * implementation defined */
+    int64_t d = ((int64_t) 1) << levels;
+    int64_t r = (v >= 0) ? ((int64_t) v / d) : -((d - 1 - (int64_t) v) / d);
+    return (int32_t) r;
+}
+
+static int32_t
+reduce_size (int32_t sz, int levels)
+{
+    int64_t d = ((int64_t) 1) << levels;
+    return (int32_t) (((int64_t) sz + d - 1) / d);
+}
+
+static exr_result_t
+check_resolution_reduction (
+    exr_const_context_t ctxt, exr_const_priv_part_t part, int levels)
+{
+    uint32_t step;
+
+    if (levels < 0 || levels > 16)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid resolution reduction (%d) requested",
+            levels);
+
+    if (levels == 0) return EXR_ERR_SUCCESS;
+
+    if (part->comp_type == EXR_COMPRESSION_DWAA ||
+        part->comp_type == EXR_COMPRESSION_DWAB)
+    {
+        /* only the DC of each 8x8 block can be decoded on its own */
+        if (levels != 3)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Reduced resolution decoding of DWA compression is only available at 1/8 resolution (3 levels), not %d",
+                levels);
+    }
+    else if (
+        part->comp_type != EXR_COMPRESSION_HTJ2K256 &&
+        part->comp_type != EXR_COMPRESSION_HTJ2K32)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Reduced resolution decoding is only available for HTJ2K and DWA compression");
+
+    if (part->storage_mode == EXR_STORAGE_DEEP_SCANLINE ||
+        part->storage_mode == EXR_STORAGE_DEEP_TILED)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Reduced resolution decoding is not available for deep data");
+
+    for (int c = 0; c < part->channels->chlist->num_channels; ++c)
+    {
+        const exr_attr_chlist_entry_t* curc =
+            part->channels->chlist->entries + c;
+        if (curc->x_sampling != 1 || curc->y_sampling != 1)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Reduced resolution decoding is not available for sub-sampled channel '%s'",
+                curc->name.str);
+    }
+
+    step = ((uint32_t) 1) << levels;
+    if (part->storage_mode == EXR_STORAGE_TILED)
+    {
+        const exr_attr_tiledesc_t* tiledesc = part->tiles->tiledesc;
+        if ((tiledesc->x_size % step) != 0 || (tiledesc->y_size % step) != 0)
+            return ctxt->print_error (
+                ctxt,
+                EXR_ERR_INVALID_ARGUMENT,
+                "Tile size %u x %u is not a multiple of the reduction factor %u",
+                tiledesc->x_size,
+                tiledesc->y_size,
+                step);
+    }
+    else if (((uint32_t) part->lines_per_chunk % step) != 0)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Scanlines per chunk (%d) is not a multiple of the reduction factor %u",
+            (int) part->lines_per_chunk,
+            step);
+
+    return EXR_ERR_SUCCESS;
+}
+
+/* decode->chunk holds the chunk as stored, reduce it along with the
+ * channel sizes (all channels are known to be unsampled) */
+static void
+apply_resolution_reduction (
+    exr_const_priv_part_t part, exr_decode_pipeline_t* decode)
+{
+    int               levels = decode->resolution_reduction;
+    exr_chunk_info_t* chunk  = &(decode->chunk);
+    uint64_t          unpacked = 0;
+
+    decode->stored_chunk = *chunk;
+
+    chunk->width  = reduce_size (chunk->width, levels);
+    chunk->height = reduce_size (chunk->height, levels);
+    /* tiles are addressed by tile index, which is unchanged */
+    if (part->storage_mode == EXR_STORAGE_SCANLINE)
+    {
+        chunk->start_x =
+            reduce_coord (part->data_window.min.x, levels) +
+            ((chunk->start_x - part->data_window.min.x) >> levels);
+        chunk->start_y =
+            reduce_coord (part->data_window.min.y, levels) +
+            ((chunk->start_y - part->data_window.min.y) >> levels);
+    }
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        exr_coding_channel_info_t* decc = decode->channels + c;
+
+        decc->width  = chunk->width;
+        decc->height = chunk->height;
+        unpacked += (uint64_t) decc->width * (uint64_t) decc->height *
+                    (uint64_t) decc->bytes_per_element;
+    }
+    chunk->unpacked_size = unpacked;
+}
+
+exr_result_t
+exr_get_reduced_data_window (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 levels,
+    exr_attr_box2i_t*   out)
+{
+    exr_result_t rv;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (!out) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    rv = check_resolution_reduction (ctxt, part, levels);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    out->min.x = reduce_coord (part->data_window.min.x, levels);
+    out->min.y = reduce_coord (part->data_window.min.y, levels);
+    out->max.x =
+        out->min.x +
+        reduce_size (
+            part->data_window.max.x - part->data_window.min.x + 1, levels) -
+        1;
+    out->max.y =
+        out->min.y +
+        reduce_size (
+            part->data_window.max.y - part->data_window.min.y + 1, levels) -
+        1;
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+exr_decoding_set_resolution_reduction (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    exr_decode_pipeline_t* decode,
+    int                    levels)
+{
+    exr_result_t rv;
+    EXR_READONLY_AND_DEFINE_PART (part_index);
+
+    if (!decode) return ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT);
+
+    if (decode->context != ctxt || decode->part_index != part_index)
+        return ctxt->report_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid request for resolution reduction from different context / part");
+
+    rv = check_resolution_reduction (ctxt, part, levels);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (decode->resolution_reduction > 0)
+    {
+        rv = internal_coding_update_channel_info (
+            decode->channels,
+            decode->channel_count,
+            &(decode->stored_chunk),
+            ctxt,
+            part);
+        if (rv != EXR_ERR_SUCCESS) return rv;
+        decode->chunk = decode->stored_chunk;
+    }
+
+    decode->resolution_reduction = levels;
+    if (levels > 0) apply_resolution_reduction (part, decode);
+
+    return EXR_ERR_SUCCESS;
+}
+
+/**************************************/
+
 exr_result_t
 exr_decoding_update (
     exr_const_context_t     ctxt,
@@ -537,6 +945,9 @@ exr_decoding_update (
         decode->channels, decode->channel_count, cinfo, ctxt, part);
     decode->chunk = *cinfo;
 
+    if (rv == EXR_ERR_SUCCESS && decode->resolution_reduction > 0)
+        apply_resolution_reduction (part, decode);
+
     return rv;
 }
 
@@ -563,6 +974,19 @@ exr_decoding_run (
             EXR_ERR_INVALID_ARGUMENT,
             "Invalid request for decoding update from different context / part");
 
+    if (decode->user_column_begin_skip < 0 ||
+        decode->user_column_end_ignore < 0 ||
+        (int64_t) decode->user_column_begin_skip +
+                (int64_t) decode->user_column_end_ignore >
+            (int64_t) decode->chunk.width)
+        return ctxt->print_error (
+            ctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Invalid column range (skip %d, ignore %d) for chunk of width %d",
+            decode->user_column_begin_skip,
+            decode->user_column_end_ignore,
+            decode->chunk.width);
+
     if (!decode->read_fn)
         return ctxt->report_error (
             ctxt,
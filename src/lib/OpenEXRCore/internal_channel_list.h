@@ -45,6 +45,15 @@ exr_result_t exr_attr_chlist_duplicate (
     exr_attr_chlist_t*       chl,
     const exr_attr_chlist_t* srcchl);
 
+/** @brief Binary search of the (sorted) channel list by name.
+ *
+ * Returns the index of the channel, or -1 if not found. If @p insertpos is
+ * not `NULL`, it is filled with the index a channel of that name
+ * would need to be inserted at to keep the list sorted.
+ */
+int internal_chlist_find (
+    const exr_attr_chlist_t* chl, const char* name, int* insertpos);
+
 /** @brief Frees memory for the channel list and all channels inside */
 exr_result_t exr_attr_chlist_destroy (exr_context_t ctxt, exr_attr_chlist_t*);
 
@@ -107,6 +107,16 @@ exr_result_t internal_decode_alloc_buffer (
     size_t*                              cursz,
     size_t                               newsz);
 
+/* Validates a line of w cumulative (native endian) deep sample
+ * counts, which must not decrease, and stores the last one in
+ * total. If individual is non-zero, the line is converted in place
+ * to per-pixel sample counts. */
+exr_result_t internal_coding_unpack_sample_line (
+    int32_t* counts, int64_t w, int individual, int32_t* total);
+
+/* Sum of a line of w individual (non-negative) deep sample counts */
+uint64_t internal_coding_sum_sample_line (const int32_t* counts, int64_t w);
+
 /**************************************/
 
 static inline float
@@ -21,6 +21,10 @@ exr_result_t internal_exr_apply_rle (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_zip (exr_encode_pipeline_t* encode);
 
+exr_result_t internal_exr_apply_zipd (exr_encode_pipeline_t* encode);
+
+exr_result_t internal_exr_apply_zipd_table (exr_encode_pipeline_t* encode);
+
 exr_result_t internal_exr_apply_piz (exr_encode_pipeline_t* encode);
 
 exr_result_t internal_exr_apply_pxr24 (exr_encode_pipeline_t* encode);
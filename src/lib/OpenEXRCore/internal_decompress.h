@@ -31,6 +31,20 @@ exr_result_t internal_exr_undo_zip (
     void*                  uncompressed_data,
     uint64_t               uncompressed_size);
 
+exr_result_t internal_exr_undo_zipd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
+exr_result_t internal_exr_undo_zipd_table (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size);
+
 exr_result_t internal_exr_undo_piz (
     exr_decode_pipeline_t* decode,
     const void*            compressed_data,
@@ -42,6 +42,14 @@ typedef struct _DwaCompressor
 
     int   _zipLevel;
     float _dwaCompressionLevel;
+
+    //
+    // When decoding at 1/8 resolution, only the DC components are
+    // decoded, and the channels describe the chunk as stored
+    //
+
+    int                        _dcOnly;
+    exr_coding_channel_info_t* _storedChannels;
 } DwaCompressor;
 
 static exr_result_t DwaCompressor_construct (
@@ -88,6 +96,18 @@ static exr_result_t DwaCompressor_classifyChannels (DwaCompressor* me);
 
 static exr_result_t DwaCompressor_setupChannelData (DwaCompressor* me);
 
+//
+// Box filter a channel which is not lossy compressed into the
+// rows for 1/8 resolution decoding
+//
+
+static void DwaCompressor_reduceChannel (
+    DwaCompressor* me,
+    ChannelData*   cd,
+    const uint8_t* src,
+    size_t         byteStride,
+    size_t         pixelStride);
+
 /**************************************/
 
 exr_result_t
@@ -155,11 +175,40 @@ DwaCompressor_construct (
     }
     else
     {
-        exr_const_context_t pctxt = decode->context;
+        exr_const_context_t        pctxt = decode->context;
+        const exr_chunk_info_t*    chunk = &(decode->chunk);
+        exr_coding_channel_info_t* chans = decode->channels;
 
         me->alloc_fn = pctxt ? pctxt->alloc_fn : internal_exr_alloc;
         me->free_fn  = pctxt ? pctxt->free_fn : internal_exr_free;
 
+        if (decode->resolution_reduction > 0)
+        {
+            if (decode->resolution_reduction != 3)
+                return EXR_ERR_INVALID_ARGUMENT;
+
+            chunk = &(decode->stored_chunk);
+
+            me->_storedChannels = me->alloc_fn (
+                sizeof (exr_coding_channel_info_t) *
+                (size_t) decode->channel_count);
+            if (!me->_storedChannels) return EXR_ERR_OUT_OF_MEMORY;
+
+            memcpy (
+                me->_storedChannels,
+                decode->channels,
+                sizeof (exr_coding_channel_info_t) *
+                    (size_t) decode->channel_count);
+            for (int c = 0; c < decode->channel_count; ++c)
+            {
+                me->_storedChannels[c].width  = chunk->width;
+                me->_storedChannels[c].height = chunk->height;
+            }
+
+            chans       = me->_storedChannels;
+            me->_dcOnly = 1;
+        }
+
         me->_channelData = internal_exr_alloc_aligned (
             me->alloc_fn,
             &(me->_channel_mem),
@@ -175,16 +224,16 @@ DwaCompressor_construct (
         me->_numChannels = decode->channel_count;
         for (int c = 0; c < decode->channel_count; ++c)
         {
-            me->_channelData[c].chan        = decode->channels + c;
+            me->_channelData[c].chan        = chans + c;
             me->_channelData[c].compression = UNKNOWN;
         }
 
-        me->_numScanLines = decode->chunk.height;
+        me->_numScanLines = chunk->height;
 
-        me->_min[0] = decode->chunk.start_x;
-        me->_min[1] = decode->chunk.start_y;
-        me->_max[0] = me->_min[0] + decode->chunk.width - 1;
-        me->_max[1] = me->_min[1] + decode->chunk.height - 1;
+        me->_min[0] = chunk->start_x;
+        me->_min[1] = chunk->start_y;
+        me->_max[0] = me->_min[0] + chunk->width - 1;
+        me->_max[1] = me->_min[1] + chunk->height - 1;
     }
     return rv;
 }
@@ -208,6 +257,7 @@ DwaCompressor_destroy (DwaCompressor* me)
     }
 
     if (me->_cscChannelSets) me->free_fn (me->_cscChannelSets);
+    if (me->_storedChannels) me->free_fn (me->_storedChannels);
     if (me->_channelRules != sLegacyChannelRules &&
         me->_channelRules != sDefaultChannelRules)
     {
@@ -762,9 +812,12 @@ DwaCompressor_uncompress (
     const uint8_t* compressedAcBuf;
     const uint8_t* compressedDcBuf;
     const uint8_t* compressedRleBuf;
+    uint64_t       storedSize = uncompressed_size;
 
     if (iSize < headerSize) return EXR_ERR_CORRUPT_CHUNK;
 
+    if (me->_dcOnly) storedSize = me->_decode->stored_chunk.unpacked_size;
+
     //
     // Flip the counters from XDR to NATIVE
     //
@@ -809,9 +862,8 @@ DwaCompressor_uncompress (
     /* check for overflow conditions in the unc sizes, corrupt file no
        need to check the rleUncompressedSize, the zipped rle data will
        be checked below */
-    if (unknownUncompressedSize > uncompressed_size ||
-        rleRawSize > uncompressed_size ||
-        (unknownUncompressedSize + rleRawSize) > uncompressed_size)
+    if (unknownUncompressedSize > storedSize || rleRawSize > storedSize ||
+        (unknownUncompressedSize + rleRawSize) > storedSize)
     {
         return EXR_ERR_CORRUPT_CHUNK;
     }
@@ -934,10 +986,12 @@ DwaCompressor_uncompress (
     }
 
     //
-    // Uncompress the AC data into _packedAcBuffer
+    // Uncompress the AC data into _packedAcBuffer, unless only
+    // the DC components are needed
     //
 
-    if (acCompressedSize > 0)
+    if (me->_dcOnly) { totalAcUncompressedCount = 0; }
+    else if (acCompressedSize > 0)
     {
         if (!me->_packedAcBuffer ||
             totalAcUncompressedCount * sizeof (uint16_t) >
@@ -1076,22 +1130,49 @@ DwaCompressor_uncompress (
         me->_channelData[c].processed = 0;
     }
 
-    for (int y = me->_min[1]; y <= me->_max[1]; ++y)
+    if (me->_dcOnly)
     {
-        for (int c = 0; c < me->_numChannels; ++c)
+        //
+        // The output is the reduced chunk, channels are not sampled
+        //
+
+        for (int y = 0; y < me->_decode->chunk.height; ++y)
         {
-            ChannelData*               cd   = &(me->_channelData[c]);
-            exr_coding_channel_info_t* chan = cd->chan;
+            for (int c = 0; c < me->_numChannels; ++c)
+            {
+                ChannelData*                     cd = &(me->_channelData[c]);
+                const exr_coding_channel_info_t* outc =
+                    me->_decode->channels + c;
 
-            if ((y % chan->y_samples) != 0) continue;
+                rv = DctCoderChannelData_push_row (
+                    me->alloc_fn, me->free_fn, &(cd->_dctData), outBufferEnd);
+                if (rv != EXR_ERR_SUCCESS) return rv;
 
-            rv = DctCoderChannelData_push_row (
-                me->alloc_fn, me->free_fn, &(cd->_dctData), outBufferEnd);
-            if (rv != EXR_ERR_SUCCESS) return rv;
+                cd->_dctData._type = outc->data_type;
+                outBufferEnd +=
+                    (size_t) outc->width * (size_t) outc->bytes_per_element;
+            }
+        }
+    }
+    else
+    {
+        for (int y = me->_min[1]; y <= me->_max[1]; ++y)
+        {
+            for (int c = 0; c < me->_numChannels; ++c)
+            {
+                ChannelData*               cd   = &(me->_channelData[c]);
+                exr_coding_channel_info_t* chan = cd->chan;
+
+                if ((y % chan->y_samples) != 0) continue;
 
-            cd->_dctData._type = chan->data_type;
-            outBufferEnd +=
-                (size_t) chan->width * (size_t) chan->bytes_per_element;
+                rv = DctCoderChannelData_push_row (
+                    me->alloc_fn, me->free_fn, &(cd->_dctData), outBufferEnd);
+                if (rv != EXR_ERR_SUCCESS) return rv;
+
+                cd->_dctData._type = chan->data_type;
+                outBufferEnd +=
+                    (size_t) chan->width * (size_t) chan->bytes_per_element;
+            }
         }
     }
 
@@ -1130,7 +1211,13 @@ DwaCompressor_uncompress (
             me->_channelData[rChan].chan->height);
 
         if (rv == EXR_ERR_SUCCESS)
-            rv = LossyDctDecoder_execute (me->alloc_fn, me->free_fn, &decoder);
+        {
+            if (me->_dcOnly)
+                rv = LossyDctDecoder_executeDcOnly (&decoder);
+            else
+                rv = LossyDctDecoder_execute (
+                    me->alloc_fn, me->free_fn, &decoder);
+        }
 
         packedAcBufferEnd += decoder._packedAcCount * sizeof (uint16_t);
 
@@ -1193,8 +1280,13 @@ DwaCompressor_uncompress (
                         chan->height);
 
                     if (rv == EXR_ERR_SUCCESS)
-                        rv = LossyDctDecoder_execute (
-                            me->alloc_fn, me->free_fn, &decoder);
+                    {
+                        if (me->_dcOnly)
+                            rv = LossyDctDecoder_executeDcOnly (&decoder);
+                        else
+                            rv = LossyDctDecoder_execute (
+                                me->alloc_fn, me->free_fn, &decoder);
+                    }
 
                     packedAcBufferEnd +=
                         (size_t) decoder._packedAcCount * sizeof (uint16_t);
@@ -1218,6 +1310,16 @@ DwaCompressor_uncompress (
                 // order in the output buffer;
                 //
 
+                if (me->_dcOnly)
+                {
+                    DwaCompressor_reduceChannel (
+                        me,
+                        cd,
+                        cd->planarUncRleEnd[0],
+                        (size_t) chan->width * (size_t) chan->height,
+                        1);
+                }
+                else
                 {
                     int row = 0;
 
@@ -1263,6 +1365,21 @@ DwaCompressor_uncompress (
                 // and just needs to copied over to the output buffer
                 //
 
+                if (me->_dcOnly)
+                {
+                    if ((cd->planarUncBufferEnd +
+                         (size_t) chan->width * (size_t) chan->height *
+                             (size_t) pixelSize) >
+                        (me->_planarUncBuffer[UNKNOWN] +
+                         me->_planarUncBufferSize[UNKNOWN]))
+                    {
+                        return EXR_ERR_CORRUPT_CHUNK;
+                    }
+
+                    DwaCompressor_reduceChannel (
+                        me, cd, cd->planarUncBufferEnd, 1, (size_t) pixelSize);
+                }
+                else
                 {
                     int    row = 0;
                     size_t dstScanlineSize =
@@ -1443,7 +1560,8 @@ DwaCompressor_initializeBuffers (DwaCompressor* me, size_t* bufferSize)
     // to Huffman encoding
     //
 
-    if (maxLossyDctAcSize * numLossyDctChans > me->_packedAcBufferSize)
+    if (!me->_dcOnly &&
+        maxLossyDctAcSize * numLossyDctChans > me->_packedAcBufferSize)
     {
         me->_packedAcBufferSize = maxLossyDctAcSize * numLossyDctChans;
         if (me->_packedAcBufferSize > SIZE_MAX)
@@ -1805,3 +1923,89 @@ DwaCompressor_setupChannelData (DwaCompressor* me)
 
     return EXR_ERR_SUCCESS;
 }
+
+/**************************************/
+
+void
+DwaCompressor_reduceChannel (
+    DwaCompressor* me,
+    ChannelData*   cd,
+    const uint8_t* src,
+    size_t         byteStride,
+    size_t         pixelStride)
+{
+    const exr_coding_channel_info_t* chan      = cd->chan;
+    int pixelSize  = chan->bytes_per_element;
+    int step       = 1 << me->_decode->resolution_reduction;
+    int numBlocksX = (chan->width + step - 1) / step;
+    int numBlocksY = (chan->height + step - 1) / step;
+
+    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    {
+        uint8_t* dst = cd->_dctData._rows[blocky];
+        int      y0  = blocky * step;
+        int      y1  = (y0 + step < chan->height) ? y0 + step : chan->height;
+
+        for (int blockx = 0; blockx < numBlocksX; ++blockx)
+        {
+            int      x0 = blockx * step;
+            int      x1 = (x0 + step < chan->width) ? x0 + step : chan->width;
+            uint32_t v  = 0;
+
+            //
+            // UINT channels are typically ids, which can not be
+            // averaged, so take the first of the block
+            //
+
+            if (chan->data_type == EXR_PIXEL_UINT)
+            {
+                const uint8_t* p =
+                    src + ((size_t) y0 * (size_t) chan->width + (size_t) x0) *
+                              pixelStride;
+                for (int byte = pixelSize - 1; byte >= 0; --byte)
+                    v = (v << 8) | p[(size_t) byte * byteStride];
+            }
+            else
+            {
+                float sum = 0.f;
+
+                for (int y = y0; y < y1; ++y)
+                {
+                    for (int x = x0; x < x1; ++x)
+                    {
+                        const uint8_t* p =
+                            src +
+                            ((size_t) y * (size_t) chan->width + (size_t) x) *
+                                pixelStride;
+                        uint32_t bits = 0;
+
+                        for (int byte = pixelSize - 1; byte >= 0; --byte)
+                            bits = (bits << 8) | p[(size_t) byte * byteStride];
+
+                        if (chan->data_type == EXR_PIXEL_HALF)
+                            sum += half_to_float ((uint16_t) bits);
+                        else
+                        {
+                            float f;
+                            memcpy (&f, &bits, sizeof (f));
+                            sum += f;
+                        }
+                    }
+                }
+
+                sum /= (float) ((x1 - x0) * (y1 - y0));
+
+                if (chan->data_type == EXR_PIXEL_HALF)
+                    v = float_to_half (sum);
+                else
+                    memcpy (&v, &sum, sizeof (v));
+            }
+
+            for (int byte = 0; byte < pixelSize; ++byte)
+            {
+                *dst++ = (uint8_t) (v & 0xff);
+                v >>= 8;
+            }
+        }
+    }
+}
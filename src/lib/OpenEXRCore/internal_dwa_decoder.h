@@ -91,6 +91,12 @@ static exr_result_t LossyDctDecoderCsc_construct (
 static exr_result_t LossyDctDecoder_execute (
     void* (*alloc_fn) (size_t), void (*free_fn) (void*), LossyDctDecoder* d);
 
+//
+// Decode only the DC component of each block, producing one
+// value per 8x8 block in row y / 8, column x / 8 of the rows.
+//
+static exr_result_t LossyDctDecoder_executeDcOnly (LossyDctDecoder* d);
+
 //
 // Un-RLE the packed AC components into
 // a half buffer. The half block should
@@ -767,3 +773,91 @@ LossyDctDecoder_execute (
 }
 
 /**************************************/
+
+exr_result_t
+LossyDctDecoder_executeDcOnly (LossyDctDecoder* d)
+{
+    int                  numComp = d->_channel_decode_data_count;
+    DctCoderChannelData* chanData[3];
+    int                  numBlocksX = (d->_width + 7) / 8;
+    int                  numBlocksY = (d->_height + 7) / 8;
+    uint16_t*            currDcComp[3];
+
+    if (d->_remDcCount <
+        ((uint64_t) numComp * (uint64_t) numBlocksX * (uint64_t) numBlocksY))
+    {
+        return EXR_ERR_CORRUPT_CHUNK;
+    }
+
+    for (int chan = 0; chan < numComp; ++chan)
+    {
+        chanData[chan] = d->_channel_decode_data[chan];
+    }
+
+    currDcComp[0] = (uint16_t*) d->_packedDc;
+    for (int comp = 1; comp < numComp; ++comp)
+        currDcComp[comp] = currDcComp[comp - 1] + (size_t) numBlocksX * numBlocksY;
+
+    for (int blocky = 0; blocky < numBlocksY; ++blocky)
+    {
+        for (int blockx = 0; blockx < numBlocksX; ++blockx)
+        {
+            float val[3];
+
+            //
+            // The DC component is the block average (scaled), so
+            // the inverse DCT of a DC only block is a constant,
+            // and the AC components can be left alone entirely
+            //
+
+            for (int comp = 0; comp < numComp; ++comp)
+            {
+                uint16_t dc = *currDcComp[comp]++;
+
+                priv_to_native16 (&dc, 1);
+                val[comp] = half_to_float (dc) * 3.535536e-01f * 3.535536e-01f;
+
+                d->_packedDcCount++;
+            }
+
+            if (numComp == 3) csc709Inverse (val, val + 1, val + 2);
+
+            for (int comp = 0; comp < numComp; ++comp)
+            {
+                uint16_t h = float_to_half (val[comp]);
+
+                if (d->_toLinear) h = d->_toLinear[h];
+
+                unaligned_store16 (
+                    chanData[comp]->_rows[blocky] + blockx * sizeof (uint16_t),
+                    h);
+            }
+        }
+    }
+
+    //
+    // Walk over all the channels that are of type FLOAT.
+    // Convert from HALF XDR back to FLOAT XDR.
+    //
+
+    for (int chan = 0; chan < numComp; ++chan)
+    {
+        if (chanData[chan]->_type != EXR_PIXEL_FLOAT) continue;
+
+        for (int y = 0; y < numBlocksY; ++y)
+        {
+            uint8_t* rowBytes = chanData[chan]->_rows[y];
+
+            for (int x = numBlocksX - 1; x >= 0; --x)
+            {
+                uint16_t h = unaligned_load16 (rowBytes + x * sizeof (uint16_t));
+                float    f = half_to_float (h);
+                uint32_t bits;
+                memcpy (&bits, &f, sizeof (bits));
+                unaligned_store32 (rowBytes + x * sizeof (float), bits);
+            }
+        }
+    }
+
+    return EXR_ERR_SUCCESS;
+}
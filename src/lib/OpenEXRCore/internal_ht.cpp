@@ -17,6 +17,7 @@
 #include "openexr_decode.h"
 #include "openexr_encode.h"
 #include "internal_ht_common.h"
+#include "internal_util.h"
 
 /**
  * OpenJPH output file that is backed by a fixed-size memory buffer
@@ -217,6 +218,21 @@ ht_undo_impl (
     ojph::codestream cs;
     cs.read_headers (&infile);
 
+    /* when decoding at reduced resolution, the chunk describes the
+     * reduced chunk, and the finest wavelet levels are not decoded */
+    const exr_chunk_info_t& stored =
+        decode->resolution_reduction > 0 ? decode->stored_chunk
+                                         : decode->chunk;
+    const ojph::ui32 levels =
+        static_cast<ojph::ui32> (decode->resolution_reduction);
+
+    if (levels > 0)
+    {
+        if (levels > cs.access_cod ().get_num_decompositions ())
+            return EXR_ERR_INVALID_ARGUMENT;
+        cs.restrict_input_resolution (levels, levels);
+    }
+
     ojph::param_siz siz = cs.access_siz ();
 
     ojph::ui32 image_height =
@@ -224,11 +240,16 @@ ht_undo_impl (
     ojph::ui32 image_width =
         siz.get_image_extent ().x - siz.get_image_offset ().x;
 
-    if (decode->chunk.width != image_width
-        || decode->chunk.height != image_height
-        || decode->channel_count != siz.get_num_components())
+    if (static_cast<ojph::ui32> (stored.width) != image_width
+        || static_cast<ojph::ui32> (stored.height) != image_height
+        || static_cast<ojph::ui32> (decode->channel_count) !=
+               siz.get_num_components ())
         return EXR_ERR_CORRUPT_CHUNK;
 
+    /* the size of the decoded image */
+    image_height = (image_height + (1u << levels) - 1) >> levels;
+    image_width  = (image_width + (1u << levels) - 1) >> levels;
+
     for (int cs_i = 0; cs_i < decode->channel_count; cs_i++)
     {
         int file_i = cs_to_file_ch[cs_i].file_index;
@@ -252,6 +273,45 @@ ht_undo_impl (
     }
     if (bpl > INT32_MAX || bpl * decode->chunk.height > (int64_t) PTRDIFF_MAX)
         return EXR_ERR_CORRUPT_CHUNK;
+
+    /* components of channels which are not requested are not copied
+     * out, and when the codestream is read one component at a time,
+     * decoding stops after the last one requested. Components are
+     * only interleaved when color transformed, as the transform needs
+     * the first three together. Likewise, only the requested columns
+     * of each line are copied out */
+    std::vector<bool> wanted (decode->channel_count, true);
+    std::vector<int>  col_first (decode->channel_count, 0);
+    std::vector<int>  col_count (decode->channel_count);
+    int               last_wanted = decode->channel_count - 1;
+    for (int cs_i = 0; cs_i < decode->channel_count; cs_i++)
+        col_count[cs_i] = decode->channels[cs_to_file_ch[cs_i].file_index].width;
+    if (decode->decode_flags & EXR_DECODE_REQUESTED_CHANNELS_ONLY)
+    {
+        last_wanted = -1;
+        for (int cs_i = 0; cs_i < decode->channel_count; cs_i++)
+        {
+            int file_i   = cs_to_file_ch[cs_i].file_index;
+            wanted[cs_i] = decode->channels[file_i].decode_to_ptr != NULL;
+            if (wanted[cs_i]) last_wanted = cs_i;
+
+            col_count[cs_i] = compute_sampled_columns (
+                decode->channels[file_i].width,
+                decode->channels[file_i].x_samples,
+                decode->chunk.width,
+                decode->user_column_begin_skip,
+                decode->user_column_end_ignore,
+                &col_first[cs_i]);
+        }
+        if (last_wanted < 0)
+        {
+            infile.close ();
+            return rv;
+        }
+        if (last_wanted < decode->channel_count - 1 &&
+            !cs.access_cod ().is_using_color_transform ())
+            is_planar = true;
+    }
     cs.set_planar (is_planar);
 
     cs.create ();
@@ -262,7 +322,7 @@ ht_undo_impl (
     ojph::line_buf* cur_line;
     if (cs.is_planar ())
     {
-        for (int16_t c = 0; c < decode->channel_count; c++)
+        for (int16_t c = 0; c <= last_wanted; c++)
         {
             int file_c = cs_to_file_ch[c].file_index;
 
@@ -291,22 +351,25 @@ ht_undo_impl (
                         cur_line = cs.pull (next_comp);
                         assert (next_comp == c);
 
-                        if (decode->channels[file_c].data_type ==
-                            EXR_PIXEL_HALF)
+                        /* unwanted lines only advance the codestream */
+                        if (wanted[c] && decode->channels[file_c].data_type ==
+                                             EXR_PIXEL_HALF)
                         {
-                            int16_t* channel_pixels = (int16_t*) line_pixels;
-                            for (int32_t p = 0;
-                                 p < decode->channels[file_c].width;
+                            int16_t* channel_pixels =
+                                (int16_t*) line_pixels + col_first[c];
+                            for (int32_t p = col_first[c];
+                                 p < col_first[c] + col_count[c];
                                  p++)
                             {
                                 *channel_pixels++ = cur_line->i32[p];
                             }
                         }
-                        else
+                        else if (wanted[c])
                         {
-                            int32_t* channel_pixels = (int32_t*) line_pixels;
-                            for (int32_t p = 0;
-                                 p < decode->channels[file_c].width;
+                            int32_t* channel_pixels =
+                                (int32_t*) line_pixels + col_first[c];
+                            for (int32_t p = col_first[c];
+                                 p < col_first[c] + col_count[c];
                                  p++)
                             {
                                 *channel_pixels++ = cur_line->i32[p];
@@ -333,11 +396,14 @@ ht_undo_impl (
                 int file_c = cs_to_file_ch[c].file_index;
                 cur_line   = cs.pull (next_comp);
                 assert (next_comp == c);
+                if (!wanted[c]) continue;
                 if (decode->channels[file_c].data_type == EXR_PIXEL_HALF)
                 {
                     int16_t* channel_pixels =
-                        (int16_t*) (line_pixels + cs_to_file_ch[c].raster_line_offset);
-                    for (int32_t p = 0; p < decode->channels[file_c].width;
+                        (int16_t*) (line_pixels + cs_to_file_ch[c].raster_line_offset) +
+                        col_first[c];
+                    for (int32_t p = col_first[c];
+                         p < col_first[c] + col_count[c];
                          p++)
                     {
                         *channel_pixels++ = cur_line->i32[p];
@@ -346,8 +412,10 @@ ht_undo_impl (
                 else
                 {
                     int32_t* channel_pixels =
-                        (int32_t*) (line_pixels + cs_to_file_ch[c].raster_line_offset);
-                    for (int32_t p = 0; p < decode->channels[file_c].width;
+                        (int32_t*) (line_pixels + cs_to_file_ch[c].raster_line_offset) +
+                        col_first[c];
+                    for (int32_t p = col_first[c];
+                         p < col_first[c] + col_count[c];
                          p++)
                     {
                         *channel_pixels++ = cur_line->i32[p];
@@ -214,8 +214,12 @@ struct _priv_exr_context_t
 
     int64_t             file_size;
     exr_read_func_ptr_t read_fn;
+    /* caller owned file data when reading from memory, NULL otherwise */
+    const uint8_t* memory_data;
 
     exr_write_func_ptr_t write_fn;
+    /* caller owned output buffer when writing to memory, NULL otherwise */
+    exr_memory_output_buffer_t* memory_output;
     /* used when writing under a mutex, is there a better way? */
     uint64_t output_file_offset;
     int      cur_output_part;
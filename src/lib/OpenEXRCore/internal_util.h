@@ -61,4 +61,28 @@ compute_sampled_width (int width, int x_sampling, int start_x)
     return (width == 1) ? 1 : (width / x_sampling);
 }
 
+/*
+ * computes the samples of a channel of chan_width samples which fall
+ * in the columns [begin_skip, width - end_ignore) of a chunk of width
+ * columns, returning the count and the index of the first in first.
+ * Relies on start_x % x_sampling == 0 as compute_sampled_width does
+ */
+static inline int
+compute_sampled_columns (
+    int chan_width,
+    int x_sampling,
+    int width,
+    int begin_skip,
+    int end_ignore,
+    int* first)
+{
+    int xs  = (x_sampling > 1) ? x_sampling : 1;
+    int beg = (begin_skip + xs - 1) / xs;
+    int end = (width - end_ignore + xs - 1) / xs;
+
+    if (end > chan_width) end = chan_width;
+    *first = beg;
+    return (end > beg) ? (end - beg) : 0;
+}
+
 #endif /* OPENEXR_PRIVATE_UTIL_H */
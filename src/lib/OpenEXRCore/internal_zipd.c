@@ -0,0 +1,642 @@
+/*
+** SPDX-License-Identifier: BSD-3-Clause
+** Copyright Contributors to the OpenEXR Project.
+*/
+
+#include "internal_compress.h"
+#include "internal_decompress.h"
+
+#include "internal_coding.h"
+#include "internal_structs.h"
+#include "internal_xdr.h"
+
+#include <string.h>
+
+#include "openexr_compression.h"
+
+/*
+ * ZIPD compression is a lossless compression of deep data, tuned for
+ * the sample lists of deep pixels, which are sorted by depth.
+ *
+ * The samples of each line of the chunk are split by channel. Each
+ * sample is predicted from the previous sample in the list of the
+ * same pixel, and the first sample of a pixel from the first sample
+ * of the previous non-empty pixel of the line. The prediction is done
+ * on the float bit patterns remapped to ordered integers, so the
+ * difference between neighbouring depths is a small integer. The
+ * zig-zag coded differences are split into byte planes per channel
+ * run and then deflated.
+ *
+ * The sample count table is turned back into individual counts,
+ * predicted from the counts to the left of and above each pixel and
+ * stored the same way.
+ *
+ * Flat data is handled as deep data with one sample per pixel, which
+ * reduces the prediction to the neighbour on the left.
+ */
+
+/**************************************/
+
+static inline uint32_t
+order32 (uint32_t v)
+{
+    return (v & 0x80000000u) ? ~v : (v | 0x80000000u);
+}
+
+static inline uint32_t
+unorder32 (uint32_t v)
+{
+    return (v & 0x80000000u) ? (v & 0x7fffffffu) : ~v;
+}
+
+static inline uint16_t
+order16 (uint16_t v)
+{
+    return (v & 0x8000u) ? (uint16_t) ~v : (uint16_t) (v | 0x8000u);
+}
+
+static inline uint16_t
+unorder16 (uint16_t v)
+{
+    return (v & 0x8000u) ? (uint16_t) (v & 0x7fffu) : (uint16_t) ~v;
+}
+
+static inline uint32_t
+zigzag32 (uint32_t d)
+{
+    return (d << 1) ^ (0u - (d >> 31));
+}
+
+static inline uint32_t
+unzigzag32 (uint32_t z)
+{
+    return (z >> 1) ^ (0u - (z & 1u));
+}
+
+static inline uint16_t
+zigzag16 (uint16_t d)
+{
+    return (uint16_t) ((d << 1) ^ (0u - (d >> 15)));
+}
+
+static inline uint16_t
+unzigzag16 (uint16_t z)
+{
+    return (uint16_t) ((z >> 1) ^ (0u - (z & 1u)));
+}
+
+/**************************************/
+
+/*
+ * The runs of one channel of one line: nsamp samples, in npix pixel
+ * lists whose cumulative counts are in cum (little endian, as stored
+ * in the file), or one sample per pixel if cum is NULL.
+ */
+
+static void
+encode_run32 (
+    uint8_t*       planes,
+    const uint8_t* src,
+    uint64_t       nsamp,
+    int            ordered,
+    const int32_t* cum,
+    int64_t        npix)
+{
+    uint8_t* p0    = planes;
+    uint8_t* p1    = p0 + nsamp;
+    uint8_t* p2    = p1 + nsamp;
+    uint8_t* p3    = p2 + nsamp;
+    uint32_t first = 0, prev = 0;
+    uint64_t s     = 0;
+
+    for (int64_t x = 0; x < npix; ++x)
+    {
+        uint64_t end =
+            cum ? (uint64_t) one_to_native32 ((uint32_t) cum[x]) : s + 1;
+        uint64_t start = s;
+
+        for (; s < end; ++s)
+        {
+            uint32_t v, z;
+
+            memcpy (&v, src + s * 4, 4);
+            v = one_to_native32 (v);
+            if (ordered) v = order32 (v);
+
+            z = zigzag32 (v - ((s == start) ? first : prev));
+            if (s == start) first = v;
+            prev = v;
+
+            p0[s] = (uint8_t) (z);
+            p1[s] = (uint8_t) (z >> 8);
+            p2[s] = (uint8_t) (z >> 16);
+            p3[s] = (uint8_t) (z >> 24);
+        }
+    }
+}
+
+static void
+decode_run32 (
+    uint8_t*       dst,
+    const uint8_t* planes,
+    uint64_t       nsamp,
+    int            ordered,
+    const int32_t* cum,
+    int64_t        npix)
+{
+    const uint8_t* p0    = planes;
+    const uint8_t* p1    = p0 + nsamp;
+    const uint8_t* p2    = p1 + nsamp;
+    const uint8_t* p3    = p2 + nsamp;
+    uint32_t       first = 0, prev = 0;
+    uint64_t       s     = 0;
+
+    for (int64_t x = 0; x < npix; ++x)
+    {
+        uint64_t end =
+            cum ? (uint64_t) one_to_native32 ((uint32_t) cum[x]) : s + 1;
+        uint64_t start = s;
+
+        for (; s < end; ++s)
+        {
+            uint32_t z = (uint32_t) p0[s] | ((uint32_t) p1[s] << 8) |
+                         ((uint32_t) p2[s] << 16) | ((uint32_t) p3[s] << 24);
+            uint32_t v = unzigzag32 (z) + ((s == start) ? first : prev);
+
+            if (s == start) first = v;
+            prev = v;
+
+            if (ordered) v = unorder32 (v);
+            v = one_from_native32 (v);
+            memcpy (dst + s * 4, &v, 4);
+        }
+    }
+}
+
+static void
+encode_run16 (
+    uint8_t*       planes,
+    const uint8_t* src,
+    uint64_t       nsamp,
+    const int32_t* cum,
+    int64_t        npix)
+{
+    uint8_t* p0    = planes;
+    uint8_t* p1    = p0 + nsamp;
+    uint16_t first = 0, prev = 0;
+    uint64_t s     = 0;
+
+    for (int64_t x = 0; x < npix; ++x)
+    {
+        uint64_t end =
+            cum ? (uint64_t) one_to_native32 ((uint32_t) cum[x]) : s + 1;
+        uint64_t start = s;
+
+        for (; s < end; ++s)
+        {
+            uint16_t v, z;
+
+            memcpy (&v, src + s * 2, 2);
+            v = order16 (one_to_native16 (v));
+
+            z = zigzag16 ((uint16_t) (v - ((s == start) ? first : prev)));
+            if (s == start) first = v;
+            prev = v;
+
+            p0[s] = (uint8_t) (z);
+            p1[s] = (uint8_t) (z >> 8);
+        }
+    }
+}
+
+static void
+decode_run16 (
+    uint8_t*       dst,
+    const uint8_t* planes,
+    uint64_t       nsamp,
+    const int32_t* cum,
+    int64_t        npix)
+{
+    const uint8_t* p0    = planes;
+    const uint8_t* p1    = p0 + nsamp;
+    uint16_t       first = 0, prev = 0;
+    uint64_t       s     = 0;
+
+    for (int64_t x = 0; x < npix; ++x)
+    {
+        uint64_t end =
+            cum ? (uint64_t) one_to_native32 ((uint32_t) cum[x]) : s + 1;
+        uint64_t start = s;
+
+        for (; s < end; ++s)
+        {
+            uint16_t z = (uint16_t) (p0[s] | (p1[s] << 8));
+            uint16_t v =
+                (uint16_t) (unzigzag16 (z) + ((s == start) ? first : prev));
+
+            if (s == start) first = v;
+            prev = v;
+
+            v = one_from_native16 (unorder16 (v));
+            memcpy (dst + s * 2, &v, 2);
+        }
+    }
+}
+
+/**************************************/
+
+/* returns the number of samples in a line of the sample count table,
+ * or -1 if the cumulative counts decrease */
+static int64_t
+line_sample_count (const int32_t* cum, int64_t w)
+{
+    int32_t last = 0;
+    for (int64_t x = 0; x < w; ++x)
+    {
+        int32_t c = (int32_t) one_to_native32 ((uint32_t) cum[x]);
+        if (c < last) return -1;
+        last = c;
+    }
+    return last;
+}
+
+/*
+ * Walks the channel runs of the chunk, converting between the packed
+ * data in raw and the byte planes of the predicted samples in
+ * planes. Returns 0 if the runs do not exactly cover the bytes of
+ * the chunk.
+ */
+static int
+transform_chunk (
+    const exr_coding_channel_info_t* chans,
+    int                              nchans,
+    const exr_chunk_info_t*          chunk,
+    const int32_t*                   table,
+    uint8_t*                         planes,
+    uint8_t*                         raw,
+    uint64_t                         bytes,
+    int                              encode)
+{
+    int      isdeep = (chunk->type == EXR_STORAGE_DEEP_SCANLINE ||
+                  chunk->type == EXR_STORAGE_DEEP_TILED);
+    int64_t  w      = chunk->width;
+    uint64_t off    = 0;
+
+    if (isdeep && !table) return 0;
+
+    for (int64_t y = 0; y < chunk->height; ++y)
+    {
+        const int32_t* cum   = NULL;
+        int64_t        npix  = 0;
+        int64_t        nsamp = 0;
+        int            cury  = chunk->start_y + (int) y;
+
+        if (isdeep)
+        {
+            cum   = table + y * w;
+            npix  = w;
+            nsamp = line_sample_count (cum, w);
+            if (nsamp < 0) return 0;
+        }
+
+        for (int c = 0; c < nchans; ++c)
+        {
+            const exr_coding_channel_info_t* curc = chans + c;
+            uint64_t                         bpe  = curc->bytes_per_element;
+            uint64_t                         runbytes;
+
+            if (!isdeep)
+            {
+                if (curc->height == 0) continue;
+                if (curc->y_samples > 1 && (cury % curc->y_samples) != 0)
+                    continue;
+                npix = nsamp = curc->width;
+            }
+
+            runbytes = (uint64_t) nsamp * bpe;
+            if (runbytes > bytes - off) return 0;
+
+            if (bpe == 4)
+            {
+                int ordered = curc->data_type != EXR_PIXEL_UINT;
+                if (encode)
+                    encode_run32 (
+                        planes + off, raw + off, nsamp, ordered, cum, npix);
+                else
+                    decode_run32 (
+                        raw + off, planes + off, nsamp, ordered, cum, npix);
+            }
+            else if (bpe == 2)
+            {
+                if (encode)
+                    encode_run16 (planes + off, raw + off, nsamp, cum, npix);
+                else
+                    decode_run16 (raw + off, planes + off, nsamp, cum, npix);
+            }
+            else
+                return 0;
+
+            off += runbytes;
+        }
+    }
+
+    return off == bytes;
+}
+
+/**************************************/
+
+static inline int32_t
+table_count (const int32_t* cum, int64_t x)
+{
+    uint32_t c = one_to_native32 ((uint32_t) cum[x]);
+    if (x > 0) c -= one_to_native32 ((uint32_t) cum[x - 1]);
+    return (int32_t) c;
+}
+
+/* median edge detector of the individual counts of the neighbours */
+static inline uint32_t
+predict_count (const int32_t* cum, const int32_t* above, int64_t x)
+{
+    int64_t a, b, c;
+
+    if (!above) return (x > 0) ? (uint32_t) table_count (cum, x - 1) : 0u;
+    if (x == 0) return (uint32_t) table_count (above, 0);
+
+    a = table_count (cum, x - 1);
+    b = table_count (above, x);
+    c = table_count (above, x - 1);
+
+    if (c >= (a > b ? a : b)) return (uint32_t) (a < b ? a : b);
+    if (c <= (a < b ? a : b)) return (uint32_t) (a > b ? a : b);
+    return (uint32_t) (a + b - c);
+}
+
+static void
+encode_table (
+    uint8_t* planes, const int32_t* table, int64_t w, int64_t h)
+{
+    uint64_t n  = (uint64_t) w * (uint64_t) h;
+    uint8_t* p0 = planes;
+    uint8_t* p1 = p0 + n;
+    uint8_t* p2 = p1 + n;
+    uint8_t* p3 = p2 + n;
+    uint64_t s  = 0;
+
+    for (int64_t y = 0; y < h; ++y)
+    {
+        const int32_t* cum   = table + y * w;
+        const int32_t* above = (y > 0) ? cum - w : NULL;
+
+        for (int64_t x = 0; x < w; ++x, ++s)
+        {
+            uint32_t z = zigzag32 (
+                (uint32_t) table_count (cum, x) - predict_count (cum, above, x));
+
+            p0[s] = (uint8_t) (z);
+            p1[s] = (uint8_t) (z >> 8);
+            p2[s] = (uint8_t) (z >> 16);
+            p3[s] = (uint8_t) (z >> 24);
+        }
+    }
+}
+
+static void
+decode_table (int32_t* table, const uint8_t* planes, int64_t w, int64_t h)
+{
+    uint64_t       n  = (uint64_t) w * (uint64_t) h;
+    const uint8_t* p0 = planes;
+    const uint8_t* p1 = p0 + n;
+    const uint8_t* p2 = p1 + n;
+    const uint8_t* p3 = p2 + n;
+    uint64_t       s  = 0;
+
+    for (int64_t y = 0; y < h; ++y)
+    {
+        int32_t*       cum   = table + y * w;
+        const int32_t* above = (y > 0) ? cum - w : NULL;
+        uint32_t       total = 0;
+
+        for (int64_t x = 0; x < w; ++x, ++s)
+        {
+            uint32_t z = (uint32_t) p0[s] | ((uint32_t) p1[s] << 8) |
+                         ((uint32_t) p2[s] << 16) | ((uint32_t) p3[s] << 24);
+
+            total += unzigzag32 (z) + predict_count (cum, above, x);
+            cum[x] = (int32_t) one_from_native32 (total);
+        }
+    }
+}
+
+/**************************************/
+
+static exr_result_t
+deflate_planes (
+    exr_encode_pipeline_t* encode,
+    const void*            raw,
+    uint64_t               rawbytes,
+    const void*            planes,
+    void*                  out,
+    size_t                 outsz,
+    size_t*                actual)
+{
+    int          level;
+    exr_result_t rv;
+
+    rv = exr_get_zip_compression_level (
+        encode->context, encode->part_index, &level);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = exr_compress_buffer (
+        encode->context, level, planes, rawbytes, out, outsz, actual);
+
+    if (rv == EXR_ERR_SUCCESS && *actual >= rawbytes)
+    {
+        memcpy (out, raw, rawbytes);
+        *actual = rawbytes;
+    }
+    return rv;
+}
+
+exr_result_t
+internal_exr_apply_zipd (exr_encode_pipeline_t* encode)
+{
+    exr_result_t rv;
+    size_t       compbufsz;
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        encode->packed_bytes);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (!transform_chunk (
+            encode->channels,
+            encode->channel_count,
+            &(encode->chunk),
+            encode->sample_count_table,
+            encode->scratch_buffer_1,
+            encode->packed_buffer,
+            encode->packed_bytes,
+            1))
+    {
+        exr_const_context_t pctxt = encode->context;
+        return pctxt->report_error (
+            pctxt,
+            EXR_ERR_INVALID_ARGUMENT,
+            "Sample data does not match the channels and sample counts of the chunk");
+    }
+
+    rv = deflate_planes (
+        encode,
+        encode->packed_buffer,
+        encode->packed_bytes,
+        encode->scratch_buffer_1,
+        encode->compressed_buffer,
+        encode->compressed_alloc_size,
+        &compbufsz);
+    if (rv == EXR_ERR_SUCCESS) encode->compressed_bytes = compbufsz;
+    return rv;
+}
+
+exr_result_t
+internal_exr_apply_zipd_table (exr_encode_pipeline_t* encode)
+{
+    exr_result_t rv;
+    size_t       compbufsz;
+    int64_t      w = encode->chunk.width;
+    int64_t      h = encode->chunk.height;
+    uint64_t     n = (uint64_t) w * (uint64_t) h * sizeof (int32_t);
+
+    rv = internal_encode_alloc_buffer (
+        encode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(encode->scratch_buffer_1),
+        &(encode->scratch_alloc_size_1),
+        n);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    encode_table (encode->scratch_buffer_1, encode->sample_count_table, w, h);
+
+    rv = deflate_planes (
+        encode,
+        encode->sample_count_table,
+        n,
+        encode->scratch_buffer_1,
+        encode->packed_sample_count_table,
+        encode->packed_sample_count_alloc_size,
+        &compbufsz);
+    if (rv == EXR_ERR_SUCCESS) encode->packed_sample_count_bytes = compbufsz;
+    return rv;
+}
+
+/**************************************/
+
+static exr_result_t
+inflate_planes (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    uint64_t               uncompressed_size)
+{
+    exr_result_t rv;
+    size_t       actual_out_bytes;
+
+    rv = internal_decode_alloc_buffer (
+        decode,
+        EXR_TRANSCODE_BUFFER_SCRATCH1,
+        &(decode->scratch_buffer_1),
+        &(decode->scratch_alloc_size_1),
+        uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    rv = exr_uncompress_buffer (
+        decode->context,
+        compressed_data,
+        comp_buf_size,
+        decode->scratch_buffer_1,
+        uncompressed_size,
+        &actual_out_bytes);
+    if (rv == EXR_ERR_SUCCESS && actual_out_bytes != uncompressed_size)
+        rv = EXR_ERR_CORRUPT_CHUNK;
+    return rv;
+}
+
+exr_result_t
+internal_exr_undo_zipd (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+    exr_result_t rv;
+
+    if (comp_buf_size == uncompressed_size)
+    {
+        decode->bytes_decompressed = comp_buf_size;
+        if (compressed_data != uncompressed_data)
+            memcpy (uncompressed_data, compressed_data, comp_buf_size);
+        return EXR_ERR_SUCCESS;
+    }
+
+    /* the samples of a deep chunk can only be put back in order with
+     * the sample counts, which are only valid when the chunk had a
+     * table to decompress them from */
+    if ((decode->chunk.type == EXR_STORAGE_DEEP_SCANLINE ||
+         decode->chunk.type == EXR_STORAGE_DEEP_TILED) &&
+        (decode->chunk.sample_count_table_size == 0 ||
+         !decode->sample_count_table))
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    rv = inflate_planes (
+        decode, compressed_data, comp_buf_size, uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    if (!transform_chunk (
+            decode->channels,
+            decode->channel_count,
+            &(decode->chunk),
+            decode->sample_count_table,
+            decode->scratch_buffer_1,
+            uncompressed_data,
+            uncompressed_size,
+            0))
+        return EXR_ERR_CORRUPT_CHUNK;
+
+    decode->bytes_decompressed = uncompressed_size;
+    return EXR_ERR_SUCCESS;
+}
+
+exr_result_t
+internal_exr_undo_zipd_table (
+    exr_decode_pipeline_t* decode,
+    const void*            compressed_data,
+    uint64_t               comp_buf_size,
+    void*                  uncompressed_data,
+    uint64_t               uncompressed_size)
+{
+    exr_result_t rv;
+    int64_t      w = decode->chunk.width;
+    int64_t      h = decode->chunk.height;
+
+    if ((uint64_t) w * (uint64_t) h * sizeof (int32_t) != uncompressed_size)
+        return EXR_ERR_INVALID_ARGUMENT;
+
+    /* tiled writers store a table which does not shrink padded to
+     * the full tile size */
+    if (comp_buf_size >= uncompressed_size)
+    {
+        if (compressed_data != uncompressed_data)
+            memcpy (uncompressed_data, compressed_data, uncompressed_size);
+        return EXR_ERR_SUCCESS;
+    }
+
+    rv = inflate_planes (
+        decode, compressed_data, comp_buf_size, uncompressed_size);
+    if (rv != EXR_ERR_SUCCESS) return rv;
+
+    decode_table (uncompressed_data, decode->scratch_buffer_1, w, h);
+    return EXR_ERR_SUCCESS;
+}
@@ -47,6 +47,7 @@ typedef enum
     EXR_COMPRESSION_DWAB  = 9,
     EXR_COMPRESSION_HTJ2K256  = 10,
     EXR_COMPRESSION_HTJ2K32   = 11,
+    EXR_COMPRESSION_ZIPD      = 12,
     EXR_COMPRESSION_LAST_TYPE /**< Invalid value, provided for range checking. */
 } exr_compression_t;
 
@@ -411,6 +411,31 @@ EXR_EXPORT exr_result_t exr_start_read (
     const char*                      filename,
     const exr_context_initializer_t* ctxtdata);
 
+/** @brief Create and initialize a read-only exr read context over a
+ * buffer in memory.
+ *
+ * This behaves as exr_start_read(), but the file data is the @p size
+ * bytes at @p data, which must remain valid and unmodified until
+ * exr_finish() is called. No copy of the buffer is made, no locking
+ * is needed to read from it, and the decoding pipeline references
+ * the compressed chunk data in the buffer directly instead of
+ * reading it into a separate allocation.
+ *
+ * The @p name is for informational purposes only (error messages,
+ * exr_get_file_name()) and may be `NULL`.
+ *
+ * Any read, size, or write functions in @p ctxtdata are ignored. The
+ * user data and destroy function are retained, so the destroy
+ * function may be used to release the buffer when the context is
+ * finished.
+ */
+EXR_EXPORT exr_result_t exr_start_read_from_memory (
+    exr_context_t*                   ctxt,
+    const char*                      name,
+    const void*                      data,
+    uint64_t                         size,
+    const exr_context_initializer_t* ctxtdata);
+
 /** @brief Enum describing how default files are handled during write. */
 typedef enum exr_default_write_mode
 {
@@ -470,6 +495,40 @@ EXR_EXPORT exr_result_t exr_start_write (
     exr_default_write_mode_t         default_mode,
     const exr_context_initializer_t* ctxtdata);
 
+/** @brief Growable output buffer for exr_start_write_to_memory().
+ *
+ * The buffer is grown geometrically using the allocation routines of
+ * the context as data is written. It may be pre-allocated by the
+ * caller with the same allocation routines to avoid growing it.
+ */
+typedef struct _exr_memory_output_buffer
+{
+    void*    data;     /**< The file data, owned by the caller once finished. */
+    uint64_t size;     /**< The number of bytes of file data written. */
+    uint64_t capacity; /**< The allocated size of @ref data. */
+} exr_memory_output_buffer_t;
+
+/** @brief Create and initialize a write-only context writing into a
+ * buffer in memory.
+ *
+ * This behaves as exr_start_write(), but the file is written into
+ * @p outbuf, starting at offset 0. Data is written in place, so the
+ * chunk offset table is filled in at exr_finish() without copying the
+ * image data again. @p outbuf must remain valid until exr_finish() is
+ * called, after which @p outbuf->data holds @p outbuf->size bytes of
+ * file data and belongs to the caller, to be released with the free
+ * function of the initializer (or the default memory routines if none
+ * was provided). This is the case even if writing fails.
+ *
+ * The @p name is for informational purposes only and may be `NULL`.
+ * Any read, size, or write functions in @p ctxtdata are ignored.
+ */
+EXR_EXPORT exr_result_t exr_start_write_to_memory (
+    exr_context_t*                   ctxt,
+    const char*                      name,
+    exr_memory_output_buffer_t*      outbuf,
+    const exr_context_initializer_t* ctxtdata);
+
 /** @brief Create a new context for updating an exr file in place.
  *
  * This is a custom mode that allows one to modify the value of a
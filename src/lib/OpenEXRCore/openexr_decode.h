@@ -46,6 +46,9 @@ extern "C" {
  * If this is NOT set (0), the default unpacking routine assumes the
  * data will be planar and contiguous (each channel is a separate
  * memory block), ignoring user_line_stride and user_pixel_stride.
+ * For deep data, the samples of the chunk are then stored back to back
+ * in each channel's block, in the same order as the sample count
+ * table, starting at the first line after user_line_begin_skip.
  */
 #define EXR_DECODE_NON_IMAGE_DATA_AS_POINTERS ((uint16_t) (1 << 1))
 
@@ -54,6 +57,34 @@ extern "C" {
  */
 #define EXR_DECODE_SAMPLE_DATA_ONLY ((uint16_t) (1 << 2))
 
+/** Can be bit-wise or'ed into the decode_flags in the decode pipeline.
+ *
+ * Indicates that only the channels with a non-`NULL` decode_to_ptr
+ * are needed from the unpacked buffer, such that the decompression
+ * step may leave the others undefined if it can avoid decoding them,
+ * as well as the columns outside of the requested column range.
+ * At the moment, this is used by HTJ2K, which stops decoding the
+ * codestream after the last requested component when it is not
+ * color transformed, and only copies out the requested columns.
+ *
+ * This is set by exr_decoding_choose_default_routines() when the
+ * default routines it picks only read the requested channels, so
+ * must be cleared if replacing the unpack routine with one which
+ * reads channels without a decode_to_ptr.
+ */
+#define EXR_DECODE_REQUESTED_CHANNELS_ONLY ((uint16_t) (1 << 3))
+
+/** Can be bit-wise or'ed into the decode_flags in the decode pipeline.
+ *
+ * When decimating (see user_decimation), indicates that each pixel
+ * written is the average of the block of pixels it is the top left
+ * corner of, rather than a copy of that pixel. The block is clipped
+ * to the chunk and the column range, so is only complete when the chunk boundaries are
+ * multiples of the decimation factor. UINT channels are always point
+ * sampled.
+ */
+#define EXR_DECODE_DECIMATE_BOX_FILTER ((uint16_t) (1 << 4))
+
 /**
  * Struct meant to be used on a per-thread basis for reading exr data
  *
@@ -119,6 +150,11 @@ typedef struct _exr_decode_pipeline
      * If the caller wishes to take control of the buffer, simple
      * adopt the pointer and set it to `NULL` here. Be cognizant of any
      * custom allocators.
+     *
+     * For a context created with exr_start_read_from_memory(), the
+     * default read routine points this at the chunk data in the
+     * caller's buffer, leaving packed_alloc_size as 0. It must not be
+     * modified or adopted in that case.
      */
     void* packed_buffer;
 
@@ -264,6 +300,55 @@ typedef struct _exr_decode_pipeline
      * this being used.
      */
     exr_coding_channel_info_t _quick_chan_store[5];
+
+    /*
+     * The fields below are new in 4.0. They grow the structure, and
+     * exr_decoding_initialize() and exr_decoding_destroy() assign the
+     * whole structure, so this is an ABI break: applications must be
+     * rebuilt against this header.
+     */
+
+    /** Number of resolution levels discarded when decoding, such that
+     * the chunk is decoded at 1/2^n of its size in each direction.
+     *
+     * Set using exr_decoding_set_resolution_reduction(). When non-zero,
+     * \ref chunk and the channel widths and heights describe the
+     * reduced chunk, and \ref stored_chunk the chunk as stored in the
+     * file.
+     */
+    int32_t          resolution_reduction;
+    exr_chunk_info_t stored_chunk;
+
+    /** How many columns of the chunk to skip filling, assumes the
+     * pointer is at the first column to be filled (i.e. includes
+     * this skip so does not need to be adjusted). For channels with
+     * x sampling, the samples at or after this column are filled.
+     *
+     * Only used for non-deep data. Set before calling
+     * exr_decoding_choose_default_routines(), which then chooses
+     * routines that only read and unpack the requested columns. The
+     * range may then change from chunk to chunk, but routines chosen
+     * without a column range ignore it, so must be chosen again.
+     */
+    int32_t user_column_begin_skip;
+
+    /** How many columns of the chunk to ignore at the end, assumes
+     * the output is meant to be N columns narrower
+     */
+    int32_t user_column_end_ignore;
+
+    /** When greater than 1, only the pixels whose x and y coordinates
+     * are multiples of this factor are written to the output, such
+     * that the channel pointers and strides describe an image which
+     * is this factor smaller in each direction, as if it were sampled
+     * at this rate. The line and column skips still refer to the
+     * chunk, and the pointers are at the first pixel written.
+     *
+     * Only used for non-deep parts without sub-sampled channels. Like
+     * the column range, set before calling
+     * exr_decoding_choose_default_routines().
+     */
+    int32_t user_decimation;
 } exr_decode_pipeline_t;
 
 /** @brief Simple macro to initialize an empty decode pipeline. */
@@ -293,11 +378,69 @@ exr_result_t exr_decoding_initialize (
  * just the raw compressed data is desired. Although in that scenario,
  * it is probably easier to just read the chunk directly using 
  * exr_read_chunk().
+ *
+ * For non-deep parts, this also sets
+ * \ref EXR_DECODE_REQUESTED_CHANNELS_ONLY, so channels without a
+ * decode_to_ptr may be skipped when decompressing.
  */
 EXR_EXPORT
 exr_result_t exr_decoding_choose_default_routines (
     exr_const_context_t ctxt, int part_index, exr_decode_pipeline_t* decode);
 
+/** Compute the data window of a part as decoded at a reduced
+ * resolution of 1/2^@p levels in each direction.
+ *
+ * The minimum of the window is divided by 2^@p levels, rounding
+ * down, and the size is divided by 2^@p levels, rounding up. This is
+ * the layout produced by exr_decoding_set_resolution_reduction() for
+ * the chunks of the part. For tiled parts, a tile at index (dx, dy)
+ * of a level is placed at an offset of (dx, dy) times the tile size
+ * divided by 2^@p levels from the minimum of the window.
+ *
+ * Returns EXR_ERR_INVALID_ARGUMENT if the part can not be decoded at
+ * that resolution: it must be HTJ2K compressed, or DWAA / DWAB
+ * compressed with @p levels of 3, not deep, not have any sub-sampled
+ * channels, and the scanlines per chunk or the tile sizes must be
+ * multiples of 2^@p levels.
+ */
+EXR_EXPORT
+exr_result_t exr_get_reduced_data_window (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    int                 levels,
+    exr_attr_box2i_t*   out);
+
+/** Request that the chunks be decoded at a reduced resolution of
+ * 1/2^@p levels in each direction, by discarding wavelet resolution
+ * levels of the HTJ2K codestream.
+ *
+ * This is much cheaper than decoding at full resolution and
+ * subsampling the result, as the discarded levels are never decoded,
+ * and the intermediate buffers are only allocated at the reduced
+ * size. The values are those of the low-pass wavelet band, so are
+ * filtered, not point sampled. Chunks which were stored uncompressed
+ * (because compression did not reduce their size) are point sampled.
+ *
+ * DWAA / DWAB compressed parts can be decoded at 1/8 resolution
+ * (@p levels of 3). The lossy channels are then reconstructed from the
+ * DC coefficient of each 8x8 block alone, skipping the decoding of the
+ * AC coefficients and the inverse DCT. The remaining channels are box
+ * filtered, except for UINT channels, which are point sampled.
+ *
+ * Call after exr_decoding_initialize() and before filling in the
+ * channel output information, as this updates the chunk and channel
+ * sizes to the reduced sizes. The setting is retained by
+ * exr_decoding_update(). Setting @p levels back to 0 restores full
+ * resolution decoding. See exr_get_reduced_data_window() for the
+ * requirements on the part and the resulting layout.
+ */
+EXR_EXPORT
+exr_result_t exr_decoding_set_resolution_reduction (
+    exr_const_context_t    ctxt,
+    int                    part_index,
+    exr_decode_pipeline_t* decode,
+    int                    levels);
+
 /** Given a decode pipeline previously initialized, update it for the
  * new chunk to be read.
  *
@@ -368,6 +368,22 @@ EXR_EXPORT exr_result_t exr_copy_unset_attributes (
 EXR_EXPORT exr_result_t exr_get_channels (
     exr_const_context_t ctxt, int part_index, const exr_attr_chlist_t** chlist);
 
+/** @brief Find the index of a channel by name.
+ *
+ * The channel list is kept sorted by name, so this is a binary
+ * search, and is substantially faster than a linear scan of the list
+ * returned by exr_get_channels() for parts with many channels. The
+ * index returned matches both the index in that channel list and in
+ * the channels array of an encode / decode pipeline for the part.
+ *
+ * Returns EXR_ERR_NO_ATTR_BY_NAME if there is no such channel.
+ */
+EXR_EXPORT exr_result_t exr_find_channel (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    const char*         name,
+    int32_t*            chan_index);
+
 /** @brief Define a new channel to the output file part.
  *
  * The @p percept parameter is used for lossy compression techniques
@@ -634,6 +634,32 @@ exr_get_channels (
 
 /**************************************/
 
+exr_result_t
+exr_find_channel (
+    exr_const_context_t ctxt,
+    int                 part_index,
+    const char*         name,
+    int32_t*            chan_index)
+{
+    int idx;
+    EXR_LOCK_WRITE_AND_DEFINE_PART (part_index);
+
+    if (!name || !chan_index)
+        return EXR_UNLOCK_WRITE_AND_RETURN (
+            ctxt->standard_error (ctxt, EXR_ERR_INVALID_ARGUMENT));
+
+    if (!part->channels || part->channels->type != EXR_ATTR_CHLIST)
+        return EXR_UNLOCK_WRITE_AND_RETURN (EXR_ERR_NO_ATTR_BY_NAME);
+
+    idx = internal_chlist_find (part->channels->chlist, name, NULL);
+    if (idx < 0) return EXR_UNLOCK_WRITE_AND_RETURN (EXR_ERR_NO_ATTR_BY_NAME);
+
+    *chan_index = idx;
+    return EXR_UNLOCK_WRITE_AND_RETURN (EXR_ERR_SUCCESS);
+}
+
+/**************************************/
+
 exr_result_t
 exr_add_channel (
     exr_context_t              ctxt,
@@ -6,6 +6,7 @@
 #include "internal_coding.h"
 #include "internal_xdr.h"
 #include "internal_cpuid.h"
+#include "internal_util.h"
 
 #include "openexr_attr.h"
 
@@ -1234,7 +1235,7 @@ generic_unpack (exr_decode_pipeline_t* decode)
 {
     const uint8_t* srcbuffer = decode->unpacked_buffer;
     uint8_t*       cdata;
-    int            w, h, bpc, ubpc, uls;
+    int            w, h, bpc, ubpc, uls, colfirst, colcount;
 
     uls = decode->user_line_begin_skip;
     h = decode->chunk.height - decode->user_line_end_ignore;
@@ -1284,9 +1285,200 @@ generic_unpack (exr_decode_pipeline_t* decode)
                 cdata += ((uint64_t) (y - uls)) * ((uint64_t) decc->user_line_stride);
             }
 
+            colcount = compute_sampled_columns (
+                w,
+                decc->x_samples,
+                decode->chunk.width,
+                decode->user_column_begin_skip,
+                decode->user_column_end_ignore,
+                &colfirst);
+            srcbuffer += (int64_t) colfirst * bpc;
+            UNPACK_SAMPLES (colcount)
+            srcbuffer += (int64_t) (w - colfirst) * bpc;
+        }
+    }
+    return EXR_ERR_SUCCESS;
+}
+
+/* limit on the number of requested channels the sparse unpacker will
+ * track on the stack, beyond which the generic unpacker is used */
+#define EXR_SPARSE_UNPACK_MAX_CHANNELS 64
+
+/*
+ * When only a subset of the channels of a part without vertical
+ * sampling is requested, every scanline of the unpacked buffer has
+ * the same layout, so the offset of each requested channel can be
+ * computed once per chunk. The per-line work is then proportional to
+ * the number of requested channels, not the number of channels in
+ * the part, which matters for parts with hundreds or thousands of
+ * channels where only a few are being read. The same holds for the
+ * columns when only a horizontal range of the chunk is requested.
+ */
+static exr_result_t
+generic_unpack_sparse (exr_decode_pipeline_t* decode)
+{
+    exr_coding_channel_info_t* chans[EXR_SPARSE_UNPACK_MAX_CHANNELS];
+    uint64_t                   chanoffs[EXR_SPARSE_UNPACK_MAX_CHANNELS];
+    int                        chancounts[EXR_SPARSE_UNPACK_MAX_CHANNELS];
+    const uint8_t*             srcline = decode->unpacked_buffer;
+    const uint8_t*             srcbuffer;
+    uint8_t*                   cdata;
+    uint64_t                   linebytes = 0;
+    int                        nchans = 0, w, ubpc, uls, h, colfirst;
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        exr_coding_channel_info_t* decc = (decode->channels + c);
+
+        /* the routine is chosen from the requested channels only, but
+         * the line layout depends on all of them */
+        if (decc->y_samples != 1) return generic_unpack (decode);
+
+        if (decc->decode_to_ptr)
+        {
+            if (nchans == EXR_SPARSE_UNPACK_MAX_CHANNELS)
+                return generic_unpack (decode);
+            chancounts[nchans] = compute_sampled_columns (
+                decc->width,
+                decc->x_samples,
+                decode->chunk.width,
+                decode->user_column_begin_skip,
+                decode->user_column_end_ignore,
+                &colfirst);
+            chans[nchans]    = decc;
+            chanoffs[nchans] = linebytes + (uint64_t) colfirst *
+                                               (uint64_t) decc->bytes_per_element;
+            ++nchans;
+        }
+        linebytes += (uint64_t) decc->width * (uint64_t) decc->bytes_per_element;
+    }
+
+    uls = decode->user_line_begin_skip;
+    h   = decode->chunk.height - decode->user_line_end_ignore;
+
+    srcline += (uint64_t) uls * linebytes;
+    for (int y = uls; y < h; ++y)
+    {
+        for (int c = 0; c < nchans; ++c)
+        {
+            exr_coding_channel_info_t* decc = chans[c];
+
+            cdata = decc->decode_to_ptr;
+            cdata += ((uint64_t) (y - uls)) * ((uint64_t) decc->user_line_stride);
+            srcbuffer = srcline + chanoffs[c];
+            w         = chancounts[c];
+            ubpc      = decc->user_pixel_stride;
+
             UNPACK_SAMPLES (w)
-            srcbuffer += (int64_t) w * bpc;
         }
+        srcline += linebytes;
+    }
+    return EXR_ERR_SUCCESS;
+}
+
+/* distance from v to the next multiple of n at or after it */
+static inline int
+decimate_offset (int v, int n)
+{
+    int r = v % n;
+    if (r < 0) r += n;
+    return (r == 0) ? 0 : (n - r);
+}
+
+static inline float
+decimate_load (const uint8_t* src, exr_pixel_type_t type)
+{
+    union
+    {
+        uint32_t i;
+        float    f;
+    } v;
+
+    if (type == EXR_PIXEL_HALF) return half_to_float (unaligned_load16 (src));
+    v.i = unaligned_load32 (src);
+    return v.f;
+}
+
+/*
+ * Writes only the pixels whose coordinates are multiples of the
+ * decimation factor, either copying each or averaging the block it
+ * is the top left corner of, clipped to the chunk and the column
+ * range. As there are no sub-sampled channels, every line of the
+ * unpacked buffer has the same layout, so only the lines and
+ * columns written (or averaged) are visited.
+ */
+static exr_result_t
+generic_unpack_decimate (exr_decode_pipeline_t* decode)
+{
+    const uint8_t* srcline;
+    const uint8_t* srcbuffer;
+    uint8_t*       outline;
+    uint8_t*       cdata;
+    uint64_t       linebytes = 0, chanoff = 0;
+    int            n    = decode->user_decimation;
+    int            box  = (decode->decode_flags & EXR_DECODE_DECIMATE_BOX_FILTER);
+    int            h    = decode->chunk.height - decode->user_line_end_ignore;
+    int            xend = decode->chunk.width - decode->user_column_end_ignore;
+    int            x0, y0, bpc, ubpc, bw, bh;
+
+    for (int c = 0; c < decode->channel_count; ++c)
+        linebytes += (uint64_t) decode->channels[c].width *
+                     (uint64_t) decode->channels[c].bytes_per_element;
+
+    x0 = decode->user_column_begin_skip;
+    x0 += decimate_offset (decode->chunk.start_x + x0, n);
+    y0 = decode->user_line_begin_skip;
+    y0 += decimate_offset (decode->chunk.start_y + y0, n);
+
+    for (int c = 0; c < decode->channel_count; ++c)
+    {
+        exr_coding_channel_info_t* decc = (decode->channels + c);
+
+        bpc     = decc->bytes_per_element;
+        ubpc    = decc->user_pixel_stride;
+        outline = decc->decode_to_ptr;
+        for (int y = y0; outline && y < h; y += n)
+        {
+            srcline = decode->unpacked_buffer + (uint64_t) y * linebytes + chanoff;
+            bh      = (y + n < decode->chunk.height) ? n : (decode->chunk.height - y);
+            cdata   = outline;
+            for (int x = x0; x < xend; x += n)
+            {
+                srcbuffer = srcline + (uint64_t) x * (uint64_t) bpc;
+                if (box && decc->data_type != EXR_PIXEL_UINT)
+                {
+                    float sum = 0.f;
+
+                    bw = (x + n < xend) ? n : (xend - x);
+                    for (int by = 0; by < bh; ++by)
+                        for (int bx = 0; bx < bw; ++bx)
+                            sum += decimate_load (
+                                srcbuffer + (uint64_t) by * linebytes +
+                                    (uint64_t) bx * (uint64_t) bpc,
+                                (exr_pixel_type_t) decc->data_type);
+                    sum /= (float) (bw * bh);
+
+                    switch (decc->user_data_type)
+                    {
+                        case EXR_PIXEL_HALF:
+                            *((uint16_t*) cdata) = float_to_half (sum);
+                            break;
+                        case EXR_PIXEL_FLOAT: *((float*) cdata) = sum; break;
+                        case EXR_PIXEL_UINT:
+                            *((uint32_t*) cdata) = float_to_uint (sum);
+                            break;
+                        default: return EXR_ERR_INVALID_ARGUMENT;
+                    }
+                    cdata += ubpc;
+                }
+                else
+                {
+                    UNPACK_SAMPLES (1)
+                }
+            }
+            outline += decc->user_line_stride;
+        }
+        chanoff += (uint64_t) decc->width * (uint64_t) bpc;
     }
     return EXR_ERR_SUCCESS;
 }
@@ -1329,10 +1521,8 @@ generic_unpack_deep_pointers (exr_decode_pipeline_t* decode)
                 prevsamps = 0;
                 if ((decode->decode_flags &
                      EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL))
-                {
-                    for (int x = 0; x < w; ++x)
-                        prevsamps += sampbuffer[x];
-                }
+                    prevsamps = (int32_t) internal_coding_sum_sample_line (
+                        sampbuffer, w);
                 else
                     prevsamps = sampbuffer[w - 1];
                 srcbuffer += ((size_t) bpc) * ((size_t) prevsamps);
@@ -1535,15 +1725,14 @@ generic_unpack_deep (exr_decode_pipeline_t* decode)
             ubpc  = decc->user_bytes_per_element;
             cdata = decc->decode_to_ptr;
 
-            if (!cdata)
+            /* skipped lines are not stored, same as channels not read */
+            if (y < uls || !cdata)
             {
                 prevsamps = 0;
                 if ((decode->decode_flags &
                      EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL))
-                {
-                    for (int x = 0; x < w; ++x)
-                        prevsamps += sampbuffer[x];
-                }
+                    prevsamps = (int32_t) internal_coding_sum_sample_line (
+                        sampbuffer, w);
                 else
                     prevsamps = sampbuffer[w - 1];
 
@@ -1556,6 +1745,26 @@ generic_unpack_deep (exr_decode_pipeline_t* decode)
 
             cdata += totsamps * ((size_t) ubpc);
 
+#if !EXR_HOST_IS_NOT_LITTLE_ENDIAN
+            /* the samples of a line are contiguous on both sides, so
+             * when no conversion is needed they are a single copy */
+            if (decc->data_type == decc->user_data_type && bpc == ubpc)
+            {
+                size_t linesamps = 0;
+                if ((decode->decode_flags &
+                     EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL))
+                    linesamps = (size_t) internal_coding_sum_sample_line (
+                        sampbuffer, w);
+                else
+                    linesamps = (size_t) sampbuffer[w - 1];
+
+                memcpy (cdata, srcbuffer, linesamps * ((size_t) bpc));
+                srcbuffer += linesamps * ((size_t) bpc);
+                if (incr_tot) totsamps += linesamps;
+                continue;
+            }
+#endif
+
             switch (decc->data_type)
             {
                 case EXR_PIXEL_HALF:
@@ -1721,6 +1930,21 @@ internal_exr_match_decode (
         return &generic_unpack_deep;
     }
 
+    if (decode->user_decimation > 1) return &generic_unpack_decimate;
+
+    /* only the generic unpackers handle a column range */
+    if (decode->user_column_begin_skip > 0 ||
+        decode->user_column_end_ignore > 0)
+    {
+        if (!hassampling && chanstofill <= EXR_SPARSE_UNPACK_MAX_CHANNELS)
+            return &generic_unpack_sparse;
+        return &generic_unpack;
+    }
+
+    if (!hassampling && chanstofill < decode->channel_count &&
+        chanstofill <= EXR_SPARSE_UNPACK_MAX_CHANNELS)
+        return &generic_unpack_sparse;
+
     if (hastypechange > 0)
     {
         /* other optimizations would not be difficult, but this will
@@ -662,10 +662,11 @@ validate_deep_data (exr_context_t f, exr_priv_part_t curpart)
     {
         const exr_attr_chlist_t* channels = curpart->channels->chlist;
 
-        // none, rle, zips
+        // none, rle, zips, zipd
         if (curpart->comp_type != EXR_COMPRESSION_NONE &&
             curpart->comp_type != EXR_COMPRESSION_RLE &&
-            curpart->comp_type != EXR_COMPRESSION_ZIPS)
+            curpart->comp_type != EXR_COMPRESSION_ZIPS &&
+            curpart->comp_type != EXR_COMPRESSION_ZIPD)
             return f->report_error (
                 f, EXR_ERR_INVALID_ATTR, "Invalid compression for deep data");
 
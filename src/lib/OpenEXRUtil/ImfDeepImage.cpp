@@ -11,6 +11,8 @@
 
 #include "ImfDeepImage.h"
 #include "Iex.h"
+#include "ImfHeader.h"
+#include "ImfStandardAttributes.h"
 #include <cassert>
 
 using namespace IMATH_NAMESPACE;
@@ -62,6 +64,27 @@ DeepImage::level (int lx, int ly) const
     return static_cast<const DeepImageLevel&> (Image::level (lx, ly));
 }
 
+void
+DeepImage::tidy ()
+{
+    for (int ly = 0; ly < numYLevels (); ++ly)
+    {
+        for (int lx = 0; lx < numXLevels (); ++lx)
+        {
+            if (levelMode () != RIPMAP_LEVELS && lx != ly) continue;
+
+            level (lx, ly).tidy ();
+        }
+    }
+}
+
+void
+DeepImage::tidy (Header& hdr)
+{
+    tidy ();
+    addDeepImageState (hdr, DIS_TIDY);
+}
+
 DeepImageLevel*
 DeepImage::newLevel (int lx, int ly, const Box2i& dataWindow)
 {
@@ -16,6 +16,7 @@
 //----------------------------------------------------------------------------
 
 #include "ImfDeepImageLevel.h"
+#include "ImfForward.h"
 #include "ImfImage.h"
 #include "ImfUtilExport.h"
 
@@ -52,6 +53,15 @@ public:
     IMFUTIL_EXPORT virtual DeepImageLevel&       level (int lx, int ly);
     IMFUTIL_EXPORT virtual const DeepImageLevel& level (int lx, int ly) const;
 
+    //
+    // Tidy the pixels of all levels (see DeepImageLevel::tidy()).
+    // tidy(hdr) also sets the deepImageState attribute of header hdr
+    // to DIS_TIDY, for saving the image with saveDeepImage().
+    //
+
+    IMFUTIL_EXPORT void tidy ();
+    IMFUTIL_EXPORT void tidy (Header& hdr);
+
 protected:
     IMFUTIL_EXPORT
     virtual DeepImageLevel*
@@ -10,9 +10,14 @@
 //----------------------------------------------------------------------------
 
 #include "ImfDeepImageLevel.h"
+#include "IlmThreadPool.h"
 #include "ImfDeepImage.h"
+#include "ImfThreading.h"
 #include "Iex.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <vector>
 
 using namespace IMATH_NAMESPACE;
 using namespace IEX_NAMESPACE;
@@ -20,12 +25,477 @@ using namespace std;
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
 
+namespace
+{
+
+//
+// Support for DeepImageLevel::tidy()
+//
+
+enum ChannelRole
+{
+    FRONT, // Z
+    BACK,  // ZBack
+    ALPHA, // A
+    COLOR, // other half and float channels, premultiplied by A
+    OTHER  // unsigned int channels
+};
+
+struct TidyChannel
+{
+    DeepImageChannel* channel;
+    PixelType         type;
+    ChannelRole       role;
+};
+
+inline double
+loadSample (PixelType type, const void* samples, size_t i)
+{
+    switch (type)
+    {
+        case UINT: return static_cast<const unsigned int*> (samples)[i];
+        case HALF: return static_cast<const half*> (samples)[i];
+        case FLOAT: return static_cast<const float*> (samples)[i];
+        default: assert (false); return 0;
+    }
+}
+
+inline void
+storeSample (PixelType type, void* samples, size_t i, double value)
+{
+    switch (type)
+    {
+        case UINT:
+            static_cast<unsigned int*> (samples)[i] = (unsigned int) value;
+            break;
+        case HALF: static_cast<half*> (samples)[i] = half (float (value)); break;
+        case FLOAT: static_cast<float*> (samples)[i] = float (value); break;
+        default: assert (false);
+    }
+}
+
+inline void*
+sampleList (const TidyChannel& c, int r, int x)
+{
+    switch (c.type)
+    {
+        case UINT:
+            return static_cast<DeepUIntChannel*> (c.channel)->row (r)[x];
+        case HALF:
+            return static_cast<DeepHalfChannel*> (c.channel)->row (r)[x];
+        case FLOAT:
+            return static_cast<DeepFloatChannel*> (c.channel)->row (r)[x];
+        default: assert (false); return 0;
+    }
+}
+
+//
+// The part of sample s between depths front and back; a whole
+// sample if front and back are those of the sample.
+//
+
+struct Piece
+{
+    unsigned int s;
+    double       front;
+    double       back;
+    bool         whole;
+
+    bool operator< (const Piece& other) const
+    {
+        return front < other.front ||
+               (front == other.front && back < other.back);
+    }
+};
+
+//
+// Splitting and merging of samples, from "Interpreting OpenEXR Deep
+// Pixels": a fraction f of a volume sample with opacity a has opacity
+// 1 - (1 - a)^f, and colors are scaled with the opacity.
+//
+
+inline double
+splitAlpha (double a, double f)
+{
+    if (a >= 1) return 1;
+    if (a <= 0) return 0;
+    return -std::expm1 (f * std::log1p (-a));
+}
+
+inline double
+splitColor (double c, double a, double splitA, double f)
+{
+    if (a >= 1) return c;
+    if (a <= 0) return c * f;
+    return c * splitA / a;
+}
+
+//
+// The results of tidying a band of rows of a level: the new sample
+// counts and the new samples of each channel, in row-major order
+//
+
+struct TidyBand
+{
+    int                    r1, r2;
+    vector<unsigned int>   counts;
+    vector<vector<double>> samples;
+    bool                   changed = false;
+    std::string            error;
+};
+
+class PixelTidier
+{
+public:
+    PixelTidier (
+        const SampleCountChannel& counts, const vector<TidyChannel>& channels)
+        : _counts (counts), _channels (channels)
+    {
+        for (size_t c = 0; c < channels.size (); ++c)
+        {
+            if (channels[c].role == FRONT) _front = int (c);
+            if (channels[c].role == BACK) _back = int (c);
+            if (channels[c].role == ALPHA) _alpha = int (c);
+        }
+    }
+
+    void tidyBand (TidyBand& band);
+    void storeBand (TidyBand& band) const;
+
+private:
+    void tidyPixel (TidyBand& band, int r, int x);
+
+    double alpha (const Piece& piece) const
+    {
+        return _alpha >= 0
+                   ? loadSample (_channels[_alpha].type, _lists[_alpha], piece.s)
+                   : 0;
+    }
+
+    double fraction (const Piece& piece) const
+    {
+        if (piece.whole) return 1;
+
+        double front =
+            loadSample (_channels[_front].type, _lists[_front], piece.s);
+        double back = loadSample (_channels[_back].type, _lists[_back], piece.s);
+        return (piece.back - piece.front) / (back - front);
+    }
+
+    const SampleCountChannel&  _counts;
+    const vector<TidyChannel>& _channels;
+    int                        _front = -1;
+    int                        _back  = -1;
+    int                        _alpha = -1;
+
+    // per-pixel scratch space
+    vector<const void*> _lists;
+    vector<double>      _depths;
+    vector<Piece>       _pieces;
+};
+
+void
+PixelTidier::tidyBand (TidyBand& band)
+{
+    band.samples.assign (_channels.size (), vector<double> ());
+    _lists.resize (_channels.size ());
+
+    for (int r = band.r1; r < band.r2; ++r)
+        for (int x = 0; x < _counts.pixelsPerRow (); ++x)
+            tidyPixel (band, r, x);
+}
+
+void
+PixelTidier::tidyPixel (TidyBand& band, int r, int x)
+{
+    unsigned int n = _counts.row (r)[x];
+
+    for (size_t c = 0; c < _channels.size (); ++c)
+        _lists[c] = sampleList (_channels[c], r, x);
+
+    //
+    // Split every volume sample at the front and back
+    // depths of all the other samples.
+    //
+
+    _depths.clear ();
+    for (unsigned int s = 0; s < n; ++s)
+    {
+        _depths.push_back (loadSample (
+            _channels[_front].type, _lists[_front], s));
+        if (_back >= 0)
+            _depths.push_back (loadSample (
+                _channels[_back].type, _lists[_back], s));
+    }
+
+    std::sort (_depths.begin (), _depths.end ());
+    _depths.erase (std::unique (_depths.begin (), _depths.end ()), _depths.end ());
+
+    _pieces.clear ();
+    for (unsigned int s = 0; s < n; ++s)
+    {
+        double front =
+            loadSample (_channels[_front].type, _lists[_front], s);
+        double back = _back >= 0 ? loadSample (
+                                       _channels[_back].type, _lists[_back], s)
+                                 : front;
+
+        if (!(back > front))
+        {
+            _pieces.push_back ({s, front, front, true});
+            continue;
+        }
+
+        auto i = std::upper_bound (_depths.begin (), _depths.end (), front);
+        bool whole = *i >= back;
+
+        while (front < back)
+        {
+            double end = std::min (*i++, back);
+            _pieces.push_back ({s, front, end, whole});
+            front = end;
+        }
+    }
+
+    std::stable_sort (_pieces.begin (), _pieces.end ());
+
+    //
+    // Merge pieces with the same depth range.
+    //
+
+    size_t       first   = band.samples[0].size ();
+    unsigned int count   = 0;
+    bool         changed = false;
+
+    for (size_t p = 0; p < _pieces.size (); ++count)
+    {
+        size_t q = p + 1;
+        while (q < _pieces.size () && _pieces[q].front == _pieces[p].front &&
+               _pieces[q].back == _pieces[p].back)
+            ++q;
+
+        if (q == p + 1 && _pieces[p].whole)
+        {
+            //
+            // A sample that is neither split nor merged keeps its values.
+            //
+
+            changed |= _pieces[p].s != count;
+
+            for (size_t c = 0; c < _channels.size (); ++c)
+                band.samples[c].push_back (
+                    loadSample (_channels[c].type, _lists[c], _pieces[p].s));
+
+            p = q;
+            continue;
+        }
+
+        changed = true;
+
+        //
+        // Opacities of the pieces, and their sum in optical depth,
+        // u = -log (1 - a), to merge them.
+        //
+
+        double totalU  = 0;
+        bool   opaque  = false;
+        int    nOpaque = 0;
+
+        for (size_t i = p; i < q; ++i)
+        {
+            double a = alpha (_pieces[i]);
+            double splitA = splitAlpha (a, fraction (_pieces[i]));
+
+            if (splitA >= 1)
+            {
+                opaque = true;
+                ++nOpaque;
+            }
+            else
+                totalU -= std::log1p (-splitA);
+        }
+
+        double mergedA = opaque ? 1 : -std::expm1 (-totalU);
+        double scale   = (totalU > 0 && !opaque) ? mergedA / totalU : 1;
+
+        for (size_t c = 0; c < _channels.size (); ++c)
+        {
+            const TidyChannel& channel = _channels[c];
+            double             value   = 0;
+
+            switch (channel.role)
+            {
+                case FRONT: value = _pieces[p].front; break;
+                case BACK: value = _pieces[p].back; break;
+                case ALPHA: value = mergedA; break;
+                case OTHER:
+                    value = loadSample (channel.type, _lists[c], _pieces[p].s);
+                    break;
+
+                case COLOR:
+
+                    for (size_t i = p; i < q; ++i)
+                    {
+                        const Piece& piece  = _pieces[i];
+                        double       a      = alpha (piece);
+                        double       f      = fraction (piece);
+                        double       splitA = splitAlpha (a, f);
+                        double       splitC = splitColor (
+                            loadSample (channel.type, _lists[c], piece.s),
+                            a,
+                            splitA,
+                            f);
+
+                        //
+                        // Opaque pieces hide the others: average them.
+                        // Otherwise weight each piece by its share of the
+                        // optical depth.
+                        //
+
+                        if (opaque)
+                        {
+                            if (splitA >= 1) value += splitC / nOpaque;
+                        }
+                        else if (splitA > 0)
+                            value += splitC * -std::log1p (-splitA) / splitA;
+                        else
+                            value += splitC;
+                    }
+
+                    value *= scale;
+                    break;
+            }
+
+            band.samples[c].push_back (value);
+        }
+
+        p = q;
+    }
+
+    changed |= count != n;
+    band.counts.push_back (count);
+    band.changed |= changed;
+
+    if (!changed)
+    {
+        //
+        // Nothing to do for this pixel; drop its copy.
+        //
+
+        for (auto& samples: band.samples)
+            samples.resize (first);
+        band.counts.back () = ~0u;
+    }
+}
+
+void
+PixelTidier::storeBand (TidyBand& band) const
+{
+    size_t i = 0;
+    size_t p = 0;
+
+    for (int r = band.r1; r < band.r2; ++r)
+    {
+        for (int x = 0; x < _counts.pixelsPerRow (); ++x, ++p)
+        {
+            unsigned int n = band.counts[p];
+
+            if (n == ~0u) continue;
+
+            for (size_t c = 0; c < _channels.size (); ++c)
+            {
+                void* samples = sampleList (_channels[c], r, x);
+
+                for (unsigned int s = 0; s < n; ++s)
+                    storeSample (
+                        _channels[c].type, samples, s, band.samples[c][i + s]);
+            }
+
+            i += n;
+        }
+    }
+}
+
+class TidyTask final : public ILMTHREAD_NAMESPACE::Task
+{
+public:
+    TidyTask (
+        ILMTHREAD_NAMESPACE::TaskGroup* group,
+        const SampleCountChannel&       counts,
+        const vector<TidyChannel>&      channels,
+        TidyBand&                       band,
+        bool                            store)
+        : Task (group)
+        , _counts (counts)
+        , _channels (channels)
+        , _band (band)
+        , _store (store)
+    {}
+
+    void execute () override
+    {
+        try
+        {
+            PixelTidier tidier (_counts, _channels);
+
+            if (_store)
+                tidier.storeBand (_band);
+            else
+                tidier.tidyBand (_band);
+        }
+        catch (std::exception& e)
+        {
+            _band.error = e.what ();
+        }
+        catch (...)
+        {
+            _band.error = "unknown exception";
+        }
+    }
+
+private:
+    const SampleCountChannel&  _counts;
+    const vector<TidyChannel>& _channels;
+    TidyBand&                  _band;
+    bool                       _store;
+};
+
+void
+runTidyTasks (
+    const SampleCountChannel&  counts,
+    const vector<TidyChannel>& channels,
+    vector<TidyBand>&          bands,
+    bool                       store)
+{
+    {
+        ILMTHREAD_NAMESPACE::TaskGroup group;
+
+        for (TidyBand& band: bands)
+        {
+            ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
+                new TidyTask (&group, counts, channels, band, store));
+        }
+    }
+
+    for (const TidyBand& band: bands)
+    {
+        if (!band.error.empty ())
+            THROW (ArgExc, "Cannot tidy deep image level: " << band.error);
+    }
+}
+
+} // namespace
+
 DeepImageLevel::DeepImageLevel (
     DeepImage&   image,
     int          xLevelNumber,
     int          yLevelNumber,
     const Box2i& dataWindow)
-    : ImageLevel (image, xLevelNumber, yLevelNumber), _sampleCounts (*this)
+    : ImageLevel (image, xLevelNumber, yLevelNumber)
+    , _sampleCounts (*this)
+    , _editing (false)
+    , _editFirstRow (0)
+    , _editLastRow (-1)
 {
     resize (dataWindow);
 }
@@ -251,6 +721,102 @@ DeepImageLevel::channel (const string& name) const
     return *i->second;
 }
 
+void
+DeepImageLevel::tidy ()
+{
+    vector<TidyChannel> channels;
+    bool                hasZ = false;
+
+    for (ChannelMap::iterator i = _channels.begin (); i != _channels.end ();
+         ++i)
+    {
+        TidyChannel c;
+        c.channel = i->second;
+        c.type    = i->second->pixelType ();
+
+        if (i->first == "Z")
+            c.role = FRONT;
+        else if (i->first == "ZBack")
+            c.role = BACK;
+        else if (i->first == "A")
+            c.role = ALPHA;
+        else
+            c.role = c.type == UINT ? OTHER : COLOR;
+
+        if (c.role == FRONT) hasZ = true;
+
+        if (i->second->xSampling () != 1 || i->second->ySampling () != 1)
+        {
+            THROW (
+                ArgExc,
+                "Cannot tidy deep image channel "
+                    << i->first << ". Its x and y sampling rates must be 1.");
+        }
+
+        channels.push_back (c);
+    }
+
+    if (!hasZ)
+        THROW (ArgExc, "Cannot tidy deep image level without a Z channel.");
+
+    //
+    // Tidy bands of rows in parallel, keeping only the pixels that
+    // change, then update the sample counts if needed, and store the
+    // new samples, again in parallel.
+    //
+
+    int rows    = _sampleCounts.pixelsPerColumn ();
+    int threads = globalThreadCount ();
+    int perBand = std::max (1, rows / std::max (1, 4 * threads));
+
+    vector<TidyBand> bands;
+    for (int r = 0; r < rows; r += perBand)
+    {
+        TidyBand band;
+        band.r1 = r;
+        band.r2 = std::min (r + perBand, rows);
+        bands.push_back (band);
+    }
+
+    runTidyTasks (_sampleCounts, channels, bands, false);
+
+    int firstRow = rows;
+    int lastRow  = -1;
+
+    for (const TidyBand& band: bands)
+    {
+        if (!band.changed) continue;
+
+        firstRow = std::min (firstRow, band.r1);
+        lastRow  = std::max (lastRow, band.r2 - 1);
+    }
+
+    if (lastRow < firstRow) return;
+
+    {
+        //
+        // A row edit keeps the samples of all pixels,
+        // including the ones that tidy() leaves unchanged.
+        //
+
+        SampleCountChannel::RowEdit edit (_sampleCounts, firstRow, lastRow);
+        int                         width = _sampleCounts.pixelsPerRow ();
+
+        for (const TidyBand& band: bands)
+        {
+            if (!band.changed) continue;
+
+            unsigned int* counts =
+                edit.sampleCounts () + size_t (band.r1 - firstRow) * width;
+
+            for (size_t p = 0; p < band.counts.size (); ++p)
+                if (band.counts[p] != ~0u) counts[p] = band.counts[p];
+        }
+    }
+
+    runTidyTasks (_sampleCounts, channels, bands, true);
+}
+
 DeepImageLevel::Iterator
 DeepImageLevel::begin ()
 {
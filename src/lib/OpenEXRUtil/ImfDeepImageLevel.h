@@ -26,6 +26,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
 
@@ -114,6 +115,28 @@ public:
     IMFUTIL_EXPORT
     const SampleCountChannel& sampleCounts () const;
 
+    //
+    // Make the level tidy (see header file ImfDeepImageState.h):
+    // in every pixel, volume samples are split where other samples
+    // begin or end, samples with the same depth range are merged, and
+    // the samples are sorted by depth.
+    //
+    // The depth range of each sample is taken from the Z and ZBack
+    // channels (without a ZBack channel, all samples are point
+    // samples), and its opacity from the A channel.  All other half
+    // and float channels are assumed to be premultiplied by A, and
+    // are split and merged with it.  Unsigned int channels, such as
+    // object ids, keep the value of the first sample merged.  Pixels
+    // that are already tidy are left unchanged.
+    //
+    // Rows of pixels are tidied in parallel, on the global thread pool.
+    // tidy() throws an Iex::ArgExc exception if the level has no Z
+    // channel, or if any of its channels is subsampled.
+    //
+
+    IMFUTIL_EXPORT
+    void tidy ();
+
 private:
     friend class DeepImage;
     friend class SampleCountChannel;
@@ -181,6 +204,18 @@ private:
 
     ChannelMap         _channels;
     SampleCountChannel _sampleCounts;
+
+    //
+    // State of the edit of the sample counts in progress, if any,
+    // see SampleCountChannel::beginEdit() and beginRowEdit()
+    //
+
+    bool                      _editing;        // An edit is in progress
+    int                       _editFirstRow;   // Rows being changed by
+    int                       _editLastRow;    // beginRowEdit()
+    std::vector<unsigned int> _editNumSamples; // Sample counts in the
+                                               // edited rows before
+                                               // beginRowEdit()
 };
 
 class IMFUTIL_EXPORT_TYPE DeepImageLevel::Iterator
@@ -243,11 +243,10 @@ SampleCountChannel::set (int r, unsigned int newNumSamples[])
             << pixelsPerColumn () << " rows.");
     }
 
-    int x = level ().dataWindow ().min.x;
-    int y = r + level ().dataWindow ().min.y;
+    RowEdit edit (*this, r, r);
 
-    for (int i = 0; i < pixelsPerRow (); ++i, ++x)
-        set (x, y, newNumSamples[i]);
+    for (int i = 0; i < pixelsPerRow (); ++i)
+        edit.sampleCounts ()[i] = newNumSamples[i];
 }
 
 void
@@ -275,15 +274,34 @@ SampleCountChannel::clear ()
     }
 }
 
+void
+SampleCountChannel::startEdit ()
+{
+    DeepImageLevel& deep = deepLevel ();
+
+    if (deep._editing)
+    {
+        THROW (
+            ArgExc,
+            "Attempt to edit sample counts in an image channel "
+            "while another edit is in progress.");
+    }
+
+    deep._editing = true;
+}
+
 unsigned int*
 SampleCountChannel::beginEdit ()
 {
+    startEdit ();
     return _numSamples;
 }
 
 void
 SampleCountChannel::endEdit ()
 {
+    deepLevel ()._editing = false;
+
     try
     {
         _totalNumSamples      = 0;
@@ -308,6 +326,151 @@ SampleCountChannel::endEdit ()
     }
 }
 
+unsigned int*
+SampleCountChannel::beginRowEdit (int r1, int r2)
+{
+    if (r1 < 0 || r2 >= pixelsPerColumn () || r1 > r2)
+    {
+        THROW (
+            ArgExc,
+            "Attempt to edit sample counts for rows "
+                << r1 << " to " << r2 << " in an image channel with "
+                << pixelsPerColumn () << " rows.");
+    }
+
+    startEdit ();
+
+    DeepImageLevel& deep  = deepLevel ();
+    size_t          first = size_t (r1) * pixelsPerRow ();
+    size_t          last  = size_t (r2 + 1) * pixelsPerRow ();
+
+    try
+    {
+        deep._editNumSamples.assign (_numSamples + first, _numSamples + last);
+    }
+    catch (...)
+    {
+        deep._editing = false;
+        throw;
+    }
+
+    deep._editFirstRow = r1;
+    deep._editLastRow  = r2;
+
+    return _numSamples + first;
+}
+
+void
+SampleCountChannel::endRowEdit ()
+{
+    DeepImageLevel& deep  = deepLevel ();
+    size_t          first = size_t (deep._editFirstRow) * pixelsPerRow ();
+    size_t          last  = size_t (deep._editLastRow + 1) * pixelsPerRow ();
+
+    const vector<unsigned int>& editNumSamples = deep._editNumSamples;
+
+    deep._editing      = false;
+    deep._editFirstRow = 0;
+    deep._editLastRow  = -1;
+
+    unsigned int* oldNumSamples          = 0;
+    size_t*       oldSampleListPositions = 0;
+
+    try
+    {
+        //
+        // Find out how much space the sample lists that no longer
+        // fit in their current place need at the end of the buffer.
+        //
+
+        size_t grownSamplesOccupied = 0;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            unsigned int oldN = editNumSamples[i - first];
+            unsigned int newN = _numSamples[i];
+
+            if (newN != oldN) _totalNumSamples += size_t (newN) - oldN;
+
+            if (newN > _sampleListSizes[i])
+                grownSamplesOccupied += roundListSizeUp (newN);
+        }
+
+        if (_totalSamplesOccupied + grownSamplesOccupied <= _sampleBufferSize)
+        {
+            //
+            // Resize the changed sample lists in place, or move them
+            // to the end of the sample buffer.
+            //
+
+            for (size_t i = first; i < last; ++i)
+            {
+                unsigned int oldN = editNumSamples[i - first];
+                unsigned int newN = _numSamples[i];
+
+                if (newN <= oldN) continue;
+
+                if (newN <= _sampleListSizes[i])
+                {
+                    deepLevel ().setSamplesToZero (i, oldN, newN);
+                }
+                else
+                {
+                    deepLevel ().moveSampleList (
+                        i, oldN, newN, _totalSamplesOccupied);
+
+                    _sampleListSizes[i]     = roundListSizeUp (newN);
+                    _sampleListPositions[i] = _totalSamplesOccupied;
+                    _totalSamplesOccupied += _sampleListSizes[i];
+                }
+            }
+        }
+        else
+        {
+            //
+            // Allocate a new sample buffer, and move all sample
+            // lists into it, as in set(x,y,m).
+            //
+
+            oldNumSamples = new unsigned int[numPixels ()];
+
+            for (size_t i = 0; i < numPixels (); ++i)
+                oldNumSamples[i] = _numSamples[i];
+
+            for (size_t i = first; i < last; ++i)
+                oldNumSamples[i] = editNumSamples[i - first];
+
+            oldSampleListPositions = _sampleListPositions;
+            _sampleListPositions   = new size_t[numPixels ()];
+
+            _totalSamplesOccupied = 0;
+
+            for (size_t i = 0; i < numPixels (); ++i)
+            {
+                _sampleListPositions[i] = _totalSamplesOccupied;
+                _sampleListSizes[i]     = roundListSizeUp (_numSamples[i]);
+                _totalSamplesOccupied += _sampleListSizes[i];
+            }
+
+            _sampleBufferSize = roundBufferSizeUp (_totalSamplesOccupied);
+
+            deepLevel ().moveSamplesToNewBuffer (
+                oldNumSamples, _numSamples, _sampleListPositions);
+
+            delete[] oldNumSamples;
+            delete[] oldSampleListPositions;
+        }
+    }
+    catch (...)
+    {
+        delete[] oldNumSamples;
+        delete[] oldSampleListPositions;
+
+        level ().image ().resize (Box2i (V2i (0, 0), V2i (-1, -1)));
+        throw;
+    }
+}
+
 void
 SampleCountChannel::resize ()
 {
@@ -119,6 +119,8 @@ public:
     // Memory allocation for the sample lists is not particularly clever;
     // repeatedly increasing and decreasing the number of samples in the
     // pixels of a level is likely to result in serious memory fragmentation.
+    // Changing the sample counts of many pixels is faster with
+    // beginRowEdit() and endRowEdit(), below.
     //
     // Setting the number of samples for one or more pixels may cause the
     // program to run out of memory.  If this happens, the image is resized
@@ -162,6 +164,10 @@ public:
     // do that, application code may want to create a temporary Edit
     //  object instead of calling beginEdit() and endEdit() directly.
     //
+    // Edits cannot be nested: beginEdit() and beginRowEdit(), below,
+    // throw an Iex::ArgExc exception if an edit of the sample counts
+    // is already in progress.
+    //
     // Setting the number of samples for all pixels in the image may
     // cause the program to run out of memory.  If this happens, the image
     // is resized to zero by zero pixels and an exception is thrown.
@@ -204,6 +210,68 @@ public:
         unsigned int*       _sampleCounts;
     };
 
+    //
+    // Change the sample counts in a range of rows, keeping the samples:
+    //
+    //  beginRowEdit(r1,r2)     returns a pointer to the sample counts of
+    //                          rows r1 to r2 (inclusive), pixelsPerRow()
+    //                          entries per row, in row-major order.
+    //                          Application code may change these counts,
+    //                          but must not access any samples in the
+    //                          deep channels, or change sample counts in
+    //                          any other way, until endRowEdit() is called.
+    //                          The row numbers must be in the range from 0
+    //                          to pixelsPerColumn()-1.
+    //
+    //  endRowEdit()            resizes the sample lists of the pixels whose
+    //                          sample counts have changed, like set(x,y,m)
+    //                          would: samples are appended or truncated at
+    //                          the end of each sample list, and the samples
+    //                          in all other pixels are left alone.
+    //
+    // Sample lists that no longer fit in the space allocated for them are
+    // moved to the unused space at the end of the sample buffer.  Only if
+    // that space is too small is the sample buffer reallocated, once for
+    // the entire edit, with room for later growth.  As long as the sample
+    // buffer is not reallocated, the cost of an edit is proportional to
+    // the number of pixels in the rows being edited, not to the size of
+    // the level.
+    //
+    // The RowEdit class calls beginRowEdit() and endRowEdit(), similar
+    // to class Edit.  If the program runs out of memory, the image is
+    // resized to zero by zero pixels and an exception is thrown.
+    //
+
+    IMFUTIL_EXPORT
+    unsigned int* beginRowEdit (int r1, int r2);
+    IMFUTIL_EXPORT
+    void endRowEdit ();
+
+    class RowEdit
+    {
+    public:
+        IMFUTIL_EXPORT
+        RowEdit (SampleCountChannel& level, int r1, int r2);
+        IMFUTIL_EXPORT
+        ~RowEdit ();
+
+        RowEdit (const RowEdit& other)            = delete;
+        RowEdit& operator= (const RowEdit& other) = delete;
+        RowEdit (RowEdit&& other)                 = delete;
+        RowEdit& operator= (RowEdit&& other)      = delete;
+
+        //
+        // Access to the writable sample counts of rows r1 to r2.
+        //
+
+        IMFUTIL_EXPORT
+        unsigned int* sampleCounts () const;
+
+    private:
+        SampleCountChannel& _channel;
+        unsigned int*       _sampleCounts;
+    };
+
     //
     // Functions that support the implementation of deep image channels.
     //
@@ -230,6 +298,9 @@ private:
 
     virtual void resize ();
 
+    void startEdit (); // Note that an edit begins, or throw if
+                       // another one is in progress
+
     void resetBasePointer ();
 
     unsigned int* _numSamples; // Array of per-pixel sample counts
@@ -276,6 +347,24 @@ SampleCountChannel::Edit::sampleCounts () const
     return _sampleCounts;
 }
 
+inline SampleCountChannel::RowEdit::RowEdit (
+    SampleCountChannel& channel, int r1, int r2)
+    : _channel (channel), _sampleCounts (channel.beginRowEdit (r1, r2))
+{
+    // empty
+}
+
+inline SampleCountChannel::RowEdit::~RowEdit ()
+{
+    _channel.endRowEdit ();
+}
+
+inline unsigned int*
+SampleCountChannel::RowEdit::sampleCounts () const
+{
+    return _sampleCounts;
+}
+
 inline const unsigned int*
 SampleCountChannel::numSamples () const
 {
@@ -0,0 +1,825 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+
+#include "ImfTranscode.h"
+
+#include "Iex.h"
+#include "ImfContext.h"
+#include "ImfThreading.h"
+
+#include "IlmThreadPool.h"
+#if ILMTHREAD_THREADING_ENABLED
+#    include <condition_variable>
+#    include <mutex>
+#endif
+
+#include "openexr.h"
+
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <vector>
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_ENTER
+
+namespace
+{
+
+using std::vector;
+
+bool
+isDeep (exr_storage_t storage)
+{
+    return storage == EXR_STORAGE_DEEP_SCANLINE ||
+           storage == EXR_STORAGE_DEEP_TILED;
+}
+
+bool
+isTiled (exr_storage_t storage)
+{
+    return storage == EXR_STORAGE_TILED || storage == EXR_STORAGE_DEEP_TILED;
+}
+
+//
+// A job is the smallest set of whole chunks of both files covering the
+// same pixels: a group of scan lines, or a single tile.
+//
+
+struct Job
+{
+    int y0, y1;
+    int tx, ty, lx, ly;
+};
+
+//
+// A compressed output chunk, ready to be written. The data point either
+// into the storage of the chunk, or, if the part is not compressed, into
+// the uncompressed data of the slot.
+//
+
+struct OutChunk
+{
+    exr_chunk_info_t cinfo;
+    const uint8_t*   data;
+    uint64_t         size;
+    uint64_t         unpackedSize;
+    const uint8_t*   samples;
+    uint64_t         sampleSize;
+    vector<uint8_t>  dataStore;
+    vector<uint8_t>  sampleStore;
+};
+
+//
+// The buffers and pipelines of one job in flight. The buffers are owned
+// here rather than by the pipelines, which only borrow them.
+//
+
+struct Slot
+{
+    Slot () = default;
+
+    ~Slot ()
+    {
+        if (decoderInit) exr_decoding_destroy (inCtxt, &decoder);
+        if (encoderInit) exr_encoding_destroy (outCtxt, &encoder);
+    }
+
+    Slot (const Slot&)            = delete;
+    Slot& operator= (const Slot&) = delete;
+
+    exr_context_t         inCtxt      = nullptr;
+    exr_context_t         outCtxt     = nullptr;
+    exr_decode_pipeline_t decoder     = EXR_DECODE_PIPELINE_INITIALIZER;
+    exr_encode_pipeline_t encoder     = EXR_ENCODE_PIPELINE_INITIALIZER;
+    bool                  decoderInit = false;
+    bool                  encoderInit = false;
+
+    vector<uint8_t>          packed;
+    vector<uint8_t>          packedSamples;
+    vector<uint8_t>          unpacked;
+    vector<uint8_t>          samples;
+    vector<exr_chunk_info_t> inChunks;
+    vector<OutChunk>         outChunks;
+    size_t                   numOutChunks = 0;
+
+    bool        done = false;
+    std::string error;
+};
+
+class PartTranscoder
+{
+public:
+    PartTranscoder (
+        const Context& in, const Context& out, int part, Compression comp);
+
+    void run ();
+
+    void transcode (Slot& slot, const Job& job);
+    void finish (Slot& slot, const std::string& error);
+
+private:
+    void readChunk (Slot& slot, const exr_chunk_info_t& cinfo, uint8_t* dst,
+                    uint8_t* samples);
+    void compressChunk (Slot& slot, const exr_chunk_info_t& cinfo,
+                        const uint8_t* src, uint64_t size,
+                        const uint8_t* samples, uint64_t sampleSize);
+    void writeChunks (const Slot& slot);
+    void makeJobs ();
+    void submit (Slot& slot, size_t job);
+    void wait (Slot& slot);
+
+    const Context& _in;
+    const Context& _out;
+    int            _part;
+    Compression    _comp;
+    exr_storage_t  _storage;
+    int            _inLines;
+    int            _outLines;
+    vector<Job>    _jobs;
+
+#if ILMTHREAD_THREADING_ENABLED
+    ILMTHREAD_NAMESPACE::TaskGroup* _group = nullptr;
+    std::mutex                      _mx;
+    std::condition_variable         _cv;
+#endif
+};
+
+#if ILMTHREAD_THREADING_ENABLED
+class TranscodeTask final : public ILMTHREAD_NAMESPACE::Task
+{
+public:
+    TranscodeTask (
+        ILMTHREAD_NAMESPACE::TaskGroup* group,
+        PartTranscoder*                 transcoder,
+        Slot*                           slot,
+        const Job&                      job)
+        : Task (group), _transcoder (transcoder), _slot (slot), _job (job)
+    {}
+
+    void execute () override
+    {
+        std::string error;
+        try
+        {
+            _transcoder->transcode (*_slot, _job);
+        }
+        catch (std::exception& e)
+        {
+            error = e.what ();
+        }
+        catch (...)
+        {
+            error = "unknown exception";
+        }
+        _transcoder->finish (*_slot, error);
+    }
+
+private:
+    PartTranscoder* _transcoder;
+    Slot*           _slot;
+    Job             _job;
+};
+#endif
+
+PartTranscoder::PartTranscoder (
+    const Context& in, const Context& out, int part, Compression comp)
+    : _in (in)
+    , _out (out)
+    , _part (part)
+    , _comp (comp)
+    , _storage (in.storage (part))
+    , _inLines (1)
+    , _outLines (1)
+{
+    if (!isTiled (_storage))
+    {
+        int32_t lines;
+        if (EXR_ERR_SUCCESS != exr_get_scanlines_per_chunk (in, part, &lines))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to query scan lines per chunk of part " << part
+                    << " of \"" << in.fileName () << "\".");
+        _inLines = lines;
+
+        if (EXR_ERR_SUCCESS != exr_get_scanlines_per_chunk (out, part, &lines))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to query scan lines per chunk of part " << part
+                    << " of \"" << out.fileName () << "\".");
+        _outLines = lines;
+
+        if (_storage == EXR_STORAGE_DEEP_SCANLINE && _inLines != _outLines)
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Cannot transcode deep part " << part << " of \""
+                    << in.fileName ()
+                    << "\" between compression methods storing a different "
+                       "number of scan lines per chunk.");
+    }
+
+    makeJobs ();
+}
+
+void
+PartTranscoder::makeJobs ()
+{
+    if (!isTiled (_storage))
+    {
+        exr_attr_box2i_t dw;
+        if (EXR_ERR_SUCCESS != exr_get_data_window (_in, _part, &dw))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to query data window of part " << _part << " of \""
+                    << _in.fileName () << "\".");
+
+        //
+        // The numbers of lines per chunk are powers of two, so both
+        // files have a chunk boundary every max (in, out) lines.
+        //
+
+        int group = std::max (_inLines, _outLines);
+        for (int64_t y = dw.min.y; y <= dw.max.y; y += group)
+        {
+            Job job = {};
+            job.y0  = static_cast<int> (y);
+            job.y1  = static_cast<int> (
+                std::min<int64_t> (y + group - 1, dw.max.y));
+            _jobs.push_back (job);
+        }
+        return;
+    }
+
+    uint32_t              tx, ty;
+    exr_tile_level_mode_t levelMode;
+    exr_tile_round_mode_t roundMode;
+    int32_t               levelsX, levelsY;
+    if (EXR_ERR_SUCCESS !=
+            exr_get_tile_descriptor (
+                _in, _part, &tx, &ty, &levelMode, &roundMode) ||
+        EXR_ERR_SUCCESS !=
+            exr_get_tile_levels (_in, _part, &levelsX, &levelsY))
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Unable to query tile description of part " << _part << " of \""
+                << _in.fileName () << "\".");
+
+    //
+    // Tiles are listed in the order of their chunks in the file.
+    //
+
+    auto addLevel = [&] (int lx, int ly) {
+        int32_t countX, countY;
+        if (EXR_ERR_SUCCESS !=
+            exr_get_tile_counts (_in, _part, lx, ly, &countX, &countY))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to query tile counts of part " << _part << " of \""
+                    << _in.fileName () << "\".");
+
+        for (int y = 0; y < countY; ++y)
+        {
+            for (int x = 0; x < countX; ++x)
+            {
+                Job job = {};
+                job.tx  = x;
+                job.ty  = y;
+                job.lx  = lx;
+                job.ly  = ly;
+                _jobs.push_back (job);
+            }
+        }
+    };
+
+    if (levelMode == EXR_TILE_RIPMAP_LEVELS)
+    {
+        for (int ly = 0; ly < levelsY; ++ly)
+            for (int lx = 0; lx < levelsX; ++lx)
+                addLevel (lx, ly);
+    }
+    else
+    {
+        for (int l = 0; l < levelsX; ++l)
+            addLevel (l, l);
+    }
+}
+
+//
+// Read a chunk of the input part, and uncompress it into dst (and, for
+// deep parts, its sample count table into samples). A chunk stored
+// uncompressed is read straight into place.
+//
+
+void
+PartTranscoder::readChunk (
+    Slot& slot, const exr_chunk_info_t& cinfo, uint8_t* dst, uint8_t* samples)
+{
+    bool deep = isDeep (_storage);
+
+    if (deep && cinfo.sample_count_table_size == 0)
+        memset (
+            samples,
+            0,
+            size_t (cinfo.width) * size_t (cinfo.height) * sizeof (int32_t));
+
+    if (cinfo.packed_size == 0 && (!deep || cinfo.sample_count_table_size == 0))
+        return;
+
+    exr_result_t rv;
+    if (!slot.decoderInit)
+    {
+        rv = exr_decoding_initialize (_in, _part, &cinfo, &slot.decoder);
+        slot.decoderInit = (rv == EXR_ERR_SUCCESS);
+    }
+    else
+        rv = exr_decoding_update (_in, _part, &cinfo, &slot.decoder);
+
+    if (rv != EXR_ERR_SUCCESS)
+        THROW (
+            IEX_NAMESPACE::IoExc,
+            "Unable to initialize decoding of part " << _part << " of \""
+                << _in.fileName () << "\".");
+
+    bool     raw    = cinfo.packed_size == cinfo.unpacked_size;
+    uint8_t* packed = dst;
+    if (!raw)
+    {
+        slot.packed.resize (cinfo.packed_size);
+        packed = slot.packed.data ();
+    }
+
+    if (deep)
+    {
+        slot.packedSamples.resize (cinfo.sample_count_table_size);
+        rv = exr_read_deep_chunk (
+            _in, _part, &cinfo, packed, slot.packedSamples.data ());
+    }
+    else
+        rv = exr_read_chunk (_in, _part, &cinfo, packed);
+
+    if (rv != EXR_ERR_SUCCESS)
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Unable to read chunk of part " << _part << " of \""
+                << _in.fileName () << "\".");
+
+    if (raw && !deep) return;
+
+    exr_decode_pipeline_t& dec = slot.decoder;
+    dec.packed_buffer          = packed;
+    dec.unpacked_buffer        = dst;
+    if (deep && cinfo.sample_count_table_size > 0)
+    {
+        dec.packed_sample_count_table = slot.packedSamples.data ();
+        dec.sample_count_table        = reinterpret_cast<int32_t*> (samples);
+    }
+
+    rv = exr_uncompress_chunk (&dec);
+
+    dec.packed_buffer             = nullptr;
+    dec.unpacked_buffer           = nullptr;
+    dec.packed_sample_count_table = nullptr;
+    dec.sample_count_table        = nullptr;
+
+    if (rv != EXR_ERR_SUCCESS)
+        THROW (
+            IEX_NAMESPACE::InputExc,
+            "Unable to uncompress chunk of part " << _part << " of \""
+                << _in.fileName () << "\".");
+}
+
+//
+// Compress the uncompressed data of an output chunk (and the sample
+// count table of deep chunks) into the next output chunk of the slot.
+//
+
+void
+PartTranscoder::compressChunk (
+    Slot&                   slot,
+    const exr_chunk_info_t& cinfo,
+    const uint8_t*          src,
+    uint64_t                size,
+    const uint8_t*          samples,
+    uint64_t                sampleSize)
+{
+    if (slot.numOutChunks == slot.outChunks.size ())
+        slot.outChunks.emplace_back ();
+
+    OutChunk& oc    = slot.outChunks[slot.numOutChunks++];
+    oc.cinfo        = cinfo;
+    oc.data         = src;
+    oc.size         = size;
+    oc.unpackedSize = size;
+    oc.samples      = samples;
+    oc.sampleSize   = sampleSize;
+
+    if (_comp == NO_COMPRESSION || (size == 0 && sampleSize == 0)) return;
+
+    exr_result_t rv;
+    if (!slot.encoderInit)
+    {
+        rv = exr_encoding_initialize (_out, _part, &cinfo, &slot.encoder);
+        slot.encoderInit = (rv == EXR_ERR_SUCCESS);
+    }
+    else
+        rv = exr_encoding_update (_out, _part, &cinfo, &slot.encoder);
+
+    if (rv != EXR_ERR_SUCCESS)
+        THROW (
+            IEX_NAMESPACE::IoExc,
+            "Unable to initialize encoding of part " << _part << " of \""
+                << _out.fileName () << "\".");
+
+    //
+    // The sample count table of deep chunks is compressed along with
+    // the samples, some compression methods predict the samples from
+    // the sample counts.
+    //
+
+    exr_encode_pipeline_t& enc = slot.encoder;
+    enc.packed_buffer          = const_cast<uint8_t*> (src);
+    enc.packed_bytes           = size;
+    enc.packed_alloc_size      = 0;
+    enc.chunk.unpacked_size    = size;
+    if (sampleSize > 0)
+        enc.sample_count_table =
+            reinterpret_cast<int32_t*> (const_cast<uint8_t*> (samples));
+
+    rv = exr_compress_chunk (&enc);
+
+    enc.packed_buffer      = nullptr;
+    enc.packed_bytes       = 0;
+    enc.sample_count_table = nullptr;
+
+    if (rv != EXR_ERR_SUCCESS)
+        THROW (
+            IEX_NAMESPACE::IoExc,
+            "Unable to compress chunk of part " << _part << " of \""
+                << _out.fileName () << "\".");
+
+    if (sampleSize > 0)
+    {
+        const uint8_t* c =
+            static_cast<const uint8_t*> (enc.packed_sample_count_table);
+        oc.sampleStore.assign (c, c + enc.packed_sample_count_bytes);
+        oc.samples    = oc.sampleStore.data ();
+        oc.sampleSize = oc.sampleStore.size ();
+    }
+
+    if (size > 0)
+    {
+        const uint8_t* c = static_cast<const uint8_t*> (enc.compressed_buffer);
+        oc.dataStore.assign (c, c + enc.compressed_bytes);
+        oc.data = oc.dataStore.data ();
+        oc.size = oc.dataStore.size ();
+    }
+}
+
+void
+PartTranscoder::transcode (Slot& slot, const Job& job)
+{
+    slot.numOutChunks = 0;
+
+    exr_result_t rv;
+    if (isTiled (_storage))
+    {
+        exr_chunk_info_t cinfo;
+        if (EXR_ERR_SUCCESS != exr_read_tile_chunk_info (
+                                   _in,
+                                   _part,
+                                   job.tx,
+                                   job.ty,
+                                   job.lx,
+                                   job.ly,
+                                   &cinfo))
+            THROW (
+                IEX_NAMESPACE::InputExc,
+                "Unable to read tile (" << job.tx << ", " << job.ty
+                    << ") level (" << job.lx << ", " << job.ly
+                    << ") of part " << _part << " of \"" << _in.fileName ()
+                    << "\".");
+
+        uint64_t sampleSize =
+            isDeep (_storage)
+                ? uint64_t (cinfo.width) * uint64_t (cinfo.height) *
+                      sizeof (int32_t)
+                : 0;
+        slot.unpacked.resize (cinfo.unpacked_size);
+        slot.samples.resize (sampleSize);
+        readChunk (slot, cinfo, slot.unpacked.data (), slot.samples.data ());
+
+        exr_chunk_info_t ocinfo;
+        if (EXR_ERR_SUCCESS != exr_write_tile_chunk_info (
+                                   _out,
+                                   _part,
+                                   job.tx,
+                                   job.ty,
+                                   job.lx,
+                                   job.ly,
+                                   &ocinfo))
+            THROW (
+                IEX_NAMESPACE::IoExc,
+                "Unable to prepare tile of part " << _part << " of \""
+                    << _out.fileName () << "\".");
+
+        compressChunk (
+            slot,
+            ocinfo,
+            slot.unpacked.data (),
+            cinfo.unpacked_size,
+            slot.samples.data (),
+            sampleSize);
+        return;
+    }
+
+    //
+    // Uncompress the input chunks of the group of scan lines back to
+    // back, which is the layout of the output chunks as well.
+    //
+
+    slot.inChunks.clear ();
+    uint64_t total = 0;
+    for (int y = job.y0; y <= job.y1; y += _inLines)
+    {
+        exr_chunk_info_t cinfo;
+        rv = exr_read_scanline_chunk_info (_in, _part, y, &cinfo);
+        if (rv != EXR_ERR_SUCCESS)
+            THROW (
+                IEX_NAMESPACE::InputExc,
+                "Unable to read scan line " << y << " of part " << _part
+                    << " of \"" << _in.fileName () << "\".");
+        slot.inChunks.push_back (cinfo);
+        total += cinfo.unpacked_size;
+    }
+
+    bool     deep       = isDeep (_storage);
+    uint64_t sampleSize = 0;
+    if (deep)
+    {
+        // deep parts are transcoded chunk by chunk
+        const exr_chunk_info_t& cinfo = slot.inChunks[0];
+        sampleSize =
+            uint64_t (cinfo.width) * uint64_t (cinfo.height) * sizeof (int32_t);
+    }
+
+    slot.unpacked.resize (total);
+    slot.samples.resize (sampleSize);
+
+    uint64_t offset = 0;
+    for (const exr_chunk_info_t& cinfo: slot.inChunks)
+    {
+        readChunk (
+            slot, cinfo, slot.unpacked.data () + offset, slot.samples.data ());
+        offset += cinfo.unpacked_size;
+    }
+
+    offset = 0;
+    for (int y = job.y0; y <= job.y1; y += _outLines)
+    {
+        exr_chunk_info_t cinfo;
+        rv = exr_write_scanline_chunk_info (_out, _part, y, &cinfo);
+        if (rv != EXR_ERR_SUCCESS)
+            THROW (
+                IEX_NAMESPACE::IoExc,
+                "Unable to prepare scan line " << y << " of part " << _part
+                    << " of \"" << _out.fileName () << "\".");
+
+        uint64_t size = deep ? total : cinfo.unpacked_size;
+        if (offset + size > total)
+            THROW (
+                IEX_NAMESPACE::LogicExc,
+                "Mismatched chunk sizes transcoding scan line "
+                    << y << " of part " << _part << " of \""
+                    << _in.fileName () << "\".");
+
+        compressChunk (
+            slot,
+            cinfo,
+            slot.unpacked.data () + offset,
+            size,
+            slot.samples.data (),
+            sampleSize);
+        offset += size;
+    }
+
+    if (offset != total)
+        THROW (
+            IEX_NAMESPACE::LogicExc,
+            "Mismatched chunk sizes transcoding scan lines "
+                << job.y0 << " to " << job.y1 << " of part " << _part
+                << " of \"" << _in.fileName () << "\".");
+}
+
+void
+PartTranscoder::writeChunks (const Slot& slot)
+{
+    for (size_t i = 0; i < slot.numOutChunks; ++i)
+    {
+        const OutChunk&         oc    = slot.outChunks[i];
+        const exr_chunk_info_t& cinfo = oc.cinfo;
+
+        exr_result_t rv;
+        switch (_storage)
+        {
+            case EXR_STORAGE_SCANLINE:
+                rv = exr_write_scanline_chunk (
+                    _out, _part, cinfo.start_y, oc.data, oc.size);
+                break;
+            case EXR_STORAGE_DEEP_SCANLINE:
+                rv = exr_write_deep_scanline_chunk (
+                    _out,
+                    _part,
+                    cinfo.start_y,
+                    oc.data,
+                    oc.size,
+                    oc.unpackedSize,
+                    oc.samples,
+                    oc.sampleSize);
+                break;
+            case EXR_STORAGE_TILED:
+                rv = exr_write_tile_chunk (
+                    _out,
+                    _part,
+                    cinfo.start_x,
+                    cinfo.start_y,
+                    cinfo.level_x,
+                    cinfo.level_y,
+                    oc.data,
+                    oc.size);
+                break;
+            default:
+                rv = exr_write_deep_tile_chunk (
+                    _out,
+                    _part,
+                    cinfo.start_x,
+                    cinfo.start_y,
+                    cinfo.level_x,
+                    cinfo.level_y,
+                    oc.data,
+                    oc.size,
+                    oc.unpackedSize,
+                    oc.samples,
+                    oc.sampleSize);
+                break;
+        }
+
+        if (rv != EXR_ERR_SUCCESS)
+            THROW (
+                IEX_NAMESPACE::IoExc,
+                "Unable to write chunk of part " << _part << " of \""
+                    << _out.fileName () << "\".");
+    }
+}
+
+void
+PartTranscoder::finish (Slot& slot, const std::string& error)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::lock_guard<std::mutex> lock (_mx);
+#endif
+    slot.error = error;
+    slot.done  = true;
+#if ILMTHREAD_THREADING_ENABLED
+    _cv.notify_all ();
+#endif
+}
+
+void
+PartTranscoder::submit (Slot& slot, size_t job)
+{
+    slot.done = false;
+#if ILMTHREAD_THREADING_ENABLED
+    if (_group)
+    {
+        ILMTHREAD_NAMESPACE::ThreadPool::addGlobalTask (
+            new TranscodeTask (_group, this, &slot, _jobs[job]));
+        return;
+    }
+#endif
+    transcode (slot, _jobs[job]);
+    slot.done = true;
+}
+
+void
+PartTranscoder::wait (Slot& slot)
+{
+#if ILMTHREAD_THREADING_ENABLED
+    std::unique_lock<std::mutex> lock (_mx);
+    _cv.wait (lock, [&slot] { return slot.done; });
+#endif
+    if (!slot.error.empty ())
+        THROW (
+            IEX_NAMESPACE::IoExc,
+            "Error transcoding part " << _part << " of \"" << _in.fileName ()
+                                      << "\": " << slot.error);
+}
+
+//
+// Keep a window of jobs in flight, twice as many as there are threads,
+// and write their chunks in order as they complete, such that the memory
+// used does not depend on the size of the image.
+//
+
+void
+PartTranscoder::run ()
+{
+    int    threads = globalThreadCount ();
+    size_t window  = std::min<size_t> (
+        std::max (1, 2 * threads), std::max<size_t> (_jobs.size (), 1));
+
+    vector<Slot> slots (window);
+    for (Slot& slot: slots)
+    {
+        slot.inCtxt  = _in;
+        slot.outCtxt = _out;
+    }
+
+#if ILMTHREAD_THREADING_ENABLED
+    // declared after the slots, so waits for the tasks using them
+    ILMTHREAD_NAMESPACE::TaskGroup group;
+    _group = (threads > 0) ? &group : nullptr;
+#endif
+
+    for (size_t j = 0; j < window && j < _jobs.size (); ++j)
+        submit (slots[j], j);
+
+    for (size_t j = 0; j < _jobs.size (); ++j)
+    {
+        Slot& slot = slots[j % window];
+        wait (slot);
+        writeChunks (slot);
+        if (j + window < _jobs.size ()) submit (slot, j + window);
+    }
+}
+
+} // namespace
+
+void
+transcodeOpenEXRFile (
+    const char  inFileName[],
+    const char  outFileName[],
+    Compression compression,
+    float       level)
+{
+    if (compression < NO_COMPRESSION || compression >= NUM_COMPRESSION_METHODS)
+        THROW (
+            IEX_NAMESPACE::ArgExc,
+            "Invalid compression method " << int (compression) << ".");
+
+    Context in (inFileName, ContextInitializer (), Context::read_mode_t ());
+    Context out (outFileName, ContextInitializer (), Context::write_mode_t ());
+
+    int parts = in.partCount ();
+    for (int p = 0; p < parts; ++p)
+    {
+        exr_storage_t storage = in.storage (p);
+        if (isDeep (storage) && !isValidDeepCompression (compression))
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Cannot transcode deep part "
+                    << p << " of \"" << inFileName
+                    << "\": the compression method is not supported for "
+                       "deep data.");
+
+        const char* name = nullptr;
+        if (EXR_ERR_SUCCESS != exr_get_name (in, p, &name)) name = nullptr;
+
+        int          idx;
+        exr_result_t rv = exr_add_part (out, name, storage, &idx);
+        if (rv == EXR_ERR_SUCCESS)
+            rv = exr_set_compression (
+                out, idx, static_cast<exr_compression_t> (compression));
+        if (rv == EXR_ERR_SUCCESS)
+            rv = exr_copy_unset_attributes (out, idx, in, p);
+        if (rv == EXR_ERR_SUCCESS && level >= 0.f)
+        {
+            if (compression == ZIP_COMPRESSION ||
+                compression == ZIPS_COMPRESSION)
+                rv = exr_set_zip_compression_level (
+                    out, idx, static_cast<int> (level));
+            else if (
+                compression == DWAA_COMPRESSION ||
+                compression == DWAB_COMPRESSION)
+                rv = exr_set_dwa_compression_level (out, idx, level);
+        }
+
+        if (rv != EXR_ERR_SUCCESS)
+            THROW (
+                IEX_NAMESPACE::ArgExc,
+                "Unable to set up part " << p << " of \"" << outFileName
+                                         << "\" from \"" << inFileName
+                                         << "\".");
+    }
+
+    if (EXR_ERR_SUCCESS != exr_write_header (out))
+        THROW (
+            IEX_NAMESPACE::IoExc,
+            "Unable to write header of \"" << outFileName << "\".");
+
+    for (int p = 0; p < parts; ++p)
+    {
+        PartTranscoder transcoder (in, out, p, compression);
+        transcoder.run ();
+    }
+}
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_SOURCE_EXIT
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+
+#ifndef INCLUDED_IMF_TRANSCODE_H
+#define INCLUDED_IMF_TRANSCODE_H
+
+#include "ImfCompression.h"
+#include "ImfNamespace.h"
+#include "ImfUtilExport.h"
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_ENTER
+
+//
+// Copy an OpenEXR file, storing the pixels of every part with the given
+// compression method. Each chunk is read and uncompressed to the packed
+// representation of the file, which does not depend on the compression
+// method, and compressed again, so the pixels are never converted to or
+// from a frame buffer. Scan line chunks are regrouped when the methods
+// store a different number of lines per chunk. The headers, including
+// the line order and tile descriptions, are copied unchanged.
+//
+// Chunks are transcoded in parallel using the global thread pool (see
+// ImfThreading.h), and written in order, with at most a few chunks per
+// thread held in memory at any time.
+//
+// If level is not negative, it is used as the ZIP or DWA compression
+// level, as applicable, rather than the library default.
+//
+// Deep parts can only use the compression methods that support deep
+// data, those for which isValidDeepCompression() is true. Deep scan
+// line chunks are not regrouped, so a deep scan line part can only be
+// transcoded between methods that store the same number of lines per
+// chunk. Otherwise an ArgExc is thrown.
+//
+// Lossy compression methods lose information as they do when writing
+// a file.
+//
+// inFileName and outFileName are UTF-8 encoded paths; see ImfIO.h.
+//
+
+IMFUTIL_EXPORT void transcodeOpenEXRFile (
+    const char  inFileName[],
+    const char  outFileName[],
+    Compression compression,
+    float       level = -1.f);
+
+OPENEXR_IMF_INTERNAL_NAMESPACE_HEADER_EXIT
+
+#endif
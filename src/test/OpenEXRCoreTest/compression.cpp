@@ -18,6 +18,8 @@
 #include "ImfArray.h"
 #include "ImfChannelList.h"
 #include "ImfCompressor.h"
+#include "ImfDeepFrameBuffer.h"
+#include "ImfDeepScanLineInputFile.h"
 #include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
 #include "ImfHuf.h"
@@ -1436,6 +1438,7 @@ doWriteRead (
         case EXR_COMPRESSION_RLE:
         case EXR_COMPRESSION_ZIP:
         case EXR_COMPRESSION_ZIPS:
+        case EXR_COMPRESSION_ZIPD:
             restore.compareExact (p, "orig", "C loaded C");
             break;
         case EXR_COMPRESSION_PIZ:
@@ -1639,6 +1642,447 @@ testHUF (const std::string& tempdir)
 
 ////////////////////////////////////////
 
+static const int DEEP_WIDTH = 41;
+
+static int
+deepSampleCount (int x, int y, int linesPerChunk)
+{
+    // the second chunk has no samples at all
+    if (y / linesPerChunk == 1) return 0;
+    return (x * 7 + y * 3) % 5;
+}
+
+static float
+deepZ (int x, int y, int s)
+{
+    return static_cast<float> (x) + static_cast<float> (y) * 0.5f +
+           static_cast<float> (s);
+}
+
+static half
+deepA (int x, int y, int s)
+{
+    return half (static_cast<float> ((x + y + s) % 8) * 0.125f);
+}
+
+//
+// write a deep scanline file of three chunks with the core library,
+// compressing each chunk and its sample count table with
+// exr_compress_chunk
+//
+
+static void
+doDeepWrite (const std::string& filename, exr_compression_t comp)
+{
+    int linesPerChunk = exr_compression_lines_per_chunk (comp);
+    int height        = linesPerChunk * 3;
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.zip_level                 = 3;
+    int partidx;
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &f, filename.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "deep", EXR_STORAGE_DEEP_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        f, partidx, DEEP_WIDTH, height, comp));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "A", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "Z", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    for (int cy = 0; cy < height; cy += linesPerChunk)
+    {
+        exr_chunk_info_t      cinfo;
+        exr_encode_pipeline_t encoder;
+        std::vector<int32_t>  table;
+        std::vector<uint8_t>  packed;
+
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk_info (f, 0, cy, &cinfo));
+        EXRCORE_TEST_RVAL (exr_encoding_initialize (f, 0, &cinfo, &encoder));
+
+        //
+        // the table holds the cumulative sample counts of each line;
+        // the samples of a line are stored channel by channel
+        //
+
+        for (int y = cy; y < cy + linesPerChunk; ++y)
+        {
+            int32_t total = 0;
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                total += deepSampleCount (x, y, linesPerChunk);
+                table.push_back (total);
+            }
+
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                for (int s = 0; s < deepSampleCount (x, y, linesPerChunk); ++s)
+                {
+                    uint16_t a = deepA (x, y, s).bits ();
+                    packed.push_back (static_cast<uint8_t> (a & 0xff));
+                    packed.push_back (static_cast<uint8_t> (a >> 8));
+                }
+            }
+
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                for (int s = 0; s < deepSampleCount (x, y, linesPerChunk); ++s)
+                {
+                    float    z = deepZ (x, y, s);
+                    uint32_t zi;
+                    memcpy (&zi, &z, sizeof (zi));
+                    for (int b = 0; b < 4; ++b)
+                        packed.push_back (static_cast<uint8_t> (zi >> (b * 8)));
+                }
+            }
+        }
+
+        const void* data      = packed.data ();
+        uint64_t    dataSize  = packed.size ();
+        const void* tableData = table.data ();
+        uint64_t    tableSize = table.size () * sizeof (int32_t);
+
+        if (comp != EXR_COMPRESSION_NONE)
+        {
+            encoder.packed_buffer      = packed.data ();
+            encoder.packed_bytes       = packed.size ();
+            encoder.sample_count_table = table.data ();
+
+            EXRCORE_TEST_RVAL (exr_compress_chunk (&encoder));
+
+            data      = encoder.compressed_buffer;
+            dataSize  = encoder.compressed_bytes;
+            tableData = encoder.packed_sample_count_table;
+            tableSize = encoder.packed_sample_count_bytes;
+
+            EXRCORE_TEST (dataSize <= packed.size ());
+            EXRCORE_TEST (tableSize <= table.size () * sizeof (int32_t));
+            if (cy / linesPerChunk != 1)
+                EXRCORE_TEST (tableSize < table.size () * sizeof (int32_t));
+        }
+
+        EXRCORE_TEST_RVAL (exr_write_deep_scanline_chunk (
+            f,
+            0,
+            cy,
+            data,
+            dataSize,
+            packed.size (),
+            tableData,
+            tableSize));
+
+        encoder.packed_buffer      = NULL;
+        encoder.sample_count_table = NULL;
+        EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    }
+
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+}
+
+//
+// write a deep scanline file as above, and read it back with the C++
+// library
+//
+
+static void
+doDeepWriteRead (const std::string& tempdir, exr_compression_t comp)
+{
+    std::string filename = tempdir + std::string ("imf_test_deep_comp.exr");
+    int         linesPerChunk = exr_compression_lines_per_chunk (comp);
+    int         height        = linesPerChunk * 3;
+
+    doDeepWrite (filename, comp);
+
+    try
+    {
+        DeepScanLineInputFile in (filename.c_str ());
+
+        Array2D<unsigned int> counts (height, DEEP_WIDTH);
+        Array2D<half*>        a (height, DEEP_WIDTH);
+        Array2D<float*>       z (height, DEEP_WIDTH);
+
+        DeepFrameBuffer fb;
+        fb.insertSampleCountSlice (Slice (
+            IMF::UINT,
+            (char*) &counts[0][0],
+            sizeof (unsigned int),
+            sizeof (unsigned int) * DEEP_WIDTH));
+        fb.insert (
+            "A",
+            DeepSlice (
+                IMF::HALF,
+                (char*) &a[0][0],
+                sizeof (half*),
+                sizeof (half*) * DEEP_WIDTH,
+                sizeof (half)));
+        fb.insert (
+            "Z",
+            DeepSlice (
+                IMF::FLOAT,
+                (char*) &z[0][0],
+                sizeof (float*),
+                sizeof (float*) * DEEP_WIDTH,
+                sizeof (float)));
+
+        in.setFrameBuffer (fb);
+        in.readPixelSampleCounts (0, height - 1);
+
+        std::vector<half>  aStore;
+        std::vector<float> zStore;
+        size_t             total = 0;
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                EXRCORE_TEST (
+                    counts[y][x] ==
+                    (unsigned int) deepSampleCount (x, y, linesPerChunk));
+                total += counts[y][x];
+            }
+        }
+
+        aStore.resize (total);
+        zStore.resize (total);
+        total = 0;
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                a[y][x] = aStore.data () + total;
+                z[y][x] = zStore.data () + total;
+                total += counts[y][x];
+            }
+        }
+
+        in.readPixels (0, height - 1);
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < DEEP_WIDTH; ++x)
+            {
+                for (unsigned int s = 0; s < counts[y][x]; ++s)
+                {
+                    EXRCORE_TEST (
+                        a[y][x][s].bits () == deepA (x, y, s).bits ());
+                    EXRCORE_TEST (z[y][x][s] == deepZ (x, y, s));
+                }
+            }
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR loading " << filename << ": " << e.what ()
+                  << std::endl;
+        EXRCORE_TEST_FAIL (DeepScanLineInputFile);
+    }
+
+    remove (filename.c_str ());
+}
+
+//
+// a ZIPD deep chunk whose sample count table is missing cannot be
+// decompressed, as the samples are reordered by their counts
+//
+
+static void
+doDeepZIPDWithoutTable (const std::string& tempdir)
+{
+    std::string filename = tempdir + std::string ("imf_test_deep_notable.exr");
+
+    doDeepWrite (filename, EXR_COMPRESSION_ZIPD);
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    exr_chunk_info_t          cinfo;
+    exr_decode_pipeline_t     decoder;
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, filename.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, 0, &cinfo));
+    EXRCORE_TEST (cinfo.packed_size > 0);
+    EXRCORE_TEST (cinfo.packed_size < cinfo.unpacked_size);
+
+    std::vector<uint8_t> packed (cinfo.packed_size);
+    std::vector<uint8_t> unpacked (cinfo.unpacked_size);
+
+    //
+    // stale counts which would be those of the chunk, as left behind
+    // in a reused table
+    //
+
+    std::vector<int32_t> table;
+    for (int y = 0; y < cinfo.height; ++y)
+    {
+        int32_t total = 0;
+        for (int x = 0; x < cinfo.width; ++x)
+        {
+            total += deepSampleCount (x, y, cinfo.height);
+            table.push_back (total);
+        }
+    }
+
+    EXRCORE_TEST_RVAL (
+        exr_read_deep_chunk (f, 0, &cinfo, packed.data (), NULL));
+
+    cinfo.sample_count_table_size = 0;
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+
+    decoder.packed_buffer      = packed.data ();
+    decoder.unpacked_buffer    = unpacked.data ();
+    decoder.sample_count_table = table.data ();
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_CORRUPT_CHUNK, exr_uncompress_chunk (&decoder));
+
+    decoder.packed_buffer      = NULL;
+    decoder.unpacked_buffer    = NULL;
+    decoder.sample_count_table = NULL;
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    remove (filename.c_str ());
+}
+
+//
+// the cumulative sample count table of each line is checked and
+// converted four counts at a time, with the rest of the line on its
+// own: write one line per width with valid counts, then one line per
+// pixel whose count drops below the one before it, and check those
+// are rejected wherever the drop falls
+//
+
+static int32_t
+tableSampleCount (int x, int y)
+{
+    return (x * 5 + y) % 4 + 1;
+}
+
+static void
+doDeepSampleTable (const std::string& tempdir)
+{
+    std::string filename = tempdir + std::string ("imf_test_deep_table.exr");
+
+    const int widths[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 13, 16, 17};
+
+    for (int w: widths)
+    {
+        exr_context_t             f;
+        exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+        int                       partidx;
+
+        EXRCORE_TEST_RVAL (exr_start_write (
+            &f, filename.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+        EXRCORE_TEST_RVAL (
+            exr_add_part (f, "deep", EXR_STORAGE_DEEP_SCANLINE, &partidx));
+        EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+            f, partidx, w, w, EXR_COMPRESSION_NONE));
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f, partidx, "Z", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+        EXRCORE_TEST_RVAL (exr_write_header (f));
+
+        for (int y = 0; y < w; ++y)
+        {
+            std::vector<int32_t> table;
+            int32_t              total = 0;
+
+            for (int x = 0; x < w; ++x)
+            {
+                total += tableSampleCount (x, y);
+                // line y > 0 drops at pixel y
+                if (y > 0 && x == y) total -= tableSampleCount (x, y) + 1;
+                table.push_back (total);
+            }
+
+            std::vector<float> samples;
+            for (int x = 0; x < w; ++x)
+                for (int s = 0; s < tableSampleCount (x, y); ++s)
+                    samples.push_back (deepZ (x, y, s));
+            samples.resize (total);
+
+            EXRCORE_TEST_RVAL (exr_write_deep_scanline_chunk (
+                f,
+                partidx,
+                y,
+                samples.data (),
+                samples.size () * sizeof (float),
+                samples.size () * sizeof (float),
+                table.data (),
+                table.size () * sizeof (int32_t)));
+        }
+
+        EXRCORE_TEST_RVAL (exr_finish (&f));
+
+        EXRCORE_TEST_RVAL (exr_start_read (&f, filename.c_str (), &cinit));
+
+        for (int y = 0; y < w; ++y)
+        {
+            for (int individual = 0; individual < 2; ++individual)
+            {
+                exr_chunk_info_t      cinfo;
+                exr_decode_pipeline_t decoder;
+                std::vector<float>    samples (w * 4, -1.f);
+
+                EXRCORE_TEST_RVAL (
+                    exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+                EXRCORE_TEST_RVAL (
+                    exr_decoding_initialize (f, 0, &cinfo, &decoder));
+
+                if (individual)
+                    decoder.decode_flags |=
+                        EXR_DECODE_SAMPLE_COUNTS_AS_INDIVIDUAL;
+
+                decoder.channels[0].decode_to_ptr =
+                    (uint8_t*) samples.data ();
+                decoder.channels[0].user_pixel_stride      = 4;
+                decoder.channels[0].user_line_stride       = 4 * w;
+                decoder.channels[0].user_bytes_per_element = 4;
+                decoder.channels[0].user_data_type = EXR_PIXEL_FLOAT;
+
+                EXRCORE_TEST_RVAL (
+                    exr_decoding_choose_default_routines (f, 0, &decoder));
+
+                if (y > 0)
+                {
+                    EXRCORE_TEST_RVAL_FAIL (
+                        EXR_ERR_INVALID_SAMPLE_DATA,
+                        exr_decoding_run (f, 0, &decoder));
+                    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+                    continue;
+                }
+
+                EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+
+                int32_t total = 0;
+                size_t  i     = 0;
+                for (int x = 0; x < w; ++x)
+                {
+                    int32_t n = tableSampleCount (x, y);
+                    total += n;
+                    EXRCORE_TEST (
+                        decoder.sample_count_table[x] ==
+                        (individual ? n : total));
+                    for (int s = 0; s < n; ++s)
+                        EXRCORE_TEST (samples[i++] == deepZ (x, y, s));
+                }
+                if (individual)
+                    EXRCORE_TEST (decoder.sample_count_table[w] == total);
+                EXRCORE_TEST (samples[i] == -1.f);
+
+                EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+            }
+        }
+
+        EXRCORE_TEST_RVAL (exr_finish (&f));
+    }
+
+    remove (filename.c_str ());
+}
+
+////////////////////////////////////////
+
 void
 testNoCompression (const std::string& tempdir)
 {
@@ -1663,6 +2107,14 @@ testZIPSCompression (const std::string& tempdir)
     testComp (tempdir, EXR_COMPRESSION_ZIPS);
 }
 
+void
+testZIPDCompression (const std::string& tempdir)
+{
+    testComp (tempdir, EXR_COMPRESSION_ZIPD);
+    doDeepWriteRead (tempdir, EXR_COMPRESSION_ZIPD);
+    doDeepZIPDWithoutTable (tempdir);
+}
+
 void
 testPIZCompression (const std::string& tempdir)
 {
@@ -1805,14 +2257,187 @@ testHTHeaderBounds (const std::string& tempdir)
     EXRCORE_TEST (read_header_throws (bad_nch, hdr_sz));
 }
 
+////////////////////////////////////////
+
+static void
+doHTChannelSubset (
+    const std::string& filename, const std::vector<std::string>& names)
+{
+    const int                       w = 61, h = 75;
+    Box2i                           dw (V2i (-3, 5), V2i (-3 + w - 1, 5 + h - 1));
+    Header                          hdr (dw, dw);
+    FrameBuffer                     fb;
+    std::vector<std::vector<float>> src (names.size ());
+    std::vector<std::vector<half>>  hsrc (names.size ());
+
+    hdr.compression () = HTJ2K32_COMPRESSION;
+    for (size_t c = 0; c < names.size (); ++c)
+    {
+        PixelType pt = names[c] == "Z" ? IMF::FLOAT : IMF::HALF;
+        hdr.channels ().insert (names[c], Channel (pt));
+
+        src[c].resize (w * h);
+        hsrc[c].resize (w * h);
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                src[c][y * w + x]  = float ((x * (c + 3) + y * 7) % 64) / 8.f;
+                hsrc[c][y * w + x] = src[c][y * w + x];
+            }
+        }
+
+        if (pt == IMF::FLOAT)
+            fb.insert (
+                names[c],
+                Slice::Make (
+                    IMF::FLOAT,
+                    src[c].data (),
+                    dw,
+                    sizeof (float),
+                    w * sizeof (float)));
+        else
+            fb.insert (
+                names[c],
+                Slice::Make (
+                    IMF::HALF,
+                    hsrc[c].data (),
+                    dw,
+                    sizeof (half),
+                    w * sizeof (half)));
+    }
+
+    {
+        OutputFile out (filename.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writePixels (h);
+    }
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    EXRCORE_TEST_RVAL (exr_start_read (&f, filename.c_str (), &cinit));
+
+    int32_t scansperchunk;
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, 0, &scansperchunk));
+
+    // read each channel on its own, the others are not requested
+    // and may not be decoded
+    for (size_t want = 0; want < names.size (); ++want)
+    {
+        exr_decode_pipeline_t decoder;
+        exr_chunk_info_t      cinfo;
+        std::vector<float>    out (w * h, -1.f);
+        bool                  first = true;
+        int                   wantc = -1;
+
+        for (int y = dw.min.y; y <= dw.max.y; y += scansperchunk)
+        {
+            EXRCORE_TEST_RVAL (
+                exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+            if (first)
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_decoding_initialize (f, 0, &cinfo, &decoder));
+            }
+            else
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_decoding_update (f, 0, &cinfo, &decoder));
+            }
+
+            for (int c = 0; c < decoder.channel_count; ++c)
+            {
+                exr_coding_channel_info_t& curchan = decoder.channels[c];
+
+                if (names[want] != curchan.channel_name)
+                {
+                    curchan.decode_to_ptr = NULL;
+                    continue;
+                }
+
+                wantc                          = c;
+                curchan.user_data_type         = EXR_PIXEL_FLOAT;
+                curchan.user_bytes_per_element = sizeof (float);
+                curchan.user_pixel_stride      = sizeof (float);
+                curchan.user_line_stride       = w * sizeof (float);
+                curchan.decode_to_ptr          = reinterpret_cast<uint8_t*> (
+                    out.data () + (y - dw.min.y) * w);
+            }
+
+            if (first)
+            {
+                EXRCORE_TEST_RVAL (
+                    exr_decoding_choose_default_routines (f, 0, &decoder));
+                EXRCORE_TEST (
+                    decoder.decode_flags & EXR_DECODE_REQUESTED_CHANNELS_ONLY);
+            }
+            EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+            first = false;
+        }
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+        EXRCORE_TEST (wantc >= 0);
+        for (int i = 0; i < w * h; ++i)
+            EXRCORE_TEST (out[i] == src[want][i]);
+    }
+
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (filename.c_str ());
+}
+
+void
+testHTChannelSubset (const std::string& tempdir)
+{
+    std::string filename = tempdir + std::string ("imf_test_ht_subset.exr");
+
+    // read one component at a time, stopping after the one requested
+    doHTChannelSubset (filename, {"A", "Z", "depth", "mask"});
+    // color transformed, all components have to be decoded
+    doHTChannelSubset (filename, {"R", "G", "B", "A", "Z"});
+}
+
 void
 testDeepNoCompression (const std::string& tempdir)
-{}
+{
+    doDeepWriteRead (tempdir, EXR_COMPRESSION_NONE);
+    doDeepSampleTable (tempdir);
+}
+
+void
+testDeepRLECompression (const std::string& tempdir)
+{
+    doDeepWriteRead (tempdir, EXR_COMPRESSION_RLE);
+}
 
 void
 testDeepZIPCompression (const std::string& tempdir)
-{}
+{
+    std::string filename = tempdir + std::string ("imf_test_deep_comp.exr");
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    int                       partidx;
+
+    //
+    // deep chunks hold a single scanline, so ZIP is rejected
+    //
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &f, filename.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "deep", EXR_STORAGE_DEEP_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        f, partidx, DEEP_WIDTH, 16, EXR_COMPRESSION_ZIP));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "Z", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL_FAIL (EXR_ERR_INVALID_ATTR, exr_write_header (f));
+    exr_finish (&f);
+
+    remove (filename.c_str ());
+}
 
 void
 testDeepZIPSCompression (const std::string& tempdir)
-{}
+{
+    doDeepWriteRead (tempdir, EXR_COMPRESSION_ZIPS);
+}
@@ -16,6 +16,7 @@ void testNoCompression (const std::string& tempdir);
 void testRLECompression (const std::string& tempdir);
 void testZIPCompression (const std::string& tempdir);
 void testZIPSCompression (const std::string& tempdir);
+void testZIPDCompression (const std::string& tempdir);
 void testPIZCompression (const std::string& tempdir);
 void testPXR24Compression (const std::string& tempdir);
 void testB44Compression (const std::string& tempdir);
@@ -24,8 +25,10 @@ void testDWAACompression (const std::string& tempdir);
 void testDWABCompression (const std::string& tempdir);
 void testHTChannelMap (const std::string& tempdir);
 void testHTHeaderBounds (const std::string& tempdir);
+void testHTChannelSubset (const std::string& tempdir);
 
 void testDeepNoCompression (const std::string& tempdir);
+void testDeepRLECompression (const std::string& tempdir);
 void testDeepZIPCompression (const std::string& tempdir);
 void testDeepZIPSCompression (const std::string& tempdir);
 
@@ -175,6 +175,7 @@ main (int argc, char* argv[])
     TEST (testOpenDeep, "core_read");
     TEST (testReadScans, "core_read");
     TEST (testReadTiles, "core_read");
+    TEST (testReadFromMemory, "core_read");
     TEST (testReadMultiPart, "core_read");
     TEST (testReadDeep, "core_read");
     TEST (testReadUnpack, "core_read");
@@ -184,6 +185,7 @@ main (int argc, char* argv[])
     TEST (testWriteBadFiles, "core_write");
     TEST (testUpdateMeta, "core_write");
     TEST (testWriteBaseHeader, "core_write");
+    TEST (testWriteFindChannel, "core_write");
     TEST (testWriteAttrs, "core_write");
     TEST (testStartWriteScan, "core_write");
     TEST (testStartWriteTile, "core_write");
@@ -192,6 +194,8 @@ main (int argc, char* argv[])
     TEST (testStartWriteUTF8, "core_write");
     TEST (testWriteScans, "core_write");
     TEST (testWriteTiles, "core_write");
+    TEST (testWriteTileLevels, "core_write");
+    TEST (testWriteToMemory, "core_write");
     TEST (testWriteMultiPart, "core_write");
     TEST (testWriteDeep, "core_write");
 
@@ -203,6 +207,7 @@ main (int argc, char* argv[])
     TEST (testRLECompression, "core_compression");
     TEST (testZIPCompression, "core_compression");
     TEST (testZIPSCompression, "core_compression");
+    TEST (testZIPDCompression, "core_compression");
     TEST (testPIZCompression, "core_compression");
     TEST (testPXR24Compression, "core_compression");
     TEST (testB44Compression, "core_compression");
@@ -211,8 +216,10 @@ main (int argc, char* argv[])
     TEST (testDWABCompression, "core_compression");
     TEST (testHTChannelMap, "core_compression");
     TEST (testHTHeaderBounds, "core_compression");
+    TEST (testHTChannelSubset, "core_compression");
 
     TEST (testDeepNoCompression, "core_compression");
+    TEST (testDeepRLECompression, "core_compression");
     TEST (testDeepZIPCompression, "core_compression");
     TEST (testDeepZIPSCompression, "core_compression");
 
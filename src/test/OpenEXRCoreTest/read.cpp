@@ -12,9 +12,11 @@
 #include <math.h>
 #include <string.h>
 
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, int code, const char* msg)
@@ -242,6 +244,134 @@ void
 testOpenMultiPart (const std::string& tempdir)
 {}
 
+//
+// Uncompressed scan line chunks hold a single line, so the direct read
+// of a chunk with skipped lines is checked on a chunk of several lines
+// appended to an in-memory copy of a file: each line holds Y and, on
+// even lines, the y-sampled channel c
+//
+static void
+testReadDirectSampledSkip (const std::string& tempdir)
+{
+    const int W = 5, H = 8, Y0 = 2;
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    std::string fn = tempdir + "core_direct_sampled.exr";
+
+    exr_attr_box2i_t dw = {{0, Y0}, {W - 1, Y0 + H - 1}};
+
+    std::vector<float> lines;
+    for (int y = Y0; y < Y0 + H; ++y)
+    {
+        for (int x = 0; x < W; ++x)
+            lines.push_back (float (y * 100 + x));
+        if (y % 2 == 0)
+        {
+            for (int x = 0; x < W; ++x)
+                lines.push_back (float (1000 + y * 100 + x));
+        }
+    }
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    int partidx;
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        f, partidx, W, H, EXR_COMPRESSION_NONE));
+    EXRCORE_TEST_RVAL (exr_set_data_window (f, partidx, &dw));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "Y", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        f, partidx, "c", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LINEAR, 1, 2));
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    const float* line = lines.data ();
+    for (int y = Y0; y < Y0 + H; ++y)
+    {
+        size_t n = (y % 2 == 0) ? 2 * W : W;
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+            f, partidx, y, line, n * sizeof (float)));
+        line += n;
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    std::ifstream ifs (fn, std::ios::in | std::ios::binary);
+    std::string   filedata (
+        (std::istreambuf_iterator<char> (ifs)),
+        std::istreambuf_iterator<char> ());
+    EXRCORE_TEST (!filedata.empty ());
+
+    uint64_t chunkoff  = filedata.size ();
+    uint64_t chunksize = lines.size () * sizeof (float);
+    filedata.append ((const char*) lines.data (), chunksize);
+
+    EXRCORE_TEST_RVAL (exr_start_read_from_memory (
+        &f, NULL, filedata.data (), filedata.size (), &cinit));
+
+    exr_chunk_info_t cinfo;
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, Y0, &cinfo));
+    cinfo.height        = H;
+    cinfo.data_offset   = chunkoff;
+    cinfo.packed_size   = chunksize;
+    cinfo.unpacked_size = chunksize;
+
+    for (int skip = 0; skip < H; ++skip)
+    {
+        // as the library does, the pointers are at the first line
+        // read, and for c, at the sampled line it falls in
+        const int fby = Y0 + skip;
+
+        std::vector<float> ybuf (W * H, -1.f), cbuf (W * H / 2, -1.f);
+
+        exr_decode_pipeline_t decoder;
+        EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        EXRCORE_TEST (decoder.channels[1].height == H / 2);
+
+        decoder.user_line_begin_skip = skip;
+        for (int c = 0; c < 2; ++c)
+        {
+            exr_coding_channel_info_t& decc = decoder.channels[c];
+
+            decc.user_pixel_stride      = 4;
+            decc.user_line_stride       = 4 * W;
+            decc.user_bytes_per_element = 4;
+            decc.user_data_type         = EXR_PIXEL_FLOAT;
+        }
+        decoder.channels[0].decode_to_ptr =
+            (uint8_t*) (ybuf.data () + (fby - Y0) * W);
+        decoder.channels[1].decode_to_ptr =
+            (uint8_t*) (cbuf.data () + (fby / 2 - Y0 / 2) * W);
+
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        EXRCORE_TEST (decoder.decompress_fn == NULL);
+        EXRCORE_TEST (decoder.unpack_and_convert_fn == NULL);
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+        for (int y = Y0; y < Y0 + H; ++y)
+        {
+            for (int x = 0; x < W; ++x)
+            {
+                float yv = ybuf[(y - Y0) * W + x];
+                EXRCORE_TEST (yv == (y < fby ? -1.f : float (y * 100 + x)));
+
+                if (y % 2 != 0) continue;
+                float cv = cbuf[(y / 2 - Y0 / 2) * W + x];
+                EXRCORE_TEST (
+                    cv == (y < fby ? -1.f : float (1000 + y * 100 + x)));
+            }
+        }
+    }
+
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (fn.c_str ());
+}
+
 void
 testReadScans (const std::string& tempdir)
 {
@@ -388,6 +518,8 @@ testReadScans (const std::string& tempdir)
     EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
 
     exr_finish (&f);
+
+    testReadDirectSampledSkip (tempdir);
 }
 
 void
@@ -563,14 +695,253 @@ testReadTiles (const std::string& tempdir)
     //    std::cout << std::endl;
     //}
 
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+    // and again, only reading the byte ranges of one of the channels
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+
+    std::unique_ptr<uint8_t[]> z2ptr{new uint8_t[24 * 12 * 4]};
+    memset (z2ptr.get (), 0, 24 * 12 * 4);
+    decoder.channels[1].decode_to_ptr          = z2ptr.get ();
+    decoder.channels[1].user_pixel_stride      = 4;
+    decoder.channels[1].user_line_stride       = 4 * 12;
+    decoder.channels[1].user_bytes_per_element = 4;
+
+    EXRCORE_TEST_RVAL (exr_decoding_choose_default_routines (f, 0, &decoder));
+    EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+    EXRCORE_TEST (decoder.packed_buffer == NULL);
+    EXRCORE_TEST (0 == memcmp (zptr.get (), z2ptr.get (), 24 * 12 * 4));
+
     EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
     exr_finish (&f);
 }
 
+void
+testReadFromMemory (const std::string& tempdir)
+{
+    (void) tempdir;
+
+    exr_context_t             f;
+    std::string               fn    = ILM_IMF_TEST_IMAGEDIR;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    fn += "v1.7.test.tiled.exr";
+    std::ifstream ifs (fn, std::ios::in | std::ios::binary);
+    std::string   filedata (
+        (std::istreambuf_iterator<char> (ifs)),
+        std::istreambuf_iterator<char> ());
+    EXRCORE_TEST (!filedata.empty ());
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_read_from_memory (
+            NULL, "mem", filedata.data (), filedata.size (), &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_read_from_memory (&f, "mem", NULL, 42, &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_read_from_memory (&f, "mem", filedata.data (), 0, &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_FILE_BAD_HEADER,
+        exr_start_read_from_memory (&f, "mem", filedata.data (), 42, &cinit));
+
+    EXRCORE_TEST_RVAL (exr_start_read_from_memory (
+        &f, NULL, filedata.data (), filedata.size (), &cinit));
+
+    const char* fname = NULL;
+    EXRCORE_TEST_RVAL (exr_get_file_name (f, &fname));
+    EXRCORE_TEST (fname && !strcmp (fname, "<memory>"));
+
+    exr_storage_t ps;
+    EXRCORE_TEST_RVAL (exr_get_storage (f, 0, &ps));
+    EXRCORE_TEST (EXR_STORAGE_TILED == ps);
+
+    exr_chunk_info_t cinfo;
+    EXRCORE_TEST_RVAL (exr_read_tile_chunk_info (f, 0, 4, 2, 0, 0, &cinfo));
+
+    // the raw chunk read copies straight out of the buffer
+    std::unique_ptr<uint8_t[]> raw{new uint8_t[cinfo.packed_size]};
+    EXRCORE_TEST_RVAL (exr_read_chunk (f, 0, &cinfo, raw.get ()));
+    EXRCORE_TEST (
+        0 == memcmp (
+                 raw.get (),
+                 filedata.data () + cinfo.data_offset,
+                 cinfo.packed_size));
+
+    // and the decode pipeline references it in place
+    exr_decode_pipeline_t decoder;
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+
+    std::unique_ptr<float[]> gptr{new float[24 * 12]};
+    memset (gptr.get (), 0, 24 * 12 * 4);
+    decoder.channels[0].decode_to_ptr          = (uint8_t*) gptr.get ();
+    decoder.channels[0].user_pixel_stride      = 4;
+    decoder.channels[0].user_line_stride       = 4 * 12;
+    decoder.channels[0].user_bytes_per_element = 4;
+    decoder.channels[0].user_data_type         = EXR_PIXEL_FLOAT;
+
+    EXRCORE_TEST_RVAL (exr_decoding_choose_default_routines (f, 0, &decoder));
+    EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+    EXRCORE_TEST (
+        decoder.packed_buffer ==
+        (const void*) (filedata.data () + cinfo.data_offset));
+    EXRCORE_TEST (decoder.packed_alloc_size == 0);
+    // 0x33d5 as a half
+    EXRCORE_TEST (fabsf (gptr[0] - 0.244751f) < 0.000001f);
+
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+}
+
 void
 testReadMultiPart (const std::string& tempdir)
 {}
 
+// reads a few channels of a compressed part with many channels, which
+// the default routines unpack with the sparse unpacker
+//
+static void
+testReadSparseChannels (const std::string& tempdir)
+{
+    const int W = 7, H = 40, NCHANS = 40;
+
+    exr_context_t             f;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    std::string fn = tempdir + "core_sparse_channels.exr";
+
+    // alternating 16 and 32 bit channels, so each has a different
+    // offset in the line; the half values are only copied, never
+    // converted
+    auto chantype = [] (int c) {
+        return (c % 2 == 0) ? EXR_PIXEL_HALF : EXR_PIXEL_UINT;
+    };
+    auto value = [] (int c, int x, int y) {
+        return (c % 2 == 0) ? uint32_t ((c * 97 + y * 13 + x) & 0x3fff)
+                            : uint32_t (c * 100000 + y * 100 + x);
+    };
+
+    std::vector<std::vector<uint16_t>> halves (NCHANS);
+    std::vector<std::vector<uint32_t>> uints (NCHANS);
+    for (int c = 0; c < NCHANS; ++c)
+    {
+        for (int y = 0; y < H; ++y)
+        {
+            for (int x = 0; x < W; ++x)
+            {
+                if (chantype (c) == EXR_PIXEL_HALF)
+                    halves[c].push_back (uint16_t (value (c, x, y)));
+                else
+                    uints[c].push_back (value (c, x, y));
+            }
+        }
+    }
+
+    EXRCORE_TEST_RVAL (
+        exr_start_write (&f, fn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    int partidx;
+    EXRCORE_TEST_RVAL (
+        exr_add_part (f, "scan", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        f, partidx, W, H, EXR_COMPRESSION_ZIP));
+    for (int c = 0; c < NCHANS; ++c)
+    {
+        char name[16];
+        snprintf (name, sizeof (name), "c%02d", c);
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            f, partidx, name, chantype (c), EXR_PERCEPTUALLY_LINEAR, 1, 1));
+    }
+    EXRCORE_TEST_RVAL (exr_write_header (f));
+
+    int32_t scansperchunk;
+    EXRCORE_TEST_RVAL (exr_get_scanlines_per_chunk (f, partidx, &scansperchunk));
+    EXRCORE_TEST (scansperchunk > 1);
+
+    for (int y = 0; y < H; y += scansperchunk)
+    {
+        exr_chunk_info_t      cinfo;
+        exr_encode_pipeline_t encoder;
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk_info (f, 0, y, &cinfo));
+        EXRCORE_TEST_RVAL (exr_encoding_initialize (f, 0, &cinfo, &encoder));
+        for (int c = 0; c < NCHANS; ++c)
+        {
+            exr_coding_channel_info_t& encc = encoder.channels[c];
+            const uint8_t*             ptr =
+                (chantype (c) == EXR_PIXEL_HALF)
+                                ? (const uint8_t*) (halves[c].data () + y * W)
+                                : (const uint8_t*) (uints[c].data () + y * W);
+
+            encc.encode_from_ptr   = ptr;
+            encc.user_pixel_stride = encc.user_bytes_per_element;
+            encc.user_line_stride  = W * encc.user_bytes_per_element;
+        }
+        EXRCORE_TEST_RVAL (
+            exr_encoding_choose_default_routines (f, 0, &encoder));
+        EXRCORE_TEST_RVAL (exr_encoding_run (f, 0, &encoder));
+        EXRCORE_TEST_RVAL (exr_encoding_destroy (f, &encoder));
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+
+    const int requested[] = {1, 6, 17, 38, 39};
+
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    for (int y = 0; y < H; y += scansperchunk)
+    {
+        exr_chunk_info_t      cinfo;
+        exr_decode_pipeline_t decoder;
+        EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (f, 0, y, &cinfo));
+        EXRCORE_TEST_RVAL (exr_decoding_initialize (f, 0, &cinfo, &decoder));
+        EXRCORE_TEST (decoder.channel_count == NCHANS);
+
+        // one more line than the chunk, which must be left alone
+        std::vector<std::vector<uint32_t>> out (NCHANS);
+        for (int c: requested)
+        {
+            exr_coding_channel_info_t& decc = decoder.channels[c];
+
+            out[c].assign ((cinfo.height + 1) * W, 0xdeadbeef);
+            decc.decode_to_ptr          = (uint8_t*) out[c].data ();
+            decc.user_pixel_stride      = 4;
+            decc.user_line_stride       = 4 * W;
+            decc.user_bytes_per_element = decc.bytes_per_element;
+            decc.user_data_type         = decc.data_type;
+        }
+
+        EXRCORE_TEST_RVAL (
+            exr_decoding_choose_default_routines (f, 0, &decoder));
+        EXRCORE_TEST (decoder.decompress_fn != NULL);
+        EXRCORE_TEST (
+            decoder.decode_flags & EXR_DECODE_REQUESTED_CHANNELS_ONLY);
+        EXRCORE_TEST_RVAL (exr_decoding_run (f, 0, &decoder));
+        EXRCORE_TEST_RVAL (exr_decoding_destroy (f, &decoder));
+
+        for (int c: requested)
+        {
+            for (int ly = 0; ly <= cinfo.height; ++ly)
+            {
+                for (int x = 0; x < W; ++x)
+                {
+                    uint32_t v = out[c][ly * W + x];
+                    uint16_t h;
+                    memcpy (&h, &out[c][ly * W + x], sizeof (h));
+
+                    if (ly == cinfo.height)
+                        EXRCORE_TEST (v == 0xdeadbeef);
+                    else if (chantype (c) == EXR_PIXEL_HALF)
+                        EXRCORE_TEST (h == value (c, x, y + ly));
+                    else
+                        EXRCORE_TEST (v == value (c, x, y + ly));
+                }
+            }
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    remove (fn.c_str ());
+}
+
 void
 testReadUnpack (const std::string& tempdir)
 {
@@ -615,6 +986,8 @@ testReadUnpack (const std::string& tempdir)
     }
 
     exr_finish (&f);
+
+    testReadSparseChannels (tempdir);
 }
 
 #include "../../lib/OpenEXRCore/internal_util.h"
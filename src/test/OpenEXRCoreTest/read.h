@@ -18,6 +18,7 @@ void testOpenDeep (const std::string& tempdir);
 
 void testReadScans (const std::string& tempdir);
 void testReadTiles (const std::string& tempdir);
+void testReadFromMemory (const std::string& tempdir);
 void testReadMultiPart (const std::string& tempdir);
 
 void testReadUnpack (const std::string& tempdir);
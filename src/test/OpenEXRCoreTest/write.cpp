@@ -26,6 +26,7 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 static void
 err_cb (exr_const_context_t f, exr_result_t code, const char* msg)
@@ -608,6 +609,115 @@ testWriteBaseHeader (const std::string& tempdir)
     remove (outfn.c_str ());
 }
 
+void
+testWriteFindChannel (const std::string& tempdir)
+{
+    exr_context_t outf;
+    std::string   outfn = tempdir + "testfindchannel.exr";
+    int           partidx;
+    int32_t       chanidx = -1;
+    char          name[32];
+
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &outf, outfn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (outf, "beauty", EXR_STORAGE_SCANLINE, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        outf, partidx, 4, 4, EXR_COMPRESSION_NONE));
+    EXRCORE_TEST_RVAL (exr_set_longname_support (outf, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        outf,
+        partidx,
+        "reallongreallongreallonglongchannelname",
+        EXR_PIXEL_HALF,
+        EXR_PERCEPTUALLY_LOGARITHMIC,
+        1,
+        1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        outf, partidx, "Z", EXR_PIXEL_FLOAT, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        outf, partidx, "A", EXR_PIXEL_HALF, EXR_PERCEPTUALLY_LOGARITHMIC, 1, 1));
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_MISSING_CONTEXT_ARG,
+        exr_find_channel (NULL, partidx, "A", &chanidx));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_ARGUMENT_OUT_OF_RANGE,
+        exr_find_channel (outf, partidx + 1, "A", &chanidx));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_find_channel (outf, partidx, NULL, &chanidx));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT, exr_find_channel (outf, partidx, "A", NULL));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NO_ATTR_BY_NAME,
+        exr_find_channel (outf, partidx, "B", &chanidx));
+    EXRCORE_TEST_RVAL (exr_find_channel (outf, partidx, "A", &chanidx));
+    EXRCORE_TEST (chanidx == 0);
+    EXRCORE_TEST_RVAL (exr_find_channel (outf, partidx, "Z", &chanidx));
+    EXRCORE_TEST (chanidx == 1);
+    EXRCORE_TEST_RVAL (exr_find_channel (
+        outf, partidx, "reallongreallongreallonglongchannelname", &chanidx));
+    EXRCORE_TEST (chanidx == 2);
+
+    // inserted in reverse order, the channels are still found at
+    // their sorted position
+    for (int c = 99; c >= 0; --c)
+    {
+        snprintf (name, sizeof (name), "layer.%02d", c);
+        EXRCORE_TEST_RVAL (exr_add_channel (
+            outf,
+            partidx,
+            name,
+            EXR_PIXEL_HALF,
+            EXR_PERCEPTUALLY_LOGARITHMIC,
+            1,
+            1));
+    }
+    for (int c = 0; c < 100; ++c)
+    {
+        snprintf (name, sizeof (name), "layer.%02d", c);
+        EXRCORE_TEST_RVAL (exr_find_channel (outf, partidx, name, &chanidx));
+        EXRCORE_TEST (chanidx == 2 + c);
+    }
+    EXRCORE_TEST_RVAL (exr_find_channel (
+        outf, partidx, "reallongreallongreallonglongchannelname", &chanidx));
+    EXRCORE_TEST (chanidx == 102);
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_NO_ATTR_BY_NAME,
+        exr_find_channel (outf, partidx, "layer.100", &chanidx));
+
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+
+    // all half but for Z
+    std::vector<uint8_t> line ((102 * 2 + 4) * 4, 0);
+    for (int y = 0; y < 4; ++y)
+        EXRCORE_TEST_RVAL (exr_write_scanline_chunk (
+            outf, partidx, y, line.data (), line.size ()));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+
+    // once read back, the index is that of the decode pipeline
+    EXRCORE_TEST_RVAL (exr_start_read (&outf, outfn.c_str (), &cinit));
+
+    exr_chunk_info_t      cinfo;
+    exr_decode_pipeline_t decoder;
+    EXRCORE_TEST_RVAL (exr_read_scanline_chunk_info (outf, 0, 0, &cinfo));
+    EXRCORE_TEST_RVAL (exr_decoding_initialize (outf, 0, &cinfo, &decoder));
+    EXRCORE_TEST (decoder.channel_count == 103);
+    for (int c = 0; c < decoder.channel_count; ++c)
+    {
+        EXRCORE_TEST_RVAL (exr_find_channel (
+            outf, 0, decoder.channels[c].channel_name, &chanidx));
+        EXRCORE_TEST (chanidx == c);
+    }
+    EXRCORE_TEST_RVAL (exr_decoding_destroy (outf, &decoder));
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+    remove (outfn.c_str ());
+}
+
 void
 testWriteAttrs (const std::string& tempdir)
 {
@@ -1405,6 +1515,176 @@ testWriteTiles (const std::string& tempdir)
     remove (outfn.c_str ());
 }
 
+void
+testWriteTileLevels (const std::string& tempdir)
+{
+    exr_context_t             outf;
+    std::string               outfn = tempdir + "testtilelevels.exr";
+    int                       partidx;
+    int32_t                   levelsx, levelsy;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn          = &err_cb;
+
+    //
+    // partial tiles of the lower levels are clipped against the size
+    // of the level, not the data window, as when reading
+    //
+
+    EXRCORE_TEST_RVAL (exr_start_write (
+        &outf, outfn.c_str (), EXR_WRITE_FILE_DIRECTLY, &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_add_part (outf, "test", EXR_STORAGE_TILED, &partidx));
+    EXRCORE_TEST_RVAL (exr_initialize_required_attr_simple (
+        outf, partidx, 100, 50, EXR_COMPRESSION_NONE));
+    EXRCORE_TEST_RVAL (exr_add_channel (
+        outf,
+        partidx,
+        "Y",
+        EXR_PIXEL_HALF,
+        EXR_PERCEPTUALLY_LOGARITHMIC,
+        1,
+        1));
+    EXRCORE_TEST_RVAL (exr_set_tile_descriptor (
+        outf, partidx, 16, 16, EXR_TILE_MIPMAP_LEVELS, EXR_TILE_ROUND_DOWN));
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+
+    EXRCORE_TEST_RVAL (exr_get_tile_levels (outf, 0, &levelsx, &levelsy));
+    EXRCORE_TEST (levelsx == 7);
+    EXRCORE_TEST (levelsy == 7);
+
+    for (int l = 0; l < levelsx; ++l)
+    {
+        int32_t levw, levh;
+        EXRCORE_TEST_RVAL (exr_get_level_sizes (outf, 0, l, l, &levw, &levh));
+
+        for (int ty = 0; ty * 16 < levh; ++ty)
+        {
+            for (int tx = 0; tx * 16 < levw; ++tx)
+            {
+                exr_chunk_info_t cinfo;
+                int32_t          w = std::min (16, levw - tx * 16);
+                int32_t          h = std::min (16, levh - ty * 16);
+
+                EXRCORE_TEST_RVAL (
+                    exr_write_tile_chunk_info (outf, 0, tx, ty, l, l, &cinfo));
+                EXRCORE_TEST (cinfo.width == w);
+                EXRCORE_TEST (cinfo.height == h);
+                EXRCORE_TEST (
+                    cinfo.unpacked_size == (uint64_t) (w * h * 2));
+            }
+        }
+    }
+
+    exr_finish (&outf);
+    remove (outfn.c_str ());
+}
+
+void
+testWriteToMemory (const std::string& tempdir)
+{
+    (void) tempdir;
+
+    exr_context_t              f, outf, testf;
+    std::string                fn = ILM_IMF_TEST_IMAGEDIR;
+    int                        partidx;
+    int32_t                    partcnt, outpartcnt;
+    exr_memory_output_buffer_t outbuf = {NULL, 0, 0};
+    exr_context_initializer_t  cinit  = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.error_handler_fn            = &err_cb;
+
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_write_to_memory (NULL, "mem", &outbuf, &cinit));
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_write_to_memory (&outf, "mem", NULL, &cinit));
+    outbuf.capacity = 42;
+    EXRCORE_TEST_RVAL_FAIL (
+        EXR_ERR_INVALID_ARGUMENT,
+        exr_start_write_to_memory (&outf, "mem", &outbuf, &cinit));
+    outbuf.capacity = 0;
+
+    fn += "v1.7.test.tiled.exr";
+    EXRCORE_TEST_RVAL (exr_start_read (&f, fn.c_str (), &cinit));
+    EXRCORE_TEST_RVAL (
+        exr_start_write_to_memory (&outf, NULL, &outbuf, &cinit));
+
+    const char* fname = NULL;
+    EXRCORE_TEST_RVAL (exr_get_file_name (outf, &fname));
+    EXRCORE_TEST (fname && !strcmp (fname, "<memory>"));
+
+    EXRCORE_TEST_RVAL (
+        exr_add_part (outf, "test", EXR_STORAGE_TILED, &partidx));
+    EXRCORE_TEST_RVAL (exr_copy_unset_attributes (outf, 0, f, 0));
+    EXRCORE_TEST_RVAL (exr_write_header (outf));
+    EXRCORE_TEST (outbuf.size > 0 && outbuf.capacity >= outbuf.size);
+
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (f, 0, &partcnt));
+    EXRCORE_TEST_RVAL (exr_get_chunk_count (outf, 0, &outpartcnt));
+    EXRCORE_TEST (partcnt == outpartcnt);
+
+    int32_t          tw, th, ntx, nty;
+    exr_attr_box2i_t dw;
+    EXRCORE_TEST_RVAL (exr_get_data_window (outf, 0, &dw));
+    EXRCORE_TEST_RVAL (exr_get_tile_sizes (outf, 0, 0, 0, &tw, &th));
+    ntx = (dw.max.x - dw.min.x + tw) / tw;
+    nty = (dw.max.y - dw.min.y + th) / th;
+
+    std::vector<std::vector<uint8_t>> chunks;
+    for (int32_t ty = 0; ty < nty; ++ty)
+    {
+        for (int32_t tx = 0; tx < ntx; ++tx)
+        {
+            exr_chunk_info_t cinfo;
+            EXRCORE_TEST_RVAL (
+                exr_read_tile_chunk_info (f, 0, tx, ty, 0, 0, &cinfo));
+            chunks.emplace_back (cinfo.packed_size);
+            EXRCORE_TEST_RVAL (
+                exr_read_chunk (f, 0, &cinfo, chunks.back ().data ()));
+            EXRCORE_TEST_RVAL (exr_write_tile_chunk (
+                outf,
+                0,
+                tx,
+                ty,
+                0,
+                0,
+                chunks.back ().data (),
+                cinfo.packed_size));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&f));
+    // the offset table is patched into the buffer as the file is closed
+    EXRCORE_TEST_RVAL (exr_finish (&outf));
+    EXRCORE_TEST (outbuf.data != NULL);
+
+    EXRCORE_TEST_RVAL (exr_start_read_from_memory (
+        &testf, "mem", outbuf.data, outbuf.size, &cinit));
+    EXRCORE_TEST_RVAL (exr_get_tile_sizes (testf, 0, 0, 0, &tw, &th));
+    EXRCORE_TEST (tw == 12);
+    EXRCORE_TEST (th == 24);
+
+    size_t idx = 0;
+    for (int32_t ty = 0; ty < nty; ++ty)
+    {
+        for (int32_t tx = 0; tx < ntx; ++tx, ++idx)
+        {
+            exr_chunk_info_t cinfo;
+            EXRCORE_TEST_RVAL (
+                exr_read_tile_chunk_info (testf, 0, tx, ty, 0, 0, &cinfo));
+            EXRCORE_TEST (cinfo.packed_size == chunks[idx].size ());
+            EXRCORE_TEST (cinfo.data_offset + cinfo.packed_size <= outbuf.size);
+            EXRCORE_TEST (
+                0 == memcmp (
+                         (const uint8_t*) outbuf.data + cinfo.data_offset,
+                         chunks[idx].data (),
+                         cinfo.packed_size));
+        }
+    }
+    EXRCORE_TEST_RVAL (exr_finish (&testf));
+
+    free (outbuf.data);
+}
+
 void
 testWriteMultiPart (const std::string& tempdir)
 {
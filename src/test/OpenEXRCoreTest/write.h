@@ -10,6 +10,7 @@ void testWriteBadArgs (const std::string& tempdir);
 void testWriteBadFiles (const std::string& tempdir);
 
 void testWriteBaseHeader (const std::string& tempdir);
+void testWriteFindChannel (const std::string& tempdir);
 void testWriteAttrs (const std::string& tempdir);
 
 void testStartWriteScan (const std::string& tempdir);
@@ -22,6 +23,8 @@ void testUpdateMeta (const std::string& tempdir);
 
 void testWriteScans (const std::string& tempdir);
 void testWriteTiles (const std::string& tempdir);
+void testWriteTileLevels (const std::string& tempdir);
+void testWriteToMemory (const std::string& tempdir);
 void testWriteMultiPart (const std::string& tempdir);
 
 #endif // OPENEXR_CORE_TEST_WRITE_H
@@ -15,6 +15,7 @@
 #include "testBadTypeAttributes.h"
 #include "testChannels.h"
 #include "testCompositeDeepScanLine.h"
+#include "testCompositeDeepTiled.h"
 #include "testCompression.h"
 #include "testCompressionApi.h"
 #include "testConversion.h"
@@ -24,6 +25,7 @@
 #include "testCopyPixels.h"
 #include "testCpuId.h"
 #include "testCustomAttributes.h"
+#include "testDeepSampleOffsets.h"
 #include "testDeepScanLineBasic.h"
 #include "testDeepScanLineHuge.h"
 #include "testDeepScanLineMultipleRead.h"
@@ -33,6 +35,7 @@
 #include "testHeader.h"
 #include "testHuf.h"
 #include "testIDManifest.h"
+#include "testInPlaceHeaderUpdate.h"
 #include "testInputPart.h"
 #include "testIsComplete.h"
 #include "testLargeDataWindowOffsets.h"
@@ -50,12 +53,15 @@
 #include "testOptimizedInterleavePatterns.h"
 #include "testPartHelper.h"
 #include "testPreviewImage.h"
+#include "testReadRegion.h"
+#include "testReducedResolution.h"
 #include "testRgba.h"
 #include "testCRgba.h"
 #include "testRgbaThreading.h"
 #include "testRle.h"
 #include "testSampleImages.h"
 #include "testScanLineApi.h"
+#include "testScanLineBands.h"
 #include "testSharedFrameBuffer.h"
 #include "testStandardAttributes.h"
 #include "testTiledCompression.h"
@@ -201,6 +207,7 @@ main (int argc, char* argv[])
     TEST (testTiledCompression, "basic");
     TEST (testTiledLineOrder, "basic");
     TEST (testScanLineApi, "basic");
+    TEST (testScanLineBands, "basic");
     TEST (testExistingStreams, "core");
     TEST (testExistingStreamsUTF8, "core");
     TEST (testStandardAttributes, "core");
@@ -210,12 +217,16 @@ main (int argc, char* argv[])
     TEST (testNativeFormat, "basic");
     TEST (testMultiView, "basic");
     TEST (testIsComplete, "basic");
+    TEST (testReducedResolution, "basic");
+    TEST (testReadRegion, "basic");
     TEST (testDeepScanLineBasic, "deep");
     TEST (testCopyDeepScanLine, "deep");
     TEST (testDeepScanLineMultipleRead, "deep");
     TEST (testDeepTiledBasic, "deep");
     TEST (testCopyDeepTiled, "deep");
+    TEST (testDeepSampleOffsets, "deep");
     TEST (testCompositeDeepScanLine, "deep");
+    TEST (testCompositeDeepTiled, "deep");
     TEST (testMultiPartFileMixingBasic, "multi");
     TEST (testInputPart, "multi");
     TEST (testPartHelper, "multi");
@@ -226,6 +237,7 @@ main (int argc, char* argv[])
     TEST (testMultiPartApi, "multi");
     TEST (testMultiPartSharedAttributes, "multi");
     TEST (testCopyMultiPartFile, "multi");
+    TEST (testInPlaceHeaderUpdate, "multi");
     TEST (testBackwardCompatibility, "core");
     TEST (testFutureProofing, "core");
     TEST (testRle, "core");
@@ -11,8 +11,11 @@
 #include "random.h"
 
 #include "Iex.h"
+#include <algorithm>
 #include <assert.h>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <ostream>
 #include <sstream>
 #include <stdlib.h>
@@ -24,6 +27,7 @@
 #include "ImfChannelList.h"
 #include "ImfCompositeDeepScanLine.h"
 #include "ImfCompression.h"
+#include "ImfDeepCompositing.h"
 #include "ImfDeepFrameBuffer.h"
 #include "ImfDeepScanLineInputPart.h"
 #include "ImfDeepScanLineOutputPart.h"
@@ -53,6 +57,7 @@ using OPENEXR_IMF_NAMESPACE::MultiPartInputFile;
 
 using IMATH_NAMESPACE::Box2i;
 using OPENEXR_IMF_NAMESPACE::CompositeDeepScanLine;
+using OPENEXR_IMF_NAMESPACE::DeepCompositing;
 using OPENEXR_IMF_NAMESPACE::DeepFrameBuffer;
 using OPENEXR_IMF_NAMESPACE::DEEPSCANLINE;
 using OPENEXR_IMF_NAMESPACE::DeepSlice;
@@ -638,11 +643,134 @@ test_parts (
     remove (fn.c_str ());
 }
 
+//
+// a scanline with more samples than the limit cannot be composited
+//
+void
+test_sample_limit (const std::string& tempDir)
+{
+    std::string fn = tempDir + "imf_test_composite_deep_scanline_source.exr";
+
+    data<float> main;
+    make_pattern (main, 1);
+    write_file (fn.c_str (), main, 1);
+
+    {
+        vector<float>         data;
+        CompositeDeepScanLine comp;
+        FrameBuffer           testbuf;
+        MultiPartInputFile    input (fn.c_str ());
+        DeepScanLineInputPart part (input, 0);
+
+        comp.addSource (&part);
+        main.setUpFrameBuffer (data, testbuf, comp.dataWindow (), false);
+        comp.setFrameBuffer (testbuf);
+
+        CompositeDeepScanLine::setMaximumSampleCount (1);
+
+        try
+        {
+            comp.readPixels (
+                comp.dataWindow ().min.y, comp.dataWindow ().max.y);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+    }
+
+    remove (fn.c_str ());
+}
+
+//
+// the default sort must give the same order as a plain std::sort on
+// (Z, ZBack, sample index), with NaN depths last, whichever method it
+// picks for a given number of samples, and whichever permutation of
+// the samples it starts from
+//
+void
+test_sort ()
+{
+    cout << "Testing deep sample sorting" << endl;
+
+    DeepCompositing comp;
+    const int       sizes[] = {0, 1, 2, 5, 16, 17, 100, 2047, 2048, 5000};
+    const float     nan     = std::numeric_limits<float>::quiet_NaN ();
+
+    auto depthLess = [] (float a, float b) {
+        if (std::isnan (a) || std::isnan (b))
+            return !std::isnan (a) && std::isnan (b);
+        return a < b;
+    };
+
+    for (int n: sizes)
+    {
+        for (int pattern = 0; pattern < 5; pattern++)
+        {
+            vector<float> z (n), zback (n);
+            for (int i = 0; i < n; i++)
+            {
+                switch (pattern)
+                {
+                    case 0: // random, with ties and both zeros
+                        z[i] = float (random_int (n / 4 + 2) - 1);
+                        if (z[i] == 0.0f && random_int (2)) z[i] = -0.0f;
+                        break;
+                    case 1: // already in order
+                        z[i] = float (i / 3);
+                        break;
+                    case 2: // reversed
+                        z[i] = float (n - i);
+                        break;
+                    case 3: // some depths are NaN, of either sign
+                        z[i] = random_int (4) ? float (random_int (8)) : nan;
+                        if (std::isnan (z[i]) && random_int (2)) z[i] = -nan;
+                        break;
+                    default: z[i] = random_float (1000.0f) - 500.0f;
+                }
+                zback[i] = z[i] + float (random_int (3));
+                if (pattern == 3 && random_int (8) == 0) zback[i] = nan;
+            }
+
+            const float* inputs[3] = {z.data (), zback.data (), z.data ()};
+            const char*  names[3]  = {"Z", "ZBack", "A"};
+
+            vector<int> expected (n);
+            for (int i = 0; i < n; i++)
+                expected[i] = i;
+            std::sort (expected.begin (), expected.end (), [&] (int a, int b) {
+                if (depthLess (z[a], z[b])) return true;
+                if (depthLess (z[b], z[a])) return false;
+                if (depthLess (zback[a], zback[b])) return true;
+                if (depthLess (zback[b], zback[a])) return false;
+                return a < b;
+            });
+
+            vector<int> order (n);
+            for (int i = 0; i < n; i++)
+                order[i] = i;
+            comp.sort (order.data (), inputs, names, 3, n, 2);
+            assert (order == expected);
+
+            for (int i = n - 1; i > 0; i--)
+                std::swap (order[i], order[random_int (i + 1)]);
+            comp.sort (order.data (), inputs, names, 3, n, 2);
+            assert (order == expected);
+
+            // the order is kept when it is right already
+            comp.sort (order.data (), inputs, names, 3, n, 2);
+            assert (order == expected);
+        }
+    }
+}
+
 } // namespace
 
 void
 testCompositeDeepScanLine (const std::string& tempDir)
 {
+    random_reseed (1);
+    test_sort ();
+
 
     cout << "\n\nTesting deep compositing interface basic functionality:\n"
          << endl;
@@ -692,5 +820,23 @@ testCompositeDeepScanLine (const std::string& tempDir)
             setGlobalThreadCount (64);
         }
     }
+
+    //
+    // no scanline of the patterns has more than 4000 samples, so
+    // whole images are composited in bands of a few scanlines
+    //
+    cout << "Testing deep compositing in bands of scanlines:\n" << endl;
+
+    CompositeDeepScanLine::setMaximumSampleCount (4000);
+
+    test_parts<float> (0, 1, true, true, tempDir);
+    test_parts<half> (1, 1, false, true, tempDir);
+    test_parts<float> (1, 3, false, true, tempDir);
+    test_parts<half> (0, 5, true, false, tempDir);
+
+    test_sample_limit (tempDir);
+
+    CompositeDeepScanLine::setMaximumSampleCount (0);
+
     cout << " ok\n" << endl;
 }
@@ -0,0 +1,520 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "testCompositeDeepTiled.h"
+#include "random.h"
+
+#include "Iex.h"
+#include <assert.h>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IlmThread.h"
+#include "ImfChannelList.h"
+#include "ImfCompositeDeepScanLine.h"
+#include "ImfCompositeDeepTiled.h"
+#include "ImfDeepCompositing.h"
+#include "ImfDeepFrameBuffer.h"
+#include "ImfDeepTiledInputPart.h"
+#include "ImfDeepTiledOutputPart.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfMultiPartInputFile.h"
+#include "ImfMultiPartOutputFile.h"
+#include "ImfPartType.h"
+#include "ImfThreading.h"
+#include "ImfTiledInputFile.h"
+#include "ImfTiledOutputFile.h"
+
+namespace
+{
+
+using std::cout;
+using std::endl;
+using std::map;
+using std::ostringstream;
+using std::pair;
+using std::string;
+using std::vector;
+
+using IMATH_NAMESPACE::Box2i;
+using IMATH_NAMESPACE::V2i;
+using namespace OPENEXR_IMF_NAMESPACE;
+
+//
+// the samples of one level of one source part, and the expected
+// composited R and A values of each level
+//
+
+struct Samples
+{
+    Box2i                 dw;
+    vector<unsigned int>  counts;
+    vector<vector<float>> values; // per channel, per sample
+    vector<size_t>        offsets;
+};
+
+typedef pair<int, int>                  Level;
+typedef map<Level, vector<Samples>>     Source; // per level, per part
+typedef map<Level, vector<vector<float>>> Result; // per level, R and A
+
+const int numChannels = 4; // Z, ZBack, A, R
+
+const char* const channelNames[numChannels] = {"Z", "ZBack", "A", "R"};
+
+Box2i
+dataWindow ()
+{
+    return Box2i (V2i (-7, 3), V2i (60, 44));
+}
+
+void
+write_file (
+    const string&          fn,
+    int                    parts,
+    const TileDescription& tiles,
+    bool                   zback,
+    Source&                source)
+{
+    vector<Header> headers (parts);
+
+    for (int p = 0; p < parts; p++)
+    {
+        Header& h       = headers[p];
+        h.dataWindow () = dataWindow ();
+        h.displayWindow () =
+            Box2i (V2i (0, 0), V2i (dataWindow ().max.x, dataWindow ().max.y));
+        h.setType (DEEPTILE);
+        h.setTileDescription (tiles);
+        h.compression () = ZIPS_COMPRESSION;
+
+        ostringstream s;
+        s << "Part" << p;
+        h.setName (s.str ());
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            if (c == 1 && !zback) continue;
+            h.channels ().insert (channelNames[c], Channel (FLOAT));
+        }
+    }
+
+    MultiPartOutputFile file (fn.c_str (), headers.data (), parts);
+
+    for (int p = 0; p < parts; p++)
+    {
+        DeepTiledOutputPart out (file, p);
+
+        for (int ly = 0; ly < out.numYLevels (); ly++)
+        {
+            for (int lx = 0; lx < out.numXLevels (); lx++)
+            {
+                if (!out.isValidLevel (lx, ly)) continue;
+
+                vector<Samples>& level = source[Level (lx, ly)];
+                level.resize (parts);
+
+                Samples& s    = level[p];
+                s.dw          = out.dataWindowForLevel (lx, ly);
+                size_t width  = s.dw.size ().x + 1;
+                size_t pixels = width * (s.dw.size ().y + 1);
+
+                s.counts.resize (pixels);
+                s.offsets.resize (pixels);
+                s.values.assign (numChannels, vector<float> ());
+
+                size_t total = 0;
+                for (size_t i = 0; i < pixels; i++)
+                {
+                    s.offsets[i] = total;
+                    s.counts[i]  = random_int (4);
+                    total += s.counts[i];
+                }
+
+                for (size_t i = 0; i < total; i++)
+                {
+                    float z = random_float (10.0f);
+                    s.values[0].push_back (z);
+                    s.values[1].push_back (
+                        zback ? z + random_float (1.0f) : z);
+                    s.values[2].push_back (random_float (1.0f));
+                    s.values[3].push_back (random_float (1.0f));
+                }
+
+                vector<vector<float*>> pointers (numChannels);
+                DeepFrameBuffer        fb;
+
+                fb.insertSampleCountSlice (Slice (
+                    UINT,
+                    (char*) (&s.counts[0] - s.dw.min.x - s.dw.min.y * width),
+                    sizeof (unsigned int),
+                    sizeof (unsigned int) * width));
+
+                for (int c = 0; c < numChannels; c++)
+                {
+                    pointers[c].resize (pixels);
+                    for (size_t i = 0; i < pixels; i++)
+                        pointers[c][i] = s.values[c].data () + s.offsets[i];
+
+                    if (c == 1 && !zback) continue;
+
+                    fb.insert (
+                        channelNames[c],
+                        DeepSlice (
+                            FLOAT,
+                            (char*) (&pointers[c][0] - s.dw.min.x -
+                                     s.dw.min.y * width),
+                            sizeof (float*),
+                            sizeof (float*) * width,
+                            sizeof (float)));
+                }
+
+                out.setFrameBuffer (fb);
+                out.writeTiles (
+                    0,
+                    out.numXTiles (lx) - 1,
+                    0,
+                    out.numYTiles (ly) - 1,
+                    lx,
+                    ly);
+            }
+        }
+    }
+}
+
+//
+// composite each pixel directly, with the samples of all parts
+// in the order the parts are added as sources
+//
+
+void
+composite (const Source& source, bool zback, Result& result)
+{
+    DeepCompositing comp;
+    const char*     names[numChannels] = {
+        "Z", zback ? "ZBack" : "Z", "A", "R"};
+
+    for (Source::const_iterator i = source.begin (); i != source.end (); ++i)
+    {
+        const vector<Samples>& parts  = i->second;
+        size_t                 pixels = parts[0].counts.size ();
+
+        vector<vector<float>>& out = result[i->first];
+        out.assign (2, vector<float> (pixels));
+
+        for (size_t p = 0; p < pixels; p++)
+        {
+            vector<vector<float>> samples (numChannels);
+            int                   sources = 0;
+
+            for (size_t part = 0; part < parts.size (); part++)
+            {
+                const Samples& s = parts[part];
+                if (s.counts[p] > 0) sources++;
+
+                for (int c = 0; c < numChannels; c++)
+                {
+                    samples[c].insert (
+                        samples[c].end (),
+                        s.values[c].begin () + s.offsets[p],
+                        s.values[c].begin () + s.offsets[p] + s.counts[p]);
+                }
+            }
+
+            const float* inputs[numChannels];
+            for (int c = 0; c < numChannels; c++)
+                inputs[c] = samples[c].data ();
+            if (!zback) inputs[1] = inputs[0];
+
+            float pixel[numChannels];
+            comp.composite_pixel (
+                pixel,
+                inputs,
+                names,
+                numChannels,
+                int (samples[0].size ()),
+                sources);
+
+            out[0][p] = pixel[3];
+            out[1][p] = pixel[2];
+        }
+    }
+}
+
+void
+check_tiles (
+    CompositeDeepTiled& comp, const Result& result, const Box2i& dw, int l)
+{
+    const vector<vector<float>>& expected = result.at (Level (l, l));
+
+    //
+    // whole level at once, then tile by tile into a tile-sized
+    // buffer using tile coordinates
+    //
+
+    size_t        width = dw.size ().x + 1;
+    vector<float> r (width * (dw.size ().y + 1), -1.0f);
+    vector<float> a (r.size (), -1.0f);
+
+    FrameBuffer fb;
+    fb.insert ("R", Slice::Make (FLOAT, r.data (), dw));
+    fb.insert ("A", Slice::Make (FLOAT, a.data (), dw));
+    comp.setFrameBuffer (fb);
+
+    const TileDescription& td = comp.tileDescription ();
+    int numXTiles = (dw.size ().x + td.xSize) / td.xSize;
+    int numYTiles = (dw.size ().y + td.ySize) / td.ySize;
+
+    comp.readTiles (0, numXTiles - 1, 0, numYTiles - 1, l);
+
+    assert (r == expected[0]);
+    assert (a == expected[1]);
+
+    vector<float> tile (td.xSize * td.ySize);
+    FrameBuffer   tb;
+    tb.insert (
+        "R",
+        Slice (
+            FLOAT,
+            (char*) tile.data (),
+            sizeof (float),
+            sizeof (float) * td.xSize,
+            1,
+            1,
+            0.0,
+            true,
+            true));
+    comp.setFrameBuffer (tb);
+
+    for (int dy = 0; dy < numYTiles; dy++)
+    {
+        for (int dx = 0; dx < numXTiles; dx++)
+        {
+            comp.readTile (dx, dy, l);
+
+            for (int y = 0; y < int (td.ySize); y++)
+            {
+                for (int x = 0; x < int (td.xSize); x++)
+                {
+                    int ix = dx * td.xSize + x;
+                    int iy = dy * td.ySize + y;
+                    if (ix > dw.size ().x || iy > dw.size ().y) continue;
+
+                    assert (tile[y * td.xSize + x] == expected[0][iy * width + ix]);
+                }
+            }
+        }
+    }
+}
+
+void
+test_composite (
+    int                    parts,
+    const TileDescription& tiles,
+    bool                   zback,
+    const string&          tempDir)
+{
+    cout << "compositing " << parts << " part(s), " << tiles.xSize << 'x'
+         << tiles.ySize << " tiles, "
+         << (tiles.mode == ONE_LEVEL ? "one level" : "mipmap")
+         << (zback ? ", with ZBack" : "") << endl;
+
+    string fn  = tempDir + "imf_test_composite_deep_tiled_source.exr";
+    string out = tempDir + "imf_test_composite_deep_tiled_flat.exr";
+
+    Source source;
+    Result result;
+    write_file (fn, parts, tiles, zback, source);
+    composite (source, zback, result);
+
+    {
+        MultiPartInputFile          input (fn.c_str ());
+        vector<DeepTiledInputPart*> sources;
+        CompositeDeepTiled          comp;
+
+        for (int p = 0; p < parts; p++)
+        {
+            sources.push_back (new DeepTiledInputPart (input, p));
+            comp.addSource (sources.back ());
+        }
+
+        assert (comp.sources () == parts);
+        assert (comp.dataWindow () == dataWindow ());
+
+        const vector<Samples>& level0 = source.at (Level (0, 0));
+        check_tiles (comp, result, level0[0].dw, 0);
+
+        if (tiles.mode == MIPMAP_LEVELS)
+        {
+            const vector<Samples>& level1 = source.at (Level (1, 1));
+            check_tiles (comp, result, level1[0].dw, 1);
+        }
+
+        //
+        // composite in bands of a few tiles; no pixel of these files
+        // has more than 3 samples in each part
+        //
+
+        CompositeDeepTiled::setMaximumSampleCount (
+            4 * tiles.xSize * tiles.ySize * parts);
+        assert (
+            CompositeDeepTiled::getMaximumSampleCount () ==
+            4 * tiles.xSize * tiles.ySize * parts);
+        check_tiles (comp, result, level0[0].dw, 0);
+
+        CompositeDeepTiled::setMaximumSampleCount (1);
+        try
+        {
+            check_tiles (comp, result, level0[0].dw, 0);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+        CompositeDeepTiled::setMaximumSampleCount (0);
+
+        //
+        // the limit of CompositeDeepScanLine does not apply to tiles
+        //
+
+        CompositeDeepScanLine::setMaximumSampleCount (1);
+        check_tiles (comp, result, level0[0].dw, 0);
+        CompositeDeepScanLine::setMaximumSampleCount (0);
+
+        //
+        // write all levels into a flat file, with half R
+        //
+
+        {
+            Header h (dataWindow ().max.x + 1, dataWindow ().max.y + 1);
+            h.dataWindow () = dataWindow ();
+            h.setTileDescription (tiles);
+            h.channels ().insert ("R", Channel (HALF));
+            h.channels ().insert ("A", Channel (FLOAT));
+
+            TiledOutputFile file (out.c_str (), h);
+            comp.writeTiles (file);
+        }
+
+        TiledInputFile file (out.c_str ());
+
+        for (Result::const_iterator i = result.begin (); i != result.end ();
+             ++i)
+        {
+            int   lx = i->first.first;
+            int   ly = i->first.second;
+            Box2i dw = file.dataWindowForLevel (lx, ly);
+
+            vector<half>  r ((dw.size ().x + 1) * (dw.size ().y + 1));
+            vector<float> a (r.size ());
+
+            FrameBuffer fb;
+            fb.insert ("R", Slice::Make (HALF, r.data (), dw));
+            fb.insert ("A", Slice::Make (FLOAT, a.data (), dw));
+            file.setFrameBuffer (fb);
+            file.readTiles (
+                0, file.numXTiles (lx) - 1, 0, file.numYTiles (ly) - 1, lx, ly);
+
+            for (size_t p = 0; p < r.size (); p++)
+            {
+                assert (r[p] == half (i->second[0][p]));
+                assert (a[p] == i->second[1][p]);
+            }
+        }
+
+        for (size_t p = 0; p < sources.size (); p++)
+            delete sources[p];
+    }
+
+    remove (fn.c_str ());
+    remove (out.c_str ());
+}
+
+void
+test_mismatch (const string& tempDir)
+{
+    cout << "rejecting parts with different tiles" << endl;
+
+    string fn = tempDir + "imf_test_composite_deep_tiled_source.exr";
+
+    Source source;
+    write_file (fn, 1, TileDescription (16, 16, ONE_LEVEL), false, source);
+
+    string fn2 = tempDir + "imf_test_composite_deep_tiled_source2.exr";
+    write_file (fn2, 1, TileDescription (8, 16, ONE_LEVEL), false, source);
+
+    {
+        MultiPartInputFile input (fn.c_str ());
+        MultiPartInputFile input2 (fn2.c_str ());
+        DeepTiledInputPart part (input, 0);
+        DeepTiledInputPart part2 (input2, 0);
+
+        CompositeDeepTiled comp;
+        comp.addSource (&part);
+
+        try
+        {
+            comp.addSource (&part2);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+
+        assert (comp.sources () == 1);
+    }
+
+    remove (fn.c_str ());
+    remove (fn2.c_str ());
+}
+
+} // namespace
+
+void
+testCompositeDeepTiled (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing deep tiled compositing" << endl;
+
+        random_reseed (1);
+
+        int passes = ILMTHREAD_NAMESPACE::supportsThreads () ? 2 : 1;
+
+        for (int pass = 0; pass < passes; pass++)
+        {
+            test_composite (
+                1, TileDescription (16, 16, ONE_LEVEL), false, tempDir);
+            test_composite (
+                3, TileDescription (16, 11, ONE_LEVEL), true, tempDir);
+            test_composite (
+                2,
+                TileDescription (8, 8, MIPMAP_LEVELS, ROUND_UP),
+                false,
+                tempDir);
+
+            if (passes == 2 && pass == 0)
+            {
+                cout << " testing with multithreading..." << endl;
+                setGlobalThreadCount (8);
+            }
+        }
+
+        test_mismatch (tempDir);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cout << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,13 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTCOMPOSITEDEEPTILED_H_
+#define TESTCOMPOSITEDEEPTILED_H_
+
+#include <string>
+
+void testCompositeDeepTiled (const std::string& tempDir);
+
+#endif /* TESTCOMPOSITEDEEPTILED_H_ */
@@ -8,14 +8,17 @@
 #    undef NDEBUG
 #endif
 
+#include "ImfChannelList.h"
 #include "ImfCompression.h"
 #include "ImfCompressor.h"
 #include "ImfHeader.h"
+#include "ImfPartType.h"
 #include "openexr_compression.h"
 
 #include <cassert>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 using namespace OPENEXR_IMF_NAMESPACE;
 using namespace std;
@@ -32,11 +35,11 @@ testCompressionApi (const string& tempDir)
         cout << "Testing compression API functions." << endl;
 
         // update this if you add a new compressor.
-        string codecList = "none/rle/zips/zip/piz/pxr24/b44/b44a/dwaa/dwab/htj2k256/htj2k32";
+        string codecList = "none/rle/zips/zip/piz/pxr24/b44/b44a/dwaa/dwab/htj2k256/htj2k32/zipd";
 
         int numMethods = static_cast<int> (NUM_COMPRESSION_METHODS);
         // update this if you add a new compressor.
-        assert (numMethods == 12);
+        assert (numMethods == 13);
 
         for (int i = 0; i < numMethods; i++)
         {
@@ -70,6 +73,7 @@ testCompressionApi (const string& tempDir)
                 case PIZ_COMPRESSION:
                 case HTJ2K256_COMPRESSION:
                 case HTJ2K32_COMPRESSION:
+                case ZIPD_COMPRESSION:
                     assert (isLossyCompression (c) == false);
                     break;
 
@@ -82,6 +86,7 @@ testCompressionApi (const string& tempDir)
                 case NO_COMPRESSION:
                 case RLE_COMPRESSION:
                 case ZIPS_COMPRESSION:
+                case ZIPD_COMPRESSION:
                     assert (isValidDeepCompression (c) == true);
                     break;
 
@@ -116,6 +121,7 @@ testCompressionApi (const string& tempDir)
             {DWAB_COMPRESSION,   EXR_COMPRESSION_LAST_TYPE,   256, true},
             {HTJ2K256_COMPRESSION, EXR_COMPRESSION_LAST_TYPE, 256, true},
             {HTJ2K32_COMPRESSION,  EXR_COMPRESSION_LAST_TYPE,  32,  true},
+            {ZIPD_COMPRESSION,   EXR_COMPRESSION_ZIPD,    1,   true},
         };
 
         const size_t maxScanLineSize = 1024;
@@ -142,6 +148,70 @@ testCompressionApi (const string& tempDir)
             }
         }
 
+        cout << "Testing Compressor sample count tables" << endl;
+
+        Compression deepCodecs[] = {RLE_COMPRESSION, ZIPS_COMPRESSION};
+
+        for (Compression c: deepCodecs)
+        {
+            const int width = 64;
+
+            Header hdr (width, 1);
+            hdr.compression () = c;
+            hdr.setType (DEEPSCANLINE);
+            hdr.channels ().insert ("Z", Channel (FLOAT));
+
+            std::unique_ptr<Compressor> comp (
+                newCompressor (c, maxScanLineSize, hdr));
+            assert (comp != nullptr);
+
+            //
+            // one sample per pixel, so the cumulative counts of the
+            // table compress well; stored little-endian, as in the file
+            //
+
+            vector<char>  table (width * 4);
+            vector<float> data (width);
+            for (int x = 0; x < width; x++)
+            {
+                int count        = x + 1;
+                table[x * 4]     = static_cast<char> (count);
+                table[x * 4 + 1] = 0;
+                table[x * 4 + 2] = 0;
+                table[x * 4 + 3] = 0;
+                data[x]          = 1.0f;
+            }
+
+            const char* outPtr;
+            const char* tablePtr;
+
+            comp->setSampleCountTable (
+                table.data (), static_cast<int> (table.size ()));
+            comp->compress (
+                reinterpret_cast<const char*> (data.data ()),
+                static_cast<int> (data.size () * sizeof (float)),
+                0,
+                outPtr);
+
+            int tableSize = comp->sampleCountTable (tablePtr);
+            assert (tablePtr != nullptr);
+            assert (tableSize > 0);
+            assert (tableSize < static_cast<int> (table.size ()));
+
+            //
+            // the table only applies to the next chunk
+            //
+
+            comp->compress (
+                reinterpret_cast<const char*> (data.data ()),
+                static_cast<int> (data.size () * sizeof (float)),
+                0,
+                outPtr);
+
+            assert (comp->sampleCountTable (tablePtr) == 0);
+            assert (tablePtr == nullptr);
+        }
+
         cout << "ok" << endl;
     }
     catch (const exception& e)
@@ -13,6 +13,7 @@
 #include "ImfHeader.h"
 #include "ImfInputFile.h"
 #include "ImfOutputFile.h"
+#include "ImfThreading.h"
 #include <Imath/half.h>
 
 #include <assert.h>
@@ -206,10 +207,25 @@ testCopyPixels (const std::string& tempDir)
         Array2D<half> ph (H, W);
 
         fillPixels (ph, W, H);
-        writeCopyRead (tempDir, ph, W, H, 0, 0);
-        writeCopyRead (tempDir, ph, W, H, 0, DY);
-        writeCopyRead (tempDir, ph, W, H, DX, 0);
-        writeCopyRead (tempDir, ph, W, H, DX, DY);
+
+        //
+        // With threads, copyPixels() reads the chunks in parallel.
+        //
+
+        int numThreads = globalThreadCount ();
+
+        for (int n: {0, 4})
+        {
+            cout << "threads " << n << endl;
+            setGlobalThreadCount (n);
+
+            writeCopyRead (tempDir, ph, W, H, 0, 0);
+            writeCopyRead (tempDir, ph, W, H, 0, DY);
+            writeCopyRead (tempDir, ph, W, H, DX, 0);
+            writeCopyRead (tempDir, ph, W, H, DX, DY);
+        }
+
+        setGlobalThreadCount (numThreads);
 
         cout << "ok\n" << endl;
     }
@@ -0,0 +1,512 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "testDeepSampleOffsets.h"
+#include "random.h"
+
+#include "Iex.h"
+#include "ImfChannelList.h"
+#include "ImfDeepFrameBuffer.h"
+#include "ImfDeepScanLineInputFile.h"
+#include "ImfDeepScanLineOutputFile.h"
+#include "ImfDeepTiledInputFile.h"
+#include "ImfDeepTiledOutputFile.h"
+#include "ImfHeader.h"
+#include "ImfPartType.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+using IMATH_NAMESPACE::Box2i;
+using IMATH_NAMESPACE::V2i;
+using namespace OPENEXR_IMF_NAMESPACE;
+
+const Box2i dataWindow (V2i (-3, 5), V2i (33, 27));
+const int   width     = 37;
+const int   height    = 23;
+const int   tileSize  = 8;
+const int   maxCount  = 5;
+const float fillValue = 0.5f;
+
+//
+// the order in which the samples of the pixels are laid out
+// in the contiguous buffers of the frame buffer
+//
+
+enum Layout
+{
+    ROWS,     // scan line by scan line, as in a deep scan line file
+    TILES,    // tile by tile, as in a deep tiled file
+    REVERSED, // last pixel first
+    SLOTS     // maxCount samples reserved for every pixel
+};
+
+float
+zValue (int x, int y, int s)
+{
+    return float (x) * 0.25f + float (y) * 8.f + float (s);
+}
+
+half
+aValue (int x, int y, int s)
+{
+    return half (float ((x + y + s) % 16) / 16.f);
+}
+
+unsigned int
+idValue (int x, int y, int s)
+{
+    return (unsigned int) ((y * 1000 + x) * 10 + s);
+}
+
+vector<unsigned int>
+randomCounts ()
+{
+    vector<unsigned int> counts (width * height);
+    for (auto& c: counts)
+        c = (unsigned int) random_int (maxCount);
+    return counts;
+}
+
+vector<int>
+pixelOrder (Layout layout)
+{
+    vector<int> order;
+
+    if (layout == TILES)
+    {
+        for (int ty = 0; ty < height; ty += tileSize)
+            for (int tx = 0; tx < width; tx += tileSize)
+                for (int y = ty; y < std::min (ty + tileSize, height); ++y)
+                    for (int x = tx; x < std::min (tx + tileSize, width); ++x)
+                        order.push_back (y * width + x);
+        return order;
+    }
+
+    for (int i = 0; i < width * height; ++i)
+        order.push_back (i);
+
+    if (layout == REVERSED) std::reverse (order.begin (), order.end ());
+
+    return order;
+}
+
+//
+// contiguous per-channel sample buffers and the sample counts and
+// offsets describing them
+//
+
+struct Buffers
+{
+    vector<unsigned int> counts;
+    vector<unsigned int> offsets;
+    vector<float>        z;
+    vector<half>         a;
+    vector<unsigned int> id;
+    vector<float>        fill;
+
+    size_t total = 0;
+
+    void layOut (Layout layout)
+    {
+        offsets.assign (width * height, 0);
+
+        total = 0;
+        for (int p: pixelOrder (layout))
+        {
+            offsets[p] = (unsigned int) total;
+            total += layout == SLOTS ? maxCount : counts[p];
+        }
+
+        z.assign (total, 0.f);
+        a.assign (total, half (0.f));
+        id.assign (total, 0);
+        fill.assign (total, 0.f);
+    }
+
+    void setValues ()
+    {
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+            {
+                int    p = y * width + x;
+                size_t o = offsets[p];
+                int    dx = x + dataWindow.min.x;
+                int    dy = y + dataWindow.min.y;
+
+                for (unsigned int s = 0; s < counts[p]; ++s)
+                {
+                    z[o + s]  = zValue (dx, dy, s);
+                    a[o + s]  = aValue (dx, dy, s);
+                    id[o + s] = idValue (dx, dy, s);
+                }
+            }
+    }
+
+    void checkValues (const vector<unsigned int>& expectedCounts, bool filled)
+        const
+    {
+        assert (counts == expectedCounts);
+
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+            {
+                int    p = y * width + x;
+                size_t o = offsets[p];
+                int    dx = x + dataWindow.min.x;
+                int    dy = y + dataWindow.min.y;
+
+                for (unsigned int s = 0; s < counts[p]; ++s)
+                {
+                    assert (z[o + s] == zValue (dx, dy, s));
+                    assert (a[o + s] == aValue (dx, dy, s));
+                    assert (id[o + s] == idValue (dx, dy, s));
+                    assert (!filled || fill[o + s] == fillValue);
+                }
+            }
+    }
+
+    template <class T>
+    static char* origin (vector<T>& v, size_t xStride)
+    {
+        return (char*) v.data () - dataWindow.min.x * xStride -
+               dataWindow.min.y * xStride * width;
+    }
+
+    DeepFrameBuffer frameBuffer (bool withFill)
+    {
+        DeepFrameBuffer fb;
+
+        fb.insertSampleCountSlice (Slice (
+            UINT,
+            origin (counts, sizeof (unsigned int)),
+            sizeof (unsigned int),
+            sizeof (unsigned int) * width));
+        fb.insertSampleOffsetSlice (Slice (
+            UINT,
+            origin (offsets, sizeof (unsigned int)),
+            sizeof (unsigned int),
+            sizeof (unsigned int) * width));
+
+        fb.insert (
+            "Z",
+            DeepSlice (FLOAT, (char*) z.data (), 0, 0, sizeof (float)));
+        fb.insert (
+            "A", DeepSlice (HALF, (char*) a.data (), 0, 0, sizeof (half)));
+        fb.insert (
+            "id",
+            DeepSlice (
+                UINT, (char*) id.data (), 0, 0, sizeof (unsigned int)));
+
+        if (withFill)
+        {
+            fb.insert (
+                "F",
+                DeepSlice (
+                    FLOAT,
+                    (char*) fill.data (),
+                    0,
+                    0,
+                    sizeof (float),
+                    1,
+                    1,
+                    fillValue));
+        }
+
+        return fb;
+    }
+
+    //
+    // the equivalent frame buffer with tables of per-pixel pointers
+    //
+
+    vector<vector<char*>> pointers;
+
+    DeepFrameBuffer pointerFrameBuffer ()
+    {
+        DeepFrameBuffer fb;
+
+        fb.insertSampleCountSlice (Slice (
+            UINT,
+            origin (counts, sizeof (unsigned int)),
+            sizeof (unsigned int),
+            sizeof (unsigned int) * width));
+
+        pointers.assign (3, vector<char*> (width * height));
+        for (int p = 0; p < width * height; ++p)
+        {
+            pointers[0][p] = (char*) (z.data () + offsets[p]);
+            pointers[1][p] = (char*) (a.data () + offsets[p]);
+            pointers[2][p] = (char*) (id.data () + offsets[p]);
+        }
+
+        const PixelType   types[3] = {FLOAT, HALF, UINT};
+        const char* const names[3] = {"Z", "A", "id"};
+        const size_t      sizes[3] = {
+            sizeof (float), sizeof (half), sizeof (unsigned int)};
+
+        for (int c = 0; c < 3; ++c)
+        {
+            fb.insert (
+                names[c],
+                DeepSlice (
+                    types[c],
+                    origin (pointers[c], sizeof (char*)),
+                    sizeof (char*),
+                    sizeof (char*) * width,
+                    sizes[c]));
+        }
+
+        return fb;
+    }
+};
+
+Header
+makeHeader (bool tiled)
+{
+    Header header (
+        dataWindow, dataWindow, 1, V2i (0, 0), 1, INCREASING_Y,
+        RLE_COMPRESSION);
+
+    header.channels ().insert ("Z", Channel (FLOAT));
+    header.channels ().insert ("A", Channel (HALF));
+    header.channels ().insert ("id", Channel (UINT));
+
+    if (tiled)
+    {
+        header.setType (DEEPTILE);
+        header.setTileDescription (TileDescription (tileSize, tileSize));
+    }
+    else
+        header.setType (DEEPSCANLINE);
+
+    return header;
+}
+
+void
+writeScanLines (const string& fileName, Buffers& in)
+{
+    DeepScanLineOutputFile file (fileName.c_str (), makeHeader (false));
+    file.setFrameBuffer (in.frameBuffer (false));
+    file.writePixels (height);
+}
+
+void
+writeTiles (const string& fileName, Buffers& in)
+{
+    DeepTiledOutputFile file (fileName.c_str (), makeHeader (true));
+    file.setFrameBuffer (in.frameBuffer (false));
+    file.writeTiles (0, file.numXTiles () - 1, 0, file.numYTiles () - 1);
+}
+
+void
+readScanLines (
+    const string&               fileName,
+    const vector<unsigned int>& counts,
+    Layout                      layout,
+    int                         numThreads)
+{
+    DeepScanLineInputFile file (fileName.c_str (), numThreads);
+    Buffers               out;
+
+    out.counts.assign (width * height, 0);
+    file.setFrameBuffer (out.frameBuffer (true));
+    file.readPixelSampleCounts (dataWindow.min.y, dataWindow.max.y);
+
+    out.layOut (layout);
+    file.setFrameBuffer (out.frameBuffer (true));
+    file.readPixels (dataWindow.min.y, dataWindow.max.y);
+
+    out.checkValues (counts, true);
+
+    //
+    // one scan line at a time, into the pointer tables
+    //
+
+    Buffers ptrs;
+    ptrs.counts = counts;
+    ptrs.layOut (layout);
+    file.setFrameBuffer (ptrs.pointerFrameBuffer ());
+    for (int y = dataWindow.min.y; y <= dataWindow.max.y; ++y)
+        file.readPixels (y);
+
+    ptrs.checkValues (counts, false);
+}
+
+void
+readScanLinesSinglePass (
+    const string& fileName, const vector<unsigned int>& counts, int numThreads)
+{
+    DeepScanLineInputFile file (fileName.c_str (), numThreads);
+    Buffers               out;
+
+    //
+    // the whole image is reserved up front, and the offsets of
+    // the pixels of each chunk only set once its counts are known
+    //
+
+    out.counts.assign (width * height, 0);
+    out.layOut (SLOTS);
+    out.offsets.assign (width * height, ~0u);
+
+    file.setFrameBuffer (out.frameBuffer (false));
+    file.readSampleCountsAndPixels (
+        dataWindow.min.y, dataWindow.max.y, [&] (int y1, int y2) {
+            for (int y = y1; y <= y2; ++y)
+            {
+                int row = y - dataWindow.min.y;
+                for (int x = 0; x < width; ++x)
+                {
+                    assert (out.counts[row * width + x] <= maxCount);
+                    out.offsets[row * width + x] =
+                        (unsigned int) ((row * width + x) * maxCount);
+                }
+            }
+        });
+
+    out.checkValues (counts, false);
+}
+
+void
+readTiles (
+    const string&               fileName,
+    const vector<unsigned int>& counts,
+    Layout                      layout,
+    int                         numThreads)
+{
+    DeepTiledInputFile file (fileName.c_str (), numThreads);
+    Buffers            out;
+
+    int nx = file.numXTiles () - 1;
+    int ny = file.numYTiles () - 1;
+
+    out.counts.assign (width * height, 0);
+    file.setFrameBuffer (out.frameBuffer (true));
+    file.readPixelSampleCounts (0, nx, 0, ny);
+
+    out.layOut (layout);
+    file.setFrameBuffer (out.frameBuffer (true));
+    file.readTiles (0, nx, 0, ny);
+
+    out.checkValues (counts, true);
+
+    Buffers ptrs;
+    ptrs.counts = counts;
+    ptrs.layOut (layout);
+    file.setFrameBuffer (ptrs.pointerFrameBuffer ());
+    for (int ty = 0; ty <= ny; ++ty)
+        for (int tx = 0; tx <= nx; ++tx)
+            file.readTile (tx, ty);
+
+    ptrs.checkValues (counts, false);
+}
+
+void
+testScanLines (const string& fileName)
+{
+    vector<unsigned int> counts = randomCounts ();
+
+    for (Layout written: {ROWS, REVERSED})
+    {
+        cout << "scan lines written in " << (written == ROWS ? "row" : "reversed")
+             << " order" << endl;
+
+        Buffers in;
+        in.counts = counts;
+        in.layOut (written);
+        in.setValues ();
+        writeScanLines (fileName, in);
+
+        for (int numThreads: {0, 4})
+        {
+            for (Layout read: {ROWS, TILES, REVERSED})
+                readScanLines (fileName, counts, read, numThreads);
+
+            readScanLinesSinglePass (fileName, counts, numThreads);
+        }
+    }
+}
+
+void
+testTiles (const string& fileName)
+{
+    vector<unsigned int> counts = randomCounts ();
+
+    for (Layout written: {TILES, ROWS})
+    {
+        cout << "tiles written in " << (written == TILES ? "tile" : "row")
+             << " order" << endl;
+
+        Buffers in;
+        in.counts = counts;
+        in.layOut (written);
+        in.setValues ();
+        writeTiles (fileName, in);
+
+        for (int numThreads: {0, 4})
+            for (Layout read: {TILES, ROWS, REVERSED})
+                readTiles (fileName, counts, read, numThreads);
+    }
+}
+
+void
+testBadSlice ()
+{
+    DeepFrameBuffer fb;
+
+    try
+    {
+        fb.insertSampleOffsetSlice (Slice (FLOAT, (char*) &fb));
+        assert (false);
+    }
+    catch (const IEX_NAMESPACE::ArgExc&)
+    {}
+
+    fb.insertSampleOffsetSlice (Slice ());
+    assert (fb.getSampleOffsetSlice ().base == nullptr);
+}
+
+} // namespace
+
+void
+testDeepSampleOffsets (const string& tempDir)
+{
+    try
+    {
+        cout << "Testing deep frame buffers with sample offsets" << endl;
+
+        random_reseed (1);
+
+        string fileName = tempDir + "imf_test_deep_sample_offsets.exr";
+
+        testBadSlice ();
+        testScanLines (fileName);
+        testTiles (fileName);
+
+        remove (fileName.c_str ());
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,13 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifndef TESTDEEPSAMPLEOFFSETS_H_
+#define TESTDEEPSAMPLEOFFSETS_H_
+
+#include <string>
+
+void testDeepSampleOffsets (const std::string& tempDir);
+
+#endif /* TESTDEEPSAMPLEOFFSETS_H_ */
@@ -247,7 +247,8 @@ enum ReadType
 {
     eReadBulk = 1,
     eReadScanline,
-    eReadScanlinelFrameBuffer
+    eReadScanlinelFrameBuffer,
+    eReadSinglePass
 };
 
 void
@@ -404,6 +405,47 @@ readFile (
         file.readPixels (dataWindow.min.y, dataWindow.max.y);
     }
 
+    else if (readType == eReadSinglePass)
+    {
+        cout << "single pass " << flush;
+        file.readSampleCountsAndPixels (
+            dataWindow.min.y, dataWindow.max.y, [&] (int y1, int y2) {
+                for (int i = y1 - dataWindow.min.y;
+                     i <= y2 - dataWindow.min.y;
+                     i++)
+                {
+                    for (int j = 0; j < width; j++)
+                        assert (localSampleCount[i][j] == sampleCount[i][j]);
+
+                    for (int j = 0; j < width; j++)
+                    {
+                        int32_t lsc = localSampleCount[i][j];
+                        for (int k = 0; k < channelCount; k++)
+                        {
+                            if (lsc > 0 &&
+                                (!randomChannels || read_channel[k] == 1))
+                            {
+                                if (channelTypes[k] == 0)
+                                    data[k][i][j] = new unsigned int[lsc];
+                                if (channelTypes[k] == 1)
+                                    data[k][i][j] = new half[lsc];
+                                if (channelTypes[k] == 2)
+                                    data[k][i][j] = new float[lsc];
+                            }
+                            else { data[k][i][j] = nullptr; }
+                        }
+                        for (int f = 0; f < fillChannels; ++f)
+                        {
+                            if (lsc > 0)
+                                data[f + channelCount][i][j] = new float[lsc];
+                            else
+                                data[f + channelCount][i][j] = nullptr;
+                        }
+                    }
+                }
+            });
+    }
+
     else
     {
         cout << "per-line " << flush;
@@ -586,6 +628,8 @@ readWriteTest (
             displayWindow);
         readFile (filename, channelCount, eReadBulk, false);
         if (channelCount > 1) readFile (filename, channelCount, eReadBulk, true);
+        readFile (filename, channelCount, eReadSinglePass, false);
+        if (channelCount > 1) readFile (filename, channelCount, eReadSinglePass, true);
         remove (filename.c_str ());
         cout << endl << flush;
     }
@@ -433,9 +433,11 @@ readFile (
     bool               bulkRead,
     bool               relativeCoords,
     bool               randomChannels,
-    const std::string& filename)
+    const std::string& filename,
+    bool               singlePass = false)
 {
     if (relativeCoords) assert (bulkRead == false);
+    if (singlePass) assert (bulkRead == true);
 
     cout << "reading " << flush;
 
@@ -551,7 +553,9 @@ readFile (
 
     file.setFrameBuffer (frameBuffer);
 
-    if (bulkRead)
+    if (singlePass)
+        cout << "single pass " << flush;
+    else if (bulkRead)
         cout << "bulk " << flush;
     else
     {
@@ -566,7 +570,63 @@ readFile (
         {
             Box2i dataWindowL = file.dataWindowForLevel (lx, ly);
 
-            if (bulkRead)
+            //
+            // Allocates the samples of tile (j, i), once its sample
+            // counts have been read.
+            //
+
+            auto allocateTile = [&] (int j, int i) {
+                Box2i box = file.dataWindowForTile (j, i, lx, ly);
+                for (int y = box.min.y; y <= box.max.y; y++)
+                    for (int x = box.min.x; x <= box.max.x; x++)
+                    {
+                        int dwy = y - dataWindowL.min.y;
+                        int dwx = x - dataWindowL.min.x;
+                        assert (
+                            localSampleCount[dwy][dwx] ==
+                            sampleCountWhole[ly][lx][dwy][dwx]);
+
+                        for (size_t k = 0; k < channelTypes.size (); k++)
+                        {
+                            if (channelTypes[k] == 0)
+                                data[k][dwy][dwx] = new unsigned int
+                                    [localSampleCount[dwy][dwx]];
+                            if (channelTypes[k] == 1)
+                                data[k][dwy][dwx] =
+                                    new half[localSampleCount[dwy][dwx]];
+                            if (channelTypes[k] == 2)
+                                data[k][dwy][dwx] =
+                                    new float[localSampleCount[dwy][dwx]];
+                        }
+
+                        for (int f = 0; f < fillChannels; ++f)
+                        {
+                            data[f + channelTypes.size ()][dwy][dwx] =
+                                new float[localSampleCount[dwy][dwx]];
+                        }
+                    }
+            };
+
+            if (singlePass)
+            {
+                //
+                // Testing single-pass read: the samples of each tile
+                // are allocated as soon as its sample counts are read.
+                //
+
+                file.readSampleCountsAndTiles (
+                    0,
+                    file.numXTiles (lx) - 1,
+                    0,
+                    file.numYTiles (ly) - 1,
+                    lx,
+                    ly,
+                    [&] (int dx, int dy, int tlx, int tly) {
+                        assert (tlx == lx && tly == ly);
+                        allocateTile (dx, dy);
+                    });
+            }
+            else if (bulkRead)
             {
                 //
                 // Testing bulk read (without relative coordinates).
@@ -581,43 +641,8 @@ readFile (
                     ly);
 
                 for (int i = 0; i < file.numYTiles (ly); i++)
-                {
                     for (int j = 0; j < file.numXTiles (lx); j++)
-                    {
-                        Box2i box = file.dataWindowForTile (j, i, lx, ly);
-                        for (int y = box.min.y; y <= box.max.y; y++)
-                            for (int x = box.min.x; x <= box.max.x; x++)
-                            {
-                                int dwy = y - dataWindowL.min.y;
-                                int dwx = x - dataWindowL.min.x;
-                                assert (
-                                    localSampleCount[dwy][dwx] ==
-                                    sampleCountWhole[ly][lx][dwy][dwx]);
-
-                                for (size_t k = 0; k < channelTypes.size ();
-                                     k++)
-                                {
-                                    if (channelTypes[k] == 0)
-                                        data[k][dwy][dwx] = new unsigned int
-                                            [localSampleCount[dwy][dwx]];
-                                    if (channelTypes[k] == 1)
-                                        data[k][dwy][dwx] =
-                                            new half[localSampleCount[dwy]
-                                                                     [dwx]];
-                                    if (channelTypes[k] == 2)
-                                        data[k][dwy][dwx] =
-                                            new float[localSampleCount[dwy]
-                                                                      [dwx]];
-                                }
-
-                                for (int f = 0; f < fillChannels; ++f)
-                                {
-                                    data[f + channelTypes.size ()][dwy][dwx] =
-                                        new float[localSampleCount[dwy][dwx]];
-                                }
-                            }
-                    }
-                }
+                        allocateTile (j, i);
 
                 file.readTiles (
                     0,
@@ -886,6 +911,8 @@ readWriteTestWithAbsoluateCoordinates (
         generateRandomFile (channelCount, compression, true, false, fn);
         readFile (channelCount, true, false, false, fn);
         readFile (channelCount, true, false, true, fn);
+        readFile (channelCount, true, false, false, fn, true);
+        readFile (channelCount, true, false, true, fn, true);
 
         remove (fn.c_str ());
         cout << endl << flush;
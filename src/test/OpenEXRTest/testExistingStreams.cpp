@@ -33,6 +33,8 @@
 #endif
 
 #include "ImfChannelList.h"
+#include <iterator>
+#include <string>
 #include <vector>
 
 #include "TestUtilFStream.h"
@@ -385,6 +387,127 @@ writeReadScanLines (
         }
     }
 
+    {
+        cout << ", reading (stateless)";
+        StdStatelessIFStream ifs (fileName);
+        assert (ifs.isStatelessRead ());
+
+        RgbaInputFile in (ifs);
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+        in.readPixels (dw.min.y, dw.max.y);
+
+        if (!isLossyCompression (compression))
+        {
+            cout << ", comparing";
+            for (int y = 0; y < h; ++y)
+            {
+                for (int x = 0; x < w; ++x)
+                {
+                    assert (p2[y][x].r == p1[y][x].r);
+                    assert (p2[y][x].g == p1[y][x].g);
+                    assert (p2[y][x].b == p1[y][x].b);
+                    assert (p2[y][x].a == p1[y][x].a);
+                }
+            }
+        }
+    }
+
+    {
+        cout << ", reading (memory)";
+        std::ifstream is;
+        testutil::OpenStreamWithUTF8Name (
+            is, fileName, ios::in | ios_base::binary);
+        std::string filedata (
+            (std::istreambuf_iterator<char> (is)),
+            std::istreambuf_iterator<char> ());
+
+        MemoryIStream ifs (filedata.data (), filedata.size (), fileName);
+        assert (ifs.isMemoryMapped () && ifs.isStatelessRead ());
+
+        RgbaInputFile in (ifs);
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+        in.readPixels (dw.min.y, dw.max.y);
+
+        if (!isLossyCompression (compression))
+        {
+            cout << ", comparing";
+            for (int y = 0; y < h; ++y)
+            {
+                for (int x = 0; x < w; ++x)
+                {
+                    assert (p2[y][x].r == p1[y][x].r);
+                    assert (p2[y][x].g == p1[y][x].g);
+                    assert (p2[y][x].b == p1[y][x].b);
+                    assert (p2[y][x].a == p1[y][x].a);
+                }
+            }
+        }
+    }
+
+    {
+        cout << ", writing (memory)";
+        std::vector<char> filedata;
+        {
+            MemoryOStream ofs (filedata, fileName);
+            Header        header (
+                width,
+                height,
+                1,
+                IMATH_NAMESPACE::V2f (0, 0),
+                1,
+                INCREASING_Y,
+                compression);
+            RgbaOutputFile out (ofs, header, WRITE_RGBA);
+            out.setFrameBuffer (&p1[0][0], 1, width);
+            out.writePixels (height);
+        }
+
+        cout << ", reading (memory)";
+        MemoryIStream ifs (filedata.data (), filedata.size (), fileName);
+        RgbaInputFile in (ifs);
+
+        const Box2i& dw = in.dataWindow ();
+        int          w  = dw.max.x - dw.min.x + 1;
+        int          h  = dw.max.y - dw.min.y + 1;
+        int          dx = dw.min.x;
+        int          dy = dw.min.y;
+
+        Array2D<Rgba> p2 (h, w);
+        in.setFrameBuffer (&p2[-dy][-dx], 1, w);
+        in.readPixels (dw.min.y, dw.max.y);
+
+        if (!isLossyCompression (compression))
+        {
+            cout << ", comparing";
+            for (int y = 0; y < h; ++y)
+            {
+                for (int x = 0; x < w; ++x)
+                {
+                    assert (p2[y][x].r == p1[y][x].r);
+                    assert (p2[y][x].g == p1[y][x].g);
+                    assert (p2[y][x].b == p1[y][x].b);
+                    assert (p2[y][x].a == p1[y][x].a);
+                }
+            }
+        }
+    }
+
     {
         cout << ", reading (memory-mapped, passthru)";
         MMIFStream       ifs (fileName);
@@ -1,6 +1,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // Copyright (c) Contributors to the OpenEXR Project.
 
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
 #include "testIDManifest.h"
 
 #include <assert.h>
@@ -107,6 +111,54 @@ operator<< (std::ostream& out, const IDManifest& mfst)
     return out;
 }
 
+//
+// check every entry of the manifest can be found through an IDManifestIndex
+//
+void
+checkIndex (const IDManifest& mfst, const IDManifestIndex& index)
+{
+    assert (index.size () == mfst.size ());
+
+    vector<string> text;
+    for (size_t g = 0; g < mfst.size (); ++g)
+    {
+        const IDManifest::ChannelGroupManifest& m = mfst[g];
+        const IDManifest::ChannelGroupManifest& h = index.header (g);
+
+        assert (h.getChannels () == m.getChannels ());
+        assert (h.getComponents () == m.getComponents ());
+        assert (h.getLifetime () == m.getLifetime ());
+        assert (h.getHashScheme () == m.getHashScheme ());
+        assert (h.getEncodingScheme () == m.getEncodingScheme ());
+        assert (h.size () == 0);
+        assert (index.find (*m.getChannels ().begin ()) <= g);
+        assert (index.numIds (g) == m.size ());
+
+        size_t entry = 0;
+        for (IDManifest::ChannelGroupManifest::ConstIterator i = m.begin ();
+             i != m.end ();
+             ++i, ++entry)
+        {
+            assert (index.id (g, entry) == i.id ());
+            assert (index.findEntry (g, i.id ()) == entry);
+
+            index.text (g, entry, text);
+            assert (text == i.text ());
+
+            text.clear ();
+            assert (index.lookup (g, i.id (), text));
+            assert (text == i.text ());
+
+            if (m.find (i.id () + 1) == m.end ())
+            {
+                assert (!index.lookup (g, i.id () + 1, text));
+                assert (index.findEntry (g, i.id () + 1) == m.size ());
+            }
+        }
+    }
+    assert (index.find ("not a channel in any group") == index.size ());
+}
+
 void
 doReadWriteManifest (const IDManifest& mfst, const string& fn, bool dump)
 {
@@ -156,6 +208,18 @@ doReadWriteManifest (const IDManifest& mfst, const string& fn, bool dump)
         cerr << "read manifest didn't match written manifest\n";
         assert (read == mfst);
     }
+
+    //
+    // index the manifest, both as read from the file and in place
+    //
+    checkIndex (mfst, IDManifestIndex (cmpd));
+
+    vector<char> serial;
+    mfst.serialize (serial);
+    checkIndex (
+        mfst,
+        IDManifestIndex (serial.data (), serial.data () + serial.size ()));
+
     remove (fn.c_str ());
 }
 
@@ -415,6 +479,48 @@ testLargeManifest (const string& tempDir)
     }
 }
 
+//
+// batched hashes must match hashing each ID on its own
+//
+void
+testBatchedHashes ()
+{
+    cerr << "Testing batched ID hashes... ";
+    random_reseed (3);
+
+    vector<string>         words (1000);
+    vector<vector<string>> ids (words.size ());
+    for (size_t i = 0; i < words.size (); ++i)
+    {
+        words[i] = randomWord (i % 2, vector<string> ());
+        ids[i].resize (i % 4);
+        for (size_t c = 0; c < ids[i].size (); ++c)
+        {
+            ids[i][c] = randomWord (true, vector<string> ());
+        }
+    }
+
+    vector<unsigned int> hash32 (words.size ());
+    vector<uint64_t>     hash64 (words.size ());
+
+    IDManifest::MurmurHash32 (words.data (), words.size (), hash32.data ());
+    IDManifest::MurmurHash64 (words.data (), words.size (), hash64.data ());
+    for (size_t i = 0; i < words.size (); ++i)
+    {
+        assert (hash32[i] == IDManifest::MurmurHash32 (words[i]));
+        assert (hash64[i] == IDManifest::MurmurHash64 (words[i]));
+    }
+
+    IDManifest::MurmurHash32 (ids.data (), ids.size (), hash32.data ());
+    IDManifest::MurmurHash64 (ids.data (), ids.size (), hash64.data ());
+    for (size_t i = 0; i < ids.size (); ++i)
+    {
+        assert (hash32[i] == IDManifest::MurmurHash32 (ids[i]));
+        assert (hash64[i] == IDManifest::MurmurHash64 (ids[i]));
+    }
+    cerr << "ok\n";
+}
+
 void
 testMerge ()
 {
@@ -575,4 +681,6 @@ testIDManifest (const std::string& tempDir)
 
     // test the API prevents creating invalid manifests
     testDoingBadThings ();
+
+    testBatchedHashes ();
 }
@@ -0,0 +1,286 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfInPlaceHeaderUpdate.h"
+#include "ImfInputPart.h"
+#include "ImfMultiPartInputFile.h"
+#include "ImfMultiPartOutputFile.h"
+#include "ImfOutputPart.h"
+#include "ImfPartType.h"
+#include "ImfStandardAttributes.h"
+#include "ImfTiledInputPart.h"
+#include "ImfTiledOutputPart.h"
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+
+using namespace IEX_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+const int W = 67;
+const int H = 43;
+
+vector<char>
+readFileBytes (const string& fileName)
+{
+    ifstream in (fileName, ios_base::in | ios_base::binary);
+    return vector<char> (
+        (istreambuf_iterator<char> (in)), istreambuf_iterator<char> ());
+}
+
+void
+fillPixels (Array2D<float>& pixels)
+{
+    pixels.resizeErase (H, W);
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            pixels[y][x] = float (x * 3 + y * 7);
+}
+
+vector<Header>
+makeHeaders ()
+{
+    vector<Header> headers (2, Header (W, H));
+
+    for (int p = 0; p < 2; ++p)
+    {
+        headers[p].channels ().insert ("Z", Channel (FLOAT));
+        headers[p].setName (p == 0 ? "scanlines" : "tiles");
+    }
+
+    headers[0].setType (SCANLINEIMAGE);
+    headers[0].compression () = ZIP_COMPRESSION;
+    headers[1].setType (TILEDIMAGE);
+    headers[1].setTileDescription (TileDescription (16, 16, ONE_LEVEL));
+
+    return headers;
+}
+
+void
+writeFile (const string& fileName, vector<Header> headers, int padding)
+{
+    Array2D<float> pixels;
+    fillPixels (pixels);
+
+    if (padding >= 0) addHeaderPadding (headers[0], padding);
+
+    MultiPartOutputFile file (fileName.c_str (), headers.data (), 2);
+    FrameBuffer         fb;
+    fb.insert (
+        "Z",
+        Slice (
+            FLOAT, (char*) &pixels[0][0], sizeof (float), sizeof (float) * W));
+
+    OutputPart scanlines (file, 0);
+    scanlines.setFrameBuffer (fb);
+    scanlines.writePixels (H);
+
+    TiledOutputPart tiles (file, 1);
+    tiles.setFrameBuffer (fb);
+    tiles.writeTiles (0, tiles.numXTiles () - 1, 0, tiles.numYTiles () - 1);
+}
+
+void
+checkPixels (const string& fileName)
+{
+    Array2D<float> expected, pixels;
+    fillPixels (expected);
+    pixels.resizeErase (H, W);
+
+    MultiPartInputFile file (fileName.c_str ());
+    FrameBuffer        fb;
+    fb.insert (
+        "Z",
+        Slice (
+            FLOAT, (char*) &pixels[0][0], sizeof (float), sizeof (float) * W));
+
+    InputPart scanlines (file, 0);
+    scanlines.setFrameBuffer (fb);
+    scanlines.readPixels (0, H - 1);
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            assert (pixels[y][x] == expected[y][x]);
+
+    TiledInputPart tiles (file, 1);
+    tiles.setFrameBuffer (fb);
+    tiles.readTiles (0, tiles.numXTiles () - 1, 0, tiles.numYTiles () - 1);
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            assert (pixels[y][x] == expected[y][x]);
+}
+
+vector<Header>
+readHeaders (const string& fileName)
+{
+    MultiPartInputFile file (fileName.c_str ());
+    vector<Header>     headers;
+
+    for (int p = 0; p < file.parts (); ++p)
+        headers.push_back (file.header (p));
+
+    return headers;
+}
+
+void
+testUpdate (const string& fileName)
+{
+    cout << "updating headers in place" << endl;
+
+    writeFile (fileName, makeHeaders (), 100);
+    size_t fileSize = readFileBytes (fileName).size ();
+
+    //
+    // Edits within the padding leave the pixels where they are.
+    //
+
+    vector<Header> headers = readHeaders (fileName);
+    addOwner (headers[1], "someone");
+    addComments (headers[0], "comments that take some of the padding");
+
+    assert (updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (readFileBytes (fileName).size () == fileSize);
+
+    headers = readHeaders (fileName);
+    assert (hasOwner (headers[1]) && owner (headers[1]) == "someone");
+    assert (hasComments (headers[0]));
+    assert (!hasOwner (headers[0]));
+    checkPixels (fileName);
+
+    //
+    // Shrinking the headers grows the padding back.
+    //
+
+    headers[0].erase ("comments");
+    assert (updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (readFileBytes (fileName).size () == fileSize);
+
+    headers = readHeaders (fileName);
+    assert (!hasComments (headers[0]));
+    addComments (headers[0], string (50, 'x'));
+    assert (updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (comments (readHeaders (fileName)[0]) == string (50, 'x'));
+    checkPixels (fileName);
+
+    //
+    // Headers that do not fit leave the file untouched.
+    //
+
+    vector<char> bytes = readFileBytes (fileName);
+    addComments (headers[0], string (200, 'y'));
+    assert (!updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (readFileBytes (fileName) == bytes);
+}
+
+void
+testNoPadding (const string& fileName)
+{
+    cout << "updating headers without padding" << endl;
+
+    writeFile (fileName, makeHeaders (), -1);
+
+    vector<Header> headers = readHeaders (fileName);
+    vector<char>   bytes   = readFileBytes (fileName);
+
+    // same size values can always be changed
+    headers[0].pixelAspectRatio () = 2.f;
+    headers[1].pixelAspectRatio () = 2.f;
+    assert (updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (readFileBytes (fileName).size () == bytes.size ());
+    assert (readHeaders (fileName)[0].pixelAspectRatio () == 2.f);
+
+    addOwner (headers[0], "someone");
+    bytes = readFileBytes (fileName);
+    assert (!updateHeadersInPlace (fileName.c_str (), headers.data (), 2));
+    assert (readFileBytes (fileName) == bytes);
+    checkPixels (fileName);
+}
+
+void
+testBadHeaders (const string& fileName)
+{
+    cout << "rejecting headers for different pixels" << endl;
+
+    writeFile (fileName, makeHeaders (), 100);
+
+    vector<Header> headers = readHeaders (fileName);
+
+    try
+    {
+        updateHeadersInPlace (fileName.c_str (), headers.data (), 1);
+        assert (false);
+    }
+    catch (const ArgExc&)
+    {}
+
+    headers[1].compression () = RLE_COMPRESSION;
+
+    try
+    {
+        updateHeadersInPlace (fileName.c_str (), headers.data (), 2);
+        assert (false);
+    }
+    catch (const ArgExc&)
+    {}
+
+    headers                  = readHeaders (fileName);
+    headers[0].dataWindow () = Box2i (V2i (0, 0), V2i (W, H - 1));
+
+    try
+    {
+        updateHeadersInPlace (fileName.c_str (), headers.data (), 2);
+        assert (false);
+    }
+    catch (const ArgExc&)
+    {}
+
+    checkPixels (fileName);
+}
+
+} // namespace
+
+void
+testInPlaceHeaderUpdate (const string& tempDir)
+{
+    try
+    {
+        cout << "Testing in place header updates" << endl;
+
+        string fileName = tempDir + "imf_test_inplace_header.exr";
+
+        testUpdate (fileName);
+        testNoPadding (fileName);
+        testBadHeaders (fileName);
+
+        remove (fileName.c_str ());
+        cout << "ok\n" << endl;
+    }
+    catch (const exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,651 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfCompression.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfInputFile.h"
+#include "ImfOutputFile.h"
+#include "ImfScanLineInputFile.h"
+#include "ImfTiledOutputFile.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+namespace
+{
+
+//
+// Channels R, G (HALF), A (FLOAT), id (UINT), and c (HALF, sampled 2x2),
+// filled with values which only depend on the pixel coordinates, such
+// that any pixel (or block average) read can be checked on its own.
+//
+
+const Box2i DW (V2i (-8, 2), V2i (183, 71));
+
+const float SENTINEL = -1.f;
+
+half
+halfValue (int x, int y, int k)
+{
+    return half (float ((x * 7 + y * 13 + k * 5 + 4096) % 2048));
+}
+
+float
+floatValue (int x, int y)
+{
+    return float (x) * 1000.f + float (y);
+}
+
+unsigned int
+uintValue (int x, int y)
+{
+    return (unsigned int) ((x + 100) * 3 + y * 1009);
+}
+
+struct Image
+{
+    Array2D<half>         r, g, c;
+    Array2D<float>        a, z;
+    Array2D<unsigned int> id;
+
+    void resize (int w, int h)
+    {
+        r.resizeErase (h, w);
+        g.resizeErase (h, w);
+        a.resizeErase (h, w);
+        z.resizeErase (h, w);
+        id.resizeErase (h, w);
+        c.resizeErase (h / 2, w / 2);
+    }
+};
+
+void
+writeImage (const string& fileName, Compression comp, bool sampled = true)
+{
+    int w = DW.max.x - DW.min.x + 1;
+    int h = DW.max.y - DW.min.y + 1;
+
+    Header hdr (DW, DW);
+    hdr.compression () = comp;
+    hdr.channels ().insert ("R", Channel (HALF));
+    hdr.channels ().insert ("G", Channel (HALF));
+    hdr.channels ().insert ("A", Channel (FLOAT));
+    hdr.channels ().insert ("id", Channel (UINT));
+    if (sampled) hdr.channels ().insert ("c", Channel (HALF, 2, 2));
+
+    Image img;
+    img.resize (w, h);
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int px = x + DW.min.x, py = y + DW.min.y;
+
+            img.r[y][x]  = halfValue (px, py, 0);
+            img.g[y][x]  = halfValue (px, py, 1);
+            img.a[y][x]  = floatValue (px, py);
+            img.id[y][x] = uintValue (px, py);
+            if (y % 2 == 0 && x % 2 == 0)
+                img.c[y / 2][x / 2] = halfValue (px, py, 2);
+        }
+    }
+
+    FrameBuffer fb;
+    fb.insert (
+        "R", Slice::Make (HALF, &img.r[0][0], DW, sizeof (half), w * sizeof (half)));
+    fb.insert (
+        "G", Slice::Make (HALF, &img.g[0][0], DW, sizeof (half), w * sizeof (half)));
+    fb.insert (
+        "A",
+        Slice::Make (FLOAT, &img.a[0][0], DW, sizeof (float), w * sizeof (float)));
+    fb.insert (
+        "id",
+        Slice::Make (
+            UINT,
+            &img.id[0][0],
+            DW,
+            sizeof (unsigned int),
+            w * sizeof (unsigned int)));
+    if (sampled)
+    {
+        fb.insert (
+            "c",
+            Slice::Make (
+                HALF,
+                &img.c[0][0],
+                DW,
+                sizeof (half),
+                (w / 2) * sizeof (half),
+                2,
+                2));
+    }
+
+    remove (fileName.c_str ());
+    OutputFile out (fileName.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (h);
+}
+
+//
+// Read region into buffers covering the whole data window, filled
+// with a sentinel, and check that exactly the pixels of the region
+// were written. Z is not in the file, so is filled.
+//
+
+void
+readAndCheck (InputFile& in, const Box2i& region, bool partial)
+{
+    int w = DW.max.x - DW.min.x + 1;
+    int h = DW.max.y - DW.min.y + 1;
+
+    Image img;
+    img.resize (w, h);
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            img.r[y][x]  = half (SENTINEL);
+            img.g[y][x]  = half (SENTINEL);
+            img.a[y][x]  = SENTINEL;
+            img.z[y][x]  = SENTINEL;
+            img.id[y][x] = 0xffffffff;
+            if (y % 2 == 0 && x % 2 == 0) img.c[y / 2][x / 2] = half (SENTINEL);
+        }
+    }
+
+    FrameBuffer fb;
+    fb.insert (
+        "R", Slice::Make (HALF, &img.r[0][0], DW, sizeof (half), w * sizeof (half)));
+    if (!partial)
+    {
+        fb.insert (
+            "G",
+            Slice::Make (HALF, &img.g[0][0], DW, sizeof (half), w * sizeof (half)));
+        fb.insert (
+            "id",
+            Slice::Make (
+                UINT,
+                &img.id[0][0],
+                DW,
+                sizeof (unsigned int),
+                w * sizeof (unsigned int)));
+        fb.insert (
+            "c",
+            Slice::Make (
+                HALF,
+                &img.c[0][0],
+                DW,
+                sizeof (half),
+                (w / 2) * sizeof (half),
+                2,
+                2));
+    }
+    fb.insert (
+        "A",
+        Slice::Make (FLOAT, &img.a[0][0], DW, sizeof (float), w * sizeof (float)));
+    fb.insert (
+        "Z",
+        Slice::Make (
+            FLOAT,
+            &img.z[0][0],
+            DW,
+            sizeof (float),
+            w * sizeof (float),
+            1,
+            1,
+            0.5));
+
+    in.readPixels (fb, region);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int  px = x + DW.min.x, py = y + DW.min.y;
+            bool inside = region.intersects (V2i (px, py));
+
+            assert (img.r[y][x] == (inside ? halfValue (px, py, 0) : half (SENTINEL)));
+            assert (img.a[y][x] == (inside ? floatValue (px, py) : SENTINEL));
+            assert (img.z[y][x] == (inside ? 0.5f : SENTINEL));
+            if (partial) continue;
+
+            assert (img.g[y][x] == (inside ? halfValue (px, py, 1) : half (SENTINEL)));
+            assert (img.id[y][x] == (inside ? uintValue (px, py) : 0xffffffff));
+            if (y % 2 == 0 && x % 2 == 0)
+            {
+                assert (
+                    img.c[y / 2][x / 2] ==
+                    (inside ? halfValue (px, py, 2) : half (SENTINEL)));
+            }
+        }
+    }
+}
+
+//
+// Read region into a frame buffer only as large as the region, as a
+// renderer re-reading crops of the scan lines would.
+//
+
+void
+readCrop (InputFile& in, const Box2i& region)
+{
+    int w = region.max.x - region.min.x + 1;
+    int h = region.max.y - region.min.y + 1;
+
+    Array2D<half>         r (h, w);
+    Array2D<float>        a (h, w);
+    Array2D<unsigned int> id (h, w);
+
+    FrameBuffer fb;
+    fb.insert (
+        "R", Slice::Make (HALF, &r[0][0], region, sizeof (half), w * sizeof (half)));
+    fb.insert (
+        "A",
+        Slice::Make (FLOAT, &a[0][0], region, sizeof (float), w * sizeof (float)));
+    fb.insert (
+        "id",
+        Slice::Make (
+            UINT,
+            &id[0][0],
+            region,
+            sizeof (unsigned int),
+            w * sizeof (unsigned int)));
+
+    in.readPixels (fb, region);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int px = x + region.min.x, py = y + region.min.y;
+
+            assert (r[y][x] == halfValue (px, py, 0));
+            assert (a[y][x] == floatValue (px, py));
+            assert (id[y][x] == uintValue (px, py));
+        }
+    }
+}
+
+void
+testCompression (const string& fileName, Compression comp, int numThreads)
+{
+    cout << "compression " << comp << ", threads " << numThreads << endl;
+
+    writeImage (fileName, comp);
+
+    {
+        InputFile in (fileName.c_str (), numThreads);
+
+        readAndCheck (in, Box2i (V2i (17, 5), V2i (60, 40)), false);
+        readAndCheck (in, Box2i (V2i (-8, 2), V2i (-8, 71)), false);
+        readAndCheck (in, Box2i (V2i (-7, 10), V2i (183, 10)), false);
+        readAndCheck (in, DW, false);
+
+        // re-reading scan lines of the last chunk, with a wider
+        // region or more channels than before
+        readAndCheck (in, Box2i (V2i (30, 60), V2i (40, 61)), true);
+        readAndCheck (in, Box2i (V2i (20, 60), V2i (50, 61)), true);
+        readAndCheck (in, Box2i (V2i (20, 60), V2i (50, 61)), false);
+        readAndCheck (in, Box2i (V2i (25, 60), V2i (45, 61)), false);
+
+        readCrop (in, Box2i (V2i (101, 3), V2i (130, 70)));
+        readCrop (in, Box2i (V2i (-3, 33), V2i (0, 33)));
+
+        // regions outside the data window are rejected
+        bool caught = false;
+        try
+        {
+            readAndCheck (in, Box2i (V2i (-9, 5), V2i (60, 40)), false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {
+            caught = true;
+        }
+        assert (caught);
+    }
+
+    remove (fileName.c_str ());
+}
+
+void
+testTiled (const string& fileName)
+{
+    Header hdr (DW, DW);
+    hdr.channels ().insert ("R", Channel (HALF));
+    hdr.setTileDescription (TileDescription (32, 32, ONE_LEVEL));
+
+    {
+        remove (fileName.c_str ());
+        TiledOutputFile out (fileName.c_str (), hdr);
+    }
+
+    // region reads are only available for scan line files
+    InputFile     in (fileName.c_str ());
+    Array2D<half> r (1, 1);
+    FrameBuffer   fb;
+    fb.insert ("R", Slice (HALF, (char*) &r[0][0], 0, 0));
+
+    bool caught = false;
+    try
+    {
+        in.readPixels (fb, Box2i (V2i (0, 2), V2i (0, 2)));
+    }
+    catch (const IEX_NAMESPACE::ArgExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+
+    remove (fileName.c_str ());
+}
+
+int
+floorDiv (int v, int n)
+{
+    return (v >= 0) ? (v / n) : -((n - 1 - v) / n);
+}
+
+int
+ceilDiv (int v, int n)
+{
+    return -floorDiv (-v, n);
+}
+
+//
+// The value expected for the decimated pixel (x, y): either the pixel
+// (x * n, y * n), or the average of the n by n block it starts, clipped
+// to the data window and the chunk of scan lines it is in.
+//
+
+void
+expectedDecimated (
+    int x, int y, int n, bool box, int linesPerChunk, half& r, float& a)
+{
+    int px = x * n, py = y * n;
+
+    r = halfValue (px, py, 0);
+    a = floatValue (px, py);
+    if (!box) return;
+
+    int chunkEnd =
+        DW.min.y + ((py - DW.min.y) / linesPerChunk + 1) * linesPerChunk - 1;
+    int ey = min (min (py + n - 1, chunkEnd), DW.max.y);
+    int ex = min (px + n - 1, DW.max.x);
+
+    float rs = 0.f, as = 0.f;
+    for (int by = py; by <= ey; ++by)
+    {
+        for (int bx = px; bx <= ex; ++bx)
+        {
+            rs += float (halfValue (bx, by, 0));
+            as += floatValue (bx, by);
+        }
+    }
+
+    float count = float ((ey - py + 1) * (ex - px + 1));
+    r           = half (rs / count);
+    a           = as / count;
+}
+
+//
+// Read region of the decimated image (or all of its scan lines) into
+// buffers covering the whole decimated data window, filled with a
+// sentinel, and check that exactly the pixels of the region were
+// written.
+//
+
+void
+readDecimated (
+    InputFile&   in,
+    int          n,
+    bool         box,
+    int          linesPerChunk,
+    const Box2i& region,
+    bool         useRegion)
+{
+    Box2i ddw = in.decimatedDataWindow ();
+    int   w   = ddw.max.x - ddw.min.x + 1;
+    int   h   = ddw.max.y - ddw.min.y + 1;
+
+    Image img;
+    img.resize (w, h);
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            img.r[y][x]  = half (SENTINEL);
+            img.a[y][x]  = SENTINEL;
+            img.z[y][x]  = SENTINEL;
+            img.id[y][x] = 0xffffffff;
+        }
+    }
+
+    FrameBuffer fb;
+    fb.insert (
+        "R",
+        Slice::Make (HALF, &img.r[0][0], ddw, sizeof (half), w * sizeof (half)));
+    fb.insert (
+        "A",
+        Slice::Make (FLOAT, &img.a[0][0], ddw, sizeof (float), w * sizeof (float)));
+    fb.insert (
+        "id",
+        Slice::Make (
+            UINT,
+            &img.id[0][0],
+            ddw,
+            sizeof (unsigned int),
+            w * sizeof (unsigned int)));
+    fb.insert (
+        "Z",
+        Slice::Make (
+            FLOAT,
+            &img.z[0][0],
+            ddw,
+            sizeof (float),
+            w * sizeof (float),
+            1,
+            1,
+            0.5));
+
+    if (useRegion)
+        in.readPixels (fb, region);
+    else
+    {
+        in.setFrameBuffer (fb);
+        in.readPixels (region.min.y, region.max.y);
+    }
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            int  px = x + ddw.min.x, py = y + ddw.min.y;
+            bool inside = region.intersects (V2i (px, py));
+
+            if (!inside)
+            {
+                assert (img.r[y][x] == half (SENTINEL));
+                assert (img.a[y][x] == SENTINEL);
+                assert (img.z[y][x] == SENTINEL);
+                assert (img.id[y][x] == 0xffffffff);
+                continue;
+            }
+
+            half  er;
+            float ea;
+            expectedDecimated (px, py, n, box, linesPerChunk, er, ea);
+
+            assert (img.r[y][x] == er);
+            assert (img.a[y][x] == ea);
+            assert (img.z[y][x] == 0.5f);
+            assert (img.id[y][x] == uintValue (px * n, py * n));
+        }
+    }
+}
+
+void
+testDecimation (const string& fileName, Compression comp, int numThreads)
+{
+    cout << "decimation, compression " << comp << ", threads " << numThreads
+         << endl;
+
+    // sub-sampled channels cannot be decimated
+    writeImage (fileName, comp, false);
+
+    int linesPerChunk = getCompressionNumScanlines (comp);
+
+    {
+        InputFile in (fileName.c_str (), numThreads);
+        assert (in.decimation () == 1);
+        assert (in.decimatedDataWindow () == DW);
+
+        for (int n: {1, 3, 4, 7})
+        {
+            for (bool box: {false, true})
+            {
+                in.setDecimation (n, box);
+                assert (in.decimation () == n);
+
+                Box2i ddw = in.decimatedDataWindow ();
+                assert (ddw.min.x == ceilDiv (DW.min.x, n));
+                assert (ddw.min.y == ceilDiv (DW.min.y, n));
+                assert (ddw.max.x == floorDiv (DW.max.x, n));
+                assert (ddw.max.y == floorDiv (DW.max.y, n));
+
+                readDecimated (in, n, box, linesPerChunk, ddw, false);
+
+                Box2i region (
+                    V2i (ddw.min.x + 2, ddw.min.y + 1),
+                    V2i (ddw.max.x - 3, ddw.min.y + 5));
+                readDecimated (in, n, box, linesPerChunk, region, true);
+
+                region = Box2i (
+                    V2i (ddw.min.x + 1, ddw.max.y - 4),
+                    V2i (ddw.max.x, ddw.max.y));
+                readDecimated (in, n, box, linesPerChunk, region, true);
+            }
+        }
+
+        in.setDecimation (1);
+        readDecimated (in, 1, false, linesPerChunk, DW, false);
+    }
+
+    remove (fileName.c_str ());
+}
+
+void
+testInvalidDecimation (const string& fileName)
+{
+    writeImage (fileName, ZIP_COMPRESSION);
+
+    {
+        InputFile in (fileName.c_str ());
+
+        // sub-sampled channels cannot be decimated
+        bool caught = false;
+        try
+        {
+            in.setDecimation (2);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {
+            caught = true;
+        }
+        assert (caught);
+        assert (in.decimation () == 1);
+
+        // decimating by one is reading every pixel
+        in.setDecimation (1);
+
+        // as is a factor which leaves no pixels, or is not positive
+        caught = false;
+        try
+        {
+            in.setDecimation (0);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {
+            caught = true;
+        }
+        assert (caught);
+    }
+
+    writeImage (fileName, ZIP_COMPRESSION, false);
+
+    {
+        InputFile in (fileName.c_str ());
+
+        bool caught = false;
+        try
+        {
+            in.setDecimation (1000);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {
+            caught = true;
+        }
+        assert (caught);
+    }
+
+    remove (fileName.c_str ());
+}
+
+} // namespace
+
+void
+testReadRegion (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing reading regions of scan lines" << endl;
+
+        string fn = tempDir + "imf_test_read_region.exr";
+
+        const Compression comps[] = {
+            NO_COMPRESSION,
+            RLE_COMPRESSION,
+            ZIP_COMPRESSION,
+            PIZ_COMPRESSION,
+            HTJ2K32_COMPRESSION};
+
+        for (Compression comp: comps)
+        {
+            testCompression (fn, comp, 0);
+            testCompression (fn, comp, 4);
+        }
+
+        testTiled (fn);
+
+        cout << "Testing decimated reading of scan lines" << endl;
+
+        for (Compression comp: comps)
+        {
+            testDecimation (fn, comp, 0);
+            testDecimation (fn, comp, 4);
+        }
+
+        testInvalidDecimation (fn);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
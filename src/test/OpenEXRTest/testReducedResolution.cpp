@@ -0,0 +1,509 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfInputFile.h"
+#include "ImfOutputFile.h"
+#include "ImfScanLineInputFile.h"
+#include "ImfTiledInputFile.h"
+#include "ImfTiledOutputFile.h"
+#include "random.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+namespace
+{
+
+const int   NUM_CHANNELS = 3;
+const char* CHANNEL_NAMES[NUM_CHANNELS] = {"B", "G", "R"};
+
+struct Planes
+{
+    Array2D<half>&       operator[] (int c) { return planes[c]; }
+    const Array2D<half>& operator[] (int c) const { return planes[c]; }
+
+    Array2D<half> planes[NUM_CHANNELS];
+};
+
+Header
+makeHeader (const Box2i& dw, Compression comp)
+{
+    Header hdr (dw, dw);
+    hdr.compression () = comp;
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+        hdr.channels ().insert (CHANNEL_NAMES[c], Channel (HALF));
+    return hdr;
+}
+
+FrameBuffer
+makeFrameBuffer (const Box2i& dw, Planes& pixels)
+{
+    int w = dw.max.x - dw.min.x + 1;
+    int h = dw.max.y - dw.min.y + 1;
+
+    FrameBuffer fb;
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+    {
+        pixels[c].resizeErase (h, w);
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                pixels[c][y][x] = half (-1.f);
+
+        fb.insert (
+            CHANNEL_NAMES[c],
+            Slice::Make (
+                HALF,
+                &pixels[c][0][0],
+                dw,
+                sizeof (half),
+                w * sizeof (half)));
+    }
+    return fb;
+}
+
+void
+fillConstant (Planes& pixels, int w, int h)
+{
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                pixels[c][y][x] = half (0.25f * float (c + 1));
+}
+
+void
+checkConstant (const Planes& pixels, int w, int h)
+{
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                assert (pixels[c][y][x] == half (0.25f * float (c + 1)));
+}
+
+Box2i
+reduceWindow (const Box2i& dw, int levels)
+{
+    int   d = 1 << levels;
+    Box2i r;
+    r.min.x = int (floor (double (dw.min.x) / d));
+    r.min.y = int (floor (double (dw.min.y) / d));
+    r.max.x = r.min.x + (dw.max.x - dw.min.x + d) / d - 1;
+    r.max.y = r.min.y + (dw.max.y - dw.min.y + d) / d - 1;
+    return r;
+}
+
+void
+testScanLines (const std::string& fn)
+{
+    cout << "scan lines" << flush;
+
+    Box2i dw (V2i (-7, -5), V2i (92, 70));
+    int   w = dw.max.x - dw.min.x + 1;
+    int   h = dw.max.y - dw.min.y + 1;
+
+    {
+        Planes pixels;
+        FrameBuffer fb = makeFrameBuffer (dw, pixels);
+        fillConstant (pixels, w, h);
+
+        OutputFile out (fn.c_str (), makeHeader (dw, HTJ2K32_COMPRESSION));
+        out.setFrameBuffer (fb);
+        out.writePixels (h);
+    }
+
+    for (int levels = 0; levels <= 3; ++levels)
+    {
+        cout << " " << levels << flush;
+
+        ScanLineInputFile in (fn.c_str ());
+        in.setResolutionReduction (levels);
+        assert (in.resolutionReduction () == levels);
+
+        Box2i rdw = in.reducedDataWindow ();
+        assert (rdw == reduceWindow (dw, levels));
+
+        int rw = rdw.max.x - rdw.min.x + 1;
+        int rh = rdw.max.y - rdw.min.y + 1;
+
+        Planes pixels;
+        in.setFrameBuffer (makeFrameBuffer (rdw, pixels));
+        in.readPixels (rdw.min.y, rdw.max.y);
+        checkConstant (pixels, rw, rh);
+
+        // one scan line at a time through InputFile
+        InputFile in2 (fn.c_str ());
+        in2.setResolutionReduction (levels);
+        assert (in2.reducedDataWindow () == rdw);
+
+        Planes pixels2;
+        in2.setFrameBuffer (makeFrameBuffer (rdw, pixels2));
+        for (int y = rdw.max.y; y >= rdw.min.y; --y)
+            in2.readPixels (y);
+        checkConstant (pixels2, rw, rh);
+    }
+
+    // noise does not compress, so chunks are stored uncompressed,
+    // which are point sampled
+    {
+        Planes pixels;
+        FrameBuffer fb = makeFrameBuffer (dw, pixels);
+        random_reseed (1);
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+            for (int y = 0; y < h; ++y)
+                for (int x = 0; x < w; ++x)
+                    pixels[c][y][x].setBits (
+                        static_cast<unsigned short> (random_int (1 << 16)));
+
+        {
+            OutputFile out (
+                fn.c_str (), makeHeader (dw, HTJ2K32_COMPRESSION));
+            out.setFrameBuffer (fb);
+            out.writePixels (h);
+        }
+
+        ScanLineInputFile in (fn.c_str ());
+        in.setResolutionReduction (2);
+        Box2i rdw = in.reducedDataWindow ();
+
+        Planes rpixels;
+        in.setFrameBuffer (makeFrameBuffer (rdw, rpixels));
+        in.readPixels (rdw.min.y, rdw.max.y);
+
+        std::vector<char> raw (w * 32 * NUM_CHANNELS * sizeof (half));
+        int               uncompressed = 0;
+        for (int y = dw.min.y; y <= dw.max.y; y += 32)
+        {
+            int rawsize = int (raw.size ());
+            in.rawPixelDataToBuffer (y, raw.data (), rawsize);
+
+            int lines = std::min (32, dw.max.y - y + 1);
+            if (rawsize != int (w * lines * NUM_CHANNELS * sizeof (half)))
+                continue;
+
+            ++uncompressed;
+            for (int c = 0; c < NUM_CHANNELS; ++c)
+                for (int ry = (y - dw.min.y) / 4;
+                     ry < (y - dw.min.y + lines + 3) / 4;
+                     ++ry)
+                    for (int rx = 0; rx < (w + 3) / 4; ++rx)
+                        assert (
+                            rpixels[c][ry][rx].bits () ==
+                            pixels[c][ry * 4][rx * 4].bits ());
+        }
+        assert (uncompressed > 0);
+    }
+
+    // compressions other than HTJ2K can not be reduced
+    {
+        {
+            Planes pixels;
+            OutputFile out (fn.c_str (), makeHeader (dw, ZIP_COMPRESSION));
+            out.setFrameBuffer (makeFrameBuffer (dw, pixels));
+            out.writePixels (h);
+        }
+
+        ScanLineInputFile in (fn.c_str ());
+        in.setResolutionReduction (0);
+        try
+        {
+            in.setResolutionReduction (1);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {
+            assert (in.resolutionReduction () == 0);
+        }
+    }
+
+    remove (fn.c_str ());
+    cout << endl;
+}
+
+void
+testTiles (const std::string& fn)
+{
+    cout << "tiles" << flush;
+
+    Box2i dw (V2i (3, -9), V2i (103, 60));
+    int   w = dw.max.x - dw.min.x + 1;
+    int   h = dw.max.y - dw.min.y + 1;
+
+    {
+        Planes pixels;
+        FrameBuffer fb = makeFrameBuffer (dw, pixels);
+        fillConstant (pixels, w, h);
+
+        Header hdr = makeHeader (dw, HTJ2K256_COMPRESSION);
+        hdr.setTileDescription (TileDescription (32, 16, ONE_LEVEL));
+
+        TiledOutputFile out (fn.c_str (), hdr);
+        out.setFrameBuffer (fb);
+        out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+    }
+
+    for (int levels = 0; levels <= 4; ++levels)
+    {
+        cout << " " << levels << flush;
+
+        TiledInputFile in (fn.c_str ());
+        in.setResolutionReduction (levels);
+
+        Box2i rdw = in.reducedDataWindow ();
+        assert (rdw == reduceWindow (dw, levels));
+
+        Planes pixels;
+        in.setFrameBuffer (makeFrameBuffer (rdw, pixels));
+        in.readTiles (0, in.numXTiles () - 1, 0, in.numYTiles () - 1);
+        checkConstant (
+            pixels, rdw.max.x - rdw.min.x + 1, rdw.max.y - rdw.min.y + 1);
+    }
+
+    {
+        TiledInputFile in (fn.c_str ());
+        // 2^5 does not divide the tile height
+        try
+        {
+            in.setResolutionReduction (5);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+
+        InputFile in2 (fn.c_str ());
+        try
+        {
+            in2.setResolutionReduction (1);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+    }
+
+    remove (fn.c_str ());
+    cout << endl;
+}
+
+void
+testDwa (const std::string& fn, Compression comp, bool tiled)
+{
+    cout << "dwa " << (comp == DWAA_COMPRESSION ? "a" : "b")
+         << (tiled ? " tiled" : "") << flush;
+
+    // the edge tiles are big enough to compress, and not be stored
+    // (and then point sampled) as is
+    Box2i dw (V2i (-5, 3), V2i (194, 125));
+    int   w = dw.max.x - dw.min.x + 1;
+    int   h = dw.max.y - dw.min.y + 1;
+
+    //
+    // R, G and B are lossy compressed, A is run length encoded, and
+    // Z and id are zip compressed by the default DWA channel rules
+    //
+
+    Planes                rgba;
+    Array2D<float>        z (h, w);
+    Array2D<unsigned int> id (h, w);
+    for (int c = 0; c < NUM_CHANNELS; ++c)
+        rgba[c].resizeErase (h, w);
+    Array2D<half> alpha (h, w);
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            rgba[0][y][x] = half (0.2f + 0.003f * float (x));
+            rgba[1][y][x] = half (0.5f);
+            rgba[2][y][x] = half (0.1f + 0.004f * float (y));
+            alpha[y][x]   = half ((x / 3 + y) % 2 ? 1.f : 0.25f);
+            z[y][x]       = float (x * y) * 0.5f;
+            id[y][x]      = (unsigned int) ((x / 5) * 1000 + y);
+        }
+    }
+
+    {
+        Header hdr = makeHeader (dw, comp);
+        hdr.channels ().insert ("A", Channel (HALF));
+        hdr.channels ().insert ("Z", Channel (FLOAT));
+        hdr.channels ().insert ("id", Channel (UINT));
+
+        FrameBuffer fb;
+        for (int c = 0; c < NUM_CHANNELS; ++c)
+            fb.insert (
+                CHANNEL_NAMES[c],
+                Slice::Make (
+                    HALF, &rgba[c][0][0], dw, sizeof (half), w * sizeof (half)));
+        fb.insert (
+            "A",
+            Slice::Make (
+                HALF, &alpha[0][0], dw, sizeof (half), w * sizeof (half)));
+        fb.insert (
+            "Z",
+            Slice::Make (
+                FLOAT, &z[0][0], dw, sizeof (float), w * sizeof (float)));
+        fb.insert (
+            "id",
+            Slice::Make (
+                UINT,
+                &id[0][0],
+                dw,
+                sizeof (unsigned int),
+                w * sizeof (unsigned int)));
+
+        if (tiled)
+        {
+            hdr.setTileDescription (TileDescription (64, 32, ONE_LEVEL));
+            TiledOutputFile out (fn.c_str (), hdr);
+            out.setFrameBuffer (fb);
+            out.writeTiles (0, out.numXTiles () - 1, 0, out.numYTiles () - 1);
+        }
+        else
+        {
+            OutputFile out (fn.c_str (), hdr);
+            out.setFrameBuffer (fb);
+            out.writePixels (h);
+        }
+    }
+
+    Box2i                 rdw = reduceWindow (dw, 3);
+    int                   rw  = rdw.max.x - rdw.min.x + 1;
+    int                   rh  = rdw.max.y - rdw.min.y + 1;
+    Planes                rpixels;
+    Array2D<half>         ralpha (rh, rw);
+    Array2D<float>        rz (rh, rw);
+    Array2D<unsigned int> rid (rh, rw);
+
+    FrameBuffer fb = makeFrameBuffer (rdw, rpixels);
+    fb.insert (
+        "A",
+        Slice::Make (
+            HALF, &ralpha[0][0], rdw, sizeof (half), rw * sizeof (half)));
+    fb.insert (
+        "Z",
+        Slice::Make (FLOAT, &rz[0][0], rdw, sizeof (float), rw * sizeof (float)));
+    fb.insert (
+        "id",
+        Slice::Make (
+            UINT,
+            &rid[0][0],
+            rdw,
+            sizeof (unsigned int),
+            rw * sizeof (unsigned int)));
+
+    if (tiled)
+    {
+        TiledInputFile in (fn.c_str ());
+        try
+        {
+            in.setResolutionReduction (2);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+
+        in.setResolutionReduction (3);
+        assert (in.reducedDataWindow () == rdw);
+        in.setFrameBuffer (fb);
+        in.readTiles (0, in.numXTiles () - 1, 0, in.numYTiles () - 1);
+    }
+    else
+    {
+        InputFile in (fn.c_str ());
+        try
+        {
+            in.setResolutionReduction (1);
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::ArgExc&)
+        {}
+
+        in.setResolutionReduction (3);
+        assert (in.reducedDataWindow () == rdw);
+        in.setFrameBuffer (fb);
+        in.readPixels (rdw.min.y, rdw.max.y);
+    }
+
+    //
+    // The lossy channels are the block averages, up to the
+    // compression error, the others are box filtered exactly,
+    // except for id which is point sampled
+    //
+
+    for (int ry = 0; ry < rh; ++ry)
+    {
+        for (int rx = 0; rx < rw; ++rx)
+        {
+            int    x0 = rx * 8, x1 = std::min (x0 + 8, w);
+            int    y0 = ry * 8, y1 = std::min (y0 + 8, h);
+            double avg[NUM_CHANNELS] = {0, 0, 0}, avga = 0, avgz = 0;
+            int    n = (x1 - x0) * (y1 - y0);
+
+            for (int y = y0; y < y1; ++y)
+            {
+                for (int x = x0; x < x1; ++x)
+                {
+                    for (int c = 0; c < NUM_CHANNELS; ++c)
+                        avg[c] += rgba[c][y][x];
+                    avga += alpha[y][x];
+                    avgz += z[y][x];
+                }
+            }
+
+            // partial blocks are padded by the encoder, so only
+            // check the full blocks of the lossy channels
+            if (x1 - x0 == 8 && y1 - y0 == 8)
+            {
+                for (int c = 0; c < NUM_CHANNELS; ++c)
+                    assert (
+                        fabs (float (rpixels[c][ry][rx]) - avg[c] / n) <
+                        0.02 * avg[c] / n + 0.002);
+            }
+
+            assert (fabs (float (ralpha[ry][rx]) - avga / n) < 0.001);
+            assert (fabs (rz[ry][rx] - avgz / n) < 1e-5 * avgz / n + 1e-5);
+            assert (rid[ry][rx] == id[y0][x0]);
+        }
+    }
+
+    remove (fn.c_str ());
+    cout << endl;
+}
+
+} // namespace
+
+void
+testReducedResolution (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing reduced resolution decoding" << endl;
+
+        testScanLines (tempDir + "imf_test_reduced_sl.exr");
+        testTiles (tempDir + "imf_test_reduced_t.exr");
+        testDwa (tempDir + "imf_test_reduced_dwa.exr", DWAA_COMPRESSION, false);
+        testDwa (tempDir + "imf_test_reduced_dwa.exr", DWAB_COMPRESSION, false);
+        testDwa (tempDir + "imf_test_reduced_dwa.exr", DWAB_COMPRESSION, true);
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -0,0 +1,298 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "IlmThread.h"
+#include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfInputFile.h"
+#include "ImfOutputFile.h"
+#include "ImfScanLineBands.h"
+#include "ImfThreading.h"
+
+#include "Iex.h"
+
+#include <Imath/half.h>
+
+#include <assert.h>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <stdio.h>
+#include <vector>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace std;
+using namespace IMATH_NAMESPACE;
+
+namespace
+{
+
+const int W = 117;
+const int H = 533;
+
+half
+pixelValue (int x, int y)
+{
+    return half (float (x % 10 + 10 * (y % 17)));
+}
+
+Slice
+bandSlice (Array2D<half>& band, int y1)
+{
+    return Slice (
+        HALF,
+        (char*) (&band[0][0] - y1 * W),
+        sizeof (half),
+        sizeof (half) * W);
+}
+
+void
+writeImage (const string& fileName)
+{
+    Header hdr (W, H);
+    hdr.compression () = ZIP_COMPRESSION;
+    hdr.channels ().insert ("H", Channel (HALF));
+
+    Array2D<half> pixels (H, W);
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            pixels[y][x] = pixelValue (x, y);
+
+    FrameBuffer fb;
+    fb.insert ("H", bandSlice (pixels, 0));
+
+    remove (fileName.c_str ());
+    OutputFile out (fileName.c_str (), hdr);
+    out.setFrameBuffer (fb);
+    out.writePixels (H);
+}
+
+//
+// Copy inFileName to outFileName in bands of bandHeight scan lines,
+// checking the bands come in line order, cover the image, and are not
+// read into the buffer that is being written.
+//
+
+void
+copyImage (
+    const string& inFileName,
+    const string& outFileName,
+    LineOrder     lineOrder,
+    int           bandHeight)
+{
+    InputFile in (inFileName.c_str ());
+    Header    hdr = in.header ();
+    hdr.lineOrder () = lineOrder;
+
+    remove (outFileName.c_str ());
+    OutputFile out (outFileName.c_str (), hdr);
+
+    Array2D<half> bands[2];
+    for (Array2D<half>& band: bands)
+        band.resizeErase (bandHeight, W);
+
+    atomic<int> writing (-1);
+    int         nextY = lineOrder == DECREASING_Y ? H - 1 : 0;
+
+    convertScanLineBands (
+        0,
+        H - 1,
+        bandHeight,
+        lineOrder,
+        [&] (int buffer, int y1, int y2) {
+            assert (buffer != writing);
+            assert (y1 <= y2 && y2 - y1 < bandHeight);
+
+            FrameBuffer fb;
+            fb.insert ("H", bandSlice (bands[buffer], y1));
+            in.setFrameBuffer (fb);
+            in.readPixels (y1, y2);
+        },
+        [&] (int buffer, int y1, int y2) {
+            writing = buffer;
+
+            if (lineOrder == DECREASING_Y)
+            {
+                assert (y2 == nextY);
+                nextY = y1 - 1;
+            }
+            else
+            {
+                assert (y1 == nextY);
+                nextY = y2 + 1;
+            }
+
+            FrameBuffer fb;
+            fb.insert ("H", bandSlice (bands[buffer], y1));
+            out.setFrameBuffer (fb);
+            out.writePixels (y2 - y1 + 1);
+
+            writing = -1;
+        });
+
+    assert (nextY == (lineOrder == DECREASING_Y ? -1 : H));
+}
+
+void
+checkImage (const string& fileName)
+{
+    InputFile     in (fileName.c_str ());
+    Array2D<half> pixels (H, W);
+
+    FrameBuffer fb;
+    fb.insert ("H", bandSlice (pixels, 0));
+    in.setFrameBuffer (fb);
+    in.readPixels (0, H - 1);
+
+    for (int y = 0; y < H; ++y)
+        for (int x = 0; x < W; ++x)
+            assert (pixels[y][x] == pixelValue (x, y));
+}
+
+vector<char>
+fileBytes (const string& fileName)
+{
+    ifstream file (fileName.c_str (), ios::binary);
+    return vector<char> (
+        (istreambuf_iterator<char> (file)), istreambuf_iterator<char> ());
+}
+
+void
+testErrors ()
+{
+    cout << "errors" << endl;
+
+    auto ignore = [] (int, int, int) {};
+
+    try
+    {
+        convertScanLineBands (0, H - 1, 0, INCREASING_Y, ignore, ignore);
+        assert (false);
+    }
+    catch (const IEX_NAMESPACE::ArgExc&)
+    {
+        // expected
+    }
+
+    //
+    // An exception on the reading thread reaches the caller, after
+    // the band that was being written is done.
+    //
+
+    for (int failing = 1; failing < 3; ++failing)
+    {
+        int written = 0;
+
+        try
+        {
+            convertScanLineBands (
+                0,
+                H - 1,
+                64,
+                INCREASING_Y,
+                [&] (int, int y1, int) {
+                    if (y1 == failing * 64)
+                        THROW (IEX_NAMESPACE::InputExc, "read failed");
+                },
+                [&] (int, int, int) { ++written; });
+
+            assert (false);
+        }
+        catch (const IEX_NAMESPACE::InputExc&)
+        {
+            assert (written == failing);
+        }
+    }
+
+    try
+    {
+        convertScanLineBands (
+            0,
+            H - 1,
+            64,
+            DECREASING_Y,
+            ignore,
+            [] (int, int, int) {
+                THROW (IEX_NAMESPACE::IoExc, "write failed");
+            });
+
+        assert (false);
+    }
+    catch (const IEX_NAMESPACE::IoExc&)
+    {
+        // expected
+    }
+}
+
+} // namespace
+
+void
+testScanLineBands (const std::string& tempDir)
+{
+    try
+    {
+        cout << "Testing converting scan lines in bands" << endl;
+
+        string inFileName  = tempDir + "imf_test_bands_in.exr";
+        string outFileName = tempDir + "imf_test_bands_out.exr";
+
+        writeImage (inFileName);
+
+        int maxThreads = ILMTHREAD_NAMESPACE::supportsThreads () ? 8 : 0;
+
+        for (int lorder = 0; lorder < RANDOM_Y; ++lorder)
+        {
+            LineOrder    lineOrder = LineOrder (lorder);
+            vector<char> expected;
+
+            for (int bandHeight: {1, 37, 0})
+            {
+                for (int n: {0, maxThreads})
+                {
+                    setGlobalThreadCount (n);
+
+                    int lines = bandHeight ? bandHeight
+                                           : scanLineBandHeight (16);
+
+                    cout << "line order " << lorder << ", " << lines
+                         << " lines per band, " << globalThreadCount ()
+                         << " threads" << endl;
+
+                    copyImage (inFileName, outFileName, lineOrder, lines);
+                    checkImage (outFileName);
+
+                    //
+                    // The output does not depend on the number of
+                    // threads or on the band height.
+                    //
+
+                    if (expected.empty ())
+                        expected = fileBytes (outFileName);
+                    else
+                        assert (fileBytes (outFileName) == expected);
+                }
+            }
+        }
+
+        testErrors ();
+
+        remove (inFileName.c_str ());
+        remove (outFileName.c_str ());
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
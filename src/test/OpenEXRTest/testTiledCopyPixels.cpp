@@ -12,6 +12,7 @@
 #include "ImfFrameBuffer.h"
 #include "ImfHeader.h"
 #include "ImfInputFile.h"
+#include "ImfThreading.h"
 #include "ImfTiledInputFile.h"
 #include "ImfTiledOutputFile.h"
 #include <Imath/half.h>
@@ -566,10 +567,24 @@ testTiledCopyPixels (const std::string& tempDir)
         const int DY = 29;
         const int YS = 55;
 
-        writeCopyRead (tempDir, W, H, DX, YS, 0, 0);
-        writeCopyRead (tempDir, W, H, DX, YS, 0, DY);
-        writeCopyRead (tempDir, W, H, DX, YS, DX, 0);
-        writeCopyRead (tempDir, W, H, DX, YS, DX, DY);
+        //
+        // With threads, copyPixels() reads the tiles in parallel.
+        //
+
+        int numThreads = globalThreadCount ();
+
+        for (int n: {0, 4})
+        {
+            cout << "threads " << n << endl;
+            setGlobalThreadCount (n);
+
+            writeCopyRead (tempDir, W, H, DX, YS, 0, 0);
+            writeCopyRead (tempDir, W, H, DX, YS, 0, DY);
+            writeCopyRead (tempDir, W, H, DX, YS, DX, 0);
+            writeCopyRead (tempDir, W, H, DX, YS, DX, DY);
+        }
+
+        setGlobalThreadCount (numThreads);
 
         cout << "ok\n" << endl;
     }
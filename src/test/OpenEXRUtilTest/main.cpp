@@ -14,6 +14,7 @@
 #include "testFlatImage.h"
 #include "testImageChannel.h"
 #include "testIO.h"
+#include "testTranscode.h"
 #include "tmpDir.h"
 #include <Imath/ImathRandom.h>
 
@@ -91,6 +92,7 @@ main (int argc, char* argv[])
     TEST (testDeepImage);
     TEST (testIO);
     TEST (testImageChannel);
+    TEST (testTranscode);
     // NB: If you add a test here, make sure to enumerate it in the
     // CMakeLists.txt so it runs as part of the test suite
 
@@ -11,11 +11,13 @@
 #include "ImfDeepImage.h"
 #include "ImfDeepImageIO.h"
 #include "ImfHeader.h"
+#include "ImfStandardAttributes.h"
 
 #include <Imath/ImathRandom.h>
 
 #include <cassert>
 #include <climits>
+#include <cmath>
 #include <cstdio>
 
 using namespace OPENEXR_IMF_NAMESPACE;
@@ -772,6 +774,320 @@ testRoundListSizeUpLimits ()
     });
 }
 
+float
+rowEditSample (int x, int y, unsigned int j)
+{
+    return float (x * 10000 + y * 100 + int (j));
+}
+
+void
+checkRowEdit (
+    const DeepImageLevel& level, const vector<unsigned int>& oldCounts)
+{
+    const Box2i&              dw = level.dataWindow ();
+    const SampleCountChannel& sc = level.sampleCounts ();
+    const DeepFloatChannel&   fc = level.typedChannel<float> ("F");
+    const DeepUIntChannel&    uc = level.typedChannel<unsigned int> ("U");
+    size_t                    i  = 0;
+
+    for (int y = dw.min.y; y <= dw.max.y; ++y)
+    {
+        for (int x = dw.min.x; x <= dw.max.x; ++x, ++i)
+        {
+            for (unsigned int j = 0; j < sc (x, y); ++j)
+            {
+                if (j < oldCounts[i])
+                {
+                    assert (fc (x, y)[j] == rowEditSample (x, y, j));
+                    assert (uc (x, y)[j] == j);
+                }
+                else
+                {
+                    assert (fc (x, y)[j] == 0);
+                    assert (uc (x, y)[j] == 0);
+                }
+            }
+        }
+    }
+}
+
+void
+fillRowEdit (DeepImageLevel& level)
+{
+    const Box2i&              dw = level.dataWindow ();
+    const SampleCountChannel& sc = level.sampleCounts ();
+
+    for (int y = dw.min.y; y <= dw.max.y; ++y)
+    {
+        for (int x = dw.min.x; x <= dw.max.x; ++x)
+        {
+            for (unsigned int j = 0; j < sc (x, y); ++j)
+            {
+                level.typedChannel<float> ("F") (x, y)[j] =
+                    rowEditSample (x, y, j);
+                level.typedChannel<unsigned int> ("U") (x, y)[j] = j;
+            }
+        }
+    }
+}
+
+void
+testRowEdit ()
+{
+    cout << "editing sample counts in a range of rows" << endl;
+
+    Box2i     dataWindow (V2i (-3, 2), V2i (12, 21));
+    DeepImage img (dataWindow, ONE_LEVEL);
+    img.insertChannel ("F", FLOAT);
+    img.insertChannel ("U", UINT);
+
+    DeepImageLevel&     level = img.level ();
+    SampleCountChannel& sc    = level.sampleCounts ();
+
+    {
+        SampleCountChannel::Edit edit (sc);
+
+        for (size_t i = 0; i < sc.numPixels (); ++i)
+            edit.sampleCounts ()[i] = (unsigned int) (i % 4);
+    }
+
+    fillRowEdit (level);
+
+    vector<unsigned int> oldCounts (
+        sc.numSamples (), sc.numSamples () + sc.numPixels ());
+
+    //
+    // Shrink and grow sample lists within the space already
+    // allocated, then grow them past the end of the sample buffer.
+    //
+
+    size_t bufferSize = sc.sampleBufferSize ();
+
+    {
+        SampleCountChannel::RowEdit edit (sc, 5, 8);
+
+        for (int i = 0; i < 4 * sc.pixelsPerRow (); ++i)
+        {
+            unsigned int& n = edit.sampleCounts ()[i];
+            n               = (i % 3 == 0) ? n / 2 : n + 1;
+        }
+    }
+
+    assert (sc.sampleBufferSize () == bufferSize);
+    checkRowEdit (level, oldCounts);
+
+    for (size_t i = 0; i < sc.numPixels (); ++i)
+        oldCounts[i] = min (oldCounts[i], sc.numSamples ()[i]);
+
+    {
+        SampleCountChannel::RowEdit edit (sc, 0, 1);
+
+        for (int i = 0; i < 2 * sc.pixelsPerRow (); ++i)
+            edit.sampleCounts ()[i] += 100;
+    }
+
+    assert (sc.sampleBufferSize () > bufferSize);
+    checkRowEdit (level, oldCounts);
+
+    //
+    // Rows must be within the data window.
+    //
+
+    bool caught = false;
+    try
+    {
+        sc.beginRowEdit (0, sc.pixelsPerColumn ());
+    }
+    catch (const ArgExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+
+    //
+    // Edits cannot be nested, and a rejected edit leaves the one
+    // in progress alone.
+    //
+
+    for (int outer = 0; outer < 2; ++outer)
+    {
+        for (int inner = 0; inner < 2; ++inner)
+        {
+            if (outer == 0)
+                sc.beginEdit ();
+            else
+                sc.beginRowEdit (2, 3);
+
+            caught = false;
+            try
+            {
+                if (inner == 0)
+                    sc.beginEdit ();
+                else
+                    sc.beginRowEdit (0, 1);
+            }
+            catch (const ArgExc&)
+            {
+                caught = true;
+            }
+            assert (caught);
+
+            if (outer == 0)
+                sc.endEdit ();
+            else
+                sc.endRowEdit ();
+        }
+    }
+
+    fillRowEdit (level);
+    oldCounts.assign (sc.numSamples (), sc.numSamples () + sc.numPixels ());
+
+    {
+        SampleCountChannel::RowEdit edit (sc, 2, 3);
+        edit.sampleCounts ()[0] += 1;
+    }
+
+    checkRowEdit (level, oldCounts);
+}
+
+void
+setSamples (
+    DeepImageLevel&                    level,
+    int                                x,
+    int                                y,
+    const vector<vector<float>>&       samples,
+    const vector<unsigned int>&        ids)
+{
+    //
+    // samples[i] is {Z, ZBack, A, R}
+    //
+
+    level.sampleCounts ().set (x, y, (unsigned int) samples.size ());
+
+    for (size_t i = 0; i < samples.size (); ++i)
+    {
+        level.typedChannel<float> ("Z").at (x, y)[i]     = samples[i][0];
+        level.typedChannel<float> ("ZBack").at (x, y)[i] = samples[i][1];
+        level.typedChannel<half> ("A").at (x, y)[i]      = samples[i][2];
+        level.typedChannel<float> ("R").at (x, y)[i]     = samples[i][3];
+        level.typedChannel<unsigned int> ("id").at (x, y)[i] = ids[i];
+    }
+}
+
+void
+checkSamples (
+    const DeepImageLevel&              level,
+    int                                x,
+    int                                y,
+    const vector<vector<float>>&       samples,
+    const vector<unsigned int>&        ids)
+{
+    assert (level.sampleCounts ().at (x, y) == samples.size ());
+
+    for (size_t i = 0; i < samples.size (); ++i)
+    {
+        assert (level.typedChannel<float> ("Z").at (x, y)[i] == samples[i][0]);
+        assert (
+            level.typedChannel<float> ("ZBack").at (x, y)[i] == samples[i][1]);
+        assert (
+            fabs (level.typedChannel<half> ("A").at (x, y)[i] - samples[i][2]) <
+            1e-3);
+        assert (
+            fabs (level.typedChannel<float> ("R").at (x, y)[i] - samples[i][3]) <
+            1e-5);
+        assert (level.typedChannel<unsigned int> ("id").at (x, y)[i] == ids[i]);
+    }
+}
+
+void
+testTidy ()
+{
+    cout << "tidying deep pixels" << endl;
+
+    DeepImage img (Box2i (V2i (0, 0), V2i (2, 1)), ONE_LEVEL);
+    img.insertChannel ("Z", FLOAT);
+    img.insertChannel ("ZBack", FLOAT);
+    img.insertChannel ("A", HALF);
+    img.insertChannel ("R", FLOAT);
+    img.insertChannel ("id", UINT);
+
+    DeepImageLevel& level = img.level ();
+
+    // already tidy
+    setSamples (level, 0, 0, {{1, 1, 0.5, 0.5}, {2, 2, 1, 1}}, {1, 2});
+
+    // unsorted point samples
+    setSamples (level, 1, 0, {{3, 3, 1, 1}, {1, 1, 0.5, 0.25}}, {1, 2});
+
+    // coincident point samples
+    setSamples (level, 2, 0, {{1, 1, 0.5, 0.5}, {1, 1, 0.5, 0.25}}, {1, 2});
+
+    // overlapping volume samples
+    setSamples (level, 0, 1, {{1, 3, 0.75, 0.375}, {0, 2, 0.75, 0.75}}, {1, 2});
+
+    // no samples
+    setSamples (level, 1, 1, {}, {});
+
+    // point sample inside a volume sample
+    setSamples (level, 2, 1, {{0, 2, 0.75, 0.75}, {1, 1, 1, 1}}, {1, 2});
+
+    //
+    // Splitting a volume sample with opacity 0.75 in half gives
+    // two samples with opacity 0.5; merging two samples with opacity
+    // 0.5 and colors 0.5 and 0.25 gives opacity 0.75 and the average
+    // of the colors composited in either order, 0.5625.
+    //
+
+    Header hdr;
+    img.tidy (hdr);
+
+    assert (deepImageState (hdr) == DIS_TIDY);
+
+    checkSamples (level, 0, 0, {{1, 1, 0.5, 0.5}, {2, 2, 1, 1}}, {1, 2});
+    checkSamples (level, 1, 0, {{1, 1, 0.5, 0.25}, {3, 3, 1, 1}}, {2, 1});
+    checkSamples (level, 2, 0, {{1, 1, 0.75, 0.5625}}, {1});
+
+    checkSamples (
+        level,
+        0,
+        1,
+        {{0, 1, 0.5, 0.5}, {1, 2, 0.75, 0.5625}, {2, 3, 0.5, 0.25}},
+        {2, 1, 1});
+
+    checkSamples (level, 1, 1, {}, {});
+
+    checkSamples (
+        level,
+        2,
+        1,
+        {{0, 1, 0.5, 0.5}, {1, 1, 1, 1}, {1, 2, 0.5, 0.5}},
+        {1, 2, 1});
+
+    //
+    // Tidying a tidy image changes nothing.
+    //
+
+    img.tidy ();
+    checkSamples (level, 2, 0, {{1, 1, 0.75, 0.5625}}, {1});
+
+    //
+    // The Z channel is required.
+    //
+
+    img.eraseChannel ("Z");
+
+    bool caught = false;
+    try
+    {
+        img.tidy ();
+    }
+    catch (const ArgExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+}
+
 } // namespace
 
 void
@@ -791,6 +1107,8 @@ testDeepImage (const string& tempDir)
         testCropping (tempDir + "deepCropped.exr");
         testRenameChannel ();
         testRenameChannels ();
+        testTidy ();
+        testRowEdit ();
 
         cout << "ok\n" << endl;
     }
@@ -0,0 +1,480 @@
+//
+// SPDX-License-Identifier: BSD-3-Clause
+// Copyright (c) Contributors to the OpenEXR Project.
+//
+
+#ifdef NDEBUG
+#    undef NDEBUG
+#endif
+
+#include "Iex.h"
+#include "ImfArray.h"
+#include "ImfChannelList.h"
+#include "ImfDeepImage.h"
+#include "ImfFlatImage.h"
+#include "ImfFrameBuffer.h"
+#include "ImfHeader.h"
+#include "ImfImageIO.h"
+#include "ImfInputPart.h"
+#include "ImfMultiPartInputFile.h"
+#include "ImfMultiPartOutputFile.h"
+#include "ImfOutputPart.h"
+#include "ImfPartType.h"
+#include "ImfStringAttribute.h"
+#include "ImfThreading.h"
+#include "ImfTiledOutputPart.h"
+#include "ImfTranscode.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+
+using namespace OPENEXR_IMF_NAMESPACE;
+using namespace IMATH_NAMESPACE;
+using namespace IEX_NAMESPACE;
+using namespace std;
+
+namespace
+{
+
+half
+value (int x, int y, int c)
+{
+    return half (float ((x * 5 + y * 17 + c * 101 + 2048) % 1024) * 0.25f);
+}
+
+void
+fillFlat (FlatImage& img)
+{
+    for (int ly = 0; ly < img.numYLevels (); ++ly)
+    {
+        for (int lx = 0; lx < img.numXLevels (); ++lx)
+        {
+            if (img.levelMode () != RIPMAP_LEVELS && lx != ly) continue;
+
+            FlatImageLevel& level = img.level (lx, ly);
+            const Box2i&    dw    = level.dataWindow ();
+            int             c     = 0;
+
+            for (FlatImageLevel::Iterator i = level.begin (); i != level.end ();
+                 ++i, ++c)
+            {
+                FlatImageChannel& ch = i.channel ();
+                for (int y = dw.min.y; y <= dw.max.y; ++y)
+                {
+                    for (int x = dw.min.x; x <= dw.max.x; ++x)
+                    {
+                        if (x % ch.xSampling () || y % ch.ySampling ())
+                            continue;
+
+                        if (ch.pixelType () == HALF)
+                            level.typedChannel<half> (i.name ()) (x, y) =
+                                value (x, y, c);
+                        else if (ch.pixelType () == FLOAT)
+                            level.typedChannel<float> (i.name ()) (x, y) =
+                                float (x) * 1000.f + float (y) + 0.5f;
+                        else
+                            level.typedChannel<unsigned int> (i.name ()) (
+                                x, y) = (unsigned int) (x * 3 + y * 1009 + c);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+compareFlat (const FlatImage& a, const FlatImage& b)
+{
+    assert (a.levelMode () == b.levelMode ());
+    assert (a.numXLevels () == b.numXLevels ());
+    assert (a.numYLevels () == b.numYLevels ());
+
+    for (int ly = 0; ly < a.numYLevels (); ++ly)
+    {
+        for (int lx = 0; lx < a.numXLevels (); ++lx)
+        {
+            if (a.levelMode () != RIPMAP_LEVELS && lx != ly) continue;
+
+            const FlatImageLevel& la = a.level (lx, ly);
+            const FlatImageLevel& lb = b.level (lx, ly);
+            const Box2i&          dw = la.dataWindow ();
+            assert (dw == lb.dataWindow ());
+
+            for (FlatImageLevel::ConstIterator i = la.begin (); i != la.end ();
+                 ++i)
+            {
+                const FlatImageChannel& ch = i.channel ();
+                for (int y = dw.min.y; y <= dw.max.y; ++y)
+                {
+                    for (int x = dw.min.x; x <= dw.max.x; ++x)
+                    {
+                        if (x % ch.xSampling () || y % ch.ySampling ())
+                            continue;
+
+                        if (ch.pixelType () == HALF)
+                            assert (
+                                la.typedChannel<half> (i.name ()) (x, y)
+                                    .bits () ==
+                                lb.typedChannel<half> (i.name ()) (x, y)
+                                    .bits ());
+                        else if (ch.pixelType () == FLOAT)
+                            assert (
+                                la.typedChannel<float> (i.name ()) (x, y) ==
+                                lb.typedChannel<float> (i.name ()) (x, y));
+                        else
+                            assert (
+                                la.typedChannel<unsigned int> (i.name ()) (
+                                    x, y) ==
+                                lb.typedChannel<unsigned int> (i.name ()) (
+                                    x, y));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void
+fillDeep (DeepImage& img)
+{
+    for (int l = 0; l < img.numLevels (); ++l)
+    {
+        DeepImageLevel& level = img.level (l);
+        const Box2i&    dw    = level.dataWindow ();
+        int             w     = dw.max.x - dw.min.x + 1;
+
+        {
+            SampleCountChannel::Edit edit (level.sampleCounts ());
+            for (int y = dw.min.y; y <= dw.max.y; ++y)
+                for (int x = dw.min.x; x <= dw.max.x; ++x)
+                    edit.sampleCounts ()[(y - dw.min.y) * w + (x - dw.min.x)] =
+                        ((x + 64) * 3 + y) % 5;
+        }
+
+        TypedDeepImageChannel<half>&  z = level.typedChannel<half> ("Z");
+        TypedDeepImageChannel<float>& a = level.typedChannel<float> ("A");
+        for (int y = dw.min.y; y <= dw.max.y; ++y)
+        {
+            for (int x = dw.min.x; x <= dw.max.x; ++x)
+            {
+                unsigned int n = level.sampleCounts ().at (x, y);
+                for (unsigned int s = 0; s < n; ++s)
+                {
+                    z.at (x, y)[s] = value (x, y, int (s));
+                    a.at (x, y)[s] = float (x + y) + float (s) * 0.125f;
+                }
+            }
+        }
+    }
+}
+
+void
+compareDeep (const DeepImage& a, const DeepImage& b)
+{
+    assert (a.numLevels () == b.numLevels ());
+
+    for (int l = 0; l < a.numLevels (); ++l)
+    {
+        const DeepImageLevel& la = a.level (l);
+        const DeepImageLevel& lb = b.level (l);
+        const Box2i&          dw = la.dataWindow ();
+        assert (dw == lb.dataWindow ());
+
+        for (int y = dw.min.y; y <= dw.max.y; ++y)
+        {
+            for (int x = dw.min.x; x <= dw.max.x; ++x)
+            {
+                unsigned int n = la.sampleCounts ().at (x, y);
+                assert (n == lb.sampleCounts ().at (x, y));
+
+                for (unsigned int s = 0; s < n; ++s)
+                {
+                    assert (
+                        la.typedChannel<half> ("Z").at (x, y)[s].bits () ==
+                        lb.typedChannel<half> ("Z").at (x, y)[s].bits ());
+                    assert (
+                        la.typedChannel<float> ("A").at (x, y)[s] ==
+                        lb.typedChannel<float> ("A").at (x, y)[s]);
+                }
+            }
+        }
+    }
+}
+
+//
+// Transcode the image saved with header hdr, and check the output has
+// the new compression method, the other attributes of the original,
+// and the same pixels.
+//
+
+void
+transcodeAndCompare (
+    const string& inName,
+    const string& outName,
+    const Header& hdr,
+    const Image&  img,
+    Compression   comp)
+{
+    saveImage (inName, hdr, img);
+
+    remove (outName.c_str ());
+    transcodeOpenEXRFile (inName.c_str (), outName.c_str (), comp);
+
+    Header                 inHdr, outHdr;
+    unique_ptr<Image>      in (loadImage (inName, inHdr));
+    unique_ptr<Image>      out (loadImage (outName, outHdr));
+
+    assert (outHdr.compression () == comp);
+    assert (outHdr.dataWindow () == inHdr.dataWindow ());
+    assert (outHdr.lineOrder () == inHdr.lineOrder ());
+    assert (outHdr.hasTileDescription () == inHdr.hasTileDescription ());
+    assert (outHdr.find ("comments") != outHdr.end ());
+
+    if (dynamic_cast<FlatImage*> (in.get ()))
+        compareFlat (
+            *dynamic_cast<FlatImage*> (in.get ()),
+            *dynamic_cast<FlatImage*> (out.get ()));
+    else
+        compareDeep (
+            *dynamic_cast<DeepImage*> (in.get ()),
+            *dynamic_cast<DeepImage*> (out.get ()));
+}
+
+Header
+makeHeader (Compression comp)
+{
+    Header hdr;
+    hdr.compression () = comp;
+    hdr.insert ("comments", StringAttribute ("transcoded"));
+    return hdr;
+}
+
+void
+testFlatScanLine (const string& inName, const string& outName)
+{
+    cout << "flat scan line" << endl;
+
+    FlatImage img (Box2i (V2i (-3, 2), V2i (140, 121)));
+    img.insertChannel ("R", HALF);
+    img.insertChannel ("G", FLOAT);
+    img.insertChannel ("id", UINT);
+    fillFlat (img);
+
+    const Compression comps[][2] = {
+        {PIZ_COMPRESSION, ZIP_COMPRESSION},
+        {ZIP_COMPRESSION, PIZ_COMPRESSION},
+        {ZIPS_COMPRESSION, RLE_COMPRESSION},
+        {NO_COMPRESSION, HTJ2K256_COMPRESSION},
+        {HTJ2K32_COMPRESSION, NO_COMPRESSION},
+        {RLE_COMPRESSION, ZIPS_COMPRESSION}};
+
+    for (const auto& c: comps)
+        transcodeAndCompare (inName, outName, makeHeader (c[0]), img, c[1]);
+
+    // sub-sampled channels, which change the size of the chunks
+    FlatImage sub (Box2i (V2i (0, 0), V2i (63, 69)));
+    sub.insertChannel ("Y", HALF);
+    sub.insertChannel ("RY", HALF, 2, 2);
+    sub.insertChannel ("BY", HALF, 2, 2);
+    fillFlat (sub);
+
+    transcodeAndCompare (
+        inName, outName, makeHeader (ZIP_COMPRESSION), sub, PIZ_COMPRESSION);
+    transcodeAndCompare (
+        inName, outName, makeHeader (PIZ_COMPRESSION), sub, RLE_COMPRESSION);
+}
+
+void
+testFlatTiled (const string& inName, const string& outName)
+{
+    cout << "flat tiled" << endl;
+
+    for (LevelMode mode: {ONE_LEVEL, MIPMAP_LEVELS, RIPMAP_LEVELS})
+    {
+        FlatImage img (Box2i (V2i (1, -2), V2i (80, 50)), mode, ROUND_UP);
+        img.insertChannel ("R", HALF);
+        img.insertChannel ("A", FLOAT);
+        fillFlat (img);
+
+        Header hdr = makeHeader (RLE_COMPRESSION);
+        hdr.setTileDescription (TileDescription (16, 24, mode, ROUND_UP));
+
+        transcodeAndCompare (inName, outName, hdr, img, ZIP_COMPRESSION);
+
+        hdr.compression () = PIZ_COMPRESSION;
+        transcodeAndCompare (inName, outName, hdr, img, NO_COMPRESSION);
+    }
+}
+
+void
+testDeep (const string& inName, const string& outName)
+{
+    cout << "deep" << endl;
+
+    DeepImage img (Box2i (V2i (-2, 0), V2i (60, 40)));
+    img.insertChannel ("Z", HALF);
+    img.insertChannel ("A", FLOAT);
+    fillDeep (img);
+
+    transcodeAndCompare (
+        inName, outName, makeHeader (ZIPS_COMPRESSION), img, RLE_COMPRESSION);
+    transcodeAndCompare (
+        inName, outName, makeHeader (RLE_COMPRESSION), img, NO_COMPRESSION);
+    transcodeAndCompare (
+        inName, outName, makeHeader (NO_COMPRESSION), img, ZIPS_COMPRESSION);
+
+    //
+    // ZIPD compresses the sample count table of a chunk along with its
+    // samples, so the table is passed to the encoder with the data
+    //
+
+    transcodeAndCompare (
+        inName, outName, makeHeader (RLE_COMPRESSION), img, ZIPD_COMPRESSION);
+    transcodeAndCompare (
+        inName, outName, makeHeader (ZIPD_COMPRESSION), img, ZIPS_COMPRESSION);
+
+    DeepImage tiled (Box2i (V2i (0, 0), V2i (50, 37)), MIPMAP_LEVELS);
+    tiled.insertChannel ("Z", HALF);
+    tiled.insertChannel ("A", FLOAT);
+    fillDeep (tiled);
+
+    Header hdr = makeHeader (ZIPS_COMPRESSION);
+    hdr.setTileDescription (TileDescription (16, 16, MIPMAP_LEVELS));
+    transcodeAndCompare (inName, outName, hdr, tiled, RLE_COMPRESSION);
+
+    hdr.compression () = RLE_COMPRESSION;
+    transcodeAndCompare (inName, outName, hdr, tiled, ZIPD_COMPRESSION);
+
+    // deep data cannot use most compression methods
+    saveImage (inName, makeHeader (ZIPS_COMPRESSION), img);
+
+    bool caught = false;
+    try
+    {
+        transcodeOpenEXRFile (
+            inName.c_str (), outName.c_str (), PIZ_COMPRESSION);
+    }
+    catch (const ArgExc&)
+    {
+        caught = true;
+    }
+    assert (caught);
+}
+
+void
+testMultiPart (const string& inName, const string& outName)
+{
+    cout << "multi-part" << endl;
+
+    const Box2i dw (V2i (0, 0), V2i (47, 39));
+    const int   w = 48, h = 40;
+
+    Array2D<half> pixels (h, w);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            pixels[y][x] = value (x, y, 0);
+
+    vector<Header> headers (2, Header (dw, dw));
+    headers[0].setName ("lines");
+    headers[0].setType (SCANLINEIMAGE);
+    headers[0].compression () = ZIP_COMPRESSION;
+    headers[1].setName ("tiles");
+    headers[1].setType (TILEDIMAGE);
+    headers[1].compression () = PIZ_COMPRESSION;
+    headers[1].setTileDescription (TileDescription (16, 16));
+    for (Header& hdr: headers)
+        hdr.channels ().insert ("R", Channel (HALF));
+
+    FrameBuffer fb;
+    fb.insert (
+        "R",
+        Slice (HALF, (char*) &pixels[0][0], sizeof (half), w * sizeof (half)));
+
+    {
+        remove (inName.c_str ());
+        MultiPartOutputFile out (inName.c_str (), headers.data (), 2);
+
+        OutputPart lines (out, 0);
+        lines.setFrameBuffer (fb);
+        lines.writePixels (h);
+
+        TiledOutputPart tiles (out, 1);
+        tiles.setFrameBuffer (fb);
+        tiles.writeTiles (0, tiles.numXTiles () - 1, 0, tiles.numYTiles () - 1);
+    }
+
+    remove (outName.c_str ());
+    transcodeOpenEXRFile (
+        inName.c_str (), outName.c_str (), DWAB_COMPRESSION, 0.f);
+
+    MultiPartInputFile in (outName.c_str ());
+    assert (in.parts () == 2);
+
+    for (int p = 0; p < 2; ++p)
+    {
+        const Header& hdr = in.header (p);
+        assert (hdr.name () == headers[p].name ());
+        assert (hdr.type () == headers[p].type ());
+        assert (hdr.compression () == DWAB_COMPRESSION);
+
+        Array2D<half> result (h, w);
+        FrameBuffer   rfb;
+        rfb.insert (
+            "R",
+            Slice (
+                HALF, (char*) &result[0][0], sizeof (half), w * sizeof (half)));
+
+        InputPart part (in, p);
+        part.setFrameBuffer (rfb);
+        part.readPixels (dw.min.y, dw.max.y);
+
+        // the DWA quantization level is zero, so values are close
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                assert (
+                    fabs (float (result[y][x]) - float (pixels[y][x])) <=
+                    0.01f * fabs (float (pixels[y][x])) + 0.01f);
+    }
+}
+
+} // namespace
+
+void
+testTranscode (const string& tempDir)
+{
+    try
+    {
+        cout << "Testing packed-domain transcoding" << endl;
+
+        string inName  = tempDir + "imf_test_transcode_in.exr";
+        string outName = tempDir + "imf_test_transcode_out.exr";
+
+        int threads = globalThreadCount ();
+
+        for (int n: {0, 4})
+        {
+            cout << "threads " << n << endl;
+            setGlobalThreadCount (n);
+
+            testFlatScanLine (inName, outName);
+            testFlatTiled (inName, outName);
+            testDeep (inName, outName);
+            testMultiPart (inName, outName);
+        }
+
+        setGlobalThreadCount (threads);
+
+        remove (inName.c_str ());
+        remove (outName.c_str ());
+
+        cout << "ok\n" << endl;
+    }
+    catch (const std::exception& e)
+    {
+        cerr << "ERROR -- caught exception: " << e.what () << endl;
+        assert (false);
+    }
+}
@@ -145,4 +145,40 @@ assert os.path.isfile(outimage2)
 result = do_run ([exrinfo, "-v", outimage2])
 assert "comments" not in result.stdout
 
+# reserve header space, then edit the file in place
+result = do_run ([exrstdattr, "-pad", "256", outimage, outimage2])
+size = os.path.getsize(outimage2)
+
+result = do_run ([exrstdattr, "-owner", "someone with a longer name", outimage2, outimage2])
+assert os.path.getsize(outimage2) == size
+
+result = do_run ([exrinfo, "-v", outimage2])
+assert 'owner: string \'someone with a longer name\'' in result.stdout
+
+# headers that do not fit make the file be rewritten
+result = do_run ([exrstdattr, "-comments", "x" * 1000, outimage2, outimage2])
+assert os.path.getsize(outimage2) > size
+
+result = do_run ([exrinfo, "-v", outimage2])
+assert 'owner: string \'someone with a longer name\'' in result.stdout
+assert 'x' * 1000 in result.stdout
+
+# the same file spelled differently is also edited in place
+size = os.path.getsize(outimage2)
+samefile = os.path.join(os.path.dirname(outimage2), ".", os.path.basename(outimage2))
+result = do_run ([exrstdattr, "-owner", "someone else", outimage2, samefile])
+assert os.path.getsize(outimage2) == size
+
+result = do_run ([exrinfo, "-v", outimage2])
+assert 'owner: string \'someone else\'' in result.stdout
+
+# a failed rewrite leaves no temporary file behind
+with open(test_images["GrayRampsHorizontal"], "rb") as f:
+    data = f.read()
+with open(outimage2, "wb") as f:
+    f.write(data[:len(data) // 2])
+
+result = do_run ([exrstdattr, "-comments", "x" * 1000, outimage2, outimage2], True)
+assert not os.path.exists(outimage2 + ".tmp")
+
 print("success")
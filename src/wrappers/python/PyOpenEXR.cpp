@@ -3022,6 +3022,7 @@ PYBIND11_MODULE(OpenEXR, m)
         .value("DWAB_COMPRESSION", DWAB_COMPRESSION)
         .value("HTJ2K256_COMPRESSION", HTJ2K256_COMPRESSION)
         .value("HTJ2K32_COMPRESSION", HTJ2K32_COMPRESSION)
+        .value("ZIPD_COMPRESSION", ZIPD_COMPRESSION)
         .value("NUM_COMPRESSION_METHODS", NUM_COMPRESSION_METHODS)
         .export_values();
     
@@ -3502,7 +3503,8 @@ PYBIND11_MODULE(OpenEXR, m)
              "    DWAA_COMPRESSION\n"
              "    DWAB_COMPRESSION\n"
              "    HTJ2K256_COMPRESSION\n"
-             "    HTJ2K32_COMPRESSION")
+             "    HTJ2K32_COMPRESSION\n"
+             "    ZIPD_COMPRESSION")
         .def_readwrite("header", &PyPart::header,
              "dict : The header metadata.")
         .def_readwrite("channels", &PyPart::channels,